@@ -40,6 +40,8 @@
 
 #include <vector>
 #include <set>
+#include <map>
+#include <utility>
 
 namespace OpenMS
 {
@@ -64,19 +66,30 @@ public:
     /// If the input feature map is empty, a warning is issued and -1 is returned.
     /// @return value of objective function
     /// and @p pairs will have all realized edges set to "active"
-    double compute(const FeatureMap fm, PairsType& pairs, Size verbose_level) const;
+    /// Independent groups of edges are solved in parallel (biggest first).
+    double compute(const FeatureMap& fm, PairsType& pairs, Size verbose_level) const;
 
 private:
 
+    /// feature variant id --> adjacent edges (columns of the slice)
+    typedef Map<Size, std::set<Size> > FeatureType_;
+
     /// slicing the problem into subproblems
-    double computeSlice_(const FeatureMap fm,
+    double computeSlice_(const FeatureMap& fm,
                          PairsType& pairs,
+                         const std::vector<std::pair<Size, Size> >& pair_variants,
                          const PairsIndex margin_left,
                          const PairsIndex margin_right,
                          const Size verbose_level) const;
 
+    /// set up and solve the ILP of one slice (feature index --> variants)
+    double solveSlice_(const std::map<Size, FeatureType_>& features,
+                       PairsType& pairs,
+                       const PairsIndex margin_left,
+                       const PairsIndex margin_right) const;
+
     /// slicing the problem into subproblems
-    double computeSliceOld_(const FeatureMap fm,
+    double computeSliceOld_(const FeatureMap& fm,
                             PairsType& pairs,
                             const PairsIndex margin_left,
                             const PairsIndex margin_right,
@@ -85,12 +98,6 @@ private:
     /// calculate a score for the i_th edge
     double getLogScore_(const PairsType::value_type& pair, const FeatureMap& fm) const;
 
-    typedef Map<String, std::set<Size> > FeatureType_;
-
-    // add another charge annotation variant for a feature
-    void updateFeatureVariant_(FeatureType_& f_set, const String& rota_l, const Size& v) const;
-
-
 
   }; // !class
 
@@ -100,6 +100,25 @@ public:
     */
     void apply(std::vector<ProteinIdentification> & ids);
 
+    /**
+        @brief Calculates FDRs or q-values for plain target and decoy scores
+
+        This is the computation behind all apply() variants. It can be used directly by tools that gather
+        scores themselves (e.g. chunk-wise while reading large result files), since no identification
+        objects need to be kept. Scores are sorted in parallel and evaluated in a single linear sweep.
+
+        Decoy scores are assigned the value of the closest target score. The results are reported in the
+        order of the input scores.
+
+        @param target_scores scores of the target hits
+        @param decoy_scores scores of the decoy hits
+        @param target_fdrs FDRs/q-values of the target hits (output)
+        @param decoy_fdrs FDRs/q-values of the decoy hits (output)
+        @param q_value compute q-values instead of FDRs
+        @param higher_score_better whether higher scores are better
+    */
+    void calculateFDRs(const std::vector<double> & target_scores, const std::vector<double> & decoy_scores, std::vector<double> & target_fdrs, std::vector<double> & decoy_fdrs, bool q_value, bool higher_score_better) const;
+
 private:
     ///Not implemented
     FalseDiscoveryRate(const FalseDiscoveryRate &);
@@ -107,8 +126,8 @@ private:
     ///Not implemented
     FalseDiscoveryRate & operator=(const FalseDiscoveryRate &);
 
-    /// calculates the fdr stored into fdrs, given two vectors of scores
-    void calculateFDRs_(Map<double, double> & score_to_fdr, std::vector<double> & target_scores, std::vector<double> & decoy_scores, bool q_value, bool higher_score_better);
+    /// writes FDRs (starting at @p offsets[i] for the hits of @p ids[i]) into the hits, keeping the original score as meta value
+    void annotatePeptideFDRs_(std::vector<PeptideIdentification> & ids, const std::vector<Size> & offsets, const std::vector<double> & fdrs, const String & score_type, bool q_value) const;
 
   };
 
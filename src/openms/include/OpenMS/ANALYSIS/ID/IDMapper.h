@@ -238,6 +238,8 @@ public:
 
       If several features (incl. tolerance) overlap the position of a peptide identification, the identification is annotated to all of them.
 
+      Feature bounding boxes are indexed by RT and m/z once per map. Candidate features of the identifications are then determined in parallel; the assignments are merged in the order of @p ids, so the result does not depend on the number of threads.
+
       @param map FeatureMap to receive the identifications
       @param ids PeptideIdentification for the ConsensusFeatures
       @param protein_ids ProteinIdentification for the ConsensusMap
@@ -256,6 +258,8 @@ public:
       If several consensus features lie inside the allowed deviation, the peptide identifications
       are mapped to all the consensus features.
 
+      As for feature maps, the consensus features are indexed by RT and m/z and the matching is done in parallel, with a deterministic merge of the assignments.
+
       @param map ConsensusMap to receive the identifications
       @param ids PeptideIdentification for the ConsensusFeatures
       @param protein_ids ProteinIdentification for the ConsensusMap
@@ -384,7 +388,17 @@ protected:
     void getIDDetails_(const PeptideIdentification& id, double& rt_pep, DoubleList& mz_values, IntList& charges, bool use_avg_mass = false) const;
 
     /// increase a bounding box by the given RT and m/z tolerances
-    void increaseBoundingBox_(DBoundingBox<2>& box);
+    void increaseBoundingBox_(DBoundingBox<2>& box) const;
+
+    /**
+      @brief determine which of the @p candidates (feature indices) match a position
+
+      Used by annotate(FeatureMap&, ...). @p boxes holds the (enlarged) bounding box of each feature.
+      Matching feature indices are written to @p matches, in the order of @p candidates.
+    */
+    void getMatchingFeatures_(const FeatureMap& map, const std::vector<DBoundingBox<2> >& boxes, const std::vector<Size>& candidates,
+                              double rt, const DoubleList& mz_values, const IntList& charges, bool use_centroid_rt, bool use_centroid_mz,
+                              std::vector<Size>& matches) const;
 
     /// try to determine the type of m/z value reported for features, return
     /// whether average peptide masses should be used for matching
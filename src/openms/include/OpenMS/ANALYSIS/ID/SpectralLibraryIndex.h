@@ -0,0 +1,163 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2016.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: Timo Sachsenberg $
+// --------------------------------------------------------------------------
+
+#ifndef OPENMS_ANALYSIS_ID_SPECTRALLIBRARYINDEX_H
+#define OPENMS_ANALYSIS_ID_SPECTRALLIBRARYINDEX_H
+
+#include <OpenMS/KERNEL/StandardTypes.h>
+#include <OpenMS/METADATA/PeptideHit.h>
+
+#include <vector>
+
+namespace OpenMS
+{
+  /**
+    @brief Precursor m/z indexed, preprocessed spectral library.
+
+    Library spectra are stored in flat arrays (peak m/z, peak intensity and
+    per-entry offsets into these arrays) sorted by precursor m/z. Candidates
+    for a query precursor are found by binary search and can be accessed
+    concurrently from several threads, as the index is not modified during the
+    search.
+
+    The index can be written to a binary cache file and loaded again, so the
+    MSP library does not need to be parsed and preprocessed for every search.
+    The file contains the arrays in the same layout as they are held in memory;
+    loading maps the file and copies the arrays out of the mapping. A free-text tag (e.g. the
+    preprocessing settings) can be stored alongside to decide whether an
+    existing cache can be reused.
+
+    Used by @ref TOPP_SpecLibSearcher.
+
+    @ingroup Analysis_ID
+  */
+  class OPENMS_DLLAPI SpectralLibraryIndex
+  {
+public:
+
+    /// Default constructor
+    SpectralLibraryIndex();
+
+    /// Destructor
+    virtual ~SpectralLibraryIndex();
+
+    /**
+      @brief Adds a (preprocessed) library spectrum
+
+      The precursor m/z is taken from the first precursor of @p spectrum (which must exist).
+      After all entries were added, sortByPrecursorMZ() has to be called before the index is searched.
+
+      @exception Exception::MissingInformation is thrown if @p spectrum has no precursor
+    */
+    void addEntry(const PeakSpectrum& spectrum, const PeptideHit& hit);
+
+    /// Sorts all entries by precursor m/z (stable), needs to be called after adding entries
+    void sortByPrecursorMZ();
+
+    /// Removes all entries
+    void clear();
+
+    /// Number of library entries
+    Size size() const;
+
+    /// Returns if the index is empty
+    bool empty() const;
+
+    /**
+      @brief Determines the entries with precursor m/z in [@p min_mz, @p max_mz]
+
+      The result is the half-open index range [@p first, @p last).
+    */
+    void getEntriesInRange(double min_mz, double max_mz, Size& first, Size& last) const;
+
+    /// Precursor m/z of entry @p index
+    double getPrecursorMZ(Size index) const;
+
+    /// Retention time of entry @p index
+    double getRT(Size index) const;
+
+    /// Copies the peaks of entry @p index into @p spectrum (RT and precursor are set as well)
+    void getSpectrum(Size index, PeakSpectrum& spectrum) const;
+
+    /// Reconstructs the peptide hit (sequence and charge) of entry @p index
+    PeptideHit getPeptideHit(Size index) const;
+
+    /// Charge of the peptide of entry @p index
+    Int getCharge(Size index) const;
+
+    /// Sets the tag that is stored with the index
+    void setTag(const String& tag);
+
+    /// Returns the tag that is stored with the index
+    const String& getTag() const;
+
+    /**
+      @brief Writes the index to a binary cache file
+
+      @exception Exception::UnableToCreateFile is thrown if the file cannot be written
+    */
+    void store(const String& filename) const;
+
+    /**
+      @brief Loads the index from a binary cache file written by store()
+
+      @exception Exception::FileNotFound is thrown if the file does not exist
+      @exception Exception::ParseError is thrown if the file is not a valid cache file (including
+      offsets that are out of bounds or not monotonic, and precursors that are not sorted)
+    */
+    void load(const String& filename);
+
+protected:
+
+    /// Tag stored with the index
+    String tag_;
+    /// Precursor m/z per entry
+    std::vector<double> precursor_mz_;
+    /// Retention time per entry
+    std::vector<double> rt_;
+    /// Peptide charge per entry
+    std::vector<Int> charge_;
+    /// Peptide sequence per entry
+    std::vector<String> sequence_;
+    /// Offset of the first peak of each entry in the peak arrays (one more than entries)
+    std::vector<Size> peak_offset_;
+    /// Peak m/z of all entries
+    std::vector<double> peak_mz_;
+    /// Peak intensities of all entries
+    std::vector<float> peak_intensity_;
+  };
+
+} // namespace OpenMS
+
+#endif // OPENMS_ANALYSIS_ID_SPECTRALLIBRARYINDEX_H
@@ -22,6 +22,7 @@ IDRipper.h
 MetaboliteSpectralMatching.h
 PeptideProteinResolution.h
 ProtonDistributionModel.h
+SpectralLibraryIndex.h
 PeptideIndexing.h
 )
 
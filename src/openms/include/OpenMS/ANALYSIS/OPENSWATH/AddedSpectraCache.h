@@ -0,0 +1,176 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2016.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#ifndef OPENMS_ANALYSIS_OPENSWATH_ADDEDSPECTRACACHE_H
+#define OPENMS_ANALYSIS_OPENSWATH_ADDEDSPECTRACACHE_H
+
+#include <OpenMS/config.h> // OPENMS_DLLAPI
+#include <OpenMS/CONCEPT/Types.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/OPENSWATHALGO/DATAACCESS/ISpectrumAccess.h>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/weak_ptr.hpp>
+
+#include <list>
+#include <map>
+#include <string>
+
+namespace OpenMS
+{
+  /**
+  @brief A thread-safe, size-bounded cache of added up (summed) spectra
+
+  Summing up multiple spectra around a chromatographic apex (see
+  OpenSwathScoring and SpectrumAddition) requires resampling of all spectra
+  and is expensive. Since many peak groups of the same SWATH window share the
+  same apex scan, the same summed spectrum is often computed repeatedly.
+
+  This cache stores summed spectra keyed by the map they were computed from,
+  the index of the closest scan, the number of added spectra, the resampling
+  spacing and the addition method ("resample" or "merge"). The least recently used spectra are evicted once the
+  total number of stored data points exceeds the given maximum. Maps are only
+  referenced weakly, so entries of maps that have been destroyed are never
+  returned.
+
+  Maps are identified by the address of their spectrum access. Threads
+  usually read from light clones of a map (see ISpectrumAccess::lightClone),
+  which have a different address for every clone. Callers therefore have to
+  pass the original map as identity (see MapIdentities), otherwise entries
+  are never shared.
+
+  A single instance may be shared between multiple threads (e.g. all
+  MRMFeatureFinderScoring instances of an OpenSwathWorkflow); all access is
+  serialized.
+
+  */
+  class OPENMS_DLLAPI AddedSpectraCache
+  {
+
+public:
+
+    /// Maps the spectrum access used for reading to the map under which its spectra are cached
+    typedef std::map<const OpenSwath::ISpectrumAccess*, OpenSwath::SpectrumAccessPtr> MapIdentities;
+
+    /// Constructor (@p max_points is the maximal number of data points stored over all spectra)
+    explicit AddedSpectraCache(Size max_points = 10000000);
+
+    /// Destructor
+    ~AddedSpectraCache();
+
+    /**
+      @brief Look up a summed spectrum
+
+      @return true if a spectrum was found (and stored in @p spectrum), false otherwise
+    */
+    bool lookup(const OpenSwath::SpectrumAccessPtr& swath_map, int scan_index,
+                int nr_spectra_to_add, double spacing, const std::string& addition_method,
+                OpenSwath::SpectrumPtr& spectrum);
+
+    /// Stores a summed spectrum (evicts the least recently used spectra if necessary)
+    void insert(const OpenSwath::SpectrumAccessPtr& swath_map, int scan_index,
+                int nr_spectra_to_add, double spacing, const std::string& addition_method,
+                const OpenSwath::SpectrumPtr& spectrum);
+
+    /// Removes all spectra and resets the hit/miss counters
+    void clear();
+
+    /// Number of successful lookups
+    Size getHits() const;
+
+    /// Number of failed lookups
+    Size getMisses() const;
+
+    /// Number of stored spectra
+    Size size() const;
+
+    /// Number of data points over all stored spectra
+    Size getNrPoints() const;
+
+    /// Maximal number of data points over all stored spectra
+    Size getMaxPoints() const;
+
+protected:
+
+    /// Cache key
+    struct Key
+    {
+      const OpenSwath::ISpectrumAccess* swath_map;
+      int scan_index;
+      int nr_spectra_to_add;
+      double spacing;
+      std::string addition_method;
+
+      bool operator<(const Key& rhs) const;
+    };
+
+    /// Cache entry (most recently used entries are at the front of the list)
+    struct Entry
+    {
+      Key key;
+      boost::weak_ptr<OpenSwath::ISpectrumAccess> swath_map;
+      OpenSwath::SpectrumPtr spectrum;
+      Size nr_points;
+    };
+
+    typedef std::list<Entry> EntryList;
+
+    /// Creates a cache key
+    static Key createKey_(const OpenSwath::SpectrumAccessPtr& swath_map, int scan_index, int nr_spectra_to_add, double spacing,
+                          const std::string& addition_method);
+
+    /// Removes an entry (needs to be called from within the critical section)
+    void erase_(EntryList::iterator it);
+
+    EntryList entries_;
+    std::map<Key, EntryList::iterator> index_;
+
+    Size max_points_;
+    Size nr_points_;
+    Size hits_;
+    Size misses_;
+
+private:
+
+    /// Not implemented
+    AddedSpectraCache(const AddedSpectraCache& rhs);
+
+    /// Not implemented
+    AddedSpectraCache& operator=(const AddedSpectraCache& rhs);
+
+  };
+
+  typedef boost::shared_ptr<AddedSpectraCache> AddedSpectraCachePtr;
+}
+
+#endif // OPENMS_ANALYSIS_OPENSWATH_ADDEDSPECTRACACHE_H
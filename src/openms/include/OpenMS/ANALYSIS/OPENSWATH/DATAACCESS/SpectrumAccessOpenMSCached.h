@@ -41,6 +41,8 @@
 
 #include <OpenMS/ANALYSIS/OPENSWATH/OPENSWATHALGO/DATAACCESS/ISpectrumAccess.h>
 
+#include <QtCore/QMutex>
+
 #include <fstream>
 
 namespace OpenMS
@@ -53,10 +55,10 @@ namespace OpenMS
     (ISpectrumAccess) using the CachedmzML class which is able to read and
     write a cached mzML file.
 
-    @note This implementation is @a not thread-safe since it keeps internally a
-    single file access pointer which it moves when accessing a specific
-    data item. The caller is responsible to ensure that access is performed
-    atomically.
+    @note Internally, a single file stream is kept which is moved when
+    accessing a specific data item. Access to this stream is serialized, so
+    concurrent readers are safe but will wait for each other. For parallel
+    access, use a light clone per thread (each one opens its own stream).
 
   */
   class OPENMS_DLLAPI SpectrumAccessOpenMSCached :
@@ -115,6 +117,9 @@ private:
     /// Internal filestream 
     std::ifstream ifs_;
 
+    /// Serializes positioning and reading of ifs_
+    QMutex ifs_mutex_;
+
     /// Name of the mzML file
     String filename_;
 
@@ -49,6 +49,9 @@ namespace OpenMS
    * This can be used to implement an on-line mass correction for TOF
    * instruments (for example).
    *
+   * The correction is applied lazily when a spectrum is accessed and, if
+   * caching is enabled, only once per spectrum (see SpectrumAccessTransforming).
+   *
    */
   class OPENMS_DLLAPI SpectrumAccessQuadMZTransforming :
     public SpectrumAccessTransforming
@@ -62,16 +65,20 @@ public:
      * @param c Regression parameter 2
      * @param ppm Whether the transformation should be applied in ppm domain
      *            (if false, it is applied directly in m/z domain)
+     * @param cache_spectra Whether to keep transformed spectra in memory
      *
     */
     explicit SpectrumAccessQuadMZTransforming(OpenSwath::SpectrumAccessPtr sptr,
-        double a, double b, double c, bool ppm);
+        double a, double b, double c, bool ppm, bool cache_spectra = false);
         
     ~SpectrumAccessQuadMZTransforming();
 
     boost::shared_ptr<OpenSwath::ISpectrumAccess> lightClone() const;
 
-    OpenSwath::SpectrumPtr getSpectrumById(int id);
+protected:
+
+    /// Apply the m/z correction (to a copy of the m/z array if it is shared)
+    OpenSwath::SpectrumPtr transformSpectrum_(const OpenSwath::SpectrumPtr& spectrum) const;
 
 private:
 
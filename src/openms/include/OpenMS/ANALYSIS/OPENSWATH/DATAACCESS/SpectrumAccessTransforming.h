@@ -38,19 +38,41 @@
 #include <OpenMS/config.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/OPENSWATHALGO/DATAACCESS/ISpectrumAccess.h>
 
+#include <QtCore/QMutex>
+
 namespace OpenMS
 {
 
   /**
    * @brief An abstract base class implementing a transforming wrapper around spectrum access.
    *
+   * Derived classes implement transformSpectrum_ which is applied lazily,
+   * i.e. only when the data of a spectrum is requested through
+   * getSpectrumById. The wrapper never modifies the spectra of the underlying
+   * access object in place unless it is their sole owner, so it can be stacked
+   * on top of any backend (including in-memory ones which hand out their
+   * internal data).
+   *
+   * Optionally, transformed spectra are cached (read-through): each spectrum
+   * is transformed only once and handed out again on subsequent requests.
+   * The cache is shared between an object and all of its light clones and
+   * may be read concurrently from multiple threads, as long as the
+   * underlying access object is thread-safe as well (or each thread works on
+   * its own light clone).
+   *
    */
   class OPENMS_DLLAPI SpectrumAccessTransforming :
     public OpenSwath::ISpectrumAccess
   {
 public:
 
-    explicit SpectrumAccessTransforming(OpenSwath::SpectrumAccessPtr sptr);
+    /** @brief Constructor
+     *
+     * @param sptr The underlying spectrum access
+     * @param cache_spectra Whether to keep transformed spectra in memory
+     *
+    */
+    explicit SpectrumAccessTransforming(OpenSwath::SpectrumAccessPtr sptr, bool cache_spectra = false);
         
     virtual ~SpectrumAccessTransforming() = 0;
 
@@ -70,9 +92,49 @@ public:
 
     virtual std::string getChromatogramNativeID(int id) const;
 
+    /// Whether transformed spectra are cached
+    bool isCaching() const;
+
+    /// Release all cached spectra (also for all light clones)
+    void clearCache();
+
 protected:
+
+    /**
+     * @brief Transform a spectrum obtained from the underlying spectrum access
+     *
+     * Must not change the data of @p spectrum if it is shared with anybody
+     * else (see getWritableMZArray_). The default implementation returns the
+     * spectrum unchanged.
+     */
+    virtual OpenSwath::SpectrumPtr transformSpectrum_(const OpenSwath::SpectrumPtr& spectrum) const;
+
+    /**
+     * @brief Returns a spectrum whose m/z array may be overwritten
+     *
+     * If @p spectrum and its m/z array are only referenced by the caller,
+     * they are returned as they are. Otherwise a shallow copy of the spectrum
+     * with a copy of the m/z array is returned (all other arrays are shared).
+     */
+    static OpenSwath::SpectrumPtr getWritableMZArray_(const OpenSwath::SpectrumPtr& spectrum);
+
+    /// Share the spectra cache of @p rhs (used to create light clones)
+    void shareCache_(const SpectrumAccessTransforming& rhs);
+
+    /// Cache of transformed spectra, shared by an object and all of its light clones
+    struct SpectraCache
+    {
+      /// Transformed spectra (empty pointer if not transformed yet)
+      std::vector<OpenSwath::SpectrumPtr> spectra;
+      /// Serializes access to spectra
+      QMutex mutex;
+    };
+
     OpenSwath::SpectrumAccessPtr sptr_;
 
+    /// Transformed spectra (NULL if caching is disabled)
+    boost::shared_ptr<SpectraCache> spectra_cache_;
+
   };
 
 }
@@ -255,6 +255,24 @@ public:
       ms1_map_ = ms1_map;
     }
 
+    /** @brief Set a cache for added up DIA spectra
+     *
+     * Summing up spectra around the peak group apex is expensive and
+     * neighboring peak groups often share the same apex. The cache may be
+     * shared between multiple instances (and threads) working on the same
+     * SWATH maps.
+     *
+     * @param spectra_cache The cache to use (may be NULL to disable caching)
+     * @param map_ids The identities of the SWATH (and MS1) maps to be scored
+     *                (see OpenSwathScoring::setAddedSpectraCache)
+     *
+    */
+    void setAddedSpectraCache(AddedSpectraCachePtr spectra_cache, const AddedSpectraCache::MapIdentities& map_ids)
+    {
+      spectra_cache_ = spectra_cache;
+      spectra_cache_map_ids_ = map_ids;
+    }
+
     /** @brief Map the chromatograms to the transitions.
      *
      * Map an input chromatogram experiment (mzML) and transition list (TraML)
@@ -288,6 +306,7 @@ private:
     double rt_normalization_factor_;
     int add_up_spectra_;
     double spacing_for_spectra_resampling_;
+    String spectra_addition_method_;
     double uis_threshold_sn_;
     double uis_threshold_peak_area_;
 
@@ -300,6 +319,8 @@ private:
 
     // data
     OpenSwath::SpectrumAccessPtr ms1_map_;
+    AddedSpectraCachePtr spectra_cache_;
+    AddedSpectraCache::MapIdentities spectra_cache_map_ids_;
 
   };
 }
@@ -115,77 +115,83 @@ public:
     template <typename SpectrumT, typename TransitionT>
     void pickTransitionGroup(MRMTransitionGroup<SpectrumT, TransitionT>& transition_group)
     {
-      std::vector<RichPeakChromatogram> picked_chroms_;
+      std::vector<RichPeakChromatogram> picked_chroms;
 
       PeakPickerMRM picker;
       picker.setParameters(param_.copy("PeakPickerMRM:", true));
 
-      // Pick chromatograms
-      for (Size k = 0; k < transition_group.getChromatograms().size(); k++)
-      {
-        RichPeakChromatogram& chromatogram = transition_group.getChromatograms()[k];
-        String native_id = chromatogram.getNativeID();
-        if (transition_group.getTransitions().size() > 0 && 
-            transition_group.hasTransition(native_id)  && 
-            !transition_group.getTransition(native_id).isDetectingTransition() )
-        {
-          continue;
-        }
+      pickTransitionGroup_(transition_group, picker, picked_chroms);
+    }
 
-        if (!chromatogram.isSorted())
-        {
-          chromatogram.sortByPosition();
-        }
-        RichPeakChromatogram picked_chrom;
-        picker.pickChromatogram(chromatogram, picked_chrom);
-        picked_chrom.sortByIntensity(); // we could do without that
-        picked_chroms_.push_back(picked_chrom);
-      }
+    /**
+      @brief Pick a batch of transition groups concurrently
 
-      // Find features (peak groups) in this group of transitions.
-      // While there are still peaks left, one will be picked and used to create
-      // a feature. Whenever we run out of peaks, we will get -1 back as index
-      // and terminate.
-      int chr_idx, peak_idx, cnt = 0;
-      std::vector<MRMFeature> features;
-      while (true)
-      {
-        chr_idx = -1; peak_idx = -1;
-        findLargestPeak(picked_chroms_, chr_idx, peak_idx);
-        if (chr_idx == -1 && peak_idx == -1) break;
+      Performs the same picking as pickTransitionGroup on every group in @p
+      transition_groups. The groups are distributed over all available
+      threads, each thread keeps its own copy of the PeakPickerMRM and reuses
+      its buffer of picked chromatograms from one group to the next. As the
+      features of each group are only added to that group, no synchronization
+      is needed and the result is identical to calling pickTransitionGroup on
+      each group in turn.
 
-        // Compute a feature from the individual chromatograms and add non-zero features
-        MRMFeature mrm_feature = createMRMFeature(transition_group, picked_chroms_, chr_idx, peak_idx);
-        if (mrm_feature.getIntensity() > 0)
-        {
-          features.push_back(mrm_feature);
-        }
+      If picking fails for any group, the exception of the first such group
+      (in input order) is thrown once all groups have been processed. It is
+      thrown as a copy of its Exception::BaseException part, so name and
+      message are kept but the derived type is not.
 
-        cnt++;
-        if ((stop_after_feature_ > 0 && cnt > stop_after_feature_) &&
-            mrm_feature.getIntensity() / (double)mrm_feature.getMetaValue("total_xic") < stop_after_intensity_ratio_)
-        {
-          break;
-        }
-      }
+      @note The groups must be distinct objects, i.e. no pointer may occur twice.
 
-      // Check for completely overlapping features
-      for (Size i = 0; i < features.size(); i++)
+      @exception Exception::IllegalArgument if the PeakPickerMRM parameters are invalid
+      @exception Exception::BaseException if picking a group fails (e.g. "NotImplemented" if background_subtraction is set to "smoothed")
+    */
+    template <typename SpectrumT, typename TransitionT>
+    void pickTransitionGroups(std::vector<MRMTransitionGroup<SpectrumT, TransitionT>*>& transition_groups)
+    {
+      // configure (and validate) the picker once, each thread works on a copy
+      PeakPickerMRM configured_picker;
+      configured_picker.setParameters(param_.copy("PeakPickerMRM:", true));
+
+      // exceptions cannot leave a parallel region, keep a copy of the error of the first failing group instead
+      SignedSize failed = -1;
+      Exception::BaseException error;
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
       {
-        MRMFeature& mrm_feature = features[i];
-        bool skip = false;
-        for (Size j = 0; j < i; j++)
+        std::vector<RichPeakChromatogram> picked_chroms;
+        PeakPickerMRM picker(configured_picker);
+
+        // Only in OpenMP 3.0 are unsigned loop variables allowed
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 1)
+#endif
+        for (SignedSize i = 0; i < (SignedSize)transition_groups.size(); ++i)
         {
-          if ((double)mrm_feature.getMetaValue("leftWidth") >=  (double)features[j].getMetaValue("leftWidth") && 
-              (double)mrm_feature.getMetaValue("rightWidth") <= (double)features[j].getMetaValue("rightWidth") )
-          { skip = true; }
-        }
-        if (mrm_feature.getIntensity() > 0 && !skip)
-        {
-          transition_group.addFeature(mrm_feature);
+          try
+          {
+            pickTransitionGroup_(*transition_groups[i], picker, picked_chroms);
+          }
+          catch (Exception::BaseException& e)
+          {
+#ifdef _OPENMP
+#pragma omp critical (MRMTransitionGroupPicker_pickTransitionGroups)
+#endif
+            {
+              if (failed < 0 || i < failed)
+              {
+                failed = i;
+                error = e;
+              }
+            }
+          }
         }
       }
 
+      if (failed >= 0)
+      {
+        throw error;
+      }
     }
 
     /// Create feature from a vector of chromatograms and a specified peak
@@ -459,6 +465,92 @@ protected:
     /// Assignment operator is protected for algorithm
     MRMTransitionGroupPicker& operator=(const MRMTransitionGroupPicker& rhs);
 
+    /**
+      @brief Pick a single transition group using the given picker and scratch buffer
+
+      The chromatograms of @p picked_chroms are overwritten; the buffer only
+      serves to avoid reallocating them for every group.
+    */
+    template <typename SpectrumT, typename TransitionT>
+    void pickTransitionGroup_(MRMTransitionGroup<SpectrumT, TransitionT>& transition_group,
+                              PeakPickerMRM& picker, std::vector<RichPeakChromatogram>& picked_chroms)
+    {
+      // Pick chromatograms
+      Size nr_picked = 0;
+      for (Size k = 0; k < transition_group.getChromatograms().size(); k++)
+      {
+        RichPeakChromatogram& chromatogram = transition_group.getChromatograms()[k];
+        String native_id = chromatogram.getNativeID();
+        if (transition_group.getTransitions().size() > 0 && 
+            transition_group.hasTransition(native_id)  && 
+            !transition_group.getTransition(native_id).isDetectingTransition() )
+        {
+          continue;
+        }
+
+        if (!chromatogram.isSorted())
+        {
+          chromatogram.sortByPosition();
+        }
+        if (nr_picked == picked_chroms.size())
+        {
+          picked_chroms.push_back(RichPeakChromatogram());
+        }
+        RichPeakChromatogram& picked_chrom = picked_chroms[nr_picked++];
+        picked_chrom.clear(true); // keeps the allocated peak storage
+        picker.pickChromatogram(chromatogram, picked_chrom);
+        picked_chrom.sortByIntensity(); // we could do without that
+      }
+      // drop left-overs from a previous (larger) group
+      picked_chroms.resize(nr_picked);
+
+      // Find features (peak groups) in this group of transitions.
+      // While there are still peaks left, one will be picked and used to create
+      // a feature. Whenever we run out of peaks, we will get -1 back as index
+      // and terminate.
+      int chr_idx, peak_idx, cnt = 0;
+      std::vector<MRMFeature> features;
+      while (true)
+      {
+        chr_idx = -1; peak_idx = -1;
+        findLargestPeak(picked_chroms, chr_idx, peak_idx);
+        if (chr_idx == -1 && peak_idx == -1) break;
+
+        // Compute a feature from the individual chromatograms and add non-zero features
+        MRMFeature mrm_feature = createMRMFeature(transition_group, picked_chroms, chr_idx, peak_idx);
+        if (mrm_feature.getIntensity() > 0)
+        {
+          features.push_back(mrm_feature);
+        }
+
+        cnt++;
+        if ((stop_after_feature_ > 0 && cnt > stop_after_feature_) &&
+            mrm_feature.getIntensity() / (double)mrm_feature.getMetaValue("total_xic") < stop_after_intensity_ratio_)
+        {
+          break;
+        }
+      }
+
+      // Check for completely overlapping features
+      for (Size i = 0; i < features.size(); i++)
+      {
+        MRMFeature& mrm_feature = features[i];
+        bool skip = false;
+        for (Size j = 0; j < i; j++)
+        {
+          if ((double)mrm_feature.getMetaValue("leftWidth") >=  (double)features[j].getMetaValue("leftWidth") && 
+              (double)mrm_feature.getMetaValue("rightWidth") <= (double)features[j].getMetaValue("rightWidth") )
+          { skip = true; }
+        }
+        if (mrm_feature.getIntensity() > 0 && !skip)
+        {
+          transition_group.addFeature(mrm_feature);
+        }
+      }
+
+    }
+
+
     /**
       @brief Compute transition group quality (higher score is better)
 
@@ -44,6 +44,7 @@
 
 // scoring
 #include <OpenMS/ANALYSIS/OPENSWATH/DIAScoring.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/AddedSpectraCache.h>
 
 #include <vector>
 #include <boost/shared_ptr.hpp>
@@ -445,7 +446,10 @@ var_yseries_score   -0.0327896378737766
     double rt_normalization_factor_;
     int add_up_spectra_;
     double spacing_for_spectra_resampling_;
+    std::string spectra_addition_method_;
     OpenSwath_Scores_Usage su_;
+    AddedSpectraCachePtr spectra_cache_;
+    AddedSpectraCache::MapIdentities cache_map_ids_;
 
   public:
 
@@ -461,13 +465,30 @@ var_yseries_score   -0.0327896378737766
      *
      * @param rt_normalization_factor Specifies the range of the normalized retention time space
      * @param add_up_spectra How many spectra to add up (default 1)
-     * @param spacing_for_spectra_resampling Spacing factor for spectra addition
+     * @param spacing_for_spectra_resampling Spacing factor for spectra addition (m/z tolerance for peak fusion if spectra are merged)
      * @param su Which scores to actually compute
+     * @param spectra_addition_method How to add up spectra ("resample" or "merge", see SpectrumAddition)
      *
     */
     void initialize(double rt_normalization_factor,
       int add_up_spectra, double spacing_for_spectra_resampling,
-      OpenSwath_Scores_Usage & su);
+      OpenSwath_Scores_Usage & su, const std::string& spectra_addition_method = "resample");
+
+    /** @brief Set a cache for added up spectra
+     *
+     * If set, spectra added up around a retention time (see
+     * getAddedSpectra_) are looked up in and stored to the cache. The cache
+     * may be shared between multiple scoring objects and threads.
+     *
+     * Only spectra of maps listed in @p map_ids are cached, under the map
+     * given there (e.g. the original map of which the scored map is a
+     * thread-local clone).
+     *
+     * @param spectra_cache The cache to use (may be NULL to disable caching)
+     * @param map_ids The identities of the maps to be scored
+     *
+    */
+    void setAddedSpectraCache(AddedSpectraCachePtr spectra_cache, const AddedSpectraCache::MapIdentities& map_ids);
 
     /** @brief Score a single peakgroup in a chromatogram using only chromatographic properties.
      *
@@ -618,6 +639,11 @@ var_yseries_score   -0.0327896378737766
     OpenSwath::SpectrumPtr getAddedSpectra_(std::vector<OpenSwath::SwathMap> swath_maps,
                                             double RT, int nr_spectra_to_add);
 
+    /** @brief Adds up the given spectra using the configured method (resampling or merging)
+     *
+    */
+    OpenSwath::SpectrumPtr addUpSpectra_(const std::vector<OpenSwath::SpectrumPtr>& all_spectra);
+
   };
 }
 
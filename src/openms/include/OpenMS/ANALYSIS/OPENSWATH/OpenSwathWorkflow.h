@@ -62,6 +62,7 @@
 #include <OpenMS/ANALYSIS/OPENSWATH/MRMFeatureFinderScoring.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/MRMTransitionGroupPicker.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/SwathMapMassCorrection.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/SwathMapPrefetcher.h>
 #include <OpenMS/FILTERING/TRANSFORMERS/LinearResamplerAlign.h>
 
 #include <assert.h>
@@ -119,6 +120,9 @@ namespace OpenMS
      * @param irt_detection_param Parameter set for the detection of the iRTs (outlier detection, peptides per bin etc)
      * @param mz_correction_function If correction in m/z is desired, which function should be used
      * @param debug_level Debug level (writes out the RT normalization chromatograms if larger than 1)
+     * @param sonar Whether the data is SONAR data
+     * @param cache_corrected_spectra Whether the m/z corrected maps keep their spectra in
+     *        memory (useful if the maps are not loaded into memory for extraction)
      *
     */
        TransformationDescription performRTNormalization(const OpenMS::TargetedExperiment & irt_transitions, 
@@ -130,7 +134,8 @@ namespace OpenMS
        const Param & irt_detection_param, 
        const String & mz_correction_function,
        Size debug_level, 
-       bool sonar = false);
+       bool sonar = false,
+       bool cache_corrected_spectra = false);
     /*
        */
 
@@ -146,6 +151,7 @@ namespace OpenMS
      * @param irt_detection_param Parameter set for the detection of the iRTs (outlier detection, peptides per bin etc)
      * @param swath_maps The raw data for the m/z correction
      * @param mz_correction_function If correction in m/z is desired, which function should be used
+     * @param cache_corrected_spectra Whether the m/z corrected maps keep their spectra in memory
      *
      * @note: feature_finder_param are copied because they are changed here.
      * @note: This function is based on the algorithm inside the OpenSwathRTNormalizer tool
@@ -160,7 +166,8 @@ namespace OpenMS
      std::vector< OpenSwath::SwathMap > & swath_maps,
      const String & mz_correction_function, 
      double mz_extraction_window, 
-     bool ppm);
+     bool ppm,
+     bool cache_corrected_spectra);
 
     /// Simple method to extract chromatograms (for the RT-normalization peptides)
     void simpleExtractChromatograms(const std::vector< OpenSwath::SwathMap > & swath_maps,
@@ -186,7 +193,8 @@ namespace OpenMS
   public:
 
     explicit OpenSwathWorkflow(bool use_ms1_traces) :
-      use_ms1_traces_(use_ms1_traces)
+      use_ms1_traces_(use_ms1_traces),
+      spectra_cache_(new AddedSpectraCache())
     {
     }
 
@@ -210,6 +218,10 @@ namespace OpenMS
      * @param chromConsumer Chromatogram consumer object to store the extracted chromatograms
      * @param batchSize Size of the batches which should be extracted and scored
      * @param load_into_memory Whether to cache the current SWATH map in memory
+     * @param prefetch_memory_budget If larger than zero, SWATH maps are loaded
+     *        into memory in a background thread (see SwathMapPrefetcher) while
+     *        the current maps are extracted and scored, using at most this
+     *        many bytes for maps loaded ahead
      *
     */
     void performExtraction(const std::vector< OpenSwath::SwathMap > & swath_maps,
@@ -222,10 +234,23 @@ namespace OpenMS
                            OpenSwathTSVWriter & tsv_writer,
                            Interfaces::IMSDataConsumer<> * chromConsumer, 
                            int batchSize,
-                           bool load_into_memory);
+                           bool load_into_memory,
+                           Size prefetch_memory_budget = 0);
 
   protected:
 
+    /** @brief Report the hit rate of the added spectra cache and clear it
+     *
+    */
+    void reportAddedSpectraCache_();
+
+    /** @brief Release the spectra kept in memory by m/z corrected maps
+     *
+     * Maps that are not m/z corrected (see SwathMapMassCorrection) or do not
+     * cache their spectra are left unchanged.
+     *
+    */
+    static void clearCorrectedSpectra_(const std::vector< OpenSwath::SwathMap > & swath_maps);
 
     /** @brief Write output features and chromatograms to disk 
      *
@@ -255,6 +280,8 @@ namespace OpenMS
      * @param input Input chromatograms (MS2 level)
      * @param ms1_chromatograms Input chromatograms for MS1-level
      * @param swath_maps Set of swath map(s) for the current swath window (for SONAR multiple maps are provided)
+     * @param original_maps The maps from which the (thread-local) swath_maps were
+     *        created, in the same order (used as identity in the cache of added up spectra)
      * @param transition_exp The transition experiment (assay library)
      * @param feature_finder_param Parameters for the MRMFeatureFinderScoring
      * @param trafo RT Transformation function
@@ -267,6 +294,7 @@ namespace OpenMS
         const OpenSwath::SpectrumAccessPtr input,
         const std::map< std::string, OpenSwath::ChromatogramPtr > & ms1_chromatograms,
         const std::vector< OpenSwath::SwathMap > swath_maps,
+        const std::vector< OpenSwath::SpectrumAccessPtr > & original_maps,
         OpenSwath::LightTargetedExperiment& transition_exp,
         const Param& feature_finder_param,
         TransformationDescription trafo, 
@@ -364,6 +392,9 @@ namespace OpenMS
     /// Whether to use the MS1 traces
     bool use_ms1_traces_;
 
+    /// Cache of added up spectra, shared by all threads scoring the same SWATH maps
+    AddedSpectraCachePtr spectra_cache_;
+
   };
 
   /**
@@ -49,6 +49,12 @@ namespace OpenMS
   then add them up. This may lead to a certain inaccuracy, especially if a
   inappropriate resampling rate is chosen.
 
+  Alternatively, spectra can be merged without resampling (see
+  mergeSpectra): all peaks are combined in a single pass over the (sorted)
+  inputs and peaks within a given m/z tolerance are fused. This avoids the
+  dense grid of the resampling approach, which becomes very large for fine
+  sampling rates.
+
   */
   class OPENMS_DLLAPI SpectrumAddition
   {
@@ -56,13 +62,28 @@ namespace OpenMS
 public:
 
     /// adds up a list of Spectra by resampling them and then addition of intensities
-    static OpenSwath::SpectrumPtr addUpSpectra(std::vector<OpenSwath::SpectrumPtr> all_spectra,
+    static OpenSwath::SpectrumPtr addUpSpectra(const std::vector<OpenSwath::SpectrumPtr>& all_spectra,
         double sampling_rate, bool filter_zeros);
 
     /// adds up a list of Spectra by resampling them and then addition of intensities
-    static OpenMS::MSSpectrum<> addUpSpectra(std::vector< OpenMS::MSSpectrum<> > all_spectra,
+    static OpenMS::MSSpectrum<> addUpSpectra(const std::vector< OpenMS::MSSpectrum<> >& all_spectra,
         double sampling_rate, bool filter_zeros);
 
+    /**
+      @brief merges a list of Spectra without resampling
+
+      Performs a k-way merge of the spectra (which need to be sorted by m/z).
+      Consecutive peaks within @p mz_tolerance (in Th) of the first peak of a
+      group are fused into one peak with the summed intensity at the
+      intensity-weighted mean m/z.
+
+      @param all_spectra The spectra to merge
+      @param mz_tolerance The m/z tolerance for peak fusion
+      @param filter_zeros Whether to ignore peaks with zero intensity
+    */
+    static OpenSwath::SpectrumPtr mergeSpectra(const std::vector<OpenSwath::SpectrumPtr>& all_spectra,
+        double mz_tolerance, bool filter_zeros);
+
   };
 }
 
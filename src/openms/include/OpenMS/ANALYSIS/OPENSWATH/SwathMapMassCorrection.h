@@ -69,13 +69,19 @@ public:
      * @param transition_group_map A MRMFeatureFinderScoring result map
      * @param swath_maps The raw swath maps from the current run
      * @param corr_type Regression type, one of "none", "unweighted_regression", "weighted_regression", "quadratic_regression", "quadratic_regression_delta_ppm"
-     *
+     * @param mz_extr_window Extraction window around the calibrant masses
+     * @param ppm Whether @p mz_extr_window is given in ppm
+     * @param cache_spectra Whether the transforming maps keep the corrected
+     *        spectra in memory (see SpectrumAccessTransforming). This avoids
+     *        reading and correcting spectra repeatedly if the maps are not
+     *        loaded into memory anyway. The MS1 map is never cached.
      *
      */
     static void correctMZ(OpenMS::MRMFeatureFinderScoring::TransitionGroupMapType & transition_group_map,
                           std::vector< OpenSwath::SwathMap > & swath_maps,
                           std::string corr_type,
-                          double mz_extr_window = 0.05, bool ppm = false);
+                          double mz_extr_window = 0.05, bool ppm = false,
+                          bool cache_spectra = false);
 
   };
 }
@@ -0,0 +1,169 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2016.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#ifndef OPENMS_ANALYSIS_OPENSWATH_SWATHMAPPREFETCHER_H
+#define OPENMS_ANALYSIS_OPENSWATH_SWATHMAPPREFETCHER_H
+
+#include <OpenMS/config.h> // OPENMS_DLLAPI
+#include <OpenMS/CONCEPT/Types.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/OPENSWATHALGO/DATAACCESS/ISpectrumAccess.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/OPENSWATHALGO/DATAACCESS/SwathMap.h>
+
+#include <QtCore/QThread>
+#include <QtCore/QMutex>
+#include <QtCore/QWaitCondition>
+
+#include <vector>
+
+namespace OpenMS
+{
+  /**
+    @brief Loads SWATH maps into memory in a background thread
+
+    When SWATH maps are backed by files (e.g. cached or split input), each
+    thread of the OpenSwathWorkflow would otherwise block on disk I/O at the
+    start of its window. The prefetcher loads the maps into memory (see
+    SpectrumAccessOpenMSInMemory) in the given order while the previous
+    windows are extracted and scored.
+
+    Maps are loaded ahead as long as the memory held by loaded (and not yet
+    released) maps is below the given budget. A map that is requested via
+    acquire() is always loaded, independent of the budget: if the background
+    thread has not started loading it yet, the requesting thread loads it
+    itself, so several maps can be read at the same time and processing never
+    waits for the background thread. Maps should be released as soon as they
+    are no longer needed.
+
+    @code
+    SwathMapPrefetcher prefetcher(swath_maps, load_order, memory_budget);
+    prefetcher.start();
+    // in each worker thread
+    OpenSwath::SpectrumAccessPtr map = prefetcher.acquire(i);
+    // ... process map ...
+    prefetcher.release(i);
+    @endcode
+
+    If loading a map fails, acquire() returns the original spectrum access.
+
+    @note acquire() and release() may be called concurrently from multiple threads.
+  */
+  class OPENMS_DLLAPI SwathMapPrefetcher :
+    public QThread
+  {
+
+public:
+
+    /**
+      @brief Constructor
+
+      @param swath_maps The SWATH maps
+      @param load_order Indices of the maps to load (in this order)
+      @param memory_budget Maximal memory (in bytes) for maps loaded ahead
+    */
+    SwathMapPrefetcher(const std::vector<OpenSwath::SwathMap>& swath_maps,
+                       const std::vector<Size>& load_order, Size memory_budget);
+
+    /// Destructor (stops the background thread)
+    ~SwathMapPrefetcher();
+
+    /**
+      @brief Returns the in-memory map with index @p map_index
+
+      If the map is not loaded yet, it is loaded by the calling thread (or, if
+      it is already being loaded, the call blocks until loading has finished).
+    */
+    OpenSwath::SpectrumAccessPtr acquire(Size map_index);
+
+    /// Releases the in-memory map with index @p map_index
+    void release(Size map_index);
+
+    /// Stops loading further maps
+    void stop();
+
+    /// Returns the memory (in bytes) currently held by loaded maps
+    Size getMemoryUsage() const;
+
+protected:
+
+    /// Loading state of a map
+    enum LoadState
+    {
+      PENDING, ///< not loaded yet
+      LOADING, ///< being loaded by the background thread or a worker
+      DONE ///< loading has finished (or failed)
+    };
+
+    /// Loads the maps (executed in the background thread)
+    void run();
+
+    /// Loads the map with index @p map_index (must be in state LOADING, called without holding the lock)
+    void load_(Size map_index);
+
+    /// Estimates the memory (in bytes) held by an in-memory map (peak data and per-spectrum overhead)
+    static Size estimateMemory_(OpenSwath::ISpectrumAccess& swath_map);
+
+    std::vector<OpenSwath::SwathMap> swath_maps_;
+    std::vector<Size> load_order_;
+    Size memory_budget_;
+
+    /// Position of each map in the load order (or -1 if it is not loaded)
+    std::vector<SignedSize> order_position_;
+    /// Loaded maps (NULL if not loaded, released or loading failed)
+    std::vector<OpenSwath::SpectrumAccessPtr> loaded_;
+    /// Memory held by each loaded map
+    std::vector<Size> memory_;
+    /// Loading state of each map
+    std::vector<LoadState> state_;
+
+    /// Position in the load order of the next map to load in the background thread
+    Size next_;
+    Size memory_usage_;
+    bool stop_;
+
+    mutable QMutex mutex_;
+    QWaitCondition loaded_condition_;
+    QWaitCondition budget_condition_;
+
+private:
+
+    /// Not implemented
+    SwathMapPrefetcher(const SwathMapPrefetcher& rhs);
+
+    /// Not implemented
+    SwathMapPrefetcher& operator=(const SwathMapPrefetcher& rhs);
+
+  };
+}
+
+#endif // OPENMS_ANALYSIS_OPENSWATH_SWATHMAPPREFETCHER_H
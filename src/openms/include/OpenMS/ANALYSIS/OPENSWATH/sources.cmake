@@ -4,6 +4,7 @@ set(directory include/OpenMS/ANALYSIS/OPENSWATH)
 ### list all header files of the directory here
 set(sources_list_h
   PeakPickerMRM.h
+  AddedSpectraCache.h
   ChromatogramExtractor.h
   ChromatogramExtractorAlgorithm.h
   ConfidenceScoring.h
@@ -23,6 +24,7 @@ set(sources_list_h
   SONARScoring.h
   SpectrumAddition.h
   SwathMapMassCorrection.h
+  SwathMapPrefetcher.h
   SwathWindowLoader.h
   TransitionTSVReader.h
 )
@@ -38,6 +38,10 @@
 #include <OpenMS/DATASTRUCTURES/DefaultParamHandler.h>
 #include <OpenMS/KERNEL/Peak2D.h>
 #include <OpenMS/KERNEL/MSExperiment.h>
+#include <OpenMS/INTERFACES/IMSDataConsumer.h>
+
+#include <deque>
+#include <vector>
 
 namespace OpenMS
 {
@@ -64,6 +68,10 @@ namespace OpenMS
 
     @note Centroided MS and MS/MS data is required.
 
+    Besides the in-memory interface (extractChannels()) the extraction can be
+    performed while reading the data using an ExtractionConsumer, which only
+    keeps the MS1 scans and MS/MS scans of the current batch in memory.
+
     @htmlinclude OpenMS_IsobaricChannelExtractor.parameters
   */
   class OPENMS_DLLAPI IsobaricChannelExtractor :
@@ -91,6 +99,74 @@ public:
     */
     void extractChannels(const MSExperiment<Peak1D>& ms_exp_data, ConsensusMap& consensus_map);
 
+    /**
+      @brief Consumer performing the channel extraction while the data is read (e.g. using MzMLFile::transform).
+
+      The consumer keeps the MS1 scans since the last processed batch (the
+      potential precursor and follow-up scans) and the selected MS/MS scans
+      of the current batch. Once a batch is complete and all its follow-up MS1
+      scans are known, precursor purity and reporter intensities are computed
+      in parallel and the resulting ConsensusFeatures are appended to the
+      output map in the order of the scans in the input. The results are
+      identical to extractChannels().
+
+      @note finish() has to be called after the last spectrum was consumed.
+    */
+    class OPENMS_DLLAPI ExtractionConsumer :
+      public Interfaces::IMSDataConsumer<MSExperiment<Peak1D> >
+    {
+public:
+      /**
+        @brief C'tor
+
+        @param extractor The configured channel extractor (has to outlive the consumer).
+        @param consensus_map Output map receiving the extracted channels.
+        @param batch_size Number of selected MS/MS scans which are processed together.
+      */
+      ExtractionConsumer(const IsobaricChannelExtractor& extractor, ConsensusMap& consensus_map, Size batch_size = 1000);
+
+      void consumeSpectrum(SpectrumType& s);
+
+      void consumeChromatogram(ChromatogramType&) {}
+
+      void setExpectedSize(Size, Size) {}
+
+      /// Stores the paths of the primary MS run in the output map
+      void setExperimentalSettings(const ExperimentalSettings& exp);
+
+      /**
+        @brief Processes the remaining scans and annotates the channels in the output map.
+
+        @exception Exception::MissingInformation is thrown if no spectrum was consumed
+      */
+      void finish();
+
+private:
+      /// Computes the pending batch and drops all MS1 scans except the most recent one
+      void processPendingScans_();
+
+      /// Drops all MS1 scans older than the earliest precursor of the pending scans (all but the most recent one if nothing is pending)
+      void dropObsoleteMS1Scans_();
+
+      const IsobaricChannelExtractor& extractor_;
+      ConsensusMap& consensus_map_;
+      Size batch_size_;
+
+      /// MS1 scans that may serve as precursor or follow-up scans of pending MS/MS scans
+      std::deque<SpectrumType> ms1_scans_;
+      /// Number of MS1 scans already removed from the front of ms1_scans_
+      Size ms1_offset_;
+      /// Selected MS/MS scans of the current batch
+      std::vector<SpectrumType> pending_ms2_;
+      /// Index of the precursor scan (counting all MS1 scans seen so far) for each pending MS/MS scan or -1
+      std::vector<SignedSize> pending_precursor_;
+
+      UInt64 element_index_;
+      Size spectra_consumed_;
+    };
+
+    friend class ExtractionConsumer;
+
 private:
     /**
       @brief Small struct to capture the current state of the purity computation.
@@ -164,7 +240,7 @@ private:
     bool interpolate_precursor_purity_;
 
     /// add channel information to the map after it has been filled
-    void registerChannelsInOutputMap_(ConsensusMap& consensus_map);
+    void registerChannelsInOutputMap_(ConsensusMap& consensus_map) const;
 
     /**
       @brief Checks if the given precursor fulfills all constraints for extractions.
@@ -183,22 +259,48 @@ private:
     bool hasLowIntensityReporter_(const ConsensusFeature& cf) const;
 
     /**
-      @brief Computes the purity of the precursor given an iterator pointing to the MS/MS spectrum and one to the precursor spectrum.
+      @brief Checks the activation method and the precursor of the given MS/MS scan.
+
+      @param ms2_spec The MS/MS scan to test.
+      @return $true$ if the scan should be used for extraction, $false$ otherwise.
+      @exception Exception::MissingInformation is thrown if the scan has no precursor information
+    */
+    bool isSelectedScan_(const MSExperiment<Peak1D>::SpectrumType& ms2_spec) const;
+
+    /**
+      @brief Computes the purity of the precursor given the MS/MS spectrum, its precursor spectrum and the following MS1 spectrum.
 
-      @param ms2_spec Iterator pointing to the MS2 spectrum.
-      @param precursor Iterator pointing to the precursor spectrum of ms2_spec.
+      @param ms2_spec The MS2 spectrum.
+      @param precursor_spec The precursor spectrum of ms2_spec.
+      @param follow_up_spec The MS1 spectrum following ms2_spec or 0 if there is none.
       @return Fraction of the total intensity in the isolation window of the precursor spectrum that was assigned to the precursor.
     */
-    double computePrecursorPurity_(const MSExperiment<Peak1D>::ConstIterator& ms2_spec, const PuritySate_& pState) const;
+    double computePrecursorPurity_(const MSExperiment<Peak1D>::SpectrumType& ms2_spec, const MSExperiment<Peak1D>::SpectrumType& precursor_spec, const MSExperiment<Peak1D>::SpectrumType* follow_up_spec) const;
 
     /**
-      @brief Computes the purity of the precursor given an iterator pointing to the MS/MS spectrum and a reference to the potential precursor spectrum.
+      @brief Computes the purity of the precursor given the MS/MS spectrum and a reference to the potential precursor spectrum.
 
-      @param ms2_spec Iterator pointing to the MS2 spectrum.
-      @param precursor Iterator pointing to the precursor spectrum of ms2_spec.
+      @param ms2_spec The MS2 spectrum.
+      @param precursor_spec The potential precursor spectrum of ms2_spec.
       @return Fraction of the total intensity in the isolation window of the precursor spectrum that was assigned to the precursor.
     */
-    double computeSingleScanPrecursorPurity_(const MSExperiment<Peak1D>::ConstIterator& ms2_spec, const MSExperiment<Peak1D>::SpectrumType& precursor_spec) const;
+    double computeSingleScanPrecursorPurity_(const MSExperiment<Peak1D>::SpectrumType& ms2_spec, const MSExperiment<Peak1D>::SpectrumType& precursor_spec) const;
+
+    /**
+      @brief Extracts the channels of a batch of selected MS/MS scans and appends the resulting features to @p consensus_map.
+
+      Purity and reporter intensities are computed in parallel, the features are added in the order of @p ms2_specs.
+
+      @param ms2_specs The selected MS/MS scans.
+      @param precursor_specs The precursor scan of each MS/MS scan or 0 if there is none.
+      @param follow_up_specs The MS1 scan following each MS/MS scan or 0 if there is none.
+      @param element_index Index of the next tandem scan added to the map (updated).
+      @param consensus_map The output map.
+    */
+    void extractBatch_(const std::vector<const MSExperiment<Peak1D>::SpectrumType*>& ms2_specs,
+                       const std::vector<const MSExperiment<Peak1D>::SpectrumType*>& precursor_specs,
+                       const std::vector<const MSExperiment<Peak1D>::SpectrumType*>& follow_up_specs,
+                       UInt64& element_index, ConsensusMap& consensus_map) const;
 
 protected:
     /// implemented for DefaultParamHandler
@@ -214,8 +214,8 @@ private:
          The keys of @p abundances are stored ordered in @p result, best first.
     */
     template <typename T>
-    void orderBest_(const std::map<T, SampleAbundances> abundances,
-                    std::vector<T>& result)
+    void orderBest_(const std::map<T, SampleAbundances>& abundances,
+                    std::vector<T>& result) const
     {
       typedef std::pair<Size, double> PairType;
       std::multimap<PairType, T, std::greater<PairType> > order;
@@ -240,6 +240,47 @@ private:
       }
     }
 
+    /**
+         @brief Dense abundance matrix of the proteotypic peptides of a protein.
+
+         Rows correspond to unmodified peptide sequences, columns to samples (in ascending order of sample IDs). Missing abundances are NaN.
+    */
+    struct ProteinMatrix_
+    {
+      /// mapping: peptide (unmodified) -> row index
+      std::map<String, Size> rows;
+
+      /// abundances (row-major)
+      std::vector<double> abundances;
+
+      /// total number of identifications (of peptides mapping to this protein)
+      Size id_count;
+
+      /// constructor
+      ProteinMatrix_() :
+        id_count(0) {}
+    };
+
+    /**
+         @brief Build the peptide-by-sample matrix of a protein from its (proteotypic) peptides.
+
+         @param peptides Peptides of the protein (entries of "pep_quant_")
+         @param sample_ids Sample IDs corresponding to the matrix columns (sorted)
+         @param matrix Output matrix (expected to be empty)
+    */
+    void buildProteinMatrix_(const std::vector<PeptideQuant::const_iterator>& peptides,
+                             const std::vector<UInt64>& sample_ids,
+                             ProteinMatrix_& matrix) const;
+
+    /**
+         @brief Compute the abundances of a protein (one value per sample, NaN if not quantified) from its peptide matrix.
+
+         Implements the peptide selection and averaging of quantifyProteins(), see the "top", "average", "include_all" and "consensus:fix_peptides" parameters.
+    */
+    void aggregateProtein_(const ProteinMatrix_& matrix, Size n_columns,
+                           Size top, const String& average, bool include_all,
+                           bool fix_peptides, std::vector<double>& result) const;
+
     /**
          @brief Normalize peptide abundances across samples by (multiplicative) scaling to equal medians.
     */
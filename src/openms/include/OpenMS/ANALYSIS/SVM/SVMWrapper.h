@@ -166,6 +166,19 @@ public:
     */
     void setParameter(SVM_parameter_type type, double value);
 
+    /**
+      @brief sets the memory limit for precomputed oligo kernel values (in MB, default 1024)
+
+      The kernel values of all pairs of training sequences (Gram matrix) are only cached if they
+      fit into this limit, otherwise they are computed on the fly for every fold. The limit also
+      bounds the number of cross validation folds that are evaluated in parallel, as each of
+      them holds its own kernel matrix.
+    */
+    void setKernelMemoryLimit(Size megabytes);
+
+    /// returns the memory limit for precomputed oligo kernel values (in MB)
+    Size getKernelMemoryLimit() const;
+
     /**
       @brief	trains the svm
 
@@ -330,6 +343,9 @@ public:
     /**
       @brief Performs a CV for the data given by 'problem'
 
+      All combinations of runs, grid cells and partitions are trained and evaluated in parallel (if OpenMP is enabled).
+      For the oligo kernel ('is_labeled'), the kernel values of all pairs of sequences are computed once per
+      value of sigma and shared by all folds. Note that each thread holds the kernel matrix of one fold.
     */
     double performCrossValidation(svm_problem* problem_ul,
                                       const SVMData& problem_l,
@@ -393,6 +409,8 @@ public:
 
     /**
       @brief calculates the significance borders of the error model and stores them in 'sigmas'
+
+      The folds are trained and evaluated in parallel, sharing the precomputed kernel values of 'data'.
     */
     void getSignificanceBorders(const SVMData& data,
                                 std::pair<double, double>& sigmas,
@@ -496,6 +514,48 @@ private:
     */
     void initParameters_();
 
+    /// sets a grid search parameter (DEGREE, C, P, NU or GAMMA) in @p param
+    static void setParameter_(svm_parameter& param, SVM_parameter_type type, double value);
+
+    /// frees a model created by svm_train
+    static void destroyModel_(svm_model* model);
+
+    /// creates 'number' equally sized random partitions of the indices [0, size) (in the same way as createRandomPartitions)
+    static void createRandomPartitionIndices_(Size size, Size number, std::vector<std::vector<Size> >& partitions);
+
+    /// returns whether the Gram matrix holds the kernel values of @p data for the current kernel parameters
+    bool hasGramMatrix_(const SVMData& data) const;
+
+    /**
+      @brief computes the oligo kernel values of all pairs of sequences in @p data (Gram matrix)
+
+      The matrix is only recomputed if the data or the kernel parameters changed, so it is shared by
+      cross validation, training and the computation of the significance borders. If it would exceed
+      the kernel memory limit, no matrix is kept (hasGramMatrix_() returns false afterwards).
+    */
+    void updateGramMatrix_(const SVMData& data);
+
+    /**
+      @brief creates the precomputed kernel problem of the sequences @p rows against @p columns (indices into @p data)
+
+      The kernel values are taken from the Gram matrix if @p use_gram is true, otherwise they are computed
+      (with the same argument order, so the values are identical).
+    */
+    svm_problem* kernelMatrix_(const SVMData& data, const std::vector<Size>& rows, const std::vector<Size>& columns, bool use_gram) const;
+
+    /// returns the number of threads that may evaluate folds with @p number_of_sequences sequences in total in parallel without exceeding the kernel memory limit
+    int getFoldThreads_(Size number_of_sequences, Size number_of_partitions) const;
+
+    /**
+      @brief trains with @p param on all partitions except @p test_partition and predicts the labels of @p test_partition
+
+      Uses the Gram matrix of @p data if @p use_gram is true (see updateGramMatrix_()). Returns false if training failed.
+    */
+    bool evaluateFold_(svm_parameter param, const SVMData& data, const std::vector<std::vector<Size> >& partitions, Size test_partition, bool use_gram, std::vector<double>& predicted_labels) const;
+
+    /// trains with @p param on @p training_data and predicts the labels of @p test_data. Returns false if training failed.
+    bool evaluateFold_(svm_parameter param, svm_problem* training_data, svm_problem* test_data, std::vector<double>& predicted_labels);
+
     /**
       @brief This function is passed to lib svm for output control
 
@@ -514,6 +574,10 @@ private:
     svm_problem* training_set_; // the training set
     svm_problem* training_problem_; // the training set
     SVMData training_data_; // the training set (different encoding)
+    std::vector<double> gram_matrix_; // oligo kernel values of all pairs of sequences in 'gram_sequences_' (row-major)
+    std::vector<std::vector<std::pair<Int, double> > > gram_sequences_; // the sequences of the Gram matrix
+    std::vector<double> gram_gauss_table_; // the gauss table used for the Gram matrix
+    Size kernel_memory_limit_; // memory limit for precomputed kernel values (in MB)
   };
 
 } // namespace OpenMS
@@ -109,6 +109,9 @@ public:
     /// Performs the enzymatic digestion of a unmodified protein String. By returning only references into the original string it is much faster. max_length restricts the maximum length of reported peptides (0 = no restriction)
     void digestUnmodifiedString(const StringView sequence, std::vector<StringView>& output, Size min_length = 1, Size max_length = 0) const;
 
+    /// Same as above, but reports the start position and length of every peptide within @p sequence (in the same order)
+    void digestUnmodifiedString(const StringView sequence, std::vector<std::pair<Size, Size> >& output, Size min_length = 1, Size max_length = 0) const;
+
     /// Returns the number of peptides a digestion of @p protein would yield under the current enzyme and missed cleavage settings.
     Size peptideCount(const AASequence& protein);
 
@@ -0,0 +1,171 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2016.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: Timo Sachsenberg $
+// --------------------------------------------------------------------------
+
+#ifndef OPENMS_CHEMISTRY_PEPTIDECATALOGUE_H
+#define OPENMS_CHEMISTRY_PEPTIDECATALOGUE_H
+
+#include <OpenMS/CHEMISTRY/EnzymaticDigestion.h>
+#include <OpenMS/FORMAT/FASTAFile.h>
+#include <OpenMS/METADATA/PeptideEvidence.h>
+
+#include <vector>
+
+namespace OpenMS
+{
+  /**
+    @brief Unique (unmodified) peptides of a digested protein database
+
+    build() digests all proteins in parallel and merges identical peptides,
+    so every peptide sequence is contained only once, together with its
+    monoisotopic mass and all of its occurrences (protein, start position and
+    flanking amino acids) in the database.
+
+    Peptides are stored in flat arrays sorted by mass; candidates for a
+    precursor mass are found by binary search (getPeptidesInMassRange()). The
+    catalogue is not modified by the const methods and can be read
+    concurrently from several threads.
+
+    The catalogue can be written to a binary file and loaded again (via a
+    memory mapped file), so a database only needs to be digested once for
+    several searches. A free-text tag (e.g. the database and digestion
+    settings) can be stored alongside to decide whether a stored catalogue
+    can be reused.
+
+    @ingroup Chemistry
+  */
+  class OPENMS_DLLAPI PeptideCatalogue
+  {
+public:
+
+    /// Default constructor
+    PeptideCatalogue();
+
+    /// Destructor
+    virtual ~PeptideCatalogue();
+
+    /**
+      @brief Digests @p proteins and stores their unique peptides (replacing the current content)
+
+      The unmodified protein sequences are digested with the enzyme and missed
+      cleavage settings of @p digestion (see
+      EnzymaticDigestion::digestUnmodifiedString()). Peptides with characters
+      that are not amino acids in ResidueDB are skipped.
+    */
+    void build(const std::vector<FASTAFile::FASTAEntry>& proteins, const EnzymaticDigestion& digestion, Size min_length = 1, Size max_length = 0);
+
+    /// Removes all peptides and proteins
+    void clear();
+
+    /// Number of unique peptides
+    Size size() const;
+
+    /// Returns if there are no peptides
+    bool empty() const;
+
+    /// Sequence of peptide @p index
+    String getSequence(Size index) const;
+
+    /// Length of peptide @p index
+    Size getLength(Size index) const;
+
+    /// Monoisotopic mass (uncharged, unmodified) of peptide @p index
+    double getMonoWeight(Size index) const;
+
+    /**
+      @brief Determines the peptides with mass in [@p min_mass, @p max_mass]
+
+      The result is the half-open index range [@p first, @p last).
+    */
+    void getPeptidesInMassRange(double min_mass, double max_mass, Size& first, Size& last) const;
+
+    /// Number of occurrences of peptide @p index in the database
+    Size getNumberOfOccurrences(Size index) const;
+
+    /// Appends the occurrences of peptide @p index in the database to @p evidences
+    void getPeptideEvidences(Size index, std::vector<PeptideEvidence>& evidences) const;
+
+    /// Number of proteins in the digested database
+    Size getNumberOfProteins() const;
+
+    /// Identifier of protein @p index of the digested database
+    const String& getProteinIdentifier(Size index) const;
+
+    /// Sets the tag that is stored with the catalogue
+    void setTag(const String& tag);
+
+    /// Returns the tag that is stored with the catalogue
+    const String& getTag() const;
+
+    /**
+      @brief Writes the catalogue to a binary file
+
+      @exception Exception::UnableToCreateFile is thrown if the file cannot be written
+    */
+    void store(const String& filename) const;
+
+    /**
+      @brief Loads the catalogue from a binary file written by store()
+
+      @exception Exception::FileNotFound is thrown if the file does not exist
+      @exception Exception::ParseError is thrown if the file is not a valid catalogue
+    */
+    void load(const String& filename);
+
+protected:
+
+    /// Tag stored with the catalogue
+    String tag_;
+    /// Identifiers of the digested proteins
+    std::vector<String> protein_identifiers_;
+    /// Residues of all peptides (concatenated)
+    std::vector<char> residues_;
+    /// Offset of each peptide in residues_ (one more than peptides)
+    std::vector<Size> peptide_offset_;
+    /// Monoisotopic mass per peptide (ascending)
+    std::vector<double> mass_;
+    /// Offset of the first occurrence of each peptide in the occurrence arrays (one more than peptides)
+    std::vector<Size> occurrence_offset_;
+    /// Protein index per occurrence
+    std::vector<Size> occurrence_protein_;
+    /// Start position in the protein per occurrence
+    std::vector<Size> occurrence_start_;
+    /// Amino acid before the peptide per occurrence (PeptideEvidence::N_TERMINAL_AA at the protein N-terminus)
+    std::vector<char> occurrence_aa_before_;
+    /// Amino acid after the peptide per occurrence (PeptideEvidence::C_TERMINAL_AA at the protein C-terminus)
+    std::vector<char> occurrence_aa_after_;
+  };
+
+} // namespace OpenMS
+
+#endif // OPENMS_CHEMISTRY_PEPTIDECATALOGUE_H
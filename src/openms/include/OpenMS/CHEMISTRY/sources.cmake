@@ -18,6 +18,7 @@ ModificationDefinitionsSet.h
 ModificationsDB.h
 ModifierRep.h
 PepIterator.h
+PeptideCatalogue.h
 Residue.h
 ResidueDB.h
 ResidueModification.h
@@ -280,6 +280,7 @@ public:
       @brief solve problems, parameters like enabled heuristics can be given via solver_param
 
       The verbose level (0,1,2) determines if the solver prints status messages and internals.
+      The status messages written to the log are serialized, so independent problems can be solved concurrently (COIN-OR only).
 
       @param solver_param
       @param verbose_level
@@ -44,6 +44,10 @@
 #include <algorithm>
 #include <iterator>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace OpenMS
 {
 
@@ -166,8 +170,7 @@ public:
     /// Constructor
     MorphologicalFilter() :
       ProgressLogger(),
-      DefaultParamHandler("MorphologicalFilter"),
-      struct_size_in_datapoints_(0)
+      DefaultParamHandler("MorphologicalFilter")
     {
       //structuring element
       defaults_.setValue("struc_elem_length", 3.0, "Length of the structuring element. This should be wider than the expected peak width.");
@@ -199,91 +202,149 @@ public:
     template <typename InputIterator, typename OutputIterator>
     void filterRange(InputIterator input_begin, InputIterator input_end, OutputIterator output_begin)
     {
-      // the buffer is static only to avoid reallocation
-      static std::vector<typename InputIterator::value_type> buffer;
-      const UInt size = input_end - input_begin;
+      std::vector<typename InputIterator::value_type> buffer, block_buffer;
+      filterRange_(param_.getValue("method"), (Int)(double)param_.getValue("struc_elem_length"),
+                   input_begin, input_end, output_begin, buffer, block_buffer);
+    }
+
+    /**
+        @brief Applies the morphological filtering operation to an MSSpectrum.
+
+        If the size of the structuring element is given in 'Thomson', the number of data points for
+        the structuring element is computed as follows:
+        <ul>
+            <li>The data points are assumed to be uniformly spaced.  We compute the
+                average spacing from the position of the first and the last peak and the
+                total number of peaks in the input range.
+            <li>The number of data points in the structuring element is computed
+                from struc_size and the average spacing, and rounded up to an odd
+                number.
+        </ul>
+    */
+    template <typename PeakType>
+    void filter(MSSpectrum<PeakType> & spectrum)
+    {
+      std::vector<typename PeakType::IntensityType> input, output, buffer, block_buffer;
+      filter_(spectrum, input, output, buffer, block_buffer);
+    }
 
-      //determine the struct size in data points if not already set
-      if (struct_size_in_datapoints_ == 0)
+    /**
+        @brief Applies the morphological filtering operation to an MSExperiment.
+
+        The size of the structuring element is computed for each spectrum individually, if it is given in 'Thomson'.
+        See the filtering method for MSSpectrum for details.
+
+        The spectra are processed in parallel (if OpenMP is enabled).
+    */
+    template <typename PeakType>
+    void filterExperiment(MSExperiment<PeakType> & exp)
+    {
+      typedef typename PeakType::IntensityType IntensityType;
+
+      Size progress = 0;
+      startProgress(0, exp.size(), "filtering baseline");
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
       {
-        struct_size_in_datapoints_ = (UInt)(double)param_.getValue("struc_elem_length");
+        // scratch space of this thread
+        std::vector<IntensityType> input, output, buffer, block_buffer;
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 16)
+#endif
+        for (SignedSize i = 0; i < (SignedSize)exp.size(); ++i)
+        {
+          filter_(exp[i], input, output, buffer, block_buffer);
+          IF_MASTERTHREAD setProgress(progress);
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+          ++progress;
+        }
       }
+      endProgress();
+    }
+
+protected:
+
+    /**
+        @brief Applies the morphological filtering operation @p method to an iterator range.
+
+        @p buffer and @p block_buffer are scratch space, which is resized as needed (and can be reused between calls).
+    */
+    template <typename InputIterator, typename OutputIterator, typename ValueType>
+    void filterRange_(const String & method, Int struc_size, InputIterator input_begin, InputIterator input_end, OutputIterator output_begin,
+                      std::vector<ValueType> & buffer, std::vector<ValueType> & block_buffer) const
+    {
+      const Int size = input_end - input_begin;
 
       //apply the filtering
-      String method = param_.getValue("method");
       if (method == "identity")
       {
         std::copy(input_begin, input_end, output_begin);
       }
       else if (method == "erosion")
       {
-        applyErosion_(struct_size_in_datapoints_, input_begin, input_end, output_begin);
+        applyErosion_(struc_size, input_begin, input_end, output_begin, block_buffer);
       }
       else if (method == "dilation")
       {
-        applyDilation_(struct_size_in_datapoints_, input_begin, input_end, output_begin);
+        applyDilation_(struc_size, input_begin, input_end, output_begin, block_buffer);
       }
       else if (method == "opening")
       {
-        if (buffer.size() < size) buffer.resize(size);
-        applyErosion_(struct_size_in_datapoints_, input_begin, input_end, buffer.begin());
-        applyDilation_(struct_size_in_datapoints_, buffer.begin(), buffer.begin() + size, output_begin);
+        if (Int(buffer.size()) < size) buffer.resize(size);
+        applyErosion_(struc_size, input_begin, input_end, buffer.begin(), block_buffer);
+        applyDilation_(struc_size, buffer.begin(), buffer.begin() + size, output_begin, block_buffer);
       }
       else if (method == "closing")
       {
-        if (buffer.size() < size) buffer.resize(size);
-        applyDilation_(struct_size_in_datapoints_, input_begin, input_end, buffer.begin());
-        applyErosion_(struct_size_in_datapoints_, buffer.begin(), buffer.begin() + size, output_begin);
+        if (Int(buffer.size()) < size) buffer.resize(size);
+        applyDilation_(struc_size, input_begin, input_end, buffer.begin(), block_buffer);
+        applyErosion_(struc_size, buffer.begin(), buffer.begin() + size, output_begin, block_buffer);
       }
       else if (method == "gradient")
       {
-        if (buffer.size() < size) buffer.resize(size);
-        applyErosion_(struct_size_in_datapoints_, input_begin, input_end, buffer.begin());
-        applyDilation_(struct_size_in_datapoints_, input_begin, input_end, output_begin);
-        for (UInt i = 0; i < size; ++i) output_begin[i] -= buffer[i];
+        if (Int(buffer.size()) < size) buffer.resize(size);
+        applyErosion_(struc_size, input_begin, input_end, buffer.begin(), block_buffer);
+        applyDilation_(struc_size, input_begin, input_end, output_begin, block_buffer);
+        for (Int i = 0; i < size; ++i) output_begin[i] -= buffer[i];
       }
       else if (method == "tophat")
       {
-        if (buffer.size() < size) buffer.resize(size);
-        applyErosion_(struct_size_in_datapoints_, input_begin, input_end, buffer.begin());
-        applyDilation_(struct_size_in_datapoints_, buffer.begin(), buffer.begin() + size, output_begin);
-        for (UInt i = 0; i < size; ++i) output_begin[i] = input_begin[i] - output_begin[i];
+        if (Int(buffer.size()) < size) buffer.resize(size);
+        applyErosion_(struc_size, input_begin, input_end, buffer.begin(), block_buffer);
+        applyDilation_(struc_size, buffer.begin(), buffer.begin() + size, output_begin, block_buffer);
+        for (Int i = 0; i < size; ++i) output_begin[i] = input_begin[i] - output_begin[i];
       }
       else if (method == "bothat")
       {
-        if (buffer.size() < size) buffer.resize(size);
-        applyDilation_(struct_size_in_datapoints_, input_begin, input_end, buffer.begin());
-        applyErosion_(struct_size_in_datapoints_, buffer.begin(), buffer.begin() + size, output_begin);
-        for (UInt i = 0; i < size; ++i) output_begin[i] = input_begin[i] - output_begin[i];
+        if (Int(buffer.size()) < size) buffer.resize(size);
+        applyDilation_(struc_size, input_begin, input_end, buffer.begin(), block_buffer);
+        applyErosion_(struc_size, buffer.begin(), buffer.begin() + size, output_begin, block_buffer);
+        for (Int i = 0; i < size; ++i) output_begin[i] = input_begin[i] - output_begin[i];
       }
       else if (method == "erosion_simple")
       {
-        applyErosionSimple_(struct_size_in_datapoints_, input_begin, input_end, output_begin);
+        applyErosionSimple_(struc_size, input_begin, input_end, output_begin);
       }
       else if (method == "dilation_simple")
       {
-        applyDilationSimple_(struct_size_in_datapoints_, input_begin, input_end, output_begin);
+        applyDilationSimple_(struc_size, input_begin, input_end, output_begin);
       }
-
-      struct_size_in_datapoints_ = 0;
     }
 
     /**
-        @brief Applies the morphological filtering operation to an MSSpectrum.
+        @brief Applies the morphological filtering operation to an MSSpectrum using the given scratch space.
 
-        If the size of the structuring element is given in 'Thomson', the number of data points for
-        the structuring element is computed as follows:
-        <ul>
-            <li>The data points are assumed to be uniformly spaced.  We compute the
-                average spacing from the position of the first and the last peak and the
-                total number of peaks in the input range.
-            <li>The number of data points in the structuring element is computed
-                from struc_size and the average spacing, and rounded up to an odd
-                number.
-        </ul>
+        The intensities are copied into the contiguous array @p input, the filtered intensities are written to @p output.
     */
     template <typename PeakType>
-    void filter(MSSpectrum<PeakType> & spectrum)
+    void filter_(MSSpectrum<PeakType> & spectrum,
+                 std::vector<typename PeakType::IntensityType> & input,
+                 std::vector<typename PeakType::IntensityType> & output,
+                 std::vector<typename PeakType::IntensityType> & buffer,
+                 std::vector<typename PeakType::IntensityType> & block_buffer) const
     {
       //make sure the right peak type is set
       spectrum.setType(SpectrumSettings::RAWDATA);
@@ -292,9 +353,10 @@ public:
       if (spectrum.size() <= 1) return;
 
       //Determine structuring element size in datapoints (depending on the unit)
+      UInt struc_size;
       if ((String)(param_.getValue("struc_elem_unit")) == "Thomson")
       {
-        struct_size_in_datapoints_ =
+        struc_size =
           UInt(
             ceil(
               (double)(param_.getValue("struc_elem_length"))
@@ -307,60 +369,40 @@ public:
       }
       else
       {
-        struct_size_in_datapoints_ = (UInt)(double)param_.getValue("struc_elem_length");
+        struc_size = (UInt)(double)param_.getValue("struc_elem_length");
       }
       //make it odd (needed for the algorithm)
-      if (!Math::isOdd(struct_size_in_datapoints_)) ++struct_size_in_datapoints_;
-
-      //apply the filtering and overwrite the input data
-      std::vector<typename PeakType::IntensityType> output(spectrum.size());
-      filterRange(Internal::intensityIteratorWrapper(spectrum.begin()),
-                  Internal::intensityIteratorWrapper(spectrum.end()),
-                  output.begin()
-                  );
+      if (!Math::isOdd(struc_size)) ++struc_size;
 
-      //overwrite output with data
-      for (Size i = 0; i < spectrum.size(); ++i)
+      //copy the intensities to contiguous memory
+      const Size size = spectrum.size();
+      input.resize(size);
+      output.resize(size);
+      for (Size i = 0; i < size; ++i)
       {
-        spectrum[i].setIntensity(output[i]);
+        input[i] = spectrum[i].getIntensity();
       }
-    }
 
-    /**
-        @brief Applies the morphological filtering operation to an MSExperiment.
+      //apply the filtering
+      filterRange_(param_.getValue("method"), (Int)struc_size, input.begin(), input.end(), output.begin(), buffer, block_buffer);
 
-        The size of the structuring element is computed for each spectrum individually, if it is given in 'Thomson'.
-        See the filtering method for MSSpectrum for details.
-    */
-    template <typename PeakType>
-    void filterExperiment(MSExperiment<PeakType> & exp)
-    {
-      startProgress(0, exp.size(), "filtering baseline");
-      for (UInt i = 0; i < exp.size(); ++i)
+      //overwrite output with data
+      for (Size i = 0; i < size; ++i)
       {
-        filter(exp[i]);
-        setProgress(i);
+        spectrum[i].setIntensity(output[i]);
       }
-      endProgress();
     }
 
-protected:
-
-    ///Member for struct size in data points
-    UInt struct_size_in_datapoints_;
-
     /** @brief Applies erosion.  This implementation uses van Herk's method.
     Only 3 min/max comparisons are required per data point, independent of
-    struc_size.
+    struc_size.  @p buffer is scratch space for the running minima of a block.
     */
-    template <typename InputIterator, typename OutputIterator>
-    void applyErosion_(Int struc_size, InputIterator input, InputIterator input_end, OutputIterator output)
+    template <typename InputIterator, typename OutputIterator, typename ValueType>
+    void applyErosion_(Int struc_size, InputIterator input, InputIterator input_end, OutputIterator output, std::vector<ValueType> & buffer) const
     {
-      typedef typename InputIterator::value_type ValueType;
       const Int size = input_end - input;
       const Int struc_size_half = struc_size / 2;           // yes, integer division
 
-      static std::vector<ValueType> buffer;
       if (Int(buffer.size()) < struc_size) buffer.resize(struc_size);
 
       Int anchor;           // anchoring position of the current block
@@ -451,16 +493,14 @@ protected:
 
     /** @brief Applies dilation.  This implementation uses van Herk's method.
     Only 3 min/max comparisons are required per data point, independent of
-    struc_size.
+    struc_size.  @p buffer is scratch space for the running maxima of a block.
     */
-    template <typename InputIterator, typename OutputIterator>
-    void applyDilation_(Int struc_size, InputIterator input, InputIterator input_end, OutputIterator output)
+    template <typename InputIterator, typename OutputIterator, typename ValueType>
+    void applyDilation_(Int struc_size, InputIterator input, InputIterator input_end, OutputIterator output, std::vector<ValueType> & buffer) const
     {
-      typedef typename InputIterator::value_type ValueType;
       const Int size = input_end - input;
       const Int struc_size_half = struc_size / 2;           // yes, integer division
 
-      static std::vector<ValueType> buffer;
       if (Int(buffer.size()) < struc_size) buffer.resize(struc_size);
 
       Int anchor;           // anchoring position of the current block
@@ -551,7 +591,7 @@ protected:
 
     /// Applies erosion.  Simple implementation, possibly faster if struc_size is very small, and used in some special cases.
     template <typename InputIterator, typename OutputIterator>
-    void applyErosionSimple_(Int struc_size, InputIterator input_begin, InputIterator input_end, OutputIterator output_begin)
+    void applyErosionSimple_(Int struc_size, InputIterator input_begin, InputIterator input_end, OutputIterator output_begin) const
     {
       typedef typename InputIterator::value_type ValueType;
       const int size = input_end - input_begin;
@@ -569,7 +609,7 @@ protected:
 
     /// Applies dilation.  Simple implementation, possibly faster if struc_size is very small, and used in some special cases.
     template <typename InputIterator, typename OutputIterator>
-    void applyDilationSimple_(Int struc_size, InputIterator input_begin, InputIterator input_end, OutputIterator output_begin)
+    void applyDilationSimple_(Int struc_size, InputIterator input_begin, InputIterator input_end, OutputIterator output_begin) const
     {
       typedef typename InputIterator::value_type ValueType;
       const int size = input_end - input_begin;
@@ -41,6 +41,8 @@
 #include <OpenMS/CONCEPT/LogStream.h>
 #include <OpenMS/CONCEPT/Exception.h>
 #include <OpenMS/DATASTRUCTURES/ListUtils.h>
+
+#include <algorithm>
 #include <vector>
 
 namespace OpenMS
@@ -71,6 +73,14 @@ namespace OpenMS
     @note If more than 1 percent of median estimations had to rely on the last(=rightmost) bin (which gives an unreliable result), a warning is issued to <i>LOG_WARN</i>.  In this case you should increase <i>max_intensity</i> (and optionally the <i>bin_count</i>). 
     @note You can disable logging this error by setting <i>write_log_messages</i> and read out the values 
 
+    Alternatively (param: <i>median_mode</i> = 'exact'), the median of each
+    window is computed exactly instead of from the histogram.  The intensities
+    of the scan are ranked once and the window content is kept in a binary
+    indexed tree over these ranks, so adding or removing a data point and
+    locating the median each take O(log n) time.  This mode is independent of
+    <i>bin_count</i> and <i>max_intensity</i> (no rightmost bin overflow
+    can occur) and is usually faster for large windows.
+
 
         @htmlinclude OpenMS_SignalToNoiseEstimatorMedian.parameters
 
@@ -136,6 +146,9 @@ public:
 
       defaults_.setValue("noise_for_empty_window", std::pow(10.0, 20), "noise value used for sparse windows", ListUtils::create<String>("advanced"));
 
+      defaults_.setValue("median_mode", "histogram", "how to compute the median of a window: 'histogram' uses 'bin_count' bins up to 'max_intensity' (approximate), 'exact' uses the actual intensities (and ignores the histogram parameters)");
+      defaults_.setValidStrings("median_mode", ListUtils::create<String>("histogram,exact"));
+
       defaults_.setValue("write_log_messages", "true", "Write out log messages in case of sparse windows or median in rightmost histogram bin");
       defaults_.setValidStrings("write_log_messages", ListUtils::create<String>("true,false"));
 
@@ -199,6 +212,12 @@ protected:
       // reset the results
       stn_estimates_.clear();
 
+      if (exact_median_)
+      {
+        computeExactSTN_(scan_first_, scan_last_);
+        return;
+      }
+
       // maximal range of histogram needs to be calculated first
       if (auto_mode_ == AUTOMAXBYSTDEV)
       {
@@ -386,9 +405,114 @@ protected:
       sparse_window_percent_ = sparse_window_percent_ * 100 / window_count;
       histogram_oob_percent_ = histogram_oob_percent_ * 100 / window_count;
 
+      writeLogMessages_();
+
+    } // end of shiftWindow_
+
+    /**
+      @brief Calculate signal-to-noise values for all data points given, using the exact median of each window
+
+      The window borders only move to the right, so each data point enters and leaves the window once. The
+      window content is stored as a binary indexed tree over the intensity ranks of the data points, which
+      allows to locate the median (the element of rank ceil(n/2) in the window, as in the histogram approach)
+      in logarithmic time.
+    */
+    void computeExactSTN_(const PeakIterator & scan_first_, const PeakIterator & scan_last_)
+    {
+      // copy positions and intensities to contiguous memory
+      std::vector<double> mz, intensity;
+      for (PeakIterator run = scan_first_; run != scan_last_; ++run)
+      {
+        mz.push_back((*run).getMZ());
+        intensity.push_back((*run).getIntensity());
+      }
+      const Size n = mz.size();
+      if (n == 0) return;
+
+      // rank all data points by intensity (ties are broken by position, so ranks are unique)
+      std::vector<Size> by_intensity(n);
+      for (Size i = 0; i < n; ++i) by_intensity[i] = i;
+      std::sort(by_intensity.begin(), by_intensity.end(), IntensityRankLess_(intensity));
+      std::vector<Size> rank(n);
+      for (Size r = 0; r < n; ++r) rank[by_intensity[r]] = r;
+
+      // binary indexed tree (1-based) counting the window elements per rank
+      std::vector<int> tree(n + 1, 0);
+      Size top_bit = 1;
+      while ((top_bit << 1) <= n) top_bit <<= 1;
+
+      SignalToNoiseEstimator<Container>::startProgress(0, n, "noise estimation of data");
+
+      const double window_half_size = win_len_ / 2;
+      Size left = 0, right = 0;
+      int elements_in_window = 0;
+      typename std::map<PeakType, double, typename PeakType::PositionLess>::iterator hint = stn_estimates_.end();
+      PeakIterator window_pos_center = scan_first_;
+      for (Size center = 0; center < n; ++center, ++window_pos_center)
+      {
+        // remove elements that leave the window on the LEFT side
+        while (mz[left] < mz[center] - window_half_size)
+        {
+          for (Size k = rank[left] + 1; k <= n; k += k & (~k + 1)) --tree[k];
+          --elements_in_window;
+          ++left;
+        }
+        // add elements that enter the window on the RIGHT side
+        while (right < n && mz[right] <= mz[center] + window_half_size)
+        {
+          for (Size k = rank[right] + 1; k <= n; k += k & (~k + 1)) ++tree[k];
+          ++elements_in_window;
+          ++right;
+        }
+
+        double noise;
+        if (elements_in_window < min_required_elements_)
+        {
+          noise = noise_for_empty_window_;
+          ++sparse_window_percent_;
+        }
+        else
+        {
+          // find the smallest rank r with (number of window elements of rank <= r) >= ceil(elements_in_window / 2)
+          int remaining = (elements_in_window + 1) / 2;
+          Size pos = 0;
+          for (Size bit = top_bit; bit != 0; bit >>= 1)
+          {
+            if (pos + bit <= n && tree[pos + bit] < remaining)
+            {
+              pos += bit;
+              remaining -= tree[pos];
+            }
+          }
+          // just avoid division by 0
+          noise = std::max(1.0, intensity[by_intensity[pos]]);
+        }
+
+        // store result (data points are sorted by position, so inserting at the end is cheap)
+        hint = stn_estimates_.insert(hint, std::make_pair(*window_pos_center, 0.0));
+        hint->second = intensity[center] / noise;
+
+        SignalToNoiseEstimator<Container>::setProgress(center + 1);
+      }
+
+      SignalToNoiseEstimator<Container>::endProgress();
+
+      sparse_window_percent_ = sparse_window_percent_ * 100 / n;
+
+      writeLogMessages_();
+    }
+
+    /// warn about sparse windows and histogram overflows (if enabled)
+    void writeLogMessages_() const
+    {
+      if (!write_log_messages_) return;
+
       // warn if percentage of sparse windows is above 20%
-      if (sparse_window_percent_ > 20 && write_log_messages_)
+      if (sparse_window_percent_ > 20)
       {
+#ifdef _OPENMP
+#pragma omp critical (OPENMS_SignalToNoiseEstimatorMedian_log)
+#endif
         LOG_WARN << "WARNING in SignalToNoiseEstimatorMedian: "
                  << sparse_window_percent_
                  << "% of all windows were sparse. You should consider increasing 'win_len' or decreasing 'min_required_elements'"
@@ -396,16 +520,34 @@ protected:
       }
 
       // warn if percentage of possibly wrong median estimates is above 1%
-      if (histogram_oob_percent_ > 1 && write_log_messages_)
+      if (histogram_oob_percent_ > 1)
       {
+#ifdef _OPENMP
+#pragma omp critical (OPENMS_SignalToNoiseEstimatorMedian_log)
+#endif
         LOG_WARN << "WARNING in SignalToNoiseEstimatorMedian: "
                  << histogram_oob_percent_
                  << "% of all Signal-to-Noise estimates are too high, because the median was found in the rightmost histogram-bin. "
                  << "You should consider increasing 'max_intensity' (and maybe 'bin_count' with it, to keep bin width reasonable)"
                  << std::endl;
       }
+    }
+
+    /// orders indices of data points by intensity (and by index for equal intensities)
+    struct IntensityRankLess_
+    {
+      explicit IntensityRankLess_(const std::vector<double> & intensity) :
+        intensity_(intensity)
+      {}
+
+      bool operator()(Size a, Size b) const
+      {
+        if (intensity_[a] != intensity_[b]) return intensity_[a] < intensity_[b];
+        return a < b;
+      }
 
-    } // end of shiftWindow_
+      const std::vector<double> & intensity_;
+    };
 
     /// overridden function from DefaultParamHandler to keep members up to date, when a parameter is changed
     void updateMembers_()
@@ -419,6 +561,7 @@ protected:
       min_required_elements_   = param_.getValue("min_required_elements");
       noise_for_empty_window_  = (double)param_.getValue("noise_for_empty_window");
       write_log_messages_      = (bool)param_.getValue("write_log_messages").toBool();
+      exact_median_            = param_.getValue("median_mode") == "exact";
       is_result_valid_         = false;
     }
 
@@ -443,6 +586,9 @@ protected:
     // whether to write out log messages in the case of failure
     bool write_log_messages_;
 
+    // whether to compute the exact median of each window (instead of using the histogram)
+    bool exact_median_;
+
     // counter for sparse windows
     double sparse_window_percent_;
     // counter for histogram overflow
@@ -44,6 +44,10 @@
 
 #include <cmath>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace OpenMS
 {
   /**
@@ -92,106 +96,157 @@ public:
     template <typename PeakType>
     void filter(MSSpectrum<PeakType> & spectrum)
     {
-      typedef std::vector<double> ContainerT;
+      std::vector<double> mz_in, int_in, mz_out, int_out;
+      filter_(spectrum, gauss_algo_, mz_in, int_in, mz_out, int_out);
+    }
+
+    template <typename PeakType>
+    void filter(MSChromatogram<PeakType> & chromatogram)
+    {
+      if (param_.getValue("use_ppm_tolerance").toBool())
+      {
+        throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 
+          "GaussFilter: Cannot use ppm tolerance on chromatograms");
+      }
+
+      std::vector<double> mz_in, int_in, mz_out, int_out;
+      filter_(chromatogram, gauss_algo_, mz_in, int_in, mz_out, int_out);
+    }
+
+    /**
+      @brief Smoothes an MSExperiment containing profile data.
+
+      Spectra and chromatograms are processed in parallel (if OpenMP is enabled).
+
+        @exception Exception::IllegalArgument is thrown, if the @em gaussian_width parameter is too small.
+          */
+    template <typename PeakType>
+    void filterExperiment(MSExperiment<PeakType> & map)
+    {
+      if (!map.getChromatograms().empty() && param_.getValue("use_ppm_tolerance").toBool())
+      {
+        throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 
+          "GaussFilter: Cannot use ppm tolerance on chromatograms");
+      }
+
+      Size progress = 0;
+      startProgress(0, map.size() + map.getChromatograms().size(), "smoothing data");
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+      {
+        // each thread works on its own copy of the kernel (it is re-initialized per data point in ppm mode)
+        GaussFilterAlgorithm algo(gauss_algo_);
+        std::vector<double> mz_in, int_in, mz_out, int_out;
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 16)
+#endif
+        for (SignedSize i = 0; i < (SignedSize)map.size(); ++i)
+        {
+          filter_(map[i], algo, mz_in, int_in, mz_out, int_out);
+          IF_MASTERTHREAD setProgress(progress);
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+          ++progress;
+        }
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 16)
+#endif
+        for (SignedSize i = 0; i < (SignedSize)map.getChromatograms().size(); ++i)
+        {
+          filter_(map.getChromatogram(i), algo, mz_in, int_in, mz_out, int_out);
+          IF_MASTERTHREAD setProgress(progress);
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+          ++progress;
+        }
+      }
+      endProgress();
+    }
+
+protected:
+
+    GaussFilterAlgorithm gauss_algo_;
 
+    /// The spacing of the pre-tabulated kernel coefficients
+    double spacing_;
+
+    // Docu in base class
+    virtual void updateMembers_();
+
+    /**
+      @brief Smoothes a spectrum using the given kernel and scratch space
+
+      The data is copied into contiguous arrays, which are reused between calls.
+    */
+    template <typename PeakType>
+    void filter_(MSSpectrum<PeakType> & spectrum, GaussFilterAlgorithm & algo,
+                 std::vector<double> & mz_in, std::vector<double> & int_in,
+                 std::vector<double> & mz_out, std::vector<double> & int_out) const
+    {
       // make sure the right data type is set
       spectrum.setType(SpectrumSettings::RAWDATA);
-      bool found_signal = false;
       Size data_size = spectrum.size();
-      ContainerT mz_in(data_size), int_in(data_size), mz_out(data_size), int_out(data_size);
+      mz_in.resize(data_size);
+      int_in.resize(data_size);
+      mz_out.resize(data_size);
+      int_out.resize(data_size);
 
       // copy spectrum to container
-      for (Size p = 0; p < spectrum.size(); ++p)
+      for (Size p = 0; p < data_size; ++p)
       {
         mz_in[p] = spectrum[p].getMZ();
         int_in[p] = spectrum[p].getIntensity();
       }
 
       // apply filter
-      ContainerT::iterator mz_out_it = mz_out.begin();
-      ContainerT::iterator int_out_it = int_out.begin();
-      found_signal = gauss_algo_.filter(mz_in.begin(), mz_in.end(), int_in.begin(), mz_out_it, int_out_it);
+      bool found_signal = algo.filter(mz_in.begin(), mz_in.end(), int_in.begin(), mz_out.begin(), int_out.begin());
 
       // If all intensities are zero in the scan and the scan has a reasonable size, throw an exception.
       // This is the case if the Gaussian filter is smaller than the spacing of raw data
-      if (!found_signal && spectrum.size() >= 3)
+      if (!found_signal && data_size >= 3)
       {
         String error_message = "Found no signal. The Gaussian width is probably smaller than the spacing in your profile data. Try to use a bigger width.";
         if (spectrum.getRT() > 0.0)
         {
           error_message += String(" The error occured in the spectrum with retention time ") + spectrum.getRT() + ".";
         }
+#ifdef _OPENMP
+#pragma omp critical (OPENMS_GaussFilter_log)
+#endif
         LOG_ERROR << error_message << std::endl;
       }
       else
       {
         // copy the new data into the spectrum
-        ContainerT::iterator mz_it = mz_out.begin();
-        ContainerT::iterator int_it = int_out.begin();
-        for (Size p = 0; mz_it != mz_out.end(); mz_it++, int_it++, p++)
+        for (Size p = 0; p < data_size; ++p)
         {
-          spectrum[p].setIntensity(*int_it);
-          spectrum[p].setMZ(*mz_it);
+          spectrum[p].setIntensity(int_out[p]);
+          spectrum[p].setMZ(mz_out[p]);
         }
       }
     }
 
+    /// Smoothes a chromatogram using the given kernel and scratch space
     template <typename PeakType>
-    void filter(MSChromatogram<PeakType> & chromatogram)
+    void filter_(MSChromatogram<PeakType> & chromatogram, GaussFilterAlgorithm & algo,
+                 std::vector<double> & mz_in, std::vector<double> & int_in,
+                 std::vector<double> & mz_out, std::vector<double> & int_out) const
     {
-
-      if (param_.getValue("use_ppm_tolerance").toBool())
-      {
-        throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 
-          "GaussFilter: Cannot use ppm tolerance on chromatograms");
-      }
-
       MSSpectrum<PeakType> filter_spectra;
       for (typename MSChromatogram<PeakType>::const_iterator it = chromatogram.begin(); it != chromatogram.end(); ++it)
       {
         filter_spectra.push_back(*it);
       }
-      filter(filter_spectra);
+      filter_(filter_spectra, algo, mz_in, int_in, mz_out, int_out);
       chromatogram.clear(false);
       for (typename MSSpectrum<PeakType>::const_iterator it = filter_spectra.begin(); it != filter_spectra.end(); ++it)
       {
         chromatogram.push_back(*it);
       }
-
-    }
-
-    /**
-      @brief Smoothes an MSExperiment containing profile data.
-
-        @exception Exception::IllegalArgument is thrown, if the @em gaussian_width parameter is too small.
-          */
-    template <typename PeakType>
-    void filterExperiment(MSExperiment<PeakType> & map)
-    {
-      Size progress = 0;
-      startProgress(0, map.size() + map.getChromatograms().size(), "smoothing data");
-      for (Size i = 0; i < map.size(); ++i)
-      {
-        filter(map[i]);
-        setProgress(++progress);
-      }
-      for (Size i = 0; i < map.getChromatograms().size(); ++i)
-      {
-        filter(map.getChromatogram(i));
-        setProgress(++progress);
-      }
-      endProgress();
     }
-
-protected:
-
-    GaussFilterAlgorithm gauss_algo_;
-
-    /// The spacing of the pre-tabulated kernel coefficients
-    double spacing_;
-
-    // Docu in base class
-    virtual void updateMembers_();
   };
 
 } // namespace OpenMS
@@ -39,6 +39,10 @@
 #include <OpenMS/CONCEPT/ProgressLogger.h>
 #include <OpenMS/KERNEL/MSExperiment.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace OpenMS
 {
   /**
@@ -115,86 +119,8 @@ public:
     template <typename PeakType>
     void filter(MSSpectrum<PeakType> & spectrum)
     {
-      UInt n = (UInt)spectrum.size();
-
-      typename MSSpectrum<PeakType>::iterator first = spectrum.begin();
-      typename MSSpectrum<PeakType>::iterator last = spectrum.end();
-
-      //copy the data AND META DATA to the output container
-      MSSpectrum<PeakType> output = spectrum;
-
-      if (frame_size_ > n)
-      {
-        return;
-      }
-
-      int i;
-      UInt j;
-      int mid = (frame_size_ / 2);
-      double help;
-
-      typename MSSpectrum<PeakType>::iterator it_forward;
-      typename MSSpectrum<PeakType>::iterator it_help;
-      typename MSSpectrum<PeakType>::iterator out_it = output.begin();
-
-      // compute the transient on
-      for (i = 0; i <= mid; ++i)
-      {
-        it_forward = (first - i);
-        help = 0;
-
-        for (j = 0; j < frame_size_; ++j)
-        {
-          help += it_forward->getIntensity() * coeffs_[(i + 1) * frame_size_ - 1 - j];
-          ++it_forward;
-        }
-
-
-        out_it->setPosition(first->getPosition());
-        out_it->setIntensity(std::max(0.0, help));
-        ++out_it;
-        ++first;
-      }
-
-      // compute the steady state output
-      it_help = (last - mid);
-      while (first != it_help)
-      {
-        it_forward = (first - mid);
-        help = 0;
-
-        for (j = 0; j < frame_size_; ++j)
-        {
-          help += it_forward->getIntensity() * coeffs_[mid * frame_size_ + j];
-          ++it_forward;
-        }
-
-
-        out_it->setPosition(first->getPosition());
-        out_it->setIntensity(std::max(0.0, help));
-        ++out_it;
-        ++first;
-      }
-
-      // compute the transient off
-      for (i = (mid - 1); i >= 0; --i)
-      {
-        it_forward = (first - (frame_size_ - i - 1));
-        help = 0;
-
-        for (j = 0; j < frame_size_; ++j)
-        {
-          help += it_forward->getIntensity() * coeffs_[i * frame_size_ + j];
-          ++it_forward;
-        }
-
-        out_it->setPosition(first->getPosition());
-        out_it->setIntensity(std::max(0.0, help));
-        ++out_it;
-        ++first;
-      }
-
-      spectrum = output;
+      std::vector<double> input, output;
+      filter_(spectrum, input, output);
     }
 
     template <typename PeakType>
@@ -217,21 +143,44 @@ public:
 
     /**
       @brief Removed the noise from an MSExperiment containing profile data.
+
+      Spectra and chromatograms are processed in parallel (if OpenMP is enabled).
     */
     template <typename PeakType>
     void filterExperiment(MSExperiment<PeakType> & map)
     {
       Size progress = 0;
       startProgress(0, map.size() + map.getChromatograms().size(), "smoothing data");
-      for (Size i = 0; i < map.size(); ++i)
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
       {
-        filter(map[i]);
-        setProgress(++progress);
+        // scratch space of this thread
+        std::vector<double> input, output;
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 16)
+#endif
+        for (SignedSize i = 0; i < (SignedSize)map.size(); ++i)
+        {
+          filter_(map[i], input, output);
+          IF_MASTERTHREAD setProgress(progress);
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+          ++progress;
+        }
       }
-      for (Size i = 0; i < map.getChromatograms().size(); ++i)
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 16)
+#endif
+      for (SignedSize i = 0; i < (SignedSize)map.getChromatograms().size(); ++i)
       {
         filter(map.getChromatogram(i));
-        setProgress(++progress);
+        IF_MASTERTHREAD setProgress(progress);
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+        ++progress;
       }
       endProgress();
     }
@@ -246,6 +195,38 @@ protected:
     // Docu in base class
     virtual void updateMembers_();
 
+    /**
+      @brief Smoothes a spectrum using the given scratch space
+
+      The intensities are copied into a contiguous array, so that the convolution can be vectorized.
+    */
+    template <typename PeakType>
+    void filter_(MSSpectrum<PeakType> & spectrum, std::vector<double> & input, std::vector<double> & output) const
+    {
+      Size n = spectrum.size();
+      if (frame_size_ > n)
+      {
+        return;
+      }
+
+      input.resize(n);
+      output.resize(n);
+      for (Size p = 0; p < n; ++p)
+      {
+        input[p] = spectrum[p].getIntensity();
+      }
+
+      convolve_(&input[0], n, &output[0]);
+
+      for (Size p = 0; p < n; ++p)
+      {
+        spectrum[p].setIntensity(std::max(0.0, output[p]));
+      }
+    }
+
+    /// Convolutes @p n (>= frame size) intensities with the filter coefficients (including the transients at both ends)
+    void convolve_(const double * input, Size n, double * output) const;
+
   };
 
 } // namespace OpenMS
@@ -202,15 +202,22 @@ public:
       return;
     }
 
-    /// merges spectra with similar precursors (must have MS2 level)
+    /**
+      @brief merges spectra with similar precursors (must have MS2 level)
+
+      Spectra are clustered by single linkage: two spectra end up in the same block if they are
+      connected by a chain of spectra whose precursors are within the RT and m/z tolerances
+      (see precursor_method parameters). Only precursor pairs within the m/z tolerance are compared
+      (in parallel), so memory and time scale with the number of spectra and close pairs instead of
+      a full distance matrix.
+    */
     template <typename MapType>
     void mergeSpectraPrecursors(MapType& exp)
     {
 
       // convert spectra's precursors to clusterizable data
-      Size data_size;
-      std::vector<BinaryTreeNode> tree;
-      Map<Size, Size> index_mapping;
+      std::vector<std::vector<Size> > clusters;
+      std::vector<Size> index_mapping;
       // local scope to save memory - we do not need the clustering stuff later
       {
         std::vector<BaseFeature> data;
@@ -220,7 +227,7 @@ public:
           if (exp[i].getMSLevel() != 2) continue;
 
           // remember which index in distance data ==> experiment index
-          index_mapping[data.size()] = i;
+          index_mapping.push_back(i);
 
           // make cluster element
           BaseFeature bf;
@@ -231,34 +238,10 @@ public:
           bf.setMZ(pcs[0].getMZ());
           data.push_back(bf);
         }
-        data_size = data.size();
 
-        SpectraDistance_ llc;
-        llc.setParameters(param_.copy("precursor_method:", true));
-        SingleLinkage sl;
-        DistanceMatrix<float> dist; // will be filled
-        ClusterHierarchical ch;
-
-        //ch.setThreshold(0.99);
-        // clustering ; threshold is implicitly at 1.0, i.e. distances of 1.0 (== similarity 0) will not be clustered
-        ch.cluster<BaseFeature, SpectraDistance_>(data, llc, sl, tree, dist);
+        clusterPrecursors_(data, clusters);
       }
 
-      // extract the clusters
-      ClusterAnalyzer ca;
-      std::vector<std::vector<Size> > clusters;
-      // count number of real tree nodes (not the -1 ones):
-      Size node_count = 0;
-      for (Size ii = 0; ii < tree.size(); ++ii)
-      {
-        if (tree[ii].distance >= 1) tree[ii].distance = -1;  // manually set to disconnect, as SingleLinkage does not support it
-        if (tree[ii].distance != -1) ++node_count;
-      }
-      ca.cut(data_size - node_count, tree, clusters);
-
-      //std::cerr << "Treesize: " << (tree.size()+1) << "   #clusters: " << clusters.size() << std::endl;
-      //std::cerr << "tree:\n" << ca.newickTree(tree, true) << "\n";
-
       // convert to blocks
       MergeBlocks spectra_to_merge;
 
@@ -468,6 +451,20 @@ public:
 
 protected:
 
+    /**
+        @brief single linkage clustering of precursors
+
+        Two precursors are linked if their similarity (see SpectraDistance_) is positive, i.e.
+        if they are within the RT and m/z tolerances. The clusters are the connected components
+        of the resulting graph, which is what hierarchical single linkage clustering cut at
+        similarity zero yields. Precursors are sorted by m/z and only pairs within the m/z
+        tolerance are compared.
+
+        @param data Precursor positions
+        @param clusters Clusters with more than one element (sorted indices into @p data), ordered by their first element
+    */
+    void clusterPrecursors_(const std::vector<BaseFeature>& data, std::vector<std::vector<Size> >& clusters) const;
+
     /**
         @brief merges blocks of spectra of a certain level
 
@@ -0,0 +1,167 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2016.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: Timo Sachsenberg $
+// --------------------------------------------------------------------------
+
+#ifndef OPENMS_FORMAT_INDEXEDFASTAFILE_H
+#define OPENMS_FORMAT_INDEXEDFASTAFILE_H
+
+#include <OpenMS/FORMAT/FASTAFile.h>
+
+#include <vector>
+
+namespace boost
+{
+  namespace iostreams
+  {
+    class mapped_file_source;
+  }
+}
+
+namespace OpenMS
+{
+  /**
+    @brief Random access to the entries of a (large) FASTA file without loading it
+
+    The FASTA file is memory mapped and only the offsets of its records are
+    held in memory. The offsets are determined by scanning the file in
+    parallel chunks for record starts ('>' at the beginning of a line), or
+    read from an index file stored next to the FASTA file (see
+    getIndexFilename()). The index file is only used if size and modification
+    time of the FASTA file did not change since it was written.
+
+    Entries can be accessed as views into the mapped file (getEntryView(),
+    no copy) or parsed into a FASTAFile::FASTAEntry (getEntry(), same
+    splitting of identifier and description as FASTAFile::load()). Both are
+    const and can be called concurrently from several threads, e.g. to
+    process the entries in a parallel loop.
+
+    @note Views are only valid as long as the file is open.
+
+    @ingroup FileIO
+  */
+  class OPENMS_DLLAPI IndexedFASTAFile
+  {
+public:
+
+    /**
+      @brief View of a FASTA record in the mapped file
+
+      The header is the text after the '>' up to the end of the line (without
+      line break), the sequence is the rest of the record including line breaks.
+    */
+    struct EntryView
+    {
+      const char* header;
+      Size header_length;
+      const char* sequence;
+      Size sequence_length;
+    };
+
+    /// Default constructor
+    IndexedFASTAFile();
+
+    /// Destructor (closes the file)
+    virtual ~IndexedFASTAFile();
+
+    /**
+      @brief Opens the FASTA file @p filename and indexes its records
+
+      If @p use_index_file is set, the index is read from the index file if it
+      is up to date, otherwise the index is built and written to the index
+      file (a warning is issued if this is not possible).
+
+      @exception Exception::FileNotFound is thrown if the file does not exist
+      @exception Exception::FileNotReadable is thrown if the file cannot be read
+      @exception Exception::ParseError is thrown if there is text before the first record
+    */
+    void open(const String& filename, bool use_index_file = false);
+
+    /// Closes the file (invalidates all views)
+    void close();
+
+    /// Returns if a file is open
+    bool isOpen() const;
+
+    /// Name of the open file
+    const String& getFilename() const;
+
+    /// Number of entries
+    Size size() const;
+
+    /// Returns a view of entry @p index
+    EntryView getEntryView(Size index) const;
+
+    /// Parses entry @p index into @p entry (whitespace is removed from the sequence)
+    void getEntry(Size index, FASTAFile::FASTAEntry& entry) const;
+
+    /**
+      @brief Writes the index of the open file to @p index_filename
+
+      @exception Exception::UnableToCreateFile is thrown if the file cannot be written
+    */
+    void storeIndex(const String& index_filename) const;
+
+    /// Name of the index file which is used for the FASTA file @p filename
+    static String getIndexFilename(const String& filename);
+
+protected:
+
+    /// Scans the mapped file for record starts (in parallel)
+    void buildIndex_();
+
+    /// Reads the index from @p index_filename, returns false if it does not exist or is outdated
+    bool loadIndex_(const String& index_filename);
+
+    /// Name of the open file
+    String filename_;
+    /// The mapped file (null if no file is open)
+    boost::iostreams::mapped_file_source* file_;
+    /// Start of the mapped data
+    const char* data_;
+    /// Size of the mapped data
+    Size data_size_;
+    /// Offset of the '>' of each record, followed by the end of the data
+    std::vector<Size> offsets_;
+
+private:
+
+    /// Not implemented
+    IndexedFASTAFile(const IndexedFASTAFile&);
+
+    /// Not implemented
+    IndexedFASTAFile& operator=(const IndexedFASTAFile&);
+  };
+
+} // namespace OpenMS
+
+#endif // OPENMS_FORMAT_INDEXEDFASTAFILE_H
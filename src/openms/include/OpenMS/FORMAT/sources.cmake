@@ -43,6 +43,7 @@ GzipIfstream.h
 GzipInputStream.h
 IBSpectraFile.h
 IdXMLFile.h
+IndexedFASTAFile.h
 IndexedMzMLFile.h
 IndexedMzMLFileLoader.h
 InspectInfile.h
@@ -88,6 +88,25 @@ public:
       */
       bool fit(std::vector<double> & search_engine_scores, std::vector<double> & probabilities);
 
+      /**
+          @brief sets the starting point of the next fits (warm start), e.g. the result of a previous fit on a similar score distribution.
+
+          Instead of estimating the initial distributions from the data, the EM algorithm starts from the given ones and therefore
+          usually converges in a few iterations for similar data.
+          @param incorrect parameters of the distribution of incorrectly assigned sequences (see getIncorrectlyAssignedFitResult())
+          @param correct parameters of the distribution of correctly assigned sequences (see getCorrectlyAssignedFitResult())
+          @param negative_prior prior probability for incorrectly assigned sequences (see getNegativePrior())
+          @param smallest_score the smallest score of the fit the parameters belong to (see getSmallestScore()), as the distributions are fitted to shifted scores
+          @exception Exception::InvalidValue is thrown if a standard deviation is not positive or the prior is not in (0, 1)
+      */
+      void setInitialParameters(const GaussFitter::GaussFitResult & incorrect, const GaussFitter::GaussFitResult & correct, double negative_prior, double smallest_score);
+
+      /// uses the result of the last fit of @p model as the starting point of the next fits (see above)
+      void setInitialParameters(const PosteriorErrorProbabilityModel & model);
+
+      /// the next fits estimate their starting point from the data again
+      void clearInitialParameters();
+
       ///Writes the distributions densities into the two vectors for a set of scores. Incorrect_densities represent the incorrectly assigned sequences.
       void fillDensities(std::vector<double> & x_scores, std::vector<double> & incorrect_density, std::vector<double> & correct_density);
       ///computes the Maximum Likelihood with a log-likelihood function.
@@ -172,6 +191,8 @@ private:
       PosteriorErrorProbabilityModel & operator=(const PosteriorErrorProbabilityModel & rhs);
       ///Copy constructor (not implemented)
       PosteriorErrorProbabilityModel(const PosteriorErrorProbabilityModel & rhs);
+      ///Writes the densities of the two Gaussians used during fitting into the vectors and returns the sum of the posterior probabilities (cf. fillDensities() and sum_post())
+      double fillGaussDensities_(const std::vector<double> & x_scores, std::vector<double> & incorrect_density, std::vector<double> & correct_density) const;
       ///stores parameters for incorrectly assigned sequences. If gumbel fit was used, A can be ignored. Furthermore, in this case, x0 and sigma are the local parameter alpha and scale parameter beta, respectively.
       GaussFitter::GaussFitResult incorrectly_assigned_fit_param_;
       ///stores gauss parameters
@@ -184,6 +205,16 @@ private:
       double max_correctly_;
       ///smallest score which was used for fitting the model
       double smallest_score_;
+      ///whether the next fit starts from the initial parameters below (warm start)
+      bool has_initial_parameters_;
+      ///initial parameters for incorrectly assigned sequences
+      GaussFitter::GaussFitResult initial_incorrectly_assigned_fit_param_;
+      ///initial parameters for correctly assigned sequences
+      GaussFitter::GaussFitResult initial_correctly_assigned_fit_param_;
+      ///initial prior probability for negative peptides
+      double initial_negative_prior_;
+      ///smallest score of the fit the initial parameters belong to
+      double initial_smallest_score_;
       ///points to getGauss
       double (PosteriorErrorProbabilityModel::* calc_incorrect_)(double x, const GaussFitter::GaussFitResult & params);
       ///points either to getGumbel or getGauss depending on whether one uses the gumbel or the gaussian distribution for incorrectly assigned sequences.
@@ -196,6 +196,25 @@ protected:
     /// Compress signals in a single RT scan (to merge signals which were sampled overlapping)
     void compressSignals_(SimTypes::MSSimExperiment& experiment);
 
+    /// Compress signals of the scans [@p scan_begin, @p scan_end) only
+    void compressSignals_(SimTypes::MSSimExperiment& experiment, Size scan_begin, Size scan_end);
+
+    /// Comparator for the indices of features by RT
+    struct FeatureRTLess_
+    {
+      explicit FeatureRTLess_(const SimTypes::FeatureMapSim& features) :
+        features_(features)
+      {
+      }
+
+      bool operator()(Size a, Size b) const
+      {
+        return features_[a].getRT() < features_[b].getRT();
+      }
+
+      const SimTypes::FeatureMapSim& features_;
+    };
+
     /// number of points sampled per peak's FWHM
     Int sampling_points_per_FWHM_;
 
@@ -102,6 +102,35 @@ public:
       int black_exception_mz_position;
     };
 
+    /**
+     * @brief structure for a peak which might be the start of a pattern
+     *
+     * The peaks of all spectra are first filtered in parallel, assuming that
+     * none of the peaks in the pattern are blacklisted. The blacklist is then
+     * applied spectrum by spectrum, and only peaks whose pattern contains a
+     * blacklisted peak are filtered again. The result is identical to a
+     * sequential run.
+     *
+     * @see filter()
+     */
+    struct PeakCandidate
+    {
+      /// index of the peak in the spectrum
+      int peak;
+      /// m/z shifts and peak indices found by the position filter (before blacklisting)
+      std::vector<double> mz_shifts_positions;
+      std::vector<int> mz_shifts_positions_indices;
+      /// number of isotopic peaks to blacklist (or -1 if nothing passed all filters)
+      int peaks_to_blacklist;
+      /// Should the peak be added to the filter result?
+      bool passed;
+      /// details of a peak that passed the filters
+      std::vector<double> mz_shifts_actual;
+      std::vector<int> mz_shifts_actual_indices;
+      std::vector<double> intensities_actual;
+      std::vector<MultiplexFilterResultRaw> results_raw;
+    };
+
     /**
      * @brief constructor
      *
@@ -116,6 +145,9 @@ public:
      * @param peptide_similarity    similarity score for two peptides in the same multiplet
      * @param averagine_similarity    similarity score for peptide isotope pattern and averagine model
      * @param averagine_similarity_scaling    scaling factor x for the averagine similarity parameter p when detecting peptide singlets. With p' = p + x(1-p). 
+     * @param averagine_type    The averagine model to use, current options are RNA DNA or peptide.
+     *
+     * @throw Exception::InvalidParameter if the averagine type is unknown
      */
     MultiplexFiltering(const MSExperiment<Peak1D>& exp_picked, const std::vector<MultiplexIsotopicPeakPattern> patterns, int peaks_per_peptide_min, int peaks_per_peptide_max, bool missing_peaks, double intensity_cutoff, double mz_tolerance, bool mz_tolerance_unit, double peptide_similarity, double averagine_similarity, double averagine_similarity_scaling, String averagine_type="peptide");
 
@@ -139,6 +171,52 @@ protected:
                                     const std::vector<double>& peak_position, int peak, std::vector<double>& mz_shifts_actual,
                                     std::vector<int>& mz_shifts_actual_indices) const;
 
+    /**
+     * @brief position filter
+     *
+     * First step of positionsAndBlacklistFilter_(). Checks if there are peaks at
+     * positions corresponding to the pattern (independent of the blacklist).
+     *
+     * @param pattern    pattern of isotopic peaks to be searched for
+     * @param peak_position    m/z positions of the peaks in spectrum
+     * @param peak    index of the peak in peak_position
+     * @param mz_shifts_actual    output for actual m/z shifts seen in the spectrum
+     * @param mz_shifts_actual_indices    output for indices of peaks corresponding to the pattern
+     *
+     * @return false if not enough peaks were found
+     */
+    bool positionsFilter_(const MultiplexIsotopicPeakPattern& pattern, const std::vector<double>& peak_position, int peak,
+                          std::vector<double>& mz_shifts_actual, std::vector<int>& mz_shifts_actual_indices) const;
+
+    /**
+     * @brief blacklist filter
+     *
+     * Second step of positionsAndBlacklistFilter_(). Removes blacklisted peaks from the pattern.
+     *
+     * @param pattern    pattern of isotopic peaks to be searched for
+     * @param spectrum    index of the spectrum in exp_picked_ and boundaries_
+     * @param mz_shifts_actual    actual m/z shifts seen in the spectrum
+     * @param mz_shifts_actual_indices    indices of peaks corresponding to the pattern
+     *
+     * @return true if any peak was removed
+     */
+    bool blacklistFilter_(const MultiplexIsotopicPeakPattern& pattern, int spectrum,
+                          std::vector<double>& mz_shifts_actual, std::vector<int>& mz_shifts_actual_indices) const;
+
+    /**
+     * @brief counts isotopic peaks seen in all peptides
+     *
+     * Last step of positionsAndBlacklistFilter_(). Optionally removes peaks following missing ones.
+     *
+     * @param pattern    pattern of isotopic peaks to be searched for
+     * @param mz_shifts_actual    actual m/z shifts seen in the spectrum
+     * @param mz_shifts_actual_indices    indices of peaks corresponding to the pattern
+     *
+     * @return number of isotopic peaks seen for each peptide
+     */
+    int countPeaksInAllPeptides_(const MultiplexIsotopicPeakPattern& pattern,
+                                 std::vector<double>& mz_shifts_actual, std::vector<int>& mz_shifts_actual_indices) const;
+
     /**
      * @brief mono-isotopic peak intensity filter
      *
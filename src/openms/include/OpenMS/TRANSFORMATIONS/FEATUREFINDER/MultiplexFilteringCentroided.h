@@ -89,11 +89,25 @@ public:
      * @brief filter for patterns
      * (generates a filter result for each of the patterns)
      *
+     * For each pattern the spectra are filtered in parallel (see PeakCandidate).
+     *
      * @see MultiplexIsotopicPeakPattern, MultiplexFilterResult
      */
     std::vector<MultiplexFilterResult> filter();
 
 private:
+    /**
+     * @brief filters (2) to (6) for a single peak
+     *
+     * @param pattern    pattern of isotopic peaks to be searched for
+     * @param spectrum    index of the spectrum in exp_picked_
+     * @param mz    m/z position of the peak
+     * @param mz_shifts_actual    actual m/z shifts seen in the spectrum (after the position and blacklist filter)
+     * @param mz_shifts_actual_indices    indices of peaks corresponding to the pattern (after the position and blacklist filter)
+     * @param candidate    output for the filter result of the peak
+     */
+    void filterPeak_(const MultiplexIsotopicPeakPattern& pattern, int spectrum, double mz, std::vector<double> mz_shifts_actual, std::vector<int> mz_shifts_actual_indices, PeakCandidate& candidate) const;
+
     /**
      * @brief non-local intensity filter
      *
@@ -95,6 +95,9 @@ public:
      * @brief filter for patterns
      * (generates a filter result for each of the patterns)
      *
+     * The spectra are spline fitted once for all patterns. For each pattern
+     * the spectra are filtered in parallel (see PeakCandidate).
+     *
      * @throw Exception::IllegalArgument if number of peaks and number of peak boundaries differ
      *
      * @see MultiplexIsotopicPeakPattern
@@ -103,6 +106,21 @@ public:
     std::vector<MultiplexFilterResult> filter();
 
 private:
+    /**
+     * @brief filters (2) to (6) for a single peak
+     *
+     * @param pattern    pattern of isotopic peaks to be searched for
+     * @param spectrum    index of the spectrum in exp_profile_, exp_picked_ and boundaries_
+     * @param peak_min    lower m/z boundary of the peak
+     * @param peak_max    upper m/z boundary of the peak
+     * @param peak_intensity    intensities of the peaks in spectrum
+     * @param nav    navigator for moving on the spline-interpolated spectrum
+     * @param mz_shifts_actual    actual m/z shifts seen in the spectrum (after the position and blacklist filter)
+     * @param mz_shifts_actual_indices    indices of peaks corresponding to the pattern (after the position and blacklist filter)
+     * @param candidate    output for the filter result of the peak
+     */
+    void filterPeak_(const MultiplexIsotopicPeakPattern& pattern, int spectrum, double peak_min, double peak_max, const std::vector<double>& peak_intensity, SplineSpectrum::Navigator& nav, std::vector<double> mz_shifts_actual, std::vector<int> mz_shifts_actual_indices, PeakCandidate& candidate) const;
+
     /**
      * @brief non-local intensity filter
      *
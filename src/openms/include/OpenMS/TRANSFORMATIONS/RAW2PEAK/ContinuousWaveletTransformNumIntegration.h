@@ -151,11 +151,15 @@ public:
           processed_input[k] = getInterpolatedValue_(x, it_help);
         }
         
+        // tabulate the wavelet at the data spacing once (instead of for every data point)
+        std::vector<double> kernel;
+        tabulateWavelet_(spacing, kernel);
+
         // TODO avoid to compute the cwt for the zeros in signal
         for (Int i = 0; i < n; ++i)
         {
           signal_[i].setMZ(origin + i * spacing);
-          signal_[i].setIntensity((Peak1D::IntensityType)integrate_(processed_input, spacing, i));
+          signal_[i].setIntensity((Peak1D::IntensityType)integrate_(processed_input, kernel, spacing, i));
         }
 
         begin_right_padding_ = n;
@@ -163,6 +167,54 @@ public:
       }
     }
 
+    /**
+        @brief Updates the wavelet transform (resolution = 1) after the raw data in [begin_changed,end_changed) changed
+
+        Only the transform at positions whose integration interval overlaps the changed
+        data is recomputed. The result is identical to calling transform() with resolution 1
+        on the changed data again.
+
+        @note transform() has to be called for [begin_input,end_input) with resolution 1 before;
+        otherwise the complete transform is computed.
+    */
+    template <typename InputPeakIterator>
+    void update(InputPeakIterator begin_input,
+                InputPeakIterator end_input,
+                InputPeakIterator begin_changed,
+                InputPeakIterator end_changed)
+    {
+      if (signal_.size() != (Size)distance(begin_input, end_input))
+      {
+        transform(begin_input, end_input, 1.);
+        return;
+      }
+      if (begin_changed == end_changed)
+      {
+        return;
+      }
+
+      // the transform at x integrates the raw data in (x - middle_spacing, x + middle_spacing)
+      double middle_spacing = wavelet_.size() * spacing_;
+      double mz_min = begin_changed->getMZ() - middle_spacing;
+      double mz_max = (end_changed - 1)->getMZ() + middle_spacing;
+
+      InputPeakIterator first = begin_changed;
+      while ((first != begin_input) && ((first - 1)->getMZ() >= mz_min))
+      {
+        --first;
+      }
+      InputPeakIterator last = end_changed;
+      while ((last != end_input) && (last->getMZ() <= mz_max))
+      {
+        ++last;
+      }
+
+      for (InputPeakIterator it = first; it != last; ++it)
+      {
+        signal_[distance(begin_input, it)].setIntensity((Peak1D::IntensityType)integrate_(it, begin_input, end_input));
+      }
+    }
+
     /**
         @brief Perform necessary preprocessing steps like tabulating the Wavelet.
 
@@ -290,8 +342,11 @@ protected:
       return v / sqrt(scale_);
     }
 
-    /// Computes the convolution of the wavelet and the raw data at position x with resolution > 1
-    double integrate_(const std::vector<double> & processed_input, double spacing_data, int index);
+    /// Computes the convolution of the wavelet (tabulated at the data spacing, see tabulateWavelet_()) and the raw data at position x with resolution > 1
+    double integrate_(const std::vector<double> & processed_input, const std::vector<double> & kernel, double spacing_data, int index) const;
+
+    /// Tabulates the wavelet at multiples of the data spacing @p spacing_data (as used by integrate_())
+    void tabulateWavelet_(double spacing_data, std::vector<double> & kernel) const;
 
     /// Computes the Marr wavelet at position x
     inline double marr_(const double x) const
@@ -154,6 +154,18 @@ protected:
     /// Switch for the 2D optimization of peak parameters
     bool two_d_optimization_;
 
+    /// The wavelet transform initialized for scale_ and the spacing (copied for each spectrum)
+    ContinuousWaveletTransformNumIntegration wt_;
+
+    /// The wavelet transform initialized for the separation of overlapping peaks (copied for each peak)
+    ContinuousWaveletTransformNumIntegration wt_deconvolution_;
+
+    /// Threshold for the peak height in the wavelet transform in the MS 1 level (see initializeWT_())
+    double peak_bound_cwt_;
+
+    /// Threshold for the peak height in the wavelet transform in the MS 2 level (see initializeWT_())
+    double peak_bound_ms2_level_cwt_;
+
 
     void updateMembers_();
 
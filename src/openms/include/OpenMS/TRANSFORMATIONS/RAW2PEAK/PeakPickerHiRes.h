@@ -44,6 +44,10 @@
 
 #include <OpenMS/FILTERING/NOISEESTIMATION/SignalToNoiseEstimatorMedian.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 
 #define DEBUG_PEAK_PICKING
 #undef DEBUG_PEAK_PICKING
@@ -497,9 +501,11 @@ public:
 
     /**
      * @brief Applies the peak-picking algorithm to a map (MSExperiment). This
-     * method picks peaks for each scan in the map consecutively. The resulting
+     * method picks peaks for each scan in the map. The resulting
      * picked peaks are written to the output map.
      *
+     * Spectra and chromatograms are picked in parallel (if OpenMP is enabled).
+     *
      * @param input  input map in profile mode
      * @param output  output map with picked peaks
      * @param boundaries_spec  boundaries of the picked peaks in spectra
@@ -518,45 +524,114 @@ public:
       // resize output with respect to input
       output.resize(input.size());
 
+      // check spectrum types first (exceptions must not be thrown inside the parallel section)
+      std::vector<bool> pick_spectrum(input.size(), false);
+      for (Size scan_idx = 0; scan_idx != input.size(); ++scan_idx)
+      {
+        if (!ListUtils::contains(ms_levels_, input[scan_idx].getMSLevel())) continue;
+
+        // determine type of spectral data (profile or centroided)
+        SpectrumSettings::SpectrumType spectrum_type = input[scan_idx].getType();
+
+        if (spectrum_type == SpectrumSettings::PEAKS && check_spectrum_type)
+        {
+          throw OpenMS::Exception::IllegalArgument(__FILE__, __LINE__, __FUNCTION__, "Error: Centroided data provided but profile spectra expected.");
+        }
+        pick_spectrum[scan_idx] = true;
+      }
+
       Size progress = 0;
       startProgress(0, input.size() + input.getChromatograms().size(), "picking peaks");
 
-      if (input.getNrSpectra() > 0)
+      // spectra (and chromatograms) are picked independently, so we do this in parallel.
+      // Exceptions must not leave a parallel section: we keep a copy of the
+      // error of the first spectrum (lowest index) that failed and throw it
+      // after the loop.
+      std::vector<std::vector<PeakBoundary> > boundaries_per_scan(input.size());
+      SignedSize failed_scan = -1;
+      Exception::BaseException error;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 16)
+#endif
+      for (SignedSize scan_idx = 0; scan_idx < (SignedSize)input.size(); ++scan_idx)
       {
-        for (Size scan_idx = 0; scan_idx != input.size(); ++scan_idx)
+        if (!pick_spectrum[scan_idx])
         {
-          if (!ListUtils::contains(ms_levels_, input[scan_idx].getMSLevel()))
+          output[scan_idx] = input[scan_idx];
+        }
+        else
+        {
+          try
           {
-            output[scan_idx] = input[scan_idx];
+            pick(input[scan_idx], output[scan_idx], boundaries_per_scan[scan_idx]);
           }
-          else
+          catch (Exception::BaseException& e)
           {
-            std::vector<PeakBoundary> boundaries_s; // peak boundaries of a single spectrum
-
-            // determine type of spectral data (profile or centroided)
-            SpectrumSettings::SpectrumType spectrum_type = input[scan_idx].getType();
-
-            if (spectrum_type == SpectrumSettings::PEAKS && check_spectrum_type)
+#ifdef _OPENMP
+#pragma omp critical (PeakPickerHiRes_pickExperiment)
+#endif
             {
-              throw OpenMS::Exception::IllegalArgument(__FILE__, __LINE__, __FUNCTION__, "Error: Centroided data provided but profile spectra expected.");
+              if (failed_scan < 0 || scan_idx < failed_scan)
+              {
+                failed_scan = scan_idx;
+                error = e;
+              }
             }
-
-            pick(input[scan_idx], output[scan_idx], boundaries_s);
-            boundaries_spec.push_back(boundaries_s);
           }
-          setProgress(++progress);
         }
+        IF_MASTERTHREAD setProgress(progress);
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+        ++progress;
+      }
+      if (failed_scan >= 0)
+      {
+        throw error;
+      }
+      for (Size scan_idx = 0; scan_idx != input.size(); ++scan_idx)
+      {
+        if (pick_spectrum[scan_idx]) boundaries_spec.push_back(boundaries_per_scan[scan_idx]);
       }
 
-
-      for (Size i = 0; i < input.getChromatograms().size(); ++i)
+      std::vector<MSChromatogram<ChromatogramPeakT> > chromatograms(input.getChromatograms().size());
+      std::vector<std::vector<PeakBoundary> > boundaries_per_chrom(input.getChromatograms().size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 16)
+#endif
+      for (SignedSize i = 0; i < (SignedSize)input.getChromatograms().size(); ++i)
       {
-        MSChromatogram<ChromatogramPeakT> chromatogram;
-        std::vector<PeakBoundary> boundaries_c; // peak boundaries of a single chromatogram
-        pick(input.getChromatograms()[i], chromatogram, boundaries_c);
-        output.addChromatogram(chromatogram);
-        boundaries_chrom.push_back(boundaries_c);
-        setProgress(++progress);
+        try
+        {
+          pick(input.getChromatograms()[i], chromatograms[i], boundaries_per_chrom[i]);
+        }
+        catch (Exception::BaseException& e)
+        {
+#ifdef _OPENMP
+#pragma omp critical (PeakPickerHiRes_pickExperiment)
+#endif
+          {
+            if (failed_scan < 0 || i < failed_scan)
+            {
+              failed_scan = i;
+              error = e;
+            }
+          }
+        }
+        IF_MASTERTHREAD setProgress(progress);
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+        ++progress;
+      }
+      if (failed_scan >= 0)
+      {
+        throw error;
+      }
+      for (Size i = 0; i < chromatograms.size(); ++i)
+      {
+        output.addChromatogram(chromatograms[i]);
+        boundaries_chrom.push_back(boundaries_per_chrom[i]);
       }
       endProgress();
 
@@ -50,9 +50,23 @@
 #include <algorithm>
 #include <utility>
 
+#include <boost/shared_ptr.hpp>
+
 namespace OpenMS
 {
 
+  namespace
+  {
+    /// sort bins (ranges of pairs) by decreasing size
+    struct BinSizeGreater
+    {
+      bool operator()(const std::pair<Size, Size>& a, const std::pair<Size, Size>& b) const
+      {
+        return (a.second - a.first) > (b.second - b.first);
+      }
+    };
+  }
+
   ILPDCWrapper::ILPDCWrapper()
   {
   }
@@ -61,7 +75,7 @@ namespace OpenMS
   {
   }
 
-  double ILPDCWrapper::compute(const FeatureMap fm, PairsType& pairs, Size verbose_level) const
+  double ILPDCWrapper::compute(const FeatureMap& fm, PairsType& pairs, Size verbose_level) const
   {
     if (fm.empty())
     {
@@ -175,8 +189,8 @@ namespace OpenMS
               pairs_clique_ordered.push_back(pairs[*i_p]);
             }
             if (verbose_level > 2)
-              LOG_INFO << "Extra bin for big clique (" << clique_size << ") prepended to schedule\n";
-            bins.insert(bins.begin(), std::make_pair(start, pairs_clique_ordered.size()));
+              LOG_INFO << "Extra bin for big clique (" << clique_size << ")\n";
+            bins.push_back(std::make_pair(start, pairs_clique_ordered.size()));
             start = pairs_clique_ordered.size();
             continue; // next clique (this one is already processed)
           }
@@ -198,19 +212,36 @@ namespace OpenMS
     /* swap pairs, such that edges are order by cliques (so we can make clean cuts) */
     pairs.swap(pairs_clique_ordered);
 
-    //PairsType pt2 = pairs;
+    // schedule the biggest bins first (they take longest to solve)
+    std::stable_sort(bins.begin(), bins.end(), BinSizeGreater());
+
+    // identify the charge variants (feature, adducts and charge) of both ends of each edge by an integer id
+    std::vector<std::pair<Size, Size> > pair_variants(pairs.size());
+    {
+      Map<String, Size> variant_ids;
+      for (Size i = 0; i < pairs.size(); ++i)
+      {
+        String rota_l = String(pairs[i].getElementIndex(0)) + pairs[i].getCompomer().getAdductsAsString(0) + "_" + pairs[i].getCharge(0);
+        Size id = variant_ids.size();
+        pair_variants[i].first = variant_ids.insert(std::make_pair(rota_l, id)).first->second;
+        String rota_r = String(pairs[i].getElementIndex(1)) + pairs[i].getCompomer().getAdductsAsString(1) + "_" + pairs[i].getCharge(1);
+        id = variant_ids.size();
+        pair_variants[i].second = variant_ids.insert(std::make_pair(rota_r, id)).first->second;
+      }
+    }
+
     StopWatch time1;
     time1.start();
 
     // split problem into slices and have each one solved by the ILPS
+    // (each slice has its own LPWrapper and works on a disjoint range of pairs)
     double score = 0;
-// OMP currently causes spurious segfaults in Release mode; OMP fix applied, however: disable if problem persists
-//#ifdef _OPENMP
-//#pragma omp parallel for schedule(dynamic, 1), reduction(+: score)
-//#endif
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1) reduction(+: score)
+#endif
     for (SignedSize i = 0; i < static_cast<SignedSize>(bins.size()); ++i)
     {
-      score = computeSlice_(fm, pairs, bins[i].first, bins[i].second, verbose_level);
+      score += computeSlice_(fm, pairs, pair_variants, bins[i].first, bins[i].second, verbose_level);
     }
     time1.stop();
     LOG_INFO << " Branch and cut took " << time1.getClockTime() << " seconds, "
@@ -220,13 +251,9 @@ namespace OpenMS
     return score;
   }
 
-  void ILPDCWrapper::updateFeatureVariant_(FeatureType_& f_set, const String& rota_l, const Size& v) const
-  {
-    f_set[rota_l].insert(v);
-  }
-
-  double ILPDCWrapper::computeSlice_(const FeatureMap fm,
+  double ILPDCWrapper::computeSlice_(const FeatureMap& fm,
                                      PairsType& pairs,
+                                     const std::vector<std::pair<Size, Size> >& pair_variants,
                                      const PairsIndex margin_left,
                                      const PairsIndex margin_right,
                                      const Size /* verbose_level */) const
@@ -235,12 +262,7 @@ namespace OpenMS
     typedef std::map<Size, FeatureType_> r_type;
     r_type features;
 
-
-    LPWrapper build;
-    //build.setSolver(LPWrapper::SOLVER_GLPK);
-    build.setObjectiveSense(LPWrapper::MAX); // maximize
-
-    // add ALL edges first. Their result is what is interesting to us later
+    // score edges and collect the variants of each feature
     for (PairsIndex i = margin_left; i < margin_right; ++i)
     {
       // log scores are good for addition in ILP - but they are < 0, thus not suitable for maximizing
@@ -248,22 +270,53 @@ namespace OpenMS
       double score = exp(getLogScore_(pairs[i], fm));
       pairs[i].setEdgeScore(score * pairs[i].getEdgeScore()); // multiply with preset score
 
+      // create feature variants set (column of the edge is its offset in the slice)
+      features[pairs[i].getElementIndex(0)][pair_variants[i].first].insert(i - margin_left);
+      features[pairs[i].getElementIndex(1)][pair_variants[i].second].insert(i - margin_left);
+    }
+
+#if COINOR_SOLVER == 1
+    // models are independent of each other and can be solved concurrently
+    return solveSlice_(features, pairs, margin_left, margin_right);
+#else
+    // GLPK keeps its environment in global state: set up and solve one problem at a time
+    double objective;
+#ifdef _OPENMP
+#pragma omp critical (OPENMS_ILPDCWrapper_solve)
+#endif
+    objective = solveSlice_(features, pairs, margin_left, margin_right);
+    return objective;
+#endif
+  }
+
+  double ILPDCWrapper::solveSlice_(const std::map<Size, FeatureType_>& features,
+                                   PairsType& pairs,
+                                   const PairsIndex margin_left,
+                                   const PairsIndex margin_right) const
+  {
+    boost::shared_ptr<LPWrapper> build_ptr;
+    // the LPWrapper constructor always creates a GLPK problem
+#ifdef _OPENMP
+#pragma omp critical (OPENMS_ILPDCWrapper_create)
+#endif
+    build_ptr = boost::shared_ptr<LPWrapper>(new LPWrapper());
+    LPWrapper& build = *build_ptr;
+    //build.setSolver(LPWrapper::SOLVER_GLPK);
+    build.setObjectiveSense(LPWrapper::MAX); // maximize
+
+    // add ALL edges first. Their result is what is interesting to us later
+    for (PairsIndex i = margin_left; i < margin_right; ++i)
+    {
       // create the column representing the edge
       Int index = build.addColumn();
       build.setColumnBounds(index, 0, 1, LPWrapper::DOUBLE_BOUNDED);
       build.setColumnType(index, LPWrapper::INTEGER); // integer variable
       build.setObjective(index, pairs[i].getEdgeScore());
-
-      // create feature variants set
-      String rota_l = String(pairs[i].getElementIndex(0)) + pairs[i].getCompomer().getAdductsAsString(0) + "_" + pairs[i].getCharge(0);
-      updateFeatureVariant_(features[pairs[i].getElementIndex(0)], rota_l, index);
-      String rota_r = String(pairs[i].getElementIndex(1)) + pairs[i].getCompomer().getAdductsAsString(1) + "_" + pairs[i].getCharge(1);
-      updateFeatureVariant_(features[pairs[i].getElementIndex(1)], rota_r, index);
     }
 
     // ADD Features (multiple variants of one feature are constrained to size=1)
-    Size count(0); // each entry is a feature idx --->    Map["AdductCgf"]->adjacentEdges
-    for (r_type::iterator it = features.begin(); it != features.end(); ++it)
+    Size count(0); // each entry is a feature idx --->    Map[variant id]->adjacentEdges
+    for (std::map<Size, FeatureType_>::const_iterator it = features.begin(); it != features.end(); ++it)
     {
       ++count;
       std::vector<Int> columns;
@@ -327,7 +380,7 @@ namespace OpenMS
 
   // old version, slower, as ILP has different layout (i.e, the same as described in paper)
 
-  double ILPDCWrapper::computeSliceOld_(const FeatureMap fm,
+  double ILPDCWrapper::computeSliceOld_(const FeatureMap& fm,
                                         PairsType& pairs,
                                         const PairsIndex margin_left,
                                         const PairsIndex margin_right,
@@ -37,6 +37,12 @@
 #include <OpenMS/CONCEPT/LogStream.h>
 
 #include <algorithm>
+#include <cmath>
+#include <limits>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 // #define FALSE_DISCOVERY_RATE_DEBUG
 // #undef  FALSE_DISCOVERY_RATE_DEBUG
@@ -45,6 +51,60 @@ using namespace std;
 
 namespace OpenMS
 {
+  namespace
+  {
+    /// score (oriented such that higher is better) together with its position in the input
+    typedef pair<double, Size> ScoreIndex;
+
+    /// sorts chunks in parallel and merges them pairwise (same result as std::sort, since the order is total)
+    void parallelSort(vector<ScoreIndex>& v)
+    {
+#ifdef _OPENMP
+      Size n_chunks = (Size)omp_get_max_threads();
+      if (n_chunks > 1 && v.size() >= 10000)
+      {
+        vector<Size> bounds(n_chunks + 1);
+        for (Size i = 0; i <= n_chunks; ++i)
+        {
+          bounds[i] = v.size() * i / n_chunks;
+        }
+#pragma omp parallel for
+        for (SignedSize i = 0; i < (SignedSize)n_chunks; ++i)
+        {
+          sort(v.begin() + bounds[i], v.begin() + bounds[i + 1]);
+        }
+        for (Size width = 1; width < n_chunks; width *= 2)
+        {
+          SignedSize step = (SignedSize)(2 * width);
+#pragma omp parallel for
+          for (SignedSize i = 0; i < (SignedSize)n_chunks; i += step)
+          {
+            Size mid = min((Size)i + width, n_chunks);
+            Size end = min((Size)i + 2 * width, n_chunks);
+            if (mid < end)
+            {
+              inplace_merge(v.begin() + bounds[i], v.begin() + bounds[mid], v.begin() + bounds[end]);
+            }
+          }
+        }
+        return;
+      }
+#endif
+      sort(v.begin(), v.end());
+    }
+
+    /// value of the given score in a sorted (score, FDR) table, 0 if the score is not contained
+    double lookupFDR(const vector<pair<double, double> >& table, double score)
+    {
+      vector<pair<double, double> >::const_iterator it = lower_bound(table.begin(), table.end(), make_pair(score, -numeric_limits<double>::max()));
+      if (it != table.end() && it->first == score)
+      {
+        return it->second;
+      }
+      return 0.0;
+    }
+  }
+
   FalseDiscoveryRate::FalseDiscoveryRate() :
     DefaultParamHandler("FalseDiscoveryRate")
   {
@@ -132,8 +192,10 @@ namespace OpenMS
 #ifdef FALSE_DISCOVERY_RATE_DEBUG
         cerr << "Id-run: " << *iit << endl;
 #endif
-        // get the scores of all peptide hits
+        // get the scores of all peptide hits, remember where the hits of each identification start
         vector<double> target_scores, decoy_scores;
+        vector<Size> target_offsets(ids.size(), 0), decoy_offsets(ids.size(), 0);
+        Size other_hits(0);
         for (vector<PeptideIdentification>::iterator it = ids.begin(); it != ids.end(); ++it)
         {
           // if runs should be treated separately, the identifiers must be the same
@@ -141,6 +203,8 @@ namespace OpenMS
           {
             continue;
           }
+          target_offsets[it - ids.begin()] = target_scores.size();
+          decoy_offsets[it - ids.begin()] = decoy_scores.size();
 
           for (Size i = 0; i < it->getHits().size(); ++i)
           {
@@ -172,6 +236,7 @@ namespace OpenMS
                 {
                   throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Unknown value of meta value 'target_decoy'", target_decoy);
                 }
+                ++other_hits;
               }
             }
           }
@@ -271,42 +336,72 @@ namespace OpenMS
 
         // calculate fdr for the forward scores
         bool higher_score_better(ids.begin()->isHigherScoreBetter());
-        Map<double, double> score_to_fdr;
-        calculateFDRs_(score_to_fdr, target_scores, decoy_scores, q_value, higher_score_better);
+        vector<double> target_fdrs, decoy_fdrs;
+        calculateFDRs(target_scores, decoy_scores, target_fdrs, decoy_fdrs, q_value, higher_score_better);
 
-        // annotate fdr
-        for (vector<PeptideIdentification>::iterator it = ids.begin(); it != ids.end(); ++it)
+        // hits that are neither target nor decoy only get a value if their score coincides with one of those
+        vector<pair<double, double> > score_to_fdr;
+        if (other_hits > 0)
+        {
+          for (Size i = 0; i < target_scores.size(); ++i)
+          {
+            score_to_fdr.push_back(make_pair(target_scores[i], target_fdrs[i]));
+          }
+          for (Size i = 0; i < decoy_scores.size(); ++i)
+          {
+            score_to_fdr.push_back(make_pair(decoy_scores[i], decoy_fdrs[i]));
+          }
+          sort(score_to_fdr.begin(), score_to_fdr.end());
+        }
+
+        // annotate fdr; the hits are visited in the same order as above, so the results can be consumed sequentially
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (SignedSize n = 0; n < (SignedSize)ids.size(); ++n)
         {
+          PeptideIdentification& id = ids[n];
           // if runs should be treated separately, the identifiers must be the same
-          if (treat_runs_separately && it->getIdentifier() != *iit)
+          if (treat_runs_separately && id.getIdentifier() != *iit)
           {
             continue;
           }
 
-          String score_type = it->getScoreType() + "_score";
+          Size target_pos(target_offsets[n]), decoy_pos(decoy_offsets[n]);
+          String score_type = id.getScoreType() + "_score";
           vector<PeptideHit> hits;
-          for (vector<PeptideHit>::const_iterator pit = it->getHits().begin(); pit != it->getHits().end(); ++pit)
+          hits.reserve(id.getHits().size());
+          for (vector<PeptideHit>::const_iterator pit = id.getHits().begin(); pit != id.getHits().end(); ++pit)
           {
-            PeptideHit hit = *pit;
-
             if (split_charge_variants && pit->getCharge() != *zit)
             {
               hits.push_back(*pit);
               continue;
             }
-            if (hit.metaValueExists("target_decoy"))
+
+            double fdr(0);
+            String target_decoy(pit->getMetaValue("target_decoy"));
+            if (target_decoy == "target" || target_decoy == "target+decoy")
             {
-              String meta_value = (String)hit.getMetaValue("target_decoy");
-              if (meta_value == "decoy" && !add_decoy_peptides)
+              fdr = target_fdrs[target_pos++];
+            }
+            else if (target_decoy == "decoy")
+            {
+              fdr = decoy_fdrs[decoy_pos++];
+              if (!add_decoy_peptides)
               {
                 continue;
               }
             }
-            hit.setMetaValue(score_type, pit->getScore());
-            hit.setScore(score_to_fdr[pit->getScore()]);
-            hits.push_back(hit);
+            else
+            {
+              fdr = lookupFDR(score_to_fdr, pit->getScore());
+            }
+            hits.push_back(*pit);
+            hits.back().setMetaValue(score_type, pit->getScore());
+            hits.back().setScore(fdr);
           }
-          it->setHits(hits);
+          id.getHits().swap(hits);
         }
       }
       if (!split_charge_variants)
@@ -346,85 +441,75 @@ namespace OpenMS
       return;
     }
     vector<double> target_scores, decoy_scores;
+    vector<Size> target_offsets(fwd_ids.size() + 1, 0), decoy_offsets(rev_ids.size() + 1, 0);
     // get the scores of all peptide hits
-    for (vector<PeptideIdentification>::const_iterator it = fwd_ids.begin(); it != fwd_ids.end(); ++it)
+    for (Size i = 0; i < fwd_ids.size(); ++i)
     {
-      for (vector<PeptideHit>::const_iterator pit = it->getHits().begin(); pit != it->getHits().end(); ++pit)
+      for (vector<PeptideHit>::const_iterator pit = fwd_ids[i].getHits().begin(); pit != fwd_ids[i].getHits().end(); ++pit)
       {
         target_scores.push_back(pit->getScore());
       }
+      target_offsets[i + 1] = target_scores.size();
     }
 
-    for (vector<PeptideIdentification>::const_iterator it = rev_ids.begin(); it != rev_ids.end(); ++it)
+    for (Size i = 0; i < rev_ids.size(); ++i)
     {
-      for (vector<PeptideHit>::const_iterator pit = it->getHits().begin(); pit != it->getHits().end(); ++pit)
+      for (vector<PeptideHit>::const_iterator pit = rev_ids[i].getHits().begin(); pit != rev_ids[i].getHits().end(); ++pit)
       {
         decoy_scores.push_back(pit->getScore());
       }
+      decoy_offsets[i + 1] = decoy_scores.size();
     }
 
     bool q_value = !param_.getValue("no_qvalues").toBool();
     bool higher_score_better = fwd_ids.begin()->isHigherScoreBetter();
     bool add_decoy_peptides = param_.getValue("add_decoy_peptides").toBool();
     // calculate fdr for the forward scores
-    Map<double, double> score_to_fdr;
-    calculateFDRs_(score_to_fdr, target_scores, decoy_scores, q_value, higher_score_better);
+    vector<double> target_fdrs, decoy_fdrs;
+    calculateFDRs(target_scores, decoy_scores, target_fdrs, decoy_fdrs, q_value, higher_score_better);
 
     // annotate fdr
     String score_type = fwd_ids.begin()->getScoreType() + "_score";
-    for (vector<PeptideIdentification>::iterator it = fwd_ids.begin(); it != fwd_ids.end(); ++it)
+    annotatePeptideFDRs_(fwd_ids, target_offsets, target_fdrs, score_type, q_value);
+
+    //write as well decoy peptides
+    if (add_decoy_peptides)
     {
+      score_type = rev_ids.begin()->getScoreType() + "_score";
+      annotatePeptideFDRs_(rev_ids, decoy_offsets, decoy_fdrs, score_type, q_value);
+    }
+
+    return;
+  }
+
+  void FalseDiscoveryRate::annotatePeptideFDRs_(vector<PeptideIdentification>& ids, const vector<Size>& offsets, const vector<double>& fdrs, const String& score_type, bool q_value) const
+  {
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (SignedSize i = 0; i < (SignedSize)ids.size(); ++i)
+    {
+      PeptideIdentification& id = ids[i];
       if (q_value)
       {
-        it->setScoreType("q-value");
+        id.setScoreType("q-value");
       }
       else
       {
-        it->setScoreType("FDR");
+        id.setScoreType("FDR");
       }
 
-      it->setHigherScoreBetter(false);
-      vector<PeptideHit> hits = it->getHits();
-      for (vector<PeptideHit>::iterator pit = hits.begin(); pit != hits.end(); ++pit)
-      {
-#ifdef FALSE_DISCOVERY_RATE_DEBUG
-        cerr << pit->getScore() << " " << score_to_fdr[pit->getScore()] << endl;
-#endif
-        pit->setMetaValue(score_type, pit->getScore());
-        pit->setScore(score_to_fdr[pit->getScore()]);
-      }
-      it->setHits(hits);
-    }
-    //write as well decoy peptides
-    if (add_decoy_peptides)
-    {
-      score_type = rev_ids.begin()->getScoreType() + "_score";
-      for (vector<PeptideIdentification>::iterator it = rev_ids.begin(); it != rev_ids.end(); ++it)
+      id.setHigherScoreBetter(false);
+      vector<PeptideHit>& hits = id.getHits();
+      for (Size k = 0; k < hits.size(); ++k)
       {
-        if (q_value)
-        {
-          it->setScoreType("q-value");
-        }
-        else
-        {
-          it->setScoreType("FDR");
-        }
-
-        it->setHigherScoreBetter(false);
-        vector<PeptideHit> hits = it->getHits();
-        for (vector<PeptideHit>::iterator pit = hits.begin(); pit != hits.end(); ++pit)
-        {
 #ifdef FALSE_DISCOVERY_RATE_DEBUG
-          cerr << pit->getScore() << " " << score_to_fdr[pit->getScore()] << endl;
+        cerr << hits[k].getScore() << " " << fdrs[offsets[i] + k] << endl;
 #endif
-          pit->setMetaValue(score_type, pit->getScore());
-          pit->setScore(score_to_fdr[pit->getScore()]);
-        }
-        it->setHits(hits);
+        hits[k].setMetaValue(score_type, hits[k].getScore());
+        hits[k].setScore(fdrs[offsets[i] + k]);
       }
     }
-
-    return;
   }
 
   void FalseDiscoveryRate::apply(vector<ProteinIdentification>& ids)
@@ -466,10 +551,11 @@ namespace OpenMS
     bool higher_score_better = ids.begin()->isHigherScoreBetter();
 
     // calculate fdr for the forward scores
-    Map<double, double> score_to_fdr;
-    calculateFDRs_(score_to_fdr, target_scores, decoy_scores, q_value, higher_score_better);
+    vector<double> target_fdrs, decoy_fdrs;
+    calculateFDRs(target_scores, decoy_scores, target_fdrs, decoy_fdrs, q_value, higher_score_better);
 
-    // annotate fdr
+    // annotate fdr, hits are visited in the same order as above
+    Size target_pos(0), decoy_pos(0);
     String score_type = ids.begin()->getScoreType() + "_score";
     for (vector<ProteinIdentification>::iterator it = ids.begin(); it != ids.end(); ++it)
     {
@@ -482,13 +568,18 @@ namespace OpenMS
         it->setScoreType("FDR");
       }
       it->setHigherScoreBetter(false);
-      vector<ProteinHit> hits = it->getHits();
-      for (vector<ProteinHit>::iterator pit = hits.begin(); pit != hits.end(); ++pit)
+      for (vector<ProteinHit>::iterator pit = it->getHits().begin(); pit != it->getHits().end(); ++pit)
       {
         pit->setMetaValue(score_type, pit->getScore());
-        pit->setScore(score_to_fdr[pit->getScore()]);
+        if (String(pit->getMetaValue("target_decoy")) == "decoy")
+        {
+          pit->setScore(decoy_fdrs[decoy_pos++]);
+        }
+        else
+        {
+          pit->setScore(target_fdrs[target_pos++]);
+        }
       }
-      it->setHits(hits);
     }
 
     return;
@@ -520,10 +611,11 @@ namespace OpenMS
     bool q_value = !param_.getValue("no_qvalues").toBool();
     bool higher_score_better = fwd_ids.begin()->isHigherScoreBetter();
     // calculate fdr for the forward scores
-    Map<double, double> score_to_fdr;
-    calculateFDRs_(score_to_fdr, target_scores, decoy_scores, q_value, higher_score_better);
+    vector<double> target_fdrs, decoy_fdrs;
+    calculateFDRs(target_scores, decoy_scores, target_fdrs, decoy_fdrs, q_value, higher_score_better);
 
     // annotate fdr
+    Size target_pos(0);
     String score_type = fwd_ids.begin()->getScoreType() + "_score";
     for (vector<ProteinIdentification>::iterator it = fwd_ids.begin(); it != fwd_ids.end(); ++it)
     {
@@ -536,142 +628,103 @@ namespace OpenMS
         it->setScoreType("FDR");
       }
       it->setHigherScoreBetter(false);
-      vector<ProteinHit> hits = it->getHits();
-      for (vector<ProteinHit>::iterator pit = hits.begin(); pit != hits.end(); ++pit)
+      for (vector<ProteinHit>::iterator pit = it->getHits().begin(); pit != it->getHits().end(); ++pit)
       {
         pit->setMetaValue(score_type, pit->getScore());
-        pit->setScore(score_to_fdr[pit->getScore()]);
+        pit->setScore(target_fdrs[target_pos++]);
       }
-      it->setHits(hits);
     }
 
     return;
   }
 
-  void FalseDiscoveryRate::calculateFDRs_(Map<double, double>& score_to_fdr, vector<double>& target_scores, vector<double>& decoy_scores, bool q_value, bool higher_score_better)
+  void FalseDiscoveryRate::calculateFDRs(const vector<double>& target_scores, const vector<double>& decoy_scores, vector<double>& target_fdrs, vector<double>& decoy_fdrs, bool q_value, bool higher_score_better) const
   {
-    Size number_of_target_scores = target_scores.size();
-    // sort the scores
-    if (higher_score_better && !q_value)
+    target_fdrs.assign(target_scores.size(), 0.0);
+    decoy_fdrs.assign(decoy_scores.size(), 0.0);
+    if (target_scores.empty())
     {
-      sort(target_scores.rbegin(), target_scores.rend());
-      sort(decoy_scores.rbegin(), decoy_scores.rend());
+      return;
     }
-    else if (!higher_score_better && !q_value)
+
+    // orient the scores such that higher is better and keep the input positions for writing back
+    double sign = higher_score_better ? 1.0 : -1.0;
+    vector<ScoreIndex> targets(target_scores.size()), decoys(decoy_scores.size());
+    for (Size i = 0; i < target_scores.size(); ++i)
     {
-      sort(target_scores.begin(), target_scores.end());
-      sort(decoy_scores.begin(), decoy_scores.end());
+      targets[i] = ScoreIndex(sign * target_scores[i], i);
     }
-    else if (higher_score_better)
+    for (Size i = 0; i < decoy_scores.size(); ++i)
     {
-      sort(target_scores.begin(), target_scores.end());
-      sort(decoy_scores.rbegin(), decoy_scores.rend());
+      decoys[i] = ScoreIndex(sign * decoy_scores[i], i);
     }
-    else
+    parallelSort(targets);
+    parallelSort(decoys);
+
+    // sweep over the distinct target scores from worst to best:
+    // FDR = #decoys / #targets scoring at least as good, q-value = minimal FDR of all worse (or equal) thresholds
+    vector<double> unique_scores, unique_fdrs;
+    Size worse_decoys = 0;
+    double minimal_fdr = 1.;
+    for (Size first = 0; first < targets.size(); )
     {
-      sort(target_scores.rbegin(), target_scores.rend());
-      sort(decoy_scores.begin(), decoy_scores.end());
-    }
-
-    Size j = 0;
-
-    if (q_value)
-    {
-      double minimal_fdr = 1.;
-      for (Size i = 0; i != target_scores.size(); ++i)
+      double score = targets[first].first;
+      Size last = first;
+      while (last < targets.size() && targets[last].first == score)
       {
-        if (decoy_scores.empty())
-        {
-          // set FDR to 0 (done below automatically)
-        }
-        else if (i == 0 && j == 0)
-        {
-          while (j != decoy_scores.size()
-                && ((target_scores[i] <= decoy_scores[j] && higher_score_better) ||
-                    (target_scores[i] >= decoy_scores[j] && !higher_score_better)))
-          {
-            ++j;
-          }
-        }
-        else
-        {
-          if (j == decoy_scores.size())
-          {
-            j--;
-          }
-          while (j != 0
-                && ((target_scores[i] > decoy_scores[j] && higher_score_better) ||
-                    (target_scores[i] < decoy_scores[j] && !higher_score_better)))
-          {
-            --j;
-          }
-          // Since j has to be equal to the number of fps above the threshold we add one
-          if ((target_scores[i] <= decoy_scores[j] && higher_score_better)
-             || (target_scores[i] >= decoy_scores[j] && !higher_score_better))
-          {
-            ++j;
-          }
-        }
-
-#ifdef FALSE_DISCOVERY_RATE_DEBUG
-        cerr << target_scores[i] << " " << decoy_scores[j] << " " << i << " " << j << " ";
-#endif
-
-        double fdr = 0.;
+        ++last;
+      }
+      while (worse_decoys < decoys.size() && decoys[worse_decoys].first < score)
+      {
+        ++worse_decoys;
+      }
 
-        if (minimal_fdr >= (double)j / (number_of_target_scores - i))
-        {
-          minimal_fdr = (double)j / (number_of_target_scores - i);
-        }
+      double fdr = (double)(decoys.size() - worse_decoys) / (double)(targets.size() - first);
+      if (q_value)
+      {
+        minimal_fdr = min(minimal_fdr, fdr);
         fdr = minimal_fdr;
+      }
 
 #ifdef FALSE_DISCOVERY_RATE_DEBUG
-        cerr << fdr << endl;
+      cerr << score << " " << (decoys.size() - worse_decoys) << " " << (targets.size() - first) << " " << fdr << endl;
 #endif
-        score_to_fdr[target_scores[i]] = fdr;
 
+      unique_scores.push_back(score);
+      unique_fdrs.push_back(fdr);
+      for (Size i = first; i < last; ++i)
+      {
+        target_fdrs[targets[i].second] = fdr;
       }
+      first = last;
     }
-    else
+
+    // assign q-value of decoy_score to closest target_score (ties: the worse target for q-values, the better one for FDRs)
+    Size next = 0;
+    for (Size i = 0; i < decoys.size(); ++i)
     {
-      for (Size i = 0; i != target_scores.size(); ++i)
+      double score = decoys[i].first;
+      while (next < unique_scores.size() && unique_scores[next] < score)
       {
-        while (j != decoy_scores.size() &&
-               ((target_scores[i] <= decoy_scores[j] && higher_score_better) ||
-                (target_scores[i] >= decoy_scores[j] && !higher_score_better)))
-        {
-          ++j;
-        }
-
-#ifdef FALSE_DISCOVERY_RATE_DEBUG
-        cerr << target_scores[i] << " " << decoy_scores[j] << " " << i << " " << j << " ";
-#endif
-        double fdr(0);
-
-        fdr = (double)j / (double)(i + 1);
-
-#ifdef FALSE_DISCOVERY_RATE_DEBUG
-        cerr << fdr << endl;
-#endif
-        score_to_fdr[target_scores[i]] = fdr;
+        ++next;
       }
-    }
-
 
-    // assign q-value of decoy_score to closest target_score
-    for (Size i = 0; i != decoy_scores.size(); ++i)
-    {
-      Size closest_idx = 0;
-      for (Size k = 0; k != target_scores.size(); ++k)
+      Size closest_idx = next;
+      if (next == unique_scores.size())
+      {
+        closest_idx = next - 1;
+      }
+      else if (next != 0 && unique_scores[next] != score)
       {
-        if (fabs(decoy_scores[i] - target_scores[k]) < fabs(decoy_scores[i] - target_scores[closest_idx]))
+        double dist_worse = fabs(score - unique_scores[next - 1]);
+        double dist_better = fabs(score - unique_scores[next]);
+        if (dist_worse < dist_better || (dist_worse == dist_better && q_value))
         {
-          closest_idx = k;
+          closest_idx = next - 1;
         }
       }
-      score_to_fdr[decoy_scores[i]] = score_to_fdr[target_scores[closest_idx]];
+      decoy_fdrs[decoys[i].second] = unique_fdrs[closest_idx];
     }
-
   }
 
 } // namespace OpenMS
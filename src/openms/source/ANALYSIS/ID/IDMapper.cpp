@@ -41,6 +41,120 @@ using namespace std;
 namespace OpenMS
 {
 
+  namespace
+  {
+    /**
+      @brief Index over the (enlarged) bounding boxes of features
+
+      The RT range is partitioned into slices (bins) of equal width; every box
+      that overlaps a certain slice is hashed into the corresponding bin. The
+      width should be in the order of the RT tolerance the boxes were enlarged
+      by, so a box only falls into a few bins and the number of bins does not
+      exceed the RT range of the boxes divided by the tolerance.
+      Within a bin, boxes are sorted by their lower m/z bound, so that the
+      boxes overlapping an m/z range can be found by binary search.
+    */
+    class FeatureBoxIndex
+    {
+public:
+      FeatureBoxIndex() :
+        offset_(0),
+        bin_width_(1.0)
+      {
+      }
+
+      /// hash all non-empty @p boxes, which are referred to by their position in the vector, into RT bins of @p bin_width seconds (at least 1)
+      void build(const vector<DBoundingBox<2> >& boxes, double bin_width)
+      {
+        bins_.clear();
+        max_width_.clear();
+        bin_width_ = max(bin_width, 1.0);
+
+        double min_rt = numeric_limits<double>::max();
+        double max_rt = -numeric_limits<double>::max();
+        for (Size i = 0; i < boxes.size(); ++i)
+        {
+          if (boxes[i].isEmpty()) continue;
+          min_rt = min(min_rt, boxes[i].minPosition().getX());
+          max_rt = max(max_rt, boxes[i].maxPosition().getX());
+        }
+        if (min_rt > max_rt) return; // no boxes
+
+        // make sure the RT hash table has indices >= 0 and doesn't waste space in the beginning
+        offset_ = getBin_(min_rt);
+        bins_.resize(getBin_(max_rt) - offset_ + 1);
+        max_width_.resize(bins_.size(), 0.0);
+        for (Size i = 0; i < boxes.size(); ++i)
+        {
+          const DBoundingBox<2>& box = boxes[i];
+          if (box.isEmpty()) continue;
+          Entry entry;
+          entry.min_mz = box.minPosition().getY();
+          entry.max_mz = box.maxPosition().getY();
+          entry.index = i;
+          for (SignedSize bin = getBin_(box.minPosition().getX()) - offset_;
+               bin <= getBin_(box.maxPosition().getX()) - offset_; ++bin)
+          {
+            bins_[bin].push_back(entry);
+            max_width_[bin] = max(max_width_[bin], entry.max_mz - entry.min_mz);
+          }
+        }
+        for (Size bin = 0; bin < bins_.size(); ++bin)
+        {
+          sort(bins_[bin].begin(), bins_[bin].end());
+        }
+      }
+
+      /// find all boxes in the RT bin of @p rt that overlap [@p min_mz, @p max_mz]; the result is sorted by box index
+      void getCandidates(double rt, double min_mz, double max_mz, vector<Size>& candidates) const
+      {
+        candidates.clear();
+        SignedSize bin = getBin_(rt) - offset_;
+        if ((bin < 0) || (bin >= SignedSize(bins_.size()))) return;
+
+        const vector<Entry>& entries = bins_[bin];
+        Entry lower;
+        lower.min_mz = min_mz - max_width_[bin];
+        for (vector<Entry>::const_iterator it = lower_bound(entries.begin(), entries.end(), lower);
+             (it != entries.end()) && (it->min_mz <= max_mz); ++it)
+        {
+          if (it->max_mz >= min_mz)
+          {
+            candidates.push_back(it->index);
+          }
+        }
+        // preserve the order of the map
+        sort(candidates.begin(), candidates.end());
+      }
+
+private:
+      /// (absolute) index of the RT bin of @p rt
+      SignedSize getBin_(double rt) const
+      {
+        return SignedSize(floor(rt / bin_width_));
+      }
+
+      struct Entry
+      {
+        double min_mz;
+        double max_mz;
+        Size index;
+
+        bool operator<(const Entry& rhs) const
+        {
+          return min_mz < rhs.min_mz;
+        }
+      };
+
+      SignedSize offset_;
+      /// width of the RT bins (seconds)
+      double bin_width_;
+      vector<vector<Entry> > bins_;
+      /// largest m/z extent of the boxes in each bin
+      vector<double> max_width_;
+    };
+  }
+
   IDMapper::IDMapper() :
     DefaultParamHandler("IDMapper"),
     rt_tolerance_(5.0),
@@ -112,31 +226,56 @@ namespace OpenMS
     // keep track of assigned/unassigned precursors
     std::map<Size, Size> assigned_precursors;
 
-    // store which peptides fit which feature (and avoid double entries)
-    // consensusMap -> {peptide_index}
-    std::vector<std::set<size_t> > mapping(map.size());
-
-    DoubleList mz_values;
-    double rt_pep;
-    IntList charges;
+    // index the consensus features (or their subelements) by RT and m/z;
+    // boxes are generously enlarged, the exact test is done by isMatch_()
+    std::vector<DBoundingBox<2> > boxes(map.size());
+    for (Size cm_index = 0; cm_index < map.size(); ++cm_index)
+    {
+      DBoundingBox<2>& box = boxes[cm_index];
+      if (!measure_from_subelements)
+      {
+        box.enlarge(map[cm_index].getRT(), map[cm_index].getMZ());
+      }
+      else
+      {
+        for (ConsensusFeature::HandleSetType::const_iterator it_handle = map[cm_index].getFeatures().begin();
+             it_handle != map[cm_index].getFeatures().end();
+             ++it_handle)
+        {
+          box.enlarge(it_handle->getRT(), it_handle->getMZ());
+        }
+      }
+      if (box.isEmpty()) continue;
+      double mz_margin = 2.0 * getAbsoluteMZTolerance_(box.maxPosition().getY());
+      box.setMin(box.minPosition() - DPosition<2>(rt_tolerance_ + 1.0, mz_margin));
+      box.setMax(box.maxPosition() + DPosition<2>(rt_tolerance_ + 1.0, mz_margin));
+    }
+    FeatureBoxIndex index;
+    index.build(boxes, rt_tolerance_);
 
-    // for statistics
-    Size id_matches_none(0), id_matches_single(0), id_matches_multiple(0);
+    // matching consensus features of each peptide ID (index and map index of the matching
+    // subelement, if measured from subelements), computed in parallel and merged in the order of the IDs below
+    std::vector<std::vector<std::pair<Size, Size> > > id_matches(ids.size());
 
-    // iterate over the peptide IDs
-    for (Size i = 0; i < ids.size(); ++i)
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 100)
+#endif
+    for (SignedSize i = 0; i < (SignedSize)ids.size(); ++i)
     {
       if (ids[i].getHits().empty()) continue;
 
+      DoubleList mz_values;
+      double rt_pep;
+      IntList charges;
       getIDDetails_(ids[i], rt_pep, mz_values, charges);
 
-      bool id_mapped(false);
+      std::vector<Size> candidates;
+      index.getCandidates(rt_pep, *std::min_element(mz_values.begin(), mz_values.end()), *std::max_element(mz_values.begin(), mz_values.end()), candidates);
 
       // iterate over the features
-      for (Size cm_index = 0; cm_index < map.size(); ++cm_index)
+      for (std::vector<Size>::const_iterator cand_it = candidates.begin(); cand_it != candidates.end(); ++cand_it)
       {
-        // if set to TRUE, we leave the i_mz-loop as we added the whole ID with all hits
-        bool was_added = false; // was current pep-m/z matched?!
+        Size cm_index = *cand_it;
 
         // iterate over m/z values of pepIds
         for (Size i_mz = 0; i_mz < mz_values.size(); ++i_mz)
@@ -160,15 +299,16 @@ namespace OpenMS
             current_charges.push_back(0); // "not specified" always matches
           }
 
+          // if set to TRUE, we leave the i_mz-loop as we added the whole ID with all hits
+          bool was_added = false; // was current pep-m/z matched?!
+
           //check if we compare distance from centroid or subelements
           if (!measure_from_subelements)
           {
             if (isMatch_(rt_pep - map[cm_index].getRT(), mz_pep, map[cm_index].getMZ()) && (ignore_charge_ || ListUtils::contains(current_charges, map[cm_index].getCharge())))
             {
-              id_mapped = true;
               was_added = true;
-              map[cm_index].getPeptideIdentifications().push_back(ids[i]);
-              ++assigned_ids[i];
+              id_matches[i].push_back(std::make_pair(cm_index, Size(0)));
             }
           }
           else
@@ -179,42 +319,51 @@ namespace OpenMS
             {
               if (isMatch_(rt_pep - it_handle->getRT(), mz_pep, it_handle->getMZ())  && (ignore_charge_ || ListUtils::contains(current_charges, it_handle->getCharge())))
               {
-                id_mapped = true;
                 was_added = true;
-                if (mapping[cm_index].count(i) == 0)
-                {
-                  // Store the map index of the peptide feature in the id the feature was mapped to.
-                  PeptideIdentification id_pep = ids[i];
-                  if (annotate_ids_with_subelements)
-                  {
-                    id_pep.setMetaValue("map_index", it_handle->getMapIndex());
-                  }
-                  
-                  map[cm_index].getPeptideIdentifications().push_back(id_pep);
-                  ++assigned_ids[i];
-                  mapping[cm_index].insert(i);
-                }
+                id_matches[i].push_back(std::make_pair(cm_index, it_handle->getMapIndex()));
                 break; // we added this peptide already.. no need to check other handles
               }
             }
-            // continue to here
           }
 
           if (was_added) break;
 
         } // m/z values to check
 
-        // break to here
-
       } // features
+    } // Identifications
+
+    // for statistics
+    Size id_matches_none(0), id_matches_single(0), id_matches_multiple(0);
+
+    // merge the assignments
+    for (Size i = 0; i < ids.size(); ++i)
+    {
+      if (ids[i].getHits().empty()) continue;
+
+      for (std::vector<std::pair<Size, Size> >::const_iterator match_it = id_matches[i].begin(); match_it != id_matches[i].end(); ++match_it)
+      {
+        if (measure_from_subelements && annotate_ids_with_subelements)
+        {
+          // Store the map index of the peptide feature in the id the feature was mapped to.
+          PeptideIdentification id_pep = ids[i];
+          id_pep.setMetaValue("map_index", match_it->second);
+          map[match_it->first].getPeptideIdentifications().push_back(id_pep);
+        }
+        else
+        {
+          map[match_it->first].getPeptideIdentifications().push_back(ids[i]);
+        }
+        ++assigned_ids[i];
+      }
 
       // the id has not been mapped to any consensus feature
-      if (!id_mapped)
+      if (id_matches[i].empty())
       {
         map.getUnassignedPeptideIdentifications().push_back(ids[i]);
         ++id_matches_none;
       }
-    } // Identifications
+    }
 
     for (std::map<Size, Size>::const_iterator it = assigned_ids.begin(); it != assigned_ids.end(); ++it)
     {
@@ -262,17 +411,17 @@ namespace OpenMS
       }
     }
 
-    // for statistics:
-    Size spectrum_matches_none(0), spectrum_matches_single(0), spectrum_matches_multiple(0);
+    // matching consensus features of each precursor of the unidentified spectra (same layout as above)
+    std::vector<std::vector<std::vector<std::pair<Size, Size> > > > precursor_matches(unidentified.size());
 
-    // are there any mapped but unidentified precursors?
-    for (Size ui = 0; ui != unidentified.size(); ++ui)
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 100)
+#endif
+    for (SignedSize ui = 0; ui < (SignedSize)unidentified.size(); ++ui)
     {
-      Size spectrum_index = unidentified[ui];
-      const MSSpectrum<Peak1D>& spectrum = spectra[spectrum_index];
+      const MSSpectrum<Peak1D>& spectrum = spectra[unidentified[ui]];
       const vector<Precursor>& precursors = spectrum.getPrecursors();
-
-      bool precursor_mapped(false);
+      precursor_matches[ui].resize(precursors.size());
 
       // check if precursor has been identified
       for (Size i_p = 0; i_p < precursors.size(); ++i_p)
@@ -282,35 +431,28 @@ namespace OpenMS
         int z_p = precursors[i_p].getCharge();
         double rt_value = spectrum.getRT();
 
-        PeptideIdentification precursor_empty_id;
-        precursor_empty_id.setRT(rt_value);
-        precursor_empty_id.setMZ(mz_p);
-        precursor_empty_id.setMetaValue("spectrum_index", spectrum_index);
-        if (!spectra[spectrum_index].getNativeID().empty())
+        // charge states to use for checking:
+        IntList current_charges;
+        if (!ignore_charge_)
         {
-          precursor_empty_id.setMetaValue("spectrum_reference",  spectra[spectrum_index].getNativeID());
+          current_charges.push_back(z_p);
+          current_charges.push_back(0); // "not specified" always matches
         }
-        precursor_empty_id.setIdentifier(empty_protein_id.getIdentifier());
+
+        std::vector<Size> candidates;
+        index.getCandidates(rt_value, mz_p, mz_p, candidates);
 
         // iterate over the consensus features
-        for (Size cm_index = 0; cm_index < map.size(); ++cm_index)
+        for (std::vector<Size>::const_iterator cand_it = candidates.begin(); cand_it != candidates.end(); ++cand_it)
         {
-          // charge states to use for checking:
-          IntList current_charges;
-          if (!ignore_charge_)
-          {
-            current_charges.push_back(z_p);
-            current_charges.push_back(0); // "not specified" always matches
-          }
+          Size cm_index = *cand_it;
 
           // check if we compare distance from centroid or subelements
           if (!measure_from_subelements) // measure from centroid
           {
             if (isMatch_(rt_value - map[cm_index].getRT(), mz_p, map[cm_index].getMZ()) && (ignore_charge_ || ListUtils::contains(current_charges, map[cm_index].getCharge())))
             {
-              map[cm_index].getPeptideIdentifications().push_back(precursor_empty_id);
-              ++assigned_precursors[spectrum_index];
-              precursor_mapped = true;
+              precursor_matches[ui][i_p].push_back(std::make_pair(cm_index, Size(0)));
             }
           }
           else // measure from subelements
@@ -321,22 +463,52 @@ namespace OpenMS
             {
               if (isMatch_(rt_value - it_handle->getRT(), mz_p, it_handle->getMZ())  && (ignore_charge_ || ListUtils::contains(current_charges, it_handle->getCharge())))
               {
-                if (annotate_ids_with_subelements)
-                {                  
-                  // store the map index the precursor was mapped to                  
-                  Size map_index = it_handle->getMapIndex();
-
-                  // we use no undesrscore here to be compatible with linkers
-                  precursor_empty_id.setMetaValue("map_index", String(map_index));
-                }
-                map[cm_index].getPeptideIdentifications().push_back(precursor_empty_id);
-                ++assigned_precursors[spectrum_index];
-                precursor_mapped = true;
+                precursor_matches[ui][i_p].push_back(std::make_pair(cm_index, it_handle->getMapIndex()));
               }
             }
           }
         } // m/z values to check
       }
+    }
+
+    // for statistics:
+    Size spectrum_matches_none(0), spectrum_matches_single(0), spectrum_matches_multiple(0);
+
+    // are there any mapped but unidentified precursors?
+    for (Size ui = 0; ui != unidentified.size(); ++ui)
+    {
+      Size spectrum_index = unidentified[ui];
+      const MSSpectrum<Peak1D>& spectrum = spectra[spectrum_index];
+      const vector<Precursor>& precursors = spectrum.getPrecursors();
+
+      bool precursor_mapped(false);
+
+      for (Size i_p = 0; i_p < precursors.size(); ++i_p)
+      {
+        PeptideIdentification precursor_empty_id;
+        precursor_empty_id.setRT(spectrum.getRT());
+        precursor_empty_id.setMZ(precursors[i_p].getMZ());
+        precursor_empty_id.setMetaValue("spectrum_index", spectrum_index);
+        if (!spectra[spectrum_index].getNativeID().empty())
+        {
+          precursor_empty_id.setMetaValue("spectrum_reference",  spectra[spectrum_index].getNativeID());
+        }
+        precursor_empty_id.setIdentifier(empty_protein_id.getIdentifier());
+
+        const std::vector<std::pair<Size, Size> >& matches = precursor_matches[ui][i_p];
+        for (std::vector<std::pair<Size, Size> >::const_iterator match_it = matches.begin(); match_it != matches.end(); ++match_it)
+        {
+          if (measure_from_subelements && annotate_ids_with_subelements)
+          {
+            // store the map index the precursor was mapped to
+            // we use no undesrscore here to be compatible with linkers
+            precursor_empty_id.setMetaValue("map_index", String(match_it->second));
+          }
+          map[match_it->first].getPeptideIdentifications().push_back(precursor_empty_id);
+          ++assigned_precursors[spectrum_index];
+          precursor_mapped = true;
+        }
+      }
       if (!precursor_mapped) ++spectrum_matches_none;
     }
 
@@ -403,8 +575,6 @@ namespace OpenMS
     
     // calculate feature bounding boxes only once:
     std::vector<DBoundingBox<2> > boxes;
-    double min_rt = std::numeric_limits<double>::max();
-    double max_rt = -std::numeric_limits<double>::max();
     // std::cout << "Precomputing bounding boxes..." << std::endl;
     boxes.reserve(map.size());
     for (FeatureMap::Iterator f_it = map.begin();
@@ -427,130 +597,58 @@ namespace OpenMS
       }
       increaseBoundingBox_(box);
       boxes.push_back(box);
-      
-      min_rt = std::min(min_rt, box.minPosition().getX());
-      max_rt = std::max(max_rt, box.maxPosition().getX());
     }
     
-    // hash bounding boxes of features by RT:
-    // RT range is partitioned into slices (bins) of 1 second; every feature
-    // that overlaps a certain slice is hashed into the corresponding bin
-    std::vector<std::vector<SignedSize> > hash_table;
-    // make sure the RT hash table has indices >= 0 and doesn't waste space
-    // in the beginning:
-    SignedSize offset(0);
-    
+    // index bounding boxes of features by RT and m/z
+    FeatureBoxIndex index;
     if (map.size() > 0)
     {
       // std::cout << "Setting up hash table..." << std::endl;
-      offset = SignedSize(floor(min_rt));
-      // this only works if features were found
-      hash_table.resize(SignedSize(floor(max_rt)) - offset + 1);
-      for (Size index = 0; index < boxes.size(); ++index)
-      {
-        const DBoundingBox<2> & box = boxes[index];
-        for (SignedSize i = SignedSize(floor(box.minPosition().getX()));
-             i <= SignedSize(floor(box.maxPosition().getX())); ++i)
-        {
-          hash_table[i - offset].push_back(index);
-        }
-      }
+      index.build(boxes, rt_tolerance_);
     }
     else
     {
       LOG_WARN << "IDMapper received an empty FeatureMap! All peptides are mapped as 'unassigned'!" << std::endl;
     }
     
-    // for statistics:
-    Size matches_none = 0, matches_single = 0, matches_multi = 0;
-    
     // std::cout << "Finding matches..." << std::endl;
-    // iterate over peptide IDs:
-    for (std::vector<PeptideIdentification>::const_iterator id_it =
-         ids.begin(); id_it != ids.end(); ++id_it)
-    {
-      // std::cout << "Peptide ID: " << id_it - ids.begin() << std::endl;
+    // matching features of each peptide ID, computed in parallel and merged in the order of the IDs below
+    std::vector<std::vector<Size> > id_matches(ids.size());
 
-      if (id_it->getHits().empty()) continue;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 100)
+#endif
+    for (SignedSize i = 0; i < (SignedSize)ids.size(); ++i)
+    {
+      if (ids[i].getHits().empty()) continue;
 
       DoubleList mz_values;
       double rt_value;
       IntList charges;
-      getIDDetails_(*id_it, rt_value, mz_values, charges, use_avg_mass);
-      
-      if ((rt_value < min_rt) || (rt_value > max_rt))             // RT out of bounds
+      getIDDetails_(ids[i], rt_value, mz_values, charges, use_avg_mass);
+
+      std::vector<Size> candidates;
+      index.getCandidates(rt_value, *std::min_element(mz_values.begin(), mz_values.end()), *std::max_element(mz_values.begin(), mz_values.end()), candidates);
+      getMatchingFeatures_(map, boxes, candidates, rt_value, mz_values, charges, use_centroid_rt, use_centroid_mz, id_matches[i]);
+    }
+
+    // for statistics:
+    Size matches_none = 0, matches_single = 0, matches_multi = 0;
+    
+    // iterate over peptide IDs:
+    for (Size i = 0; i < ids.size(); ++i)
+    {
+      if (ids[i].getHits().empty()) continue;
+
+      for (std::vector<Size>::const_iterator match_it = id_matches[i].begin(); match_it != id_matches[i].end(); ++match_it)
       {
-        map.getUnassignedPeptideIdentifications().push_back(*id_it);
-        ++matches_none;
-        continue;
-      }
-      
-      // iterate over candidate features:
-      Size index = SignedSize(floor(rt_value)) - offset;
-      Size matching_features = 0;
-      for (std::vector<SignedSize>::iterator hash_it =
-           hash_table[index].begin(); hash_it != hash_table[index].end();
-           ++hash_it)
-      {
-        Feature & feat = map[*hash_it];
-        
-        // need to check the charge state?
-        bool check_charge = !ignore_charge_;
-        if (check_charge && (mz_values.size() == 1))               // check now
-        {
-          if (!ListUtils::contains(charges, feat.getCharge())) continue;
-          check_charge = false;                 // don't need to check later
-        }
-        
-        // iterate over m/z values (only one if "mz_ref." is "precursor"):
-        Size l_index = 0;
-        for (DoubleList::iterator mz_it = mz_values.begin();
-             mz_it != mz_values.end(); ++mz_it, ++l_index)
-        {
-          if (check_charge && (charges[l_index] != feat.getCharge()))
-          {
-            continue;                   // charge states need to match
-          }
-          
-          DPosition<2> id_pos(rt_value, *mz_it);
-          if (boxes[*hash_it].encloses(id_pos))                 // potential match
-          {
-            if (use_centroid_mz)
-            {
-              // only one m/z value to check, which was already incorporated
-              // into the overall bounding box -> success!
-              feat.getPeptideIdentifications().push_back(*id_it);
-              ++matching_features;
-              break;                     // "mz_it" loop
-            }
-            // else: check all the mass traces
-            bool found_match = false;
-            for (std::vector<ConvexHull2D>::iterator ch_it =
-                 feat.getConvexHulls().begin(); ch_it !=
-                 feat.getConvexHulls().end(); ++ch_it)
-            {
-              DBoundingBox<2> box = ch_it->getBoundingBox();
-              if (use_centroid_rt)
-              {
-                box.setMinX(feat.getRT());
-                box.setMaxX(feat.getRT());
-              }
-              increaseBoundingBox_(box);
-              if (box.encloses(id_pos)) // success!
-              {
-                feat.getPeptideIdentifications().push_back(*id_it);
-                ++matching_features;
-                found_match = true;
-                break; // "ch_it" loop
-              }
-            }
-            if (found_match) break; // "mz_it" loop
-          }
-        }
+        map[*match_it].getPeptideIdentifications().push_back(ids[i]);
       }
+
+      Size matching_features = id_matches[i].size();
       if (matching_features == 0)
       {
-        map.getUnassignedPeptideIdentifications().push_back(*id_it);
+        map.getUnassignedPeptideIdentifications().push_back(ids[i]);
         ++matches_none;
       }
       else if (matching_features == 1) 
@@ -567,7 +665,6 @@ namespace OpenMS
 
     // map all unidentified precursor to features
     Size spectrum_matches_none(0);
-    Size spectrum_matches(0);
     Size spectrum_matches_single(0);
     Size spectrum_matches_multi(0);
     
@@ -592,34 +689,43 @@ namespace OpenMS
       }
     }
 
-    // are there any mapped but unidentified precursors?
-    for (Size i = 0; i != unidentified.size(); ++i)
+    // matching features of each precursor of the unidentified spectra
+    std::vector<std::vector<std::vector<Size> > > precursor_matches(unidentified.size());
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 100)
+#endif
+    for (SignedSize i = 0; i < (SignedSize)unidentified.size(); ++i)
     {
-      Size spectrum_index = unidentified[i];
-      const MSSpectrum<Peak1D>& spectrum = spectra[spectrum_index];
+      const MSSpectrum<Peak1D>& spectrum = spectra[unidentified[i]];
       const vector<Precursor>& precursors = spectrum.getPrecursors();
+      precursor_matches[i].resize(precursors.size());
 
-      // check if precursor has been identified
       for (Size i_p = 0; i_p < precursors.size(); ++i_p)
       {
         // check by precursor mass and spectrum RT
-        double mz_p = precursors[i_p].getMZ();
+        DoubleList mz_values(1, precursors[i_p].getMZ());
+        IntList charges(1, precursors[i_p].getCharge());
         double rt_value = spectrum.getRT();
-        int z_p = precursors[i_p].getCharge();
 
-        if ((rt_value < min_rt) || (rt_value > max_rt)) // RT out of bounds
-        {
-          ++spectrum_matches_none;
-          continue;
-        }
-      
-        // iterate over candidate features:
-        Size index = SignedSize(floor(rt_value)) - offset;
-        Size matching_features = 0;
+        std::vector<Size> candidates;
+        index.getCandidates(rt_value, mz_values[0], mz_values[0], candidates);
+        getMatchingFeatures_(map, boxes, candidates, rt_value, mz_values, charges, use_centroid_rt, use_centroid_mz, precursor_matches[i][i_p]);
+      }
+    }
+
+    // are there any mapped but unidentified precursors?
+    for (Size i = 0; i != unidentified.size(); ++i)
+    {
+      Size spectrum_index = unidentified[i];
+      const MSSpectrum<Peak1D>& spectrum = spectra[spectrum_index];
+      const vector<Precursor>& precursors = spectrum.getPrecursors();
 
+      for (Size i_p = 0; i_p < precursors.size(); ++i_p)
+      {
         PeptideIdentification precursor_empty_id;
-        precursor_empty_id.setRT(rt_value);
-        precursor_empty_id.setMZ(mz_p);
+        precursor_empty_id.setRT(spectrum.getRT());
+        precursor_empty_id.setMZ(precursors[i_p].getMZ());
         precursor_empty_id.setMetaValue("spectrum_index", spectrum_index);
         if (!spectra[spectrum_index].getNativeID().empty())
         {
@@ -628,61 +734,17 @@ namespace OpenMS
         precursor_empty_id.setIdentifier(empty_protein_id.getIdentifier());
         //precursor_empty_id.setCharge(z_p);
 
-        for (std::vector<SignedSize>::iterator hash_it =
-           hash_table[index].begin(); hash_it != hash_table[index].end();
-           ++hash_it)
+        const std::vector<Size>& matches = precursor_matches[i][i_p];
+        for (std::vector<Size>::const_iterator match_it = matches.begin(); match_it != matches.end(); ++match_it)
         {
-          Feature & feat = map[*hash_it];
-        
-          // (optinally) check charge state
-          if (!ignore_charge_)
-          {
-            if (z_p != feat.getCharge()) continue;
-          }
-        
-          DPosition<2> id_pos(rt_value, mz_p);
-
-          if (boxes[*hash_it].encloses(id_pos)) // potential match
-          {
-            if (use_centroid_mz)
-            {
-              // only one m/z value to check, which was already incorporated
-              // into the overall bounding box -> success!
-              feat.getPeptideIdentifications().push_back(precursor_empty_id);
-              ++spectrum_matches;
-              break; // "mz_it" loop
-            }
-            // else: check all the mass traces
-            bool found_match = false;
-            for (std::vector<ConvexHull2D>::iterator ch_it =
-                  feat.getConvexHulls().begin(); ch_it !=
-                  feat.getConvexHulls().end(); ++ch_it)
-            {
-              DBoundingBox<2> box = ch_it->getBoundingBox();
-              if (use_centroid_rt)
-              {
-                box.setMinX(feat.getRT());
-                box.setMaxX(feat.getRT());
-              }
-              increaseBoundingBox_(box);
-              if (box.encloses(id_pos)) // success!
-              {
-                feat.getPeptideIdentifications().push_back(precursor_empty_id);
-                ++matching_features;
-                found_match = true;
-                break; // "ch_it" loop
-              }
-            }
-
-            if (found_match) break; // "mz_it" loop
-          }
+          map[*match_it].getPeptideIdentifications().push_back(precursor_empty_id);
         }
 
-        if (matching_features == 0)
+        if (matches.empty())
         {
           ++spectrum_matches_none;
         }
-        else if (matching_features == 1) 
+        else if (matches.size() == 1) 
         {
           ++spectrum_matches_single;
         }
@@ -706,6 +768,71 @@ namespace OpenMS
     
   }
 
+  void IDMapper::getMatchingFeatures_(const FeatureMap& map, const std::vector<DBoundingBox<2> >& boxes, const std::vector<Size>& candidates,
+                                      double rt, const DoubleList& mz_values, const IntList& charges, bool use_centroid_rt, bool use_centroid_mz,
+                                      std::vector<Size>& matches) const
+  {
+    matches.clear();
+
+    // iterate over candidate features:
+    for (std::vector<Size>::const_iterator cand_it = candidates.begin(); cand_it != candidates.end(); ++cand_it)
+    {
+      const Feature & feat = map[*cand_it];
+
+      // need to check the charge state?
+      bool check_charge = !ignore_charge_;
+      if (check_charge && (mz_values.size() == 1))               // check now
+      {
+        if (!ListUtils::contains(charges, feat.getCharge())) continue;
+        check_charge = false;                 // don't need to check later
+      }
+
+      // iterate over m/z values (only one if "mz_ref." is "precursor"):
+      Size l_index = 0;
+      for (DoubleList::const_iterator mz_it = mz_values.begin();
+           mz_it != mz_values.end(); ++mz_it, ++l_index)
+      {
+        if (check_charge && (charges[l_index] != feat.getCharge()))
+        {
+          continue;                   // charge states need to match
+        }
+
+        DPosition<2> id_pos(rt, *mz_it);
+        if (boxes[*cand_it].encloses(id_pos))                 // potential match
+        {
+          if (use_centroid_mz)
+          {
+            // only one m/z value to check, which was already incorporated
+            // into the overall bounding box -> success!
+            matches.push_back(*cand_it);
+            break;                     // "mz_it" loop
+          }
+          // else: check all the mass traces
+          bool found_match = false;
+          for (std::vector<ConvexHull2D>::const_iterator ch_it =
+               feat.getConvexHulls().begin(); ch_it !=
+               feat.getConvexHulls().end(); ++ch_it)
+          {
+            DBoundingBox<2> box = ch_it->getBoundingBox();
+            if (use_centroid_rt)
+            {
+              box.setMinX(feat.getRT());
+              box.setMaxX(feat.getRT());
+            }
+            increaseBoundingBox_(box);
+            if (box.encloses(id_pos)) // success!
+            {
+              matches.push_back(*cand_it);
+              found_match = true;
+              break; // "ch_it" loop
+            }
+          }
+          if (found_match) break; // "mz_it" loop
+        }
+      }
+    }
+  }
+
   double IDMapper::getAbsoluteMZTolerance_(const double mz) const
   {
     if (measure_ == MEASURE_PPM)
@@ -777,7 +904,7 @@ namespace OpenMS
     }
   }
 
-  void IDMapper::increaseBoundingBox_(DBoundingBox<2>& box)
+  void IDMapper::increaseBoundingBox_(DBoundingBox<2>& box) const
   {
     DPosition<2> sub_min(rt_tolerance_,
                          getAbsoluteMZTolerance_(box.minPosition().getY())),
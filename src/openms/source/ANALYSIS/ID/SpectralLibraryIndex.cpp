@@ -0,0 +1,372 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2016.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: Timo Sachsenberg $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/ANALYSIS/ID/SpectralLibraryIndex.h>
+#include <OpenMS/CHEMISTRY/AASequence.h>
+#include <OpenMS/SYSTEM/File.h>
+
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <functional>
+
+#define SPECTRAL_LIBRARY_INDEX_IDENTIFIER 8094
+
+using std::vector;
+
+namespace OpenMS
+{
+
+  namespace
+  {
+    /// sorts entry indices by precursor m/z
+    struct PrecursorMZLess_
+    {
+      explicit PrecursorMZLess_(const vector<double>& mz) :
+        mz_(mz)
+      {
+      }
+
+      bool operator()(Size a, Size b) const
+      {
+        return mz_[a] < mz_[b];
+      }
+
+      const vector<double>& mz_;
+    };
+
+    /// appends a flat array to the stream
+    template <typename T>
+    void writeArray_(std::ofstream& ofs, const vector<T>& data)
+    {
+      Size n = data.size();
+      ofs.write((const char*) &n, sizeof(n));
+      if (n > 0)
+      {
+        ofs.write((const char*) &data[0], n * sizeof(T));
+      }
+    }
+
+    /// reads a flat array from a memory mapped buffer, advancing @p pos
+    template <typename T>
+    void readArray_(const char* data, Size data_size, Size& pos, vector<T>& result, const String& filename)
+    {
+      Size n = 0;
+      if (pos + sizeof(n) > data_size)
+      {
+        throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename, "Unexpected end of spectral library index.");
+      }
+      std::memcpy(&n, data + pos, sizeof(n));
+      pos += sizeof(n);
+      if (n > (data_size - pos) / sizeof(T))
+      {
+        throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename, "Unexpected end of spectral library index.");
+      }
+      result.resize(n);
+      if (n > 0)
+      {
+        std::memcpy(&result[0], data + pos, n * sizeof(T));
+      }
+      pos += n * sizeof(T);
+    }
+
+    /// checks that @p offsets start at 0 or later, never decrease and end at @p end (if not empty)
+    bool validOffsets_(const vector<Size>& offsets, Size end)
+    {
+      Size previous = 0;
+      for (Size i = 0; i < offsets.size(); ++i)
+      {
+        if (offsets[i] < previous || offsets[i] > end)
+        {
+          return false;
+        }
+        previous = offsets[i];
+      }
+      return offsets.empty() || offsets.back() == end;
+    }
+
+    /// reorders @p data according to @p order
+    template <typename T>
+    void permute_(vector<T>& data, const vector<Size>& order)
+    {
+      vector<T> tmp;
+      tmp.reserve(data.size());
+      for (Size i = 0; i < order.size(); ++i)
+      {
+        tmp.push_back(data[order[i]]);
+      }
+      data.swap(tmp);
+    }
+  }
+
+  SpectralLibraryIndex::SpectralLibraryIndex() :
+    tag_(),
+    peak_offset_(1, 0)
+  {
+  }
+
+  SpectralLibraryIndex::~SpectralLibraryIndex()
+  {
+  }
+
+  void SpectralLibraryIndex::addEntry(const PeakSpectrum& spectrum, const PeptideHit& hit)
+  {
+    if (spectrum.getPrecursors().empty())
+    {
+      throw Exception::MissingInformation(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Library spectrum without precursor information.");
+    }
+    precursor_mz_.push_back(spectrum.getPrecursors()[0].getMZ());
+    rt_.push_back(spectrum.getRT());
+    charge_.push_back(hit.getCharge());
+    sequence_.push_back(hit.getSequence().toString());
+    for (Size i = 0; i < spectrum.size(); ++i)
+    {
+      peak_mz_.push_back(spectrum[i].getMZ());
+      peak_intensity_.push_back(spectrum[i].getIntensity());
+    }
+    peak_offset_.push_back(peak_mz_.size());
+  }
+
+  void SpectralLibraryIndex::sortByPrecursorMZ()
+  {
+    vector<Size> order(size());
+    for (Size i = 0; i < order.size(); ++i)
+    {
+      order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), PrecursorMZLess_(precursor_mz_));
+
+    // rebuild the peak arrays in the new entry order
+    vector<Size> offset(1, 0);
+    offset.reserve(peak_offset_.size());
+    vector<double> mz;
+    mz.reserve(peak_mz_.size());
+    vector<float> intensity;
+    intensity.reserve(peak_intensity_.size());
+    for (Size i = 0; i < order.size(); ++i)
+    {
+      mz.insert(mz.end(), peak_mz_.begin() + peak_offset_[order[i]], peak_mz_.begin() + peak_offset_[order[i] + 1]);
+      intensity.insert(intensity.end(), peak_intensity_.begin() + peak_offset_[order[i]], peak_intensity_.begin() + peak_offset_[order[i] + 1]);
+      offset.push_back(mz.size());
+    }
+    peak_offset_.swap(offset);
+    peak_mz_.swap(mz);
+    peak_intensity_.swap(intensity);
+
+    permute_(precursor_mz_, order);
+    permute_(rt_, order);
+    permute_(charge_, order);
+    permute_(sequence_, order);
+  }
+
+  void SpectralLibraryIndex::clear()
+  {
+    tag_.clear();
+    precursor_mz_.clear();
+    rt_.clear();
+    charge_.clear();
+    sequence_.clear();
+    peak_offset_.assign(1, 0);
+    peak_mz_.clear();
+    peak_intensity_.clear();
+  }
+
+  Size SpectralLibraryIndex::size() const
+  {
+    return precursor_mz_.size();
+  }
+
+  bool SpectralLibraryIndex::empty() const
+  {
+    return precursor_mz_.empty();
+  }
+
+  void SpectralLibraryIndex::getEntriesInRange(double min_mz, double max_mz, Size& first, Size& last) const
+  {
+    first = std::lower_bound(precursor_mz_.begin(), precursor_mz_.end(), min_mz) - precursor_mz_.begin();
+    last = std::upper_bound(precursor_mz_.begin() + first, precursor_mz_.end(), max_mz) - precursor_mz_.begin();
+  }
+
+  double SpectralLibraryIndex::getPrecursorMZ(Size index) const
+  {
+    return precursor_mz_[index];
+  }
+
+  double SpectralLibraryIndex::getRT(Size index) const
+  {
+    return rt_[index];
+  }
+
+  Int SpectralLibraryIndex::getCharge(Size index) const
+  {
+    return charge_[index];
+  }
+
+  void SpectralLibraryIndex::getSpectrum(Size index, PeakSpectrum& spectrum) const
+  {
+    spectrum.clear(true);
+    spectrum.setRT(rt_[index]);
+    vector<Precursor> precursors(1);
+    precursors[0].setMZ(precursor_mz_[index]);
+    precursors[0].setCharge(charge_[index]);
+    spectrum.setPrecursors(precursors);
+    spectrum.reserve(peak_offset_[index + 1] - peak_offset_[index]);
+    for (Size i = peak_offset_[index]; i < peak_offset_[index + 1]; ++i)
+    {
+      Peak1D peak;
+      peak.setMZ(peak_mz_[i]);
+      peak.setIntensity(peak_intensity_[i]);
+      spectrum.push_back(peak);
+    }
+  }
+
+  PeptideHit SpectralLibraryIndex::getPeptideHit(Size index) const
+  {
+    return PeptideHit(0, 0, charge_[index], AASequence::fromString(sequence_[index]));
+  }
+
+  void SpectralLibraryIndex::setTag(const String& tag)
+  {
+    tag_ = tag;
+  }
+
+  const String& SpectralLibraryIndex::getTag() const
+  {
+    return tag_;
+  }
+
+  void SpectralLibraryIndex::store(const String& filename) const
+  {
+    std::ofstream ofs(filename.c_str(), std::ios::binary);
+    if (!ofs)
+    {
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+    }
+    int identifier = SPECTRAL_LIBRARY_INDEX_IDENTIFIER;
+    ofs.write((const char*) &identifier, sizeof(identifier));
+
+    vector<char> tag(tag_.begin(), tag_.end());
+    writeArray_(ofs, tag);
+    writeArray_(ofs, precursor_mz_);
+    writeArray_(ofs, rt_);
+    writeArray_(ofs, charge_);
+    writeArray_(ofs, peak_offset_);
+    writeArray_(ofs, peak_mz_);
+    writeArray_(ofs, peak_intensity_);
+
+    // sequences are stored as one concatenated string with their end offsets
+    vector<Size> sequence_end;
+    sequence_end.reserve(sequence_.size());
+    vector<char> sequences;
+    for (Size i = 0; i < sequence_.size(); ++i)
+    {
+      sequences.insert(sequences.end(), sequence_[i].begin(), sequence_[i].end());
+      sequence_end.push_back(sequences.size());
+    }
+    writeArray_(ofs, sequence_end);
+    writeArray_(ofs, sequences);
+
+    if (!ofs)
+    {
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+    }
+  }
+
+  void SpectralLibraryIndex::load(const String& filename)
+  {
+    if (!File::exists(filename))
+    {
+      throw Exception::FileNotFound(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+    }
+    if (File::empty(filename))
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename, "Spectral library index is empty.");
+    }
+
+    boost::iostreams::mapped_file_source file(filename);
+    const char* data = file.data();
+    Size data_size = file.size();
+    Size pos = 0;
+
+    int identifier = 0;
+    if (data_size >= sizeof(identifier))
+    {
+      std::memcpy(&identifier, data, sizeof(identifier));
+      pos += sizeof(identifier);
+    }
+    if (identifier != SPECTRAL_LIBRARY_INDEX_IDENTIFIER)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename, "File is not a spectral library index.");
+    }
+
+    clear();
+    vector<char> tag;
+    readArray_(data, data_size, pos, tag, filename);
+    tag_ = String(std::string(tag.begin(), tag.end()));
+    readArray_(data, data_size, pos, precursor_mz_, filename);
+    readArray_(data, data_size, pos, rt_, filename);
+    readArray_(data, data_size, pos, charge_, filename);
+    readArray_(data, data_size, pos, peak_offset_, filename);
+    readArray_(data, data_size, pos, peak_mz_, filename);
+    readArray_(data, data_size, pos, peak_intensity_, filename);
+
+    vector<Size> sequence_end;
+    vector<char> sequences;
+    readArray_(data, data_size, pos, sequence_end, filename);
+    readArray_(data, data_size, pos, sequences, filename);
+
+    // every offset is checked, so the accessors can index the arrays without bounds checks
+    Size n = precursor_mz_.size();
+    if (rt_.size() != n || charge_.size() != n || sequence_end.size() != n ||
+        peak_offset_.size() != n + 1 || peak_offset_.front() != 0 ||
+        !validOffsets_(peak_offset_, peak_mz_.size()) || peak_mz_.size() != peak_intensity_.size() ||
+        !validOffsets_(sequence_end, sequences.size()) ||
+        std::adjacent_find(precursor_mz_.begin(), precursor_mz_.end(), std::greater<double>()) != precursor_mz_.end())
+    {
+      clear();
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename, "Inconsistent spectral library index.");
+    }
+
+    sequence_.reserve(n);
+    Size begin = 0;
+    for (Size i = 0; i < n; ++i)
+    {
+      sequence_.push_back(String(std::string(sequences.begin() + begin, sequences.begin() + sequence_end[i])));
+      begin = sequence_end[i];
+    }
+  }
+
+} // namespace OpenMS
@@ -22,6 +22,7 @@ IDDecoyProbability.cpp
 MetaboliteSpectralMatching.cpp
 PeptideProteinResolution.cpp
 ProtonDistributionModel.cpp
+SpectralLibraryIndex.cpp
 PeptideIndexing.cpp
 )
 
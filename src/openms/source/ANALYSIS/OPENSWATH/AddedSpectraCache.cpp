@@ -0,0 +1,219 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2016.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/ANALYSIS/OPENSWATH/AddedSpectraCache.h>
+
+namespace OpenMS
+{
+
+  bool AddedSpectraCache::Key::operator<(const Key& rhs) const
+  {
+    if (swath_map != rhs.swath_map) return swath_map < rhs.swath_map;
+    if (scan_index != rhs.scan_index) return scan_index < rhs.scan_index;
+    if (nr_spectra_to_add != rhs.nr_spectra_to_add) return nr_spectra_to_add < rhs.nr_spectra_to_add;
+    if (spacing != rhs.spacing) return spacing < rhs.spacing;
+    return addition_method < rhs.addition_method;
+  }
+
+  AddedSpectraCache::AddedSpectraCache(Size max_points) :
+    max_points_(max_points),
+    nr_points_(0),
+    hits_(0),
+    misses_(0)
+  {
+  }
+
+  AddedSpectraCache::~AddedSpectraCache()
+  {
+  }
+
+  AddedSpectraCache::Key AddedSpectraCache::createKey_(const OpenSwath::SpectrumAccessPtr& swath_map,
+                                                       int scan_index, int nr_spectra_to_add, double spacing,
+                                                       const std::string& addition_method)
+  {
+    Key key;
+    key.swath_map = swath_map.get();
+    key.scan_index = scan_index;
+    key.nr_spectra_to_add = nr_spectra_to_add;
+    key.spacing = spacing;
+    key.addition_method = addition_method;
+    return key;
+  }
+
+  void AddedSpectraCache::erase_(EntryList::iterator it)
+  {
+    nr_points_ -= it->nr_points;
+    index_.erase(it->key);
+    entries_.erase(it);
+  }
+
+  bool AddedSpectraCache::lookup(const OpenSwath::SpectrumAccessPtr& swath_map, int scan_index,
+                                 int nr_spectra_to_add, double spacing, const std::string& addition_method,
+                                 OpenSwath::SpectrumPtr& spectrum)
+  {
+    const Key key = createKey_(swath_map, scan_index, nr_spectra_to_add, spacing, addition_method);
+    bool found = false;
+#ifdef _OPENMP
+#pragma omp critical (OPENMS_AddedSpectraCache)
+#endif
+    {
+      std::map<Key, EntryList::iterator>::iterator it = index_.find(key);
+      if (it != index_.end())
+      {
+        EntryList::iterator entry = it->second;
+        // the address of a destroyed map may have been reused by a new map
+        if (entry->swath_map.lock() == swath_map)
+        {
+          // move to the front (most recently used)
+          entries_.splice(entries_.begin(), entries_, entry);
+          spectrum = entry->spectrum;
+          found = true;
+        }
+        else
+        {
+          erase_(entry);
+        }
+      }
+
+      if (found)
+      {
+        ++hits_;
+      }
+      else
+      {
+        ++misses_;
+      }
+    }
+    return found;
+  }
+
+  void AddedSpectraCache::insert(const OpenSwath::SpectrumAccessPtr& swath_map, int scan_index,
+                                 int nr_spectra_to_add, double spacing, const std::string& addition_method,
+                                 const OpenSwath::SpectrumPtr& spectrum)
+  {
+    const Key key = createKey_(swath_map, scan_index, nr_spectra_to_add, spacing, addition_method);
+    const Size nr_points = spectrum->getMZArray()->data.size();
+    if (nr_points > max_points_)
+    {
+      return;
+    }
+
+#ifdef _OPENMP
+#pragma omp critical (OPENMS_AddedSpectraCache)
+#endif
+    {
+      // another thread may have computed the same spectrum in the meantime
+      std::map<Key, EntryList::iterator>::iterator it = index_.find(key);
+      if (it != index_.end())
+      {
+        erase_(it->second);
+      }
+
+      // evict least recently used spectra
+      while (!entries_.empty() && nr_points_ + nr_points > max_points_)
+      {
+        erase_(--entries_.end());
+      }
+
+      Entry entry;
+      entry.key = key;
+      entry.swath_map = swath_map;
+      entry.spectrum = spectrum;
+      entry.nr_points = nr_points;
+      entries_.push_front(entry);
+      index_[key] = entries_.begin();
+      nr_points_ += nr_points;
+    }
+  }
+
+  void AddedSpectraCache::clear()
+  {
+#ifdef _OPENMP
+#pragma omp critical (OPENMS_AddedSpectraCache)
+#endif
+    {
+      entries_.clear();
+      index_.clear();
+      nr_points_ = 0;
+      hits_ = 0;
+      misses_ = 0;
+    }
+  }
+
+  Size AddedSpectraCache::getHits() const
+  {
+    Size hits;
+#ifdef _OPENMP
+#pragma omp critical (OPENMS_AddedSpectraCache)
+#endif
+    hits = hits_;
+    return hits;
+  }
+
+  Size AddedSpectraCache::getMisses() const
+  {
+    Size misses;
+#ifdef _OPENMP
+#pragma omp critical (OPENMS_AddedSpectraCache)
+#endif
+    misses = misses_;
+    return misses;
+  }
+
+  Size AddedSpectraCache::size() const
+  {
+    Size size;
+#ifdef _OPENMP
+#pragma omp critical (OPENMS_AddedSpectraCache)
+#endif
+    size = entries_.size();
+    return size;
+  }
+
+  Size AddedSpectraCache::getNrPoints() const
+  {
+    Size nr_points;
+#ifdef _OPENMP
+#pragma omp critical (OPENMS_AddedSpectraCache)
+#endif
+    nr_points = nr_points_;
+    return nr_points;
+  }
+
+  Size AddedSpectraCache::getMaxPoints() const
+  {
+    return max_points_;
+  }
+
+}
@@ -36,6 +36,8 @@
 
 #include <OpenMS/FORMAT/CachedMzML.h>
 
+#include <QtCore/QMutexLocker>
+
 namespace OpenMS
 {
 
@@ -66,6 +68,7 @@ namespace OpenMS
     meta_ms_experiment_(rhs.meta_ms_experiment_),
     ifs_(rhs.filename_cached_.c_str(), std::ios::binary),
     filename_(rhs.filename_),
+    filename_cached_(rhs.filename_cached_),
     spectra_index_(rhs.spectra_index_),
     chrom_index_(rhs.chrom_index_)
   {
@@ -86,6 +89,7 @@ namespace OpenMS
     int ms_level = -1;
     double rt = -1.0;
 
+    QMutexLocker locker(&ifs_mutex_);
     if ( !ifs_.seekg(spectra_index_[id]) )
     {
       std::cerr << "Error while reading spectrum " << id << " - seekg created an error when trying to change position to " << spectra_index_[id] << "." << std::endl;
@@ -95,6 +99,7 @@ namespace OpenMS
     }
 
     CachedmzML::readSpectrumFast(mz_array, intensity_array, ifs_, ms_level, rt);
+    locker.unlock();
 
     OpenSwath::SpectrumPtr sptr(new OpenSwath::Spectrum);
     sptr->setMZArray(mz_array);
@@ -121,6 +126,7 @@ namespace OpenMS
     OpenSwath::BinaryDataArrayPtr rt_array(new OpenSwath::BinaryDataArray);
     OpenSwath::BinaryDataArrayPtr intensity_array(new OpenSwath::BinaryDataArray);
 
+    QMutexLocker locker(&ifs_mutex_);
     if ( !ifs_.seekg(chrom_index_[id]) )
     {
       std::cerr << "Error while reading chromatogram " << id << " - seekg created an error when trying to change position to " << chrom_index_[id] << "." << std::endl;
@@ -130,6 +136,7 @@ namespace OpenMS
     }
 
     CachedmzML::readChromatogramFast(rt_array, intensity_array, ifs_);
+    locker.unlock();
 
     OpenSwath::ChromatogramPtr cptr(new OpenSwath::Chromatogram);
     cptr->setTimeArray(rt_array);
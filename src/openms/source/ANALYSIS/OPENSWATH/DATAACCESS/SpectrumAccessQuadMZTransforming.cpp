@@ -39,8 +39,8 @@ namespace OpenMS
 
   SpectrumAccessQuadMZTransforming::SpectrumAccessQuadMZTransforming(
       OpenSwath::SpectrumAccessPtr sptr,
-      double a, double b, double c, bool ppm) :
-        SpectrumAccessTransforming(sptr), 
+      double a, double b, double c, bool ppm, bool cache_spectra) :
+        SpectrumAccessTransforming(sptr, cache_spectra), 
         a_(a), 
         b_(b), 
         c_(c), 
@@ -53,30 +53,36 @@ namespace OpenMS
     {
       // Create a light clone of *this by initializing a new
       // SpectrumAccessQuadMZTransforming with a light clone of the underlying
-      // SpectrumAccess object and the parameters.
-      return boost::shared_ptr<SpectrumAccessQuadMZTransforming>(
+      // SpectrumAccess object and the parameters. The clone shares the cache
+      // of transformed spectra with *this.
+      boost::shared_ptr<SpectrumAccessQuadMZTransforming> clone(
           new SpectrumAccessQuadMZTransforming(sptr_->lightClone(), a_, b_, c_, ppm_));
+      clone->shareCache_(*this);
+      return clone;
     }
 
-    OpenSwath::SpectrumPtr SpectrumAccessQuadMZTransforming::getSpectrumById(int id)
+    OpenSwath::SpectrumPtr SpectrumAccessQuadMZTransforming::transformSpectrum_(const OpenSwath::SpectrumPtr& spectrum) const
     {
-      OpenSwath::SpectrumPtr s = sptr_->getSpectrumById(id);
-      for (size_t i = 0; i < s->getMZArray()->data.size(); i++)
-      {
-        // mz = a + b * mz + c * mz^2
-        double predict = 
-          a_ + 
-          b_ * s->getMZArray()->data[i] +
-          c_ * s->getMZArray()->data[i] * s->getMZArray()->data[i];
+      OpenSwath::SpectrumPtr s = getWritableMZArray_(spectrum);
+      std::vector<double>& mz = s->getMZArray()->data;
+      const double a = a_, b = b_, c = c_;
 
+      // mz = a + b * mz + c * mz^2
+      // The branch is kept out of the loops so that they can be vectorized.
+      if (ppm_)
+      {
         // If ppm is true, we predicted the ppm deviation, not the actual new mass
-        if (ppm_)
+        for (std::size_t i = 0; i < mz.size(); ++i)
         {
-          s->getMZArray()->data[i] = s->getMZArray()->data[i] - predict*s->getMZArray()->data[i]/1000000;
+          double predict = a + b * mz[i] + c * mz[i] * mz[i];
+          mz[i] = mz[i] - predict * mz[i] / 1000000;
         }
-        else
+      }
+      else
+      {
+        for (std::size_t i = 0; i < mz.size(); ++i)
         {
-          s->getMZArray()->data[i] = predict;
+          mz[i] = a + b * mz[i] + c * mz[i] * mz[i];
         }
       }
       return s;
@@ -34,12 +34,20 @@
 
 #include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessTransforming.h>
 
+#include <QtCore/QMutexLocker>
+
 namespace OpenMS
 {
 
-  SpectrumAccessTransforming::SpectrumAccessTransforming(OpenSwath::SpectrumAccessPtr sptr) :
+  SpectrumAccessTransforming::SpectrumAccessTransforming(OpenSwath::SpectrumAccessPtr sptr, bool cache_spectra) :
     sptr_(sptr)
-  {}
+  {
+    if (cache_spectra)
+    {
+      spectra_cache_ = boost::shared_ptr<SpectraCache>(new SpectraCache());
+      spectra_cache_->spectra.resize(sptr_->getNrSpectra());
+    }
+  }
 
   SpectrumAccessTransforming::~SpectrumAccessTransforming() {}
 
@@ -51,7 +59,65 @@ namespace OpenMS
 
   OpenSwath::SpectrumPtr SpectrumAccessTransforming::getSpectrumById(int id)
   {
-    return sptr_->getSpectrumById(id);
+    if (!spectra_cache_)
+    {
+      return transformSpectrum_(sptr_->getSpectrumById(id));
+    }
+
+    {
+      QMutexLocker locker(&spectra_cache_->mutex);
+      if (spectra_cache_->spectra[id])
+      {
+        return spectra_cache_->spectra[id];
+      }
+    }
+
+    // transform outside of the lock, if another thread was faster we use its result
+    OpenSwath::SpectrumPtr transformed = transformSpectrum_(sptr_->getSpectrumById(id));
+    QMutexLocker locker(&spectra_cache_->mutex);
+    if (!spectra_cache_->spectra[id])
+    {
+      spectra_cache_->spectra[id] = transformed;
+    }
+    return spectra_cache_->spectra[id];
+  }
+
+  bool SpectrumAccessTransforming::isCaching() const
+  {
+    return bool(spectra_cache_);
+  }
+
+  void SpectrumAccessTransforming::clearCache()
+  {
+    if (!spectra_cache_)
+    {
+      return;
+    }
+    QMutexLocker locker(&spectra_cache_->mutex);
+    std::vector<OpenSwath::SpectrumPtr>(spectra_cache_->spectra.size()).swap(spectra_cache_->spectra);
+  }
+
+  OpenSwath::SpectrumPtr SpectrumAccessTransforming::transformSpectrum_(const OpenSwath::SpectrumPtr& spectrum) const
+  {
+    return spectrum;
+  }
+
+  OpenSwath::SpectrumPtr SpectrumAccessTransforming::getWritableMZArray_(const OpenSwath::SpectrumPtr& spectrum)
+  {
+    // the caller holds one reference to the spectrum, the spectrum holds one
+    // to its m/z array: nobody else can see the data
+    if (spectrum.use_count() == 1 && spectrum->getMZArray().use_count() == 2)
+    {
+      return spectrum;
+    }
+    OpenSwath::SpectrumPtr copy(new OpenSwath::Spectrum(*spectrum));
+    copy->setMZArray(OpenSwath::BinaryDataArrayPtr(new OpenSwath::BinaryDataArray(*spectrum->getMZArray())));
+    return copy;
+  }
+
+  void SpectrumAccessTransforming::shareCache_(const SpectrumAccessTransforming& rhs)
+  {
+    spectra_cache_ = rhs.spectra_cache_;
   }
 
   OpenSwath::SpectrumMeta SpectrumAccessTransforming::getSpectrumMetaById(int id) const
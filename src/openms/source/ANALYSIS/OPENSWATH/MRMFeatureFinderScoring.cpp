@@ -95,6 +95,8 @@ namespace OpenMS
     defaults_.setMinInt("add_up_spectra", 1);
     defaults_.setValue("spacing_for_spectra_resampling", 0.005, "If spectra are to be added, use this spacing to add them up", ListUtils::create<String>("advanced"));
     defaults_.setMinFloat("spacing_for_spectra_resampling", 0.0);
+    defaults_.setValue("spectra_addition_method", "resample", "How to add up spectra: 'resample' them onto a common grid with the given spacing or 'merge' them without resampling (peaks within the spacing are fused)", ListUtils::create<String>("advanced"));
+    defaults_.setValidStrings("spectra_addition_method", ListUtils::create<String>("resample,merge"));
     defaults_.setValue("uis_threshold_sn", -1, "S/N threshold to consider identification transition (set to -1 to consider all)");
     defaults_.setValue("uis_threshold_peak_area", 0, "Peak area threshold to consider identification transition (set to -1 to consider all)");
 
@@ -213,23 +215,30 @@ namespace OpenMS
     //
     // Step 3
     //
-    // Go through all transition groups: first create consensus features, then score them
-    Size progress = 0;
-    startProgress(0, transition_group_map.size(), "picking peaks");
+    // Go through all transition groups: first create consensus features (in
+    // parallel, each group is picked independently), then score them in the
+    // order of the map.
+    std::vector<MRMTransitionGroupType*> picked_groups;
+    picked_groups.reserve(transition_group_map.size());
     for (TransitionGroupMapType::iterator trgroup_it = transition_group_map.begin(); trgroup_it != transition_group_map.end(); ++trgroup_it)
     {
-
-      setProgress(++progress);
       MRMTransitionGroupType& transition_group = trgroup_it->second;
       if (transition_group.getChromatograms().size() == 0 || transition_group.getTransitions().size() == 0)
       {
         continue;
       }
+      picked_groups.push_back(&transition_group);
+    }
+
+    MRMTransitionGroupPicker trgroup_picker;
+    trgroup_picker.setParameters(param_.copy("TransitionGroupPicker:", true));
+    trgroup_picker.pickTransitionGroups(picked_groups);
 
-      MRMTransitionGroupPicker trgroup_picker;
-      trgroup_picker.setParameters(param_.copy("TransitionGroupPicker:", true));
-      trgroup_picker.pickTransitionGroup(transition_group);
-      scorePeakgroups(trgroup_it->second, trafo, swath_maps, output);
+    startProgress(0, picked_groups.size(), "scoring peak groups");
+    for (Size i = 0; i < picked_groups.size(); ++i)
+    {
+      setProgress(i + 1);
+      scorePeakgroups(*picked_groups[i], trafo, swath_maps, output);
     }
     endProgress();
 
@@ -415,7 +424,8 @@ namespace OpenMS
     expected_rt = newtr.apply(expected_rt);
 
     OpenSwathScoring scorer;
-    scorer.initialize(rt_normalization_factor_, add_up_spectra_, spacing_for_spectra_resampling_, su_);
+    scorer.initialize(rt_normalization_factor_, add_up_spectra_, spacing_for_spectra_resampling_, su_, spectra_addition_method_);
+    scorer.setAddedSpectraCache(spectra_cache_, spectra_cache_map_ids_);
 
     size_t feature_idx = 0;
     // Go through all peak groups (found MRM features) and score them
@@ -690,6 +700,7 @@ namespace OpenMS
     write_convex_hull_ = param_.getValue("write_convex_hull").toBool();
     add_up_spectra_ = param_.getValue("add_up_spectra");
     spacing_for_spectra_resampling_ = param_.getValue("spacing_for_spectra_resampling");
+    spectra_addition_method_ = param_.getValue("spectra_addition_method");
     uis_threshold_sn_ = param_.getValue("uis_threshold_sn");
     uis_threshold_peak_area_ = param_.getValue("uis_threshold_peak_area");
 
@@ -55,7 +55,8 @@ namespace OpenMS
   OpenSwathScoring::OpenSwathScoring() :
     rt_normalization_factor_(1.0),
     add_up_spectra_(1),
-    spacing_for_spectra_resampling_(0.005)
+    spacing_for_spectra_resampling_(0.005),
+    spectra_addition_method_("resample")
   {
   }
 
@@ -66,12 +67,19 @@ namespace OpenMS
 
   void OpenSwathScoring::initialize(double rt_normalization_factor,
     int add_up_spectra, double spacing_for_spectra_resampling,
-    OpenSwath_Scores_Usage & su)
+    OpenSwath_Scores_Usage & su, const std::string& spectra_addition_method)
   {
     this->rt_normalization_factor_ = rt_normalization_factor;
     this->add_up_spectra_ = add_up_spectra;
     this->spacing_for_spectra_resampling_ = spacing_for_spectra_resampling;
     this->su_ = su;
+    this->spectra_addition_method_ = spectra_addition_method;
+  }
+
+  void OpenSwathScoring::setAddedSpectraCache(AddedSpectraCachePtr spectra_cache, const AddedSpectraCache::MapIdentities& map_ids)
+  {
+    spectra_cache_ = spectra_cache;
+    cache_map_ids_ = map_ids;
   }
 
   void OpenSwathScoring::calculateDIAScores(OpenSwath::IMRMFeature* imrmfeature,
@@ -339,6 +347,15 @@ namespace OpenMS
     OpenSwath::Scoring::normalize_sum(&normalized_library_intensity[0], boost::numeric_cast<int>(normalized_library_intensity.size()));
   }
 
+  OpenSwath::SpectrumPtr OpenSwathScoring::addUpSpectra_(const std::vector<OpenSwath::SpectrumPtr>& all_spectra)
+  {
+    if (spectra_addition_method_ == "merge")
+    {
+      return SpectrumAddition::mergeSpectra(all_spectra, spacing_for_spectra_resampling_, true);
+    }
+    return SpectrumAddition::addUpSpectra(all_spectra, spacing_for_spectra_resampling_, true);
+  }
+
   OpenSwath::SpectrumPtr OpenSwathScoring::getAddedSpectra_(std::vector<OpenSwath::SwathMap> swath_maps,
                                                             double RT, int nr_spectra_to_add)
   {
@@ -354,7 +371,7 @@ namespace OpenMS
         OpenSwath::SpectrumPtr spec = getAddedSpectra_(swath_maps[i].sptr, RT, nr_spectra_to_add);
         all_spectra.push_back(spec);
       }
-      OpenSwath::SpectrumPtr spectrum_ = SpectrumAddition::addUpSpectra(all_spectra, spacing_for_spectra_resampling_, true);
+      OpenSwath::SpectrumPtr spectrum_ = addUpSpectra_(all_spectra);
       return spectrum_;
     }
   }
@@ -383,6 +400,23 @@ namespace OpenMS
     }
     else
     {
+      // neighboring peak groups often share the same apex scan
+      OpenSwath::SpectrumAccessPtr cache_map_id;
+      if (spectra_cache_)
+      {
+        AddedSpectraCache::MapIdentities::const_iterator id_it = cache_map_ids_.find(swath_map.get());
+        if (id_it != cache_map_ids_.end())
+        {
+          cache_map_id = id_it->second;
+        }
+      }
+      OpenSwath::SpectrumPtr spectrum_;
+      if (cache_map_id && spectra_cache_->lookup(cache_map_id, closest_idx, nr_spectra_to_add, spacing_for_spectra_resampling_,
+                                                 spectra_addition_method_, spectrum_))
+      {
+        return spectrum_;
+      }
+
       std::vector<OpenSwath::SpectrumPtr> all_spectra;
       // always add the spectrum 0, then add those right and left
       all_spectra.push_back(swath_map->getSpectrumById(closest_idx));
@@ -397,7 +431,12 @@ namespace OpenMS
           all_spectra.push_back(swath_map->getSpectrumById(closest_idx + i));
         }
       }
-      OpenSwath::SpectrumPtr spectrum_ = SpectrumAddition::addUpSpectra(all_spectra, spacing_for_spectra_resampling_, true);
+      spectrum_ = addUpSpectra_(all_spectra);
+      if (cache_map_id)
+      {
+        spectra_cache_->insert(cache_map_id, closest_idx, nr_spectra_to_add, spacing_for_spectra_resampling_,
+                               spectra_addition_method_, spectrum_);
+      }
       return spectrum_;
     }
   }
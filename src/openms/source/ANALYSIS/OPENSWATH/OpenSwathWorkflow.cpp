@@ -48,7 +48,8 @@ namespace OpenMS
     const Param & irt_detection_param,
     const String & mz_correction_function,
     Size debug_level,
-    bool sonar)
+    bool sonar,
+    bool cache_corrected_spectra)
   {
     LOG_DEBUG << "performRTNormalization method starting" << std::endl;
     std::vector< OpenMS::MSChromatogram<> > irt_chromatograms;
@@ -77,7 +78,8 @@ namespace OpenMS
     // perform RT and m/z correction on the data
     TransformationDescription tr = RTNormalization(irt_transitions,
         irt_chromatograms, min_rsq, min_coverage, feature_finder_param,
-        irt_detection_param, swath_maps, mz_correction_function, cp_irt.mz_extraction_window, cp_irt.ppm);
+        irt_detection_param, swath_maps, mz_correction_function, cp_irt.mz_extraction_window, cp_irt.ppm,
+        cache_corrected_spectra);
     return tr;
   }
 
@@ -91,7 +93,8 @@ namespace OpenMS
     std::vector< OpenSwath::SwathMap > & swath_maps,
     const String & mz_correction_function,
     double mz_extraction_window,
-    bool ppm)
+    bool ppm,
+    bool cache_corrected_spectra)
   {
     LOG_DEBUG << "Start of RTNormalization method" << std::endl;
     this->startProgress(0, 1, "Retention time normalization");
@@ -248,7 +251,7 @@ namespace OpenMS
 
     // 6. Correct m/z deviations using SwathMapMassCorrection
     SwathMapMassCorrection::correctMZ(trgrmap_final, swath_maps,
-        mz_correction_function, mz_extraction_window, ppm);
+        mz_correction_function, mz_extraction_window, ppm, cache_corrected_spectra);
 
     // 7. store transformation, using a linear model as default
     TransformationDescription trafo_out;
@@ -392,7 +395,8 @@ namespace OpenMS
     OpenSwathTSVWriter & tsv_writer,
     Interfaces::IMSDataConsumer<> * chromConsumer,
     int batchSize,
-    bool load_into_memory)
+    bool load_into_memory,
+    Size prefetch_memory_budget)
   {
     tsv_writer.writeHeader();
 
@@ -404,6 +408,28 @@ namespace OpenMS
     int progress = 0;
     this->startProgress(0, swath_maps.size(), "Extracting and scoring transitions");
 
+    // Start loading the SWATH maps which contain transitions into memory in
+    // the background (in the order in which they will be processed) such
+    // that I/O overlaps with extraction and scoring of the previous maps.
+    boost::shared_ptr<SwathMapPrefetcher> prefetcher;
+    if (prefetch_memory_budget > 0)
+    {
+      std::vector<Size> load_order;
+      for (Size i = 0; i < swath_maps.size(); ++i)
+      {
+        if (swath_maps[i].ms1) {continue;}
+        OpenSwath::LightTargetedExperiment transition_exp_used;
+        OpenSwathHelper::selectSwathTransitions(transition_exp, transition_exp_used,
+            cp.min_upper_edge_dist, swath_maps[i].lower, swath_maps[i].upper);
+        if (!transition_exp_used.getTransitions().empty())
+        {
+          load_order.push_back(i);
+        }
+      }
+      prefetcher = boost::shared_ptr<SwathMapPrefetcher>(new SwathMapPrefetcher(swath_maps, load_order, prefetch_memory_budget));
+      prefetcher->start();
+    }
+
     // (i) Obtain precursor chromatograms (MS1) if precursor extraction is enabled
     std::map< std::string, OpenSwath::ChromatogramPtr > ms1_chromatograms;
     MS1Extraction_(swath_maps, ms1_chromatograms, chromConsumer, cp,
@@ -420,20 +446,25 @@ namespace OpenMS
     {
       if (!swath_maps[i].ms1) // skip MS1
       {
-        OpenSwath::SpectrumAccessPtr current_swath_map = swath_maps[i].sptr;
-
-        if (load_into_memory)
-        {
-          // This creates an InMemory object that keeps all data in memory
-          current_swath_map = boost::shared_ptr<SpectrumAccessOpenMSInMemory>( new SpectrumAccessOpenMSInMemory(*current_swath_map) );
-        }
-
         // Step 1: select which transitions to extract (proceed in batches)
         OpenSwath::LightTargetedExperiment transition_exp_used_all;
         OpenSwathHelper::selectSwathTransitions(transition_exp, transition_exp_used_all,
             cp.min_upper_edge_dist, swath_maps[i].lower, swath_maps[i].upper);
         if (transition_exp_used_all.getTransitions().size() > 0) // skip if no transitions found
         {
+          OpenSwath::SpectrumAccessPtr current_swath_map = swath_maps[i].sptr;
+
+          if (prefetcher)
+          {
+            // The map is loaded into memory by the prefetcher (or by this thread if
+            // the prefetcher has not started on it yet)
+            current_swath_map = prefetcher->acquire(i);
+          }
+          else if (load_into_memory)
+          {
+            // This creates an InMemory object that keeps all data in memory
+            current_swath_map = boost::shared_ptr<SpectrumAccessOpenMSInMemory>( new SpectrumAccessOpenMSInMemory(*current_swath_map) );
+          }
 
           int batch_size;
           if (batchSize <= 0 || batchSize >= (int)transition_exp_used_all.getCompounds().size())
@@ -487,7 +518,8 @@ namespace OpenMS
             OpenSwath::SwathMap dummy_map (swath_maps[i]);
             dummy_map.sptr = current_swath_map;
             dummy_maps.push_back(dummy_map);
-            scoreAllChromatograms(chromatogram_ptr, ms1_chromatograms, dummy_maps, transition_exp_used,
+            std::vector< OpenSwath::SpectrumAccessPtr > original_maps(1, swath_maps[i].sptr);
+            scoreAllChromatograms(chromatogram_ptr, ms1_chromatograms, dummy_maps, original_maps, transition_exp_used,
                 feature_finder_param, trafo, cp.rt_extraction_window, featureFile, tsv_writer);
 
             // Step 4: write all chromatograms and features out into an output object / file
@@ -502,10 +534,42 @@ namespace OpenMS
             }
           }
 
+          if (prefetcher)
+          {
+            prefetcher->release(i);
+          }
+
+          // the m/z corrected spectra of this window are not needed any more
+          clearCorrectedSpectra_(std::vector< OpenSwath::SwathMap >(1, swath_maps[i]));
         } // continue 2 (no continue due to OpenMP)
       } // continue 1 (no continue due to OpenMP)
     }
     this->endProgress();
+    reportAddedSpectraCache_();
+    clearCorrectedSpectra_(swath_maps);
+  }
+
+  void OpenSwathWorkflow::clearCorrectedSpectra_(const std::vector< OpenSwath::SwathMap > & swath_maps)
+  {
+    for (Size i = 0; i < swath_maps.size(); ++i)
+    {
+      SpectrumAccessTransforming* corrected_map = dynamic_cast<SpectrumAccessTransforming*>(swath_maps[i].sptr.get());
+      if (corrected_map != NULL)
+      {
+        corrected_map->clearCache();
+      }
+    }
+  }
+
+  void OpenSwathWorkflow::reportAddedSpectraCache_()
+  {
+    if (spectra_cache_->getHits() + spectra_cache_->getMisses() > 0)
+    {
+      LOG_DEBUG << "Cache of added up spectra: " << spectra_cache_->getHits() << " hits and "
+        << spectra_cache_->getMisses() << " misses." << std::endl;
+    }
+    // release the spectra of the current run
+    spectra_cache_->clear();
   }
 
   void OpenSwathWorkflow::writeOutFeaturesAndChroms_(
@@ -595,6 +659,7 @@ namespace OpenMS
     const OpenSwath::SpectrumAccessPtr input,
     const std::map< std::string, OpenSwath::ChromatogramPtr > & ms1_chromatograms,
     const std::vector< OpenSwath::SwathMap > swath_maps,
+    const std::vector< OpenSwath::SpectrumAccessPtr > & original_maps,
     OpenSwath::LightTargetedExperiment& transition_exp,
     const Param& feature_finder_param,
     TransformationDescription trafo,
@@ -612,6 +677,20 @@ namespace OpenMS
 
     MRMFeatureFinderScoring featureFinder;
 
+    // The cache of added up spectra is shared by all threads. Since the
+    // threads read from their own clones of the maps, spectra are cached
+    // under the original maps.
+    if (original_maps.size() != swath_maps.size())
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        String("Each swath map needs an original map"));
+    }
+    AddedSpectraCache::MapIdentities map_ids;
+    for (Size i = 0; i < swath_maps.size(); ++i)
+    {
+      map_ids[swath_maps[i].sptr.get()] = original_maps[i];
+    }
+
     // To ensure multi-threading safe access to the individual spectra, we
     // need to use a light clone of the spectrum access (if multiple threads
     // share a single filestream and call seek on it, chaos will ensue).
@@ -619,7 +698,9 @@ namespace OpenMS
     {
       OpenSwath::SpectrumAccessPtr threadsafe_ms1 = ms1_map_->lightClone();
       featureFinder.setMS1Map( threadsafe_ms1 );
+      map_ids[threadsafe_ms1.get()] = ms1_map_;
     }
+    featureFinder.setAddedSpectraCache(spectra_cache_, map_ids);
 
     MRMTransitionGroupPicker trgroup_picker;
 
@@ -955,6 +1036,7 @@ namespace OpenMS
         {
 
           std::vector< OpenSwath::SwathMap > used_maps;
+          std::vector< OpenSwath::SpectrumAccessPtr > original_maps;
           for (size_t i = 0; i < swath_maps.size(); ++i)
           {
             if (swath_maps[i].ms1) {continue;} // skip MS1
@@ -969,6 +1051,7 @@ namespace OpenMS
                                                                       swath_maps[i].upper << std::endl;
 #endif
               used_maps.push_back(swath_maps[i]);
+              original_maps.push_back(swath_maps[i].sptr);
             }
           }
 
@@ -1038,7 +1121,7 @@ namespace OpenMS
 
             // Step 3: score these extracted transitions
             FeatureMap featureFile;
-            scoreAllChromatograms(chromatogram_ptr, ms1_chromatograms, used_maps, transition_exp_used,
+            scoreAllChromatograms(chromatogram_ptr, ms1_chromatograms, used_maps, original_maps, transition_exp_used,
                 feature_finder_param, trafo, cp.rt_extraction_window, featureFile, tsv_writer);
 
             // Step 4: write all chromatograms and features out into an output object / file
@@ -1058,6 +1141,8 @@ namespace OpenMS
         this->setProgress(++progress);
       }
       this->endProgress();
+      reportAddedSpectraCache_();
+      clearCorrectedSpectra_(swath_maps);
     }
 
 
@@ -39,10 +39,13 @@
 #include <OpenMS/FILTERING/TRANSFORMERS/LinearResamplerAlign.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/DataAccessHelper.h>
 
+#include <queue>
+#include <functional>
+
 namespace OpenMS
 {
 
-  OpenSwath::SpectrumPtr SpectrumAddition::addUpSpectra(std::vector<OpenSwath::SpectrumPtr> all_spectra,
+  OpenSwath::SpectrumPtr SpectrumAddition::addUpSpectra(const std::vector<OpenSwath::SpectrumPtr>& all_spectra,
       double sampling_rate, bool filter_zeros)
   {
     if (all_spectra.size() == 1) return all_spectra[0];
@@ -81,15 +84,13 @@ namespace OpenMS
     // generate the resampled peaks at positions origin+i*spacing_
     int number_resampled_points = (max - min) / sampling_rate + 1;
     OpenSwath::SpectrumPtr resampled_peak_container(new OpenSwath::Spectrum);
-    resampled_peak_container->getMZArray()->data.resize(number_resampled_points);
-    resampled_peak_container->getIntensityArray()->data.resize(number_resampled_points);
-    std::vector<double>::iterator it = resampled_peak_container->getMZArray()->data.begin();
-    int cnt = 0;
-    while (it != resampled_peak_container->getMZArray()->data.end())
+    std::vector<double>& resampled_mz = resampled_peak_container->getMZArray()->data;
+    std::vector<double>& resampled_int = resampled_peak_container->getIntensityArray()->data;
+    resampled_mz.resize(number_resampled_points);
+    resampled_int.resize(number_resampled_points);
+    for (int i = 0; i < number_resampled_points; ++i)
     {
-      *it = min + cnt * sampling_rate; // set mz (intensity is zero already)
-      ++it;
-      ++cnt;
+      resampled_mz[i] = min + i * sampling_rate; // set mz (intensity is zero already)
     }
 
     LinearResamplerAlign lresampler;
@@ -107,26 +108,94 @@ namespace OpenMS
       );
     }
 
-    if (!filter_zeros)
-    {
-      return resampled_peak_container;
-    }
-    else
+    if (filter_zeros)
     {
-      OpenSwath::SpectrumPtr master_spectrum_filtered(new OpenSwath::Spectrum);
-      for (Size i = 0; i < resampled_peak_container->getIntensityArray()->data.size(); ++i)
+      // compact non-zero points in place, then release the (large) dense grid
+      Size nr_nonzero = 0;
+      for (Size i = 0; i < resampled_int.size(); ++i)
       {
-        if (resampled_peak_container->getIntensityArray()->data[i] > 0)
+        if (resampled_int[i] > 0)
         {
-          master_spectrum_filtered->getIntensityArray()->data.push_back(resampled_peak_container->getIntensityArray()->data[i]);
-          master_spectrum_filtered->getMZArray()->data.push_back(resampled_peak_container->getMZArray()->data[i]);
+          resampled_mz[nr_nonzero] = resampled_mz[i];
+          resampled_int[nr_nonzero] = resampled_int[i];
+          ++nr_nonzero;
         }
       }
-      return master_spectrum_filtered;
+      std::vector<double>(resampled_mz.begin(), resampled_mz.begin() + nr_nonzero).swap(resampled_mz);
+      std::vector<double>(resampled_int.begin(), resampled_int.begin() + nr_nonzero).swap(resampled_int);
+    }
+    return resampled_peak_container;
+  }
+
+  OpenSwath::SpectrumPtr SpectrumAddition::mergeSpectra(const std::vector<OpenSwath::SpectrumPtr>& all_spectra,
+      double mz_tolerance, bool filter_zeros)
+  {
+    if (all_spectra.size() == 1) return all_spectra[0];
+
+    OpenSwath::SpectrumPtr merged(new OpenSwath::Spectrum);
+    std::vector<double>& merged_mz = merged->getMZArray()->data;
+    std::vector<double>& merged_int = merged->getIntensityArray()->data;
+
+    // k-way merge of the (sorted) input spectra: heap of (m/z, (spectrum index, peak index))
+    typedef std::pair<double, std::pair<Size, Size> > HeapEntry;
+    std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<HeapEntry> > heap;
+    Size total_points = 0;
+    for (Size i = 0; i < all_spectra.size(); ++i)
+    {
+      const std::vector<double>& mz = all_spectra[i]->getMZArray()->data;
+      if (!mz.empty())
+      {
+        heap.push(std::make_pair(mz[0], std::make_pair(i, Size(0))));
+        total_points += mz.size();
+      }
+    }
+    merged_mz.reserve(total_points);
+    merged_int.reserve(total_points);
+
+    // peaks within mz_tolerance of the first peak of a group are fused into
+    // one peak (summed intensity at the intensity-weighted mean m/z)
+    double group_start_mz = 0.0, group_int = 0.0, group_weighted_mz = 0.0, group_mz = 0.0;
+    Size group_size = 0;
+    while (!heap.empty())
+    {
+      const Size spec_idx = heap.top().second.first;
+      const Size peak_idx = heap.top().second.second;
+      heap.pop();
+
+      const std::vector<double>& mz = all_spectra[spec_idx]->getMZArray()->data;
+      const double peak_mz = mz[peak_idx];
+      const double peak_int = all_spectra[spec_idx]->getIntensityArray()->data[peak_idx];
+      if (peak_idx + 1 < mz.size())
+      {
+        heap.push(std::make_pair(mz[peak_idx + 1], std::make_pair(spec_idx, peak_idx + 1)));
+      }
+
+      if (filter_zeros && peak_int <= 0) continue;
+
+      if (group_size > 0 && peak_mz - group_start_mz > mz_tolerance)
+      {
+        merged_mz.push_back(group_int > 0 ? group_weighted_mz / group_int : group_mz / group_size);
+        merged_int.push_back(group_int);
+        group_int = group_weighted_mz = group_mz = 0.0;
+        group_size = 0;
+      }
+      if (group_size == 0) group_start_mz = peak_mz;
+
+      group_int += peak_int;
+      group_weighted_mz += peak_mz * peak_int;
+      group_mz += peak_mz;
+      ++group_size;
+    }
+    if (group_size > 0)
+    {
+      merged_mz.push_back(group_int > 0 ? group_weighted_mz / group_int : group_mz / group_size);
+      merged_int.push_back(group_int);
     }
+
+    return merged;
   }
 
-  OpenMS::MSSpectrum<> SpectrumAddition::addUpSpectra(std::vector<OpenMS::MSSpectrum<> > all_spectra, double sampling_rate, bool filter_zeros)
+  OpenMS::MSSpectrum<> SpectrumAddition::addUpSpectra(const std::vector<OpenMS::MSSpectrum<> >& all_spectra, double sampling_rate, bool filter_zeros)
   {
     if (all_spectra.size() == 1) return all_spectra[0];
     if (all_spectra.empty()) return MSSpectrum<>();
@@ -167,31 +236,20 @@ namespace OpenMS
 
     // generate the resampled peaks at positions origin+i*spacing_
     int number_resampled_points = (max - min) / sampling_rate + 1;
-    MSSpectrum<> resampled_peak_container;
-    resampled_peak_container.resize(number_resampled_points);
-    MSSpectrum<>::iterator it = resampled_peak_container.begin();
+    MSSpectrum<> master_spectrum;
+    master_spectrum.resize(number_resampled_points);
     for (int i = 0; i < number_resampled_points; ++i)
     {
-      it->setMZ(min + i * sampling_rate);
-      it->setIntensity(0);
-      ++it;
+      master_spectrum[i].setMZ(min + i * sampling_rate);
+      master_spectrum[i].setIntensity(0);
     }
 
-    // resample all spectra and add to master spectrum
+    // resample all spectra and add to master spectrum (raster accumulates
+    // the intensities, so no intermediate spectrum per input is needed)
     LinearResamplerAlign lresampler;
-    MSSpectrum<> master_spectrum = resampled_peak_container;
     for (Size curr_sp = 0; curr_sp < all_spectra.size(); curr_sp++)
     {
-      MSSpectrum<> input_spectrum;
-      MSSpectrum<> output_spectrum = resampled_peak_container;
-
-      lresampler.raster(all_spectra[curr_sp].begin(), all_spectra[curr_sp].end(), output_spectrum.begin(), output_spectrum.end());
-
-      // add to master spectrum
-      for (Size i = 0; i < output_spectrum.size(); ++i)
-      {
-        master_spectrum[i].setIntensity(master_spectrum[i].getIntensity() + output_spectrum[i].getIntensity());
-      }
+      lresampler.raster(all_spectra[curr_sp].begin(), all_spectra[curr_sp].end(), master_spectrum.begin(), master_spectrum.end());
     }
 
     if (!filter_zeros)
@@ -200,7 +258,14 @@ namespace OpenMS
     }
     else
     {
+      Size nr_nonzero = 0;
+      for (Size i = 0; i < master_spectrum.size(); ++i)
+      {
+        if (master_spectrum[i].getIntensity() > 0) ++nr_nonzero;
+      }
+
       MSSpectrum<> master_spectrum_filtered;
+      master_spectrum_filtered.reserve(nr_nonzero);
       for (Size i = 0; i < master_spectrum.size(); ++i)
       {
         if (master_spectrum[i].getIntensity() > 0)
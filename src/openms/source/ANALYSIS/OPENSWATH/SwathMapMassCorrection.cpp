@@ -53,7 +53,8 @@ namespace OpenMS
     std::vector< OpenSwath::SwathMap > & swath_maps,
     std::string corr_type,
     double mz_extr_window,
-    bool ppm)
+    bool ppm,
+    bool cache_spectra)
   {
     LOG_DEBUG << "SwathMapMassCorrection::correctMZ with type " << corr_type << " and window " << mz_extr_window << " in ppm " << ppm << std::endl;
 
@@ -256,12 +257,15 @@ namespace OpenMS
     std::cout <<" sum residual sq ppm before " << s_ppm_before << " / after " << s_ppm_after << std::endl;
 #endif
 
-    // Replace the swath files with a transforming wrapper.
+    // Replace the swath files with a transforming wrapper. The MS1 map is
+    // needed for every window and is never cached (it would stay in memory
+    // for the whole run).
     for (SignedSize i = 0; i < boost::numeric_cast<SignedSize>(swath_maps.size()); ++i)
     {
       swath_maps[i].sptr = boost::shared_ptr<OpenSwath::ISpectrumAccess>(
         new SpectrumAccessQuadMZTransforming(swath_maps[i].sptr,
-          regression_params[0], regression_params[1], regression_params[2], is_ppm));
+          regression_params[0], regression_params[1], regression_params[2], is_ppm,
+          cache_spectra && !swath_maps[i].ms1));
     }
 
     LOG_DEBUG << "SwathMapMassCorrection::correctMZ done." << std::endl;
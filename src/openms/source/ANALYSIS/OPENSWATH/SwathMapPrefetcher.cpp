@@ -0,0 +1,200 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2016.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/ANALYSIS/OPENSWATH/SwathMapPrefetcher.h>
+
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessOpenMSInMemory.h>
+#include <OpenMS/CONCEPT/LogStream.h>
+
+#include <QtCore/QMutexLocker>
+
+namespace OpenMS
+{
+
+  SwathMapPrefetcher::SwathMapPrefetcher(const std::vector<OpenSwath::SwathMap>& swath_maps,
+                                         const std::vector<Size>& load_order, Size memory_budget) :
+    swath_maps_(swath_maps),
+    load_order_(load_order),
+    memory_budget_(memory_budget),
+    order_position_(swath_maps.size(), -1),
+    loaded_(swath_maps.size()),
+    memory_(swath_maps.size(), 0),
+    state_(swath_maps.size(), PENDING),
+    next_(0),
+    memory_usage_(0),
+    stop_(false)
+  {
+    for (Size i = 0; i < load_order_.size(); ++i)
+    {
+      order_position_[load_order_[i]] = i;
+    }
+  }
+
+  SwathMapPrefetcher::~SwathMapPrefetcher()
+  {
+    stop();
+    wait();
+  }
+
+  void SwathMapPrefetcher::run()
+  {
+    while (true)
+    {
+      Size map_index;
+      {
+        QMutexLocker locker(&mutex_);
+        while (true)
+        {
+          // skip maps that are already loaded (or being loaded) by a worker
+          while (next_ < load_order_.size() && state_[load_order_[next_]] != PENDING)
+          {
+            ++next_;
+          }
+          if (stop_ || next_ >= load_order_.size())
+          {
+            return;
+          }
+          if (memory_usage_ < memory_budget_)
+          {
+            break;
+          }
+          // wait until the budget allows loading ahead
+          budget_condition_.wait(&mutex_);
+        }
+        map_index = load_order_[next_];
+        state_[map_index] = LOADING;
+        ++next_;
+      }
+      load_(map_index);
+    }
+  }
+
+  void SwathMapPrefetcher::load_(Size map_index)
+  {
+    // load outside of the lock (this is where the I/O happens)
+    OpenSwath::SpectrumAccessPtr in_memory;
+    Size memory = 0;
+    try
+    {
+      in_memory = OpenSwath::SpectrumAccessPtr(new SpectrumAccessOpenMSInMemory(*swath_maps_[map_index].sptr));
+      memory = estimateMemory_(*in_memory);
+    }
+    catch (std::exception& e)
+    {
+      LOG_WARN << "Warning: Could not load SWATH map " << map_index << " into memory (" << e.what() << "), will read it from its source." << std::endl;
+      in_memory.reset();
+    }
+
+    QMutexLocker locker(&mutex_);
+    loaded_[map_index] = in_memory;
+    memory_[map_index] = memory;
+    memory_usage_ += memory;
+    state_[map_index] = DONE;
+    loaded_condition_.wakeAll();
+  }
+
+  OpenSwath::SpectrumAccessPtr SwathMapPrefetcher::acquire(Size map_index)
+  {
+    QMutexLocker locker(&mutex_);
+    if (order_position_[map_index] < 0)
+    {
+      return swath_maps_[map_index].sptr;
+    }
+
+    if (state_[map_index] == PENDING)
+    {
+      if (stop_)
+      {
+        return swath_maps_[map_index].sptr;
+      }
+      // not in flight yet, load it in this thread instead of waiting for the background thread
+      state_[map_index] = LOADING;
+      locker.unlock();
+      load_(map_index);
+      locker.relock();
+    }
+    while (state_[map_index] != DONE)
+    {
+      loaded_condition_.wait(&mutex_);
+    }
+
+    if (!loaded_[map_index])
+    {
+      return swath_maps_[map_index].sptr;
+    }
+    return loaded_[map_index];
+  }
+
+  void SwathMapPrefetcher::release(Size map_index)
+  {
+    QMutexLocker locker(&mutex_);
+    memory_usage_ -= memory_[map_index];
+    memory_[map_index] = 0;
+    loaded_[map_index].reset();
+    budget_condition_.wakeAll();
+  }
+
+  void SwathMapPrefetcher::stop()
+  {
+    QMutexLocker locker(&mutex_);
+    stop_ = true;
+    budget_condition_.wakeAll();
+    loaded_condition_.wakeAll();
+  }
+
+  Size SwathMapPrefetcher::getMemoryUsage() const
+  {
+    QMutexLocker locker(&mutex_);
+    return memory_usage_;
+  }
+
+  Size SwathMapPrefetcher::estimateMemory_(OpenSwath::ISpectrumAccess& swath_map)
+  {
+    // per spectrum: the spectrum and its meta data, the two binary data arrays
+    // and the shared pointers (including their reference counts) to all of them
+    const Size spectrum_overhead = sizeof(OpenSwath::SpectrumPtr) + sizeof(OpenSwath::Spectrum) + sizeof(OpenSwath::SpectrumMeta) +
+                                   2 * (sizeof(OpenSwath::BinaryDataArrayPtr) + sizeof(OpenSwath::BinaryDataArray)) +
+                                   3 * 2 * sizeof(long);
+    Size nr_points = 0;
+    Size id_length = 0;
+    for (Size i = 0; i < swath_map.getNrSpectra(); ++i)
+    {
+      nr_points += swath_map.getSpectrumById(i)->getMZArray()->data.size();
+      id_length += swath_map.getSpectrumMetaById(i).id.size();
+    }
+    // m/z and intensity array
+    return nr_points * 2 * sizeof(double) + swath_map.getNrSpectra() * spectrum_overhead + id_length;
+  }
+
+}
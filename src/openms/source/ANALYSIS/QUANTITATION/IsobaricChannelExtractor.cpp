@@ -41,8 +41,13 @@
 
 #include <OpenMS/CONCEPT/LogStream.h>
 
+#include <algorithm>
 #include <cmath>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 // #define ISOBARIC_CHANNEL_EXTRACTOR_DEBUG
 // #undef ISOBARIC_CHANNEL_EXTRACTOR_DEBUG
 
@@ -213,28 +218,55 @@ namespace OpenMS
     return false;
   }
 
-  double IsobaricChannelExtractor::computeSingleScanPrecursorPurity_(const MSExperiment<Peak1D>::ConstIterator& ms2_spec, const MSExperiment<Peak1D>::SpectrumType& precursor_spec) const
+  bool IsobaricChannelExtractor::isSelectedScan_(const MSExperiment<Peak1D>::SpectrumType& ms2_spec) const
+  {
+    if (selected_activation_ != "")
+    {
+      HasActivationMethod<MSExperiment<Peak1D>::SpectrumType> isValidActivation(ListUtils::create<String>(selected_activation_));
+      if (!isValidActivation(ms2_spec))
+      {
+        return false;
+      }
+    }
+
+    // check if precursor is available
+    if (ms2_spec.getPrecursors().empty())
+    {
+      throw Exception::MissingInformation(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, String("No precursor information given for scan native ID ") + ms2_spec.getNativeID() + " with RT " + String(ms2_spec.getRT()));
+    }
+
+    // check precursor constraints
+    if (!isValidPrecursor_(ms2_spec.getPrecursors()[0]))
+    {
+      LOG_DEBUG << "Skip spectrum " << ms2_spec.getNativeID() << ": Precursor doesn't fulfill all constraints." << std::endl;
+      return false;
+    }
+
+    return true;
+  }
+
+  double IsobaricChannelExtractor::computeSingleScanPrecursorPurity_(const MSExperiment<Peak1D>::SpectrumType& ms2_spec, const MSExperiment<Peak1D>::SpectrumType& precursor_spec) const
   {
 
     typedef MSExperiment<>::SpectrumType::ConstIterator const_spec_iterator;
 
     // compute distance between isotopic peaks based on the precursor charge.
-    const double charge_dist = Constants::NEUTRON_MASS_U / static_cast<double>(ms2_spec->getPrecursors()[0].getCharge());
+    const double charge_dist = Constants::NEUTRON_MASS_U / static_cast<double>(ms2_spec.getPrecursors()[0].getCharge());
 
     // the actual boundary values
-    const double strict_lower_mz = ms2_spec->getPrecursors()[0].getMZ() - ms2_spec->getPrecursors()[0].getIsolationWindowLowerOffset();
-    const double strict_upper_mz = ms2_spec->getPrecursors()[0].getMZ() + ms2_spec->getPrecursors()[0].getIsolationWindowUpperOffset();
+    const double strict_lower_mz = ms2_spec.getPrecursors()[0].getMZ() - ms2_spec.getPrecursors()[0].getIsolationWindowLowerOffset();
+    const double strict_upper_mz = ms2_spec.getPrecursors()[0].getMZ() + ms2_spec.getPrecursors()[0].getIsolationWindowUpperOffset();
 
     const double fuzzy_lower_mz = strict_lower_mz - (strict_lower_mz * max_precursor_isotope_deviation_ / 1000000);
     const double fuzzy_upper_mz = strict_upper_mz + (strict_upper_mz * max_precursor_isotope_deviation_ / 1000000);
 
     // first find the actual precursor peak
-    Size precursor_peak_idx = precursor_spec.findNearest(ms2_spec->getPrecursors()[0].getMZ());
+    Size precursor_peak_idx = precursor_spec.findNearest(ms2_spec.getPrecursors()[0].getMZ());
     const Peak1D& precursor_peak = precursor_spec[precursor_peak_idx];
 
     // now we get ourselves some border iterators
     const_spec_iterator lower_bound = precursor_spec.MZBegin(fuzzy_lower_mz);
-    const_spec_iterator upper_bound = precursor_spec.MZEnd(ms2_spec->getPrecursors()[0].getMZ());
+    const_spec_iterator upper_bound = precursor_spec.MZEnd(ms2_spec.getPrecursors()[0].getMZ());
 
     Peak1D::IntensityType precursor_intensity = precursor_peak.getIntensity();
     Peak1D::IntensityType total_intensity = precursor_peak.getIntensity();
@@ -297,7 +329,7 @@ namespace OpenMS
     // try to find a match for our isotopic peak on the right
 
     // redefine bounds
-    lower_bound = precursor_spec.MZBegin(ms2_spec->getPrecursors()[0].getMZ());
+    lower_bound = precursor_spec.MZBegin(ms2_spec.getPrecursors()[0].getMZ());
     upper_bound = precursor_spec.MZEnd(fuzzy_upper_mz);
 
     expected_next_mz = precursor_peak.getMZ() + charge_dist;
@@ -388,32 +420,32 @@ namespace OpenMS
     return precursor_intensity / total_intensity;
   }
 
-  double IsobaricChannelExtractor::computePrecursorPurity_(const MSExperiment<Peak1D>::ConstIterator& ms2_spec, const PuritySate_& pState) const
+  double IsobaricChannelExtractor::computePrecursorPurity_(const MSExperiment<Peak1D>::SpectrumType& ms2_spec, const MSExperiment<Peak1D>::SpectrumType& precursor_spec, const MSExperiment<Peak1D>::SpectrumType* follow_up_spec) const
   {
     // we cannot analyze precursors without a charge
-    if (ms2_spec->getPrecursors()[0].getCharge() == 0)
+    if (ms2_spec.getPrecursors()[0].getCharge() == 0)
     {
       return 1.0;
     }
     else
     {
 #ifdef ISOBARIC_CHANNEL_EXTRACTOR_DEBUG
-      std::cerr << "------------------ analyzing " << ms2_spec->getNativeID() << std::endl;
+      std::cerr << "------------------ analyzing " << ms2_spec.getNativeID() << std::endl;
 #endif
 
       // compute purity of preceding ms1 scan
-      double early_scan_purity = computeSingleScanPrecursorPurity_(ms2_spec, *(pState.precursorScan));
+      double early_scan_purity = computeSingleScanPrecursorPurity_(ms2_spec, precursor_spec);
 
-      if (pState.hasFollowUpScan && interpolate_precursor_purity_)
+      if (follow_up_spec != 0 && interpolate_precursor_purity_)
       {
-        double late_scan_purity = computeSingleScanPrecursorPurity_(ms2_spec, *(pState.followUpScan));
+        double late_scan_purity = computeSingleScanPrecursorPurity_(ms2_spec, *follow_up_spec);
 
         // calculating the extrapolated, S2I value as a time weighted linear combination of the two scans
         // see: Savitski MM, Sweetman G, Askenazi M, Marto JA, Lang M, Zinn N, et al. (2011).
         // Analytical chemistry 83: 8959–67. http://www.ncbi.nlm.nih.gov/pubmed/22017476
         // std::fabs is applied to compensate for potentially negative RTs
-        return std::fabs(ms2_spec->getRT() - pState.precursorScan->getRT()) *
-               ((late_scan_purity - early_scan_purity) / std::fabs(pState.followUpScan->getRT() - pState.precursorScan->getRT()))
+        return std::fabs(ms2_spec.getRT() - precursor_spec.getRT()) *
+               ((late_scan_purity - early_scan_purity) / std::fabs(follow_up_spec->getRT() - precursor_spec.getRT()))
                + early_scan_purity;
       }
       else
@@ -423,6 +455,163 @@ namespace OpenMS
     }
   }
 
+  void IsobaricChannelExtractor::extractBatch_(const std::vector<const MSExperiment<Peak1D>::SpectrumType*>& ms2_specs,
+                                               const std::vector<const MSExperiment<Peak1D>::SpectrumType*>& precursor_specs,
+                                               const std::vector<const MSExperiment<Peak1D>::SpectrumType*>& follow_up_specs,
+                                               UInt64& element_index, ConsensusMap& consensus_map) const
+  {
+    typedef MSExperiment<Peak1D>::SpectrumType SpectrumType;
+
+    const IsobaricQuantitationMethod::IsobaricChannelList& channels = quant_method_->getChannelInformation();
+
+    // purity and reporter intensities only depend on the individual scans
+    // and are computed in parallel; the features are assembled afterwards in
+    // the order of the scans
+    std::vector<double> precursor_purities(ms2_specs.size(), -1.0);
+    std::vector<std::vector<Peak2D::IntensityType> > channel_intensities(ms2_specs.size());
+
+    // exceptions must not leave the parallel section: we keep a copy of the error of the
+    // first scan whose purity computation failed (e.g. an empty precursor scan) and throw it afterwards
+    SignedSize failed_scan = -1;
+    Exception::BaseException error;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 64)
+#endif
+    for (SignedSize i = 0; i < (SignedSize)ms2_specs.size(); ++i)
+    {
+      const SpectrumType& ms2_spec = *ms2_specs[i];
+
+      // check precursor purity if we have a valid precursor ..
+      if (precursor_specs[i] != 0)
+      {
+        try
+        {
+          precursor_purities[i] = computePrecursorPurity_(ms2_spec, *precursor_specs[i], follow_up_specs[i]);
+        }
+        catch (Exception::BaseException& e)
+        {
+#ifdef _OPENMP
+#pragma omp critical (IsobaricChannelExtractor_extractBatch)
+#endif
+          {
+            if (failed_scan < 0 || i < failed_scan)
+            {
+              failed_scan = i;
+              error = e;
+            }
+          }
+          continue;
+        }
+        // the spectrum will be skipped, no need to extract the reporters
+        if (precursor_purities[i] < min_precursor_purity_) continue;
+      }
+
+      std::vector<Peak2D::IntensityType>& intensities = channel_intensities[i];
+      intensities.reserve(channels.size());
+      for (IsobaricQuantitationMethod::IsobaricChannelList::const_iterator cl_it = channels.begin();
+           cl_it != channels.end();
+           ++cl_it)
+      {
+        Peak2D::IntensityType intensity = 0;
+
+        // as every evaluation requires time, we cache the MZEnd iterator
+        const SpectrumType::ConstIterator mz_end = ms2_spec.MZEnd(cl_it->center + reporter_mass_shift_);
+
+        // add up all signals
+        for (SpectrumType::ConstIterator mz_it = ms2_spec.MZBegin(cl_it->center - reporter_mass_shift_);
+             mz_it != mz_end;
+             ++mz_it)
+        {
+          intensity += mz_it->getIntensity();
+        }
+
+        // discard contribution of this channel as it is below the required intensity threshold
+        if (intensity < min_reporter_intensity_)
+        {
+          intensity = 0;
+        }
+        intensities.push_back(intensity);
+      }
+    }
+    if (failed_scan >= 0)
+    {
+      throw error;
+    }
+
+    for (Size i = 0; i < ms2_specs.size(); ++i)
+    {
+      const SpectrumType& ms2_spec = *ms2_specs[i];
+      const double precursor_purity = precursor_purities[i];
+
+      if (precursor_specs[i] != 0)
+      {
+        // check if purity is high enough
+        if (precursor_purity < min_precursor_purity_)
+        {
+          LOG_DEBUG << "Skip spectrum " << ms2_spec.getNativeID() << ": Precursor purity is below the threshold. [purity = " << precursor_purity << "]" << std::endl;
+          continue;
+        }
+      }
+      else
+      {
+        LOG_INFO << "No precursor available for spectrum: " << ms2_spec.getNativeID() << std::endl;
+      }
+
+      // store RT&MZ of parent ion as centroid of ConsensusFeature
+      ConsensusFeature cf;
+      cf.setUniqueId();
+      cf.setRT(ms2_spec.getRT());
+      cf.setMZ(ms2_spec.getPrecursors()[0].getMZ());
+
+      Peak2D channel_value;
+      channel_value.setRT(ms2_spec.getRT());
+      // for each each channel
+      UInt64 map_index = 0;
+      Peak2D::IntensityType overall_intensity = 0;
+      for (IsobaricQuantitationMethod::IsobaricChannelList::const_iterator cl_it = channels.begin();
+           cl_it != channels.end();
+           ++cl_it)
+      {
+        // set mz-position and intensity of channel
+        channel_value.setMZ(cl_it->center);
+        channel_value.setIntensity(channel_intensities[i][map_index]);
+
+        overall_intensity += channel_value.getIntensity();
+        // add channel to ConsensusFeature
+        cf.insert(map_index++, channel_value, element_index);
+      } // ! channel_iterator
+
+      // check if we keep this feature or if it contains low-intensity quantifications
+      if (remove_low_intensity_quantifications_ && hasLowIntensityReporter_(cf))
+      {
+        continue;
+      }
+
+      // check featureHandles are not empty
+      if (overall_intensity <= 0)
+      {
+        cf.setMetaValue("all_empty", String("true"));
+      }
+      // add purity information if we could compute it
+      if (precursor_purity > 0.0)
+      {
+        cf.setMetaValue("precursor_purity", precursor_purity);
+      }
+
+      // embed the id of the scan from which the quantitative information was extracted
+      cf.setMetaValue("scan_id", ms2_spec.getNativeID());
+      // ...as well as additional meta information
+      cf.setMetaValue("precursor_intensity", ms2_spec.getPrecursors()[0].getIntensity());
+
+      cf.setCharge(ms2_spec.getPrecursors()[0].getCharge());
+      cf.setIntensity(overall_intensity);
+      consensus_map.push_back(cf);
+
+      // the tandem-scan in the order they appear in the experiment
+      ++element_index;
+    }
+  }
+
   void IsobaricChannelExtractor::extractChannels(const MSExperiment<Peak1D>& ms_exp_data, ConsensusMap& consensus_map)
   {
     if (ms_exp_data.empty())
@@ -436,13 +625,10 @@ namespace OpenMS
     consensus_map.clear(false);
     consensus_map.setExperimentType("labeled_MS2");
 
-    // create predicate for spectrum checking
     LOG_INFO << "Selecting scans with activation mode: " << (selected_activation_ == "" ? "any" : selected_activation_) << "\n";
-    HasActivationMethod<MSExperiment<Peak1D>::SpectrumType> isValidActivation(ListUtils::create<String>(selected_activation_));
 
-    // now we have picked data
-    // --> assign peaks to channels
-    UInt64 element_index(0);
+    // collect the selected tandem scans together with their precursor and follow up scans
+    std::vector<const MSExperiment<Peak1D>::SpectrumType*> ms2_specs, precursor_specs, follow_up_specs;
 
     // remember the current precursor spectrum
     PuritySate_ pState(ms_exp_data);
@@ -457,7 +643,7 @@ namespace OpenMS
         continue;
       }
 
-      if (selected_activation_ == "" || isValidActivation(*it))
+      if (isSelectedScan_(*it))
       {
         // find following ms1 scan (needed for purity computation)
         if (!pState.followUpValid(it->getRT()))
@@ -466,114 +652,22 @@ namespace OpenMS
           pState.advanceFollowUp(it->getRT());
         }
 
-        // check if precursor is available
-        if (it->getPrecursors().empty())
-        {
-          throw Exception::MissingInformation(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, String("No precursor information given for scan native ID ") + it->getNativeID() + " with RT " + String(it->getRT()));
-        }
-
-        // check precursor constraints
-        if (!isValidPrecursor_(it->getPrecursors()[0]))
-        {
-          LOG_DEBUG << "Skip spectrum " << it->getNativeID() << ": Precursor doesn't fulfill all constraints." << std::endl;
-          continue;
-        }
-
-        // check precursor purity if we have a valid precursor ..
-        double precursor_purity = -1.0;
-        if (pState.precursorScan != ms_exp_data.end())
-        {
-          precursor_purity = computePrecursorPurity_(it, pState);
-          // check if purity is high enough
-          if (precursor_purity < min_precursor_purity_)
-          {
-            LOG_DEBUG << "Skip spectrum " << it->getNativeID() << ": Precursor purity is below the threshold. [purity = " << precursor_purity << "]" << std::endl;
-            continue;
-          }
-        }
-        else
-        {
-          LOG_INFO << "No precursor available for spectrum: " << it->getNativeID() << std::endl;
-        }
-
-        // store RT&MZ of parent ion as centroid of ConsensusFeature
-        ConsensusFeature cf;
-        cf.setUniqueId();
-        cf.setRT(it->getRT());
-        cf.setMZ(it->getPrecursors()[0].getMZ());
-
-        Peak2D channel_value;
-        channel_value.setRT(it->getRT());
-        // for each each channel
-        UInt64 map_index = 0;
-        Peak2D::IntensityType overall_intensity = 0;
-        for (IsobaricQuantitationMethod::IsobaricChannelList::const_iterator cl_it = quant_method_->getChannelInformation().begin();
-             cl_it != quant_method_->getChannelInformation().end();
-             ++cl_it)
-        {
-          // set mz-position of channel
-          channel_value.setMZ(cl_it->center);
-          // reset intensity
-          channel_value.setIntensity(0);
-
-          // as every evaluation requires time, we cache the MZEnd iterator
-          const MSExperiment<Peak1D>::SpectrumType::ConstIterator mz_end = it->MZEnd(cl_it->center + reporter_mass_shift_);
-
-          // add up all signals
-          for (MSExperiment<Peak1D>::SpectrumType::ConstIterator mz_it = it->MZBegin(cl_it->center - reporter_mass_shift_);
-               mz_it != mz_end;
-               ++mz_it)
-          {
-            channel_value.setIntensity(channel_value.getIntensity() + mz_it->getIntensity());
-          }
-
-          // discard contribution of this channel as it is below the required intensity threshold
-          if (channel_value.getIntensity() < min_reporter_intensity_)
-          {
-            channel_value.setIntensity(0);
-          }
-
-          overall_intensity += channel_value.getIntensity();
-          // add channel to ConsensusFeature
-          cf.insert(map_index++, channel_value, element_index);
-        } // ! channel_iterator
-
-        // check if we keep this feature or if it contains low-intensity quantifications
-        if (remove_low_intensity_quantifications_ && hasLowIntensityReporter_(cf))
-        {
-          continue;
-        }
-
-        // check featureHandles are not empty
-        if (overall_intensity <= 0)
-        {
-          cf.setMetaValue("all_empty", String("true"));
-        }
-        // add purity information if we could compute it
-        if (precursor_purity > 0.0)
-        {
-          cf.setMetaValue("precursor_purity", precursor_purity);
-        }
-
-        // embed the id of the scan from which the quantitative information was extracted
-        cf.setMetaValue("scan_id", it->getNativeID());
-        // ...as well as additional meta information
-        cf.setMetaValue("precursor_intensity", it->getPrecursors()[0].getIntensity());
-
-        cf.setCharge(it->getPrecursors()[0].getCharge());
-        cf.setIntensity(overall_intensity);
-        consensus_map.push_back(cf);
-
-        // the tandem-scan in the order they appear in the experiment
-        ++element_index;
+        ms2_specs.push_back(&(*it));
+        precursor_specs.push_back(pState.precursorScan != ms_exp_data.end() ? &(*pState.precursorScan) : 0);
+        follow_up_specs.push_back(pState.hasFollowUpScan ? &(*pState.followUpScan) : 0);
       }
     } // ! Experiment iterator
 
+    // now we have picked data
+    // --> assign peaks to channels
+    UInt64 element_index(0);
+    extractBatch_(ms2_specs, precursor_specs, follow_up_specs, element_index, consensus_map);
+
     /// add meta information to the map
     registerChannelsInOutputMap_(consensus_map);
   }
 
-  void IsobaricChannelExtractor::registerChannelsInOutputMap_(ConsensusMap& consensus_map)
+  void IsobaricChannelExtractor::registerChannelsInOutputMap_(ConsensusMap& consensus_map) const
   {
     // register the individual channels in the output consensus map
     Int index = 0;
@@ -597,4 +691,141 @@ namespace OpenMS
     }
   }
 
+  IsobaricChannelExtractor::ExtractionConsumer::ExtractionConsumer(const IsobaricChannelExtractor& extractor, ConsensusMap& consensus_map, Size batch_size) :
+    extractor_(extractor),
+    consensus_map_(consensus_map),
+    batch_size_(std::max(batch_size, Size(1))),
+    ms1_offset_(0),
+    element_index_(0),
+    spectra_consumed_(0)
+  {
+    // clear the output map
+    consensus_map_.clear(false);
+    consensus_map_.setExperimentType("labeled_MS2");
+
+    LOG_INFO << "Selecting scans with activation mode: " << (extractor_.selected_activation_ == "" ? "any" : extractor_.selected_activation_) << "\n";
+  }
+
+  void IsobaricChannelExtractor::ExtractionConsumer::setExperimentalSettings(const ExperimentalSettings& exp)
+  {
+    MSExperiment<Peak1D> settings;
+    settings.getExperimentalSettings() = exp;
+    consensus_map_.setPrimaryMSRunPath(settings.getPrimaryMSRunPath());
+  }
+
+  void IsobaricChannelExtractor::ExtractionConsumer::consumeSpectrum(SpectrumType& s)
+  {
+    ++spectra_consumed_;
+
+    if (s.getMSLevel() == 1)
+    {
+      // remember potential precursor (and follow up scan of the pending scans)
+      ms1_scans_.push_back(s);
+
+      // all pending scans know their follow up scan now
+      if (pending_ms2_.size() >= batch_size_)
+      {
+        processPendingScans_();
+      }
+      else
+      {
+        dropObsoleteMS1Scans_();
+      }
+      return;
+    }
+
+    if (extractor_.isSelectedScan_(s))
+    {
+      pending_ms2_.push_back(s);
+      pending_precursor_.push_back(ms1_scans_.empty() ? -1 : (SignedSize)(ms1_offset_ + ms1_scans_.size() - 1));
+
+      // without interpolation (or without any precursor scan) we do not need to wait for the follow up scan
+      if (pending_ms2_.size() >= batch_size_ && (!extractor_.interpolate_precursor_purity_ || ms1_scans_.empty()))
+      {
+        processPendingScans_();
+      }
+    }
+  }
+
+  void IsobaricChannelExtractor::ExtractionConsumer::finish()
+  {
+    if (spectra_consumed_ == 0)
+    {
+      LOG_WARN << "The given file does not contain any conventional peak data, but might"
+                  " contain chromatograms. This tool currently cannot handle them, sorry.\n";
+      throw Exception::MissingInformation(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Experiment has no scans!");
+    }
+
+    processPendingScans_();
+
+    /// add meta information to the map
+    extractor_.registerChannelsInOutputMap_(consensus_map_);
+  }
+
+  void IsobaricChannelExtractor::ExtractionConsumer::processPendingScans_()
+  {
+    std::vector<const SpectrumType*> ms2_specs, precursor_specs, follow_up_specs;
+    ms2_specs.reserve(pending_ms2_.size());
+    precursor_specs.reserve(pending_ms2_.size());
+    follow_up_specs.reserve(pending_ms2_.size());
+
+    for (Size i = 0; i < pending_ms2_.size(); ++i)
+    {
+      const SpectrumType* precursor_spec = 0;
+      const SpectrumType* follow_up_spec = 0;
+      if (pending_precursor_[i] >= 0)
+      {
+        Size precursor_idx = pending_precursor_[i] - ms1_offset_;
+        precursor_spec = &ms1_scans_[precursor_idx];
+
+        // the follow up scan is the first ms1 scan with a bigger RT
+        for (Size j = precursor_idx + 1; j < ms1_scans_.size(); ++j)
+        {
+          if (ms1_scans_[j].getRT() > pending_ms2_[i].getRT())
+          {
+            follow_up_spec = &ms1_scans_[j];
+            break;
+          }
+        }
+      }
+      ms2_specs.push_back(&pending_ms2_[i]);
+      precursor_specs.push_back(precursor_spec);
+      follow_up_specs.push_back(follow_up_spec);
+    }
+
+    extractor_.extractBatch_(ms2_specs, precursor_specs, follow_up_specs, element_index_, consensus_map_);
+
+    pending_ms2_.clear();
+    pending_precursor_.clear();
+
+    dropObsoleteMS1Scans_();
+  }
+
+  void IsobaricChannelExtractor::ExtractionConsumer::dropObsoleteMS1Scans_()
+  {
+    if (ms1_scans_.empty())
+    {
+      return;
+    }
+
+    // only the most recent ms1 scan can be the precursor of upcoming scans,
+    // pending scans need their precursor and the scans following it
+    // (precursor indices are non-decreasing)
+    SignedSize first_needed = (SignedSize)(ms1_offset_ + ms1_scans_.size() - 1);
+    for (Size i = 0; i < pending_precursor_.size(); ++i)
+    {
+      if (pending_precursor_[i] >= 0)
+      {
+        first_needed = std::min(first_needed, pending_precursor_[i]);
+        break;
+      }
+    }
+
+    while ((SignedSize)ms1_offset_ < first_needed)
+    {
+      ms1_scans_.pop_front();
+      ++ms1_offset_;
+    }
+  }
+
 } // namespace
@@ -38,12 +38,65 @@
 #include <OpenMS/DATASTRUCTURES/ListUtils.h>
 
 #include <algorithm> // for "equal"
+#include <limits>
+
+#include <boost/math/special_functions/fpclassify.hpp>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 using namespace std;
 
 namespace OpenMS
 {
 
+  namespace
+  {
+    // Determine the sorted sample IDs occurring in the total abundances of
+    // the given peptides - these are the columns of the dense representations
+    void getSampleColumns(const PeptideAndProteinQuant::PeptideQuant& pep_quant,
+                          vector<UInt64>& sample_ids)
+    {
+      set<UInt64> samples;
+      for (PeptideAndProteinQuant::PeptideQuant::const_iterator q_it =
+             pep_quant.begin(); q_it != pep_quant.end(); ++q_it)
+      {
+        for (PeptideAndProteinQuant::SampleAbundances::const_iterator samp_it =
+               q_it->second.total_abundances.begin(); samp_it !=
+             q_it->second.total_abundances.end(); ++samp_it)
+        {
+          samples.insert(samp_it->first);
+        }
+      }
+      sample_ids.assign(samples.begin(), samples.end());
+    }
+
+    // Advance the column index "col" to the column of sample "id" (sample IDs
+    // of a "SampleAbundances" map are visited in ascending order); returns
+    // whether there is a column for the sample
+    bool findColumn(const vector<UInt64>& sample_ids, UInt64 id, Size& col)
+    {
+      while ((col < sample_ids.size()) && (sample_ids[col] < id)) ++col;
+      return (col < sample_ids.size()) && (sample_ids[col] == id);
+    }
+
+    // Scale abundances by the factors of the respective samples
+    void scaleAbundances(PeptideAndProteinQuant::SampleAbundances& abundances,
+                         const vector<UInt64>& sample_ids,
+                         const vector<double>& scale_factors)
+    {
+      Size col = 0;
+      for (PeptideAndProteinQuant::SampleAbundances::iterator samp_it =
+             abundances.begin(); samp_it != abundances.end(); ++samp_it)
+      {
+        // samples without any total abundance have no median (scale factor 0)
+        samp_it->second *= (findColumn(sample_ids, samp_it->first, col) ?
+                            scale_factors[col] : 0.0);
+      }
+    }
+  }
+
   PeptideAndProteinQuant::PeptideAndProteinQuant() :
     DefaultParamHandler("PeptideAndProteinQuant"), stats_(), pep_quant_(),
     prot_quant_()
@@ -158,59 +211,75 @@ namespace OpenMS
     // if inference results are given, filter quant. data accordingly:
     if (!pep_info.empty())
     {
-      PeptideQuant filtered;
-      for (PeptideQuant::iterator q_it = pep_quant_.begin(); 
-           q_it != pep_quant_.end(); ++q_it)
+      for (PeptideQuant::iterator q_it = pep_quant_.begin();
+           q_it != pep_quant_.end(); )
       {
         String seq = q_it->first.toUnmodifiedString();
         map<String, set<String> >::iterator pos = pep_info.find(seq);
         if (pos != pep_info.end()) // sequence found in protein inference data
         {
           q_it->second.accessions = pos->second; // replace accessions
-          filtered.insert(*q_it);
+          ++q_it;
+        }
+        else
+        {
+          pep_quant_.erase(q_it++);
         }
       }
-      pep_quant_ = filtered;
     }
 
-    // now perform the actual peptide quantification:
+    // now perform the actual peptide quantification (peptides are independent
+    // of each other, so they can be processed in parallel):
+    bool filter_charge = param_.getValue("filter_charge") == "true";
+    vector<PeptideData*> pep_data;
+    pep_data.reserve(pep_quant_.size());
     for (PeptideQuant::iterator q_it = pep_quant_.begin();
          q_it != pep_quant_.end(); ++q_it)
     {
-      if (param_.getValue("filter_charge") == "true")
+      pep_data.push_back(&(q_it->second));
+    }
+
+    Size quant_peptides = 0;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 100) reduction(+: quant_peptides)
+#endif
+    for (SignedSize i = 0; i < (SignedSize)pep_data.size(); ++i)
+    {
+      PeptideData& data = *pep_data[i];
+      if (filter_charge)
       {
         // find charge state with abundances for highest number of samples
         // (break ties by total abundance):
         IntList charges; // sorted charge states (best first)
-        orderBest_(q_it->second.abundances, charges);
+        orderBest_(data.abundances, charges);
         if (charges.empty()) continue; // only identified, not quantified
         Int best_charge = charges[0];
 
         // quantify according to the best charge state only:
         for (SampleAbundances::iterator samp_it =
-               q_it->second.abundances[best_charge].begin(); samp_it !=
-             q_it->second.abundances[best_charge].end(); ++samp_it)
+               data.abundances[best_charge].begin(); samp_it !=
+             data.abundances[best_charge].end(); ++samp_it)
         {
-          q_it->second.total_abundances[samp_it->first] = samp_it->second;
+          data.total_abundances[samp_it->first] = samp_it->second;
         }
       }
       else
       {
         // sum up abundances over all charge states:
         for (map<Int, SampleAbundances>::iterator ab_it =
-               q_it->second.abundances.begin(); ab_it !=
-             q_it->second.abundances.end(); ++ab_it)
+               data.abundances.begin(); ab_it != data.abundances.end(); ++ab_it)
         {
           for (SampleAbundances::iterator samp_it = ab_it->second.begin();
                samp_it != ab_it->second.end(); ++samp_it)
           {
-            q_it->second.total_abundances[samp_it->first] += samp_it->second;
+            data.total_abundances[samp_it->first] += samp_it->second;
           }
         }
       }
-      if (!q_it->second.total_abundances.empty())
-        stats_.quant_peptides++;
+      if (!data.total_abundances.empty())
+        quant_peptides++;
     }
+    stats_.quant_peptides += quant_peptides;
 
     if ((stats_.n_samples > 1) &&
         (param_.getValue("consensus:normalize") == "true"))
@@ -222,63 +291,61 @@ namespace OpenMS
 
   void PeptideAndProteinQuant::normalizePeptides_()
   {
-    // gather data:
-    map<UInt64, DoubleList> abundances; // all peptide abundances by sample
+    // gather data - all peptide abundances by sample (columns):
+    vector<UInt64> sample_ids;
+    getSampleColumns(pep_quant_, sample_ids);
+    if (sample_ids.size() <= 1) return;
+
+    vector<PeptideData*> pep_data;
+    pep_data.reserve(pep_quant_.size());
+    vector<DoubleList> columns(sample_ids.size());
     for (PeptideQuant::iterator q_it = pep_quant_.begin();
          q_it != pep_quant_.end(); ++q_it)
     {
+      pep_data.push_back(&(q_it->second));
       // maybe TODO: treat missing abundance values as zero
+      Size col = 0;
       for (SampleAbundances::iterator samp_it =
              q_it->second.total_abundances.begin(); samp_it !=
            q_it->second.total_abundances.end(); ++samp_it)
       {
-        abundances[samp_it->first].push_back(samp_it->second);
+        findColumn(sample_ids, samp_it->first, col);
+        columns[col].push_back(samp_it->second);
       }
     }
-    if (abundances.size() <= 1) return;
 
     // compute scale factors for all samples:
-    SampleAbundances medians; // median abundance by sample
-    for (map<UInt64, DoubleList>::iterator ab_it = abundances.begin();
-         ab_it != abundances.end(); ++ab_it)
+    DoubleList medians(sample_ids.size()); // median abundance by sample
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+    for (SignedSize col = 0; col < (SignedSize)columns.size(); ++col)
     {
-      medians[ab_it->first] = Math::median(ab_it->second.begin(),
-                                           ab_it->second.end());
-    }
-    DoubleList all_medians;
-    for (SampleAbundances::iterator med_it = medians.begin();
-         med_it != medians.end(); ++med_it)
-    {
-      all_medians.push_back(med_it->second);
+      medians[col] = Math::median(columns[col].begin(), columns[col].end());
+      DoubleList().swap(columns[col]); // free memory
     }
+    DoubleList all_medians(medians);
     double overall_median = Math::median(all_medians.begin(),
                                          all_medians.end());
-    SampleAbundances scale_factors;
-    for (SampleAbundances::iterator med_it = medians.begin();
-         med_it != medians.end(); ++med_it)
+    vector<double> scale_factors(medians.size());
+    for (Size col = 0; col < medians.size(); ++col)
     {
-      scale_factors[med_it->first] = overall_median / med_it->second;
+      scale_factors[col] = overall_median / medians[col];
     }
 
     // scale all abundance values:
-    for (PeptideQuant::iterator q_it = pep_quant_.begin();
-         q_it != pep_quant_.end(); ++q_it)
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 100)
+#endif
+    for (SignedSize i = 0; i < (SignedSize)pep_data.size(); ++i)
     {
-      for (SampleAbundances::iterator tot_it =
-             q_it->second.total_abundances.begin(); tot_it !=
-           q_it->second.total_abundances.end(); ++tot_it)
-      {
-        tot_it->second *= scale_factors[tot_it->first];
-      }
+      scaleAbundances(pep_data[i]->total_abundances, sample_ids,
+                      scale_factors);
       for (map<Int, SampleAbundances>::iterator ab_it =
-             q_it->second.abundances.begin(); ab_it !=
-           q_it->second.abundances.end(); ++ab_it)
+             pep_data[i]->abundances.begin(); ab_it !=
+           pep_data[i]->abundances.end(); ++ab_it)
       {
-        for (SampleAbundances::iterator samp_it = ab_it->second.begin();
-             samp_it != ab_it->second.end(); ++samp_it)
-        {
-          samp_it->second *= scale_factors[samp_it->first];
-        }
+        scaleAbundances(ab_it->second, sample_ids, scale_factors);
       }
     }
   }
@@ -337,24 +404,24 @@ namespace OpenMS
       }
     }
 
+    // map proteins and samples (columns) to indexes and collect the
+    // proteotypic peptides of each protein (in the order of "pep_quant_"):
+    vector<UInt64> sample_ids;
+    getSampleColumns(pep_quant_, sample_ids);
+    Size n_columns = sample_ids.size();
+
+    map<String, Size> protein_index; // protein accession -> index
+    vector<vector<PeptideQuant::const_iterator> > protein_peptides;
     for (PeptideQuant::const_iterator pep_it = pep_quant_.begin();
          pep_it != pep_quant_.end(); ++pep_it)
     {
       String accession = getAccession_(pep_it->second.accessions,
                                        accession_to_leader);
-      if (!accession.empty()) // proteotypic peptide
-      {
-        prot_quant_[accession].id_count += pep_it->second.id_count;
-        for (SampleAbundances::const_iterator tot_it =
-               pep_it->second.total_abundances.begin(); tot_it !=
-             pep_it->second.total_abundances.end(); ++tot_it)
-        {
-          // add up contributions of same peptide with different mods:
-          String raw_peptide = pep_it->first.toUnmodifiedString();
-          prot_quant_[accession].abundances[raw_peptide][tot_it->first] +=
-            tot_it->second;
-        }
-      }
+      if (accession.empty()) continue; // not a proteotypic peptide
+      pair<map<String, Size>::iterator, bool> pos = protein_index.insert(
+        make_pair(accession, protein_index.size()));
+      if (pos.second) protein_peptides.resize(protein_peptides.size() + 1);
+      protein_peptides[pos.first->second].push_back(pep_it);
     }
 
     Size top = param_.getValue("top");
@@ -362,106 +429,213 @@ namespace OpenMS
     bool include_all = param_.getValue("include_all") == "true";
     bool fix_peptides = param_.getValue("consensus:fix_peptides") == "true";
 
-    for (ProteinQuant::iterator prot_it = prot_quant_.begin();
-         prot_it != prot_quant_.end(); ++prot_it)
+    // the result entries have to exist before they are filled in parallel:
+    vector<ProteinData*> prot_data(protein_peptides.size());
+    for (map<String, Size>::iterator prot_it = protein_index.begin();
+         prot_it != protein_index.end(); ++prot_it)
     {
-      if ((top > 0) && (prot_it->second.abundances.size() < top))
-      {
-        stats_.too_few_peptides++;
-        if (!include_all)
-          continue; // not enough proteotypic peptides
-      }
+      prot_data[prot_it->second] = &(prot_quant_[prot_it->first]);
+    }
 
-      vector<String> peptides; // peptides selected for quantification
-      if (fix_peptides && (top == 0))
+    // proteins are quantified independently of each other, the dense
+    // peptide-by-sample matrix of a protein only exists while it is processed:
+    Size too_few_peptides = 0, quant_proteins = 0;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 10) reduction(+: too_few_peptides, quant_proteins)
+#endif
+    for (SignedSize i = 0; i < (SignedSize)protein_peptides.size(); ++i)
+    {
+      ProteinMatrix_ matrix;
+      buildProteinMatrix_(protein_peptides[i], sample_ids, matrix);
+      ProteinData& data = *prot_data[i];
+
+      // report the peptide abundances:
+      data.id_count += matrix.id_count;
+      for (map<String, Size>::const_iterator row_it = matrix.rows.begin();
+           row_it != matrix.rows.end(); ++row_it)
       {
-        // consider all peptides that occur in every sample:
-        for (map<String, SampleAbundances>::iterator ab_it =
-               prot_it->second.abundances.begin(); ab_it !=
-             prot_it->second.abundances.end(); ++ab_it)
+        SampleAbundances& pep_abundances = data.abundances[row_it->first];
+        const double* row = &(matrix.abundances[row_it->second * n_columns]);
+        for (Size col = 0; col < n_columns; ++col)
         {
-          if (ab_it->second.size() == stats_.n_samples)
+          if (!boost::math::isnan(row[col]))
           {
-            peptides.push_back(ab_it->first);
+            pep_abundances[sample_ids[col]] += row[col];
           }
         }
       }
-      else if (fix_peptides && (top > 0) &&
-               (prot_it->second.abundances.size() > top))
+
+      if ((top > 0) && (matrix.rows.size() < top))
       {
-        orderBest_(prot_it->second.abundances, peptides);
-        peptides.resize(top);
+        too_few_peptides++;
+        if (!include_all)
+          continue; // not enough proteotypic peptides
       }
-      else
+
+      vector<double> result;
+      aggregateProtein_(matrix, n_columns, top, average, include_all,
+                        fix_peptides, result);
+      for (Size col = 0; col < n_columns; ++col)
       {
-        // consider all peptides:
-        for (map<String, SampleAbundances>::iterator ab_it =
-               prot_it->second.abundances.begin(); ab_it !=
-             prot_it->second.abundances.end(); ++ab_it)
+        if (!boost::math::isnan(result[col]))
         {
-          peptides.push_back(ab_it->first);
+          data.total_abundances[sample_ids[col]] = result[col];
         }
       }
 
-      map<UInt64, DoubleList> abundances; // all peptide abundances by sample
-      // consider only the peptides selected above for quantification:
-      for (vector<String>::iterator pep_it = peptides.begin();
-           pep_it != peptides.end(); ++pep_it)
+      // update statistics:
+      if (data.total_abundances.empty()) too_few_peptides++;
+      else quant_proteins++;
+    }
+    stats_.too_few_peptides += too_few_peptides;
+    stats_.quant_proteins += quant_proteins;
+  }
+
+
+  void PeptideAndProteinQuant::buildProteinMatrix_(
+    const vector<PeptideQuant::const_iterator>& peptides,
+    const vector<UInt64>& sample_ids, ProteinMatrix_& matrix) const
+  {
+    Size n_columns = sample_ids.size();
+    for (vector<PeptideQuant::const_iterator>::const_iterator it =
+           peptides.begin(); it != peptides.end(); ++it)
+    {
+      const PeptideData& pep_data = (*it)->second;
+      matrix.id_count += pep_data.id_count;
+      if (pep_data.total_abundances.empty()) continue;
+
+      // add up contributions of same peptide with different mods:
+      String raw_peptide = (*it)->first.toUnmodifiedString();
+      pair<map<String, Size>::iterator, bool> pos = matrix.rows.insert(
+        make_pair(raw_peptide, matrix.rows.size()));
+      if (pos.second) // new row
       {
-        SampleAbundances& current_ab = prot_it->second.abundances[*pep_it];
-        for (SampleAbundances::iterator samp_it = current_ab.begin();
-             samp_it != current_ab.end(); ++samp_it)
-        {
-          abundances[samp_it->first].push_back(samp_it->second);
-        }
+        matrix.abundances.resize(matrix.abundances.size() + n_columns,
+                                 numeric_limits<double>::quiet_NaN());
       }
+      double* row = &(matrix.abundances[pos.first->second * n_columns]);
+      Size col = 0;
+      for (SampleAbundances::const_iterator tot_it =
+             pep_data.total_abundances.begin(); tot_it !=
+           pep_data.total_abundances.end(); ++tot_it)
+      {
+        findColumn(sample_ids, tot_it->first, col);
+        if (boost::math::isnan(row[col])) row[col] = tot_it->second;
+        else row[col] += tot_it->second;
+      }
+    }
+  }
+
 
-      for (map<UInt64, DoubleList>::iterator ab_it = abundances.begin();
-           ab_it != abundances.end(); ++ab_it)
+  void PeptideAndProteinQuant::aggregateProtein_(
+    const ProteinMatrix_& matrix, Size n_columns, Size top,
+    const String& average, bool include_all, bool fix_peptides,
+    vector<double>& result) const
+  {
+    vector<Size> rows; // peptides selected for quantification
+    if (fix_peptides && (top == 0))
+    {
+      // consider all peptides that occur in every sample:
+      for (map<String, Size>::const_iterator row_it = matrix.rows.begin();
+           row_it != matrix.rows.end(); ++row_it)
       {
-        if (!include_all && (top > 0) && (ab_it->second.size() < top))
+        const double* row = &(matrix.abundances[row_it->second * n_columns]);
+        Size n_samples = 0;
+        for (Size col = 0; col < n_columns; ++col)
         {
-          continue; // not enough peptide abundances for this sample
+          if (!boost::math::isnan(row[col])) n_samples++;
         }
-        if ((top > 0) && (ab_it->second.size() > top))
+        if (n_samples == stats_.n_samples) rows.push_back(row_it->second);
+      }
+    }
+    else if (fix_peptides && (top > 0) && (matrix.rows.size() > top))
+    {
+      // order peptides according to how many samples they allow to quantify,
+      // breaking ties by total abundance (as in "orderBest_"):
+      typedef pair<Size, double> PairType;
+      multimap<PairType, Size, greater<PairType> > order;
+      for (map<String, Size>::const_iterator row_it = matrix.rows.begin();
+           row_it != matrix.rows.end(); ++row_it)
+      {
+        const double* row = &(matrix.abundances[row_it->second * n_columns]);
+        Size n_samples = 0;
+        double total = 0.0;
+        for (Size col = 0; col < n_columns; ++col)
         {
-          // sort descending:
-          sort(ab_it->second.begin(), ab_it->second.end(), greater<double>());
-          ab_it->second.resize(top); // remove all but best "top" values
+          if (boost::math::isnan(row[col])) continue;
+          n_samples++;
+          total += row[col];
         }
+        if (total <= 0.0) continue; // not quantified
+        order.insert(make_pair(make_pair(n_samples, total), row_it->second));
+      }
+      for (multimap<PairType, Size, greater<PairType> >::iterator ord_it =
+             order.begin(); (ord_it != order.end()) && (rows.size() < top);
+           ++ord_it)
+      {
+        rows.push_back(ord_it->second);
+      }
+    }
+    else
+    {
+      // consider all peptides:
+      for (map<String, Size>::const_iterator row_it = matrix.rows.begin();
+           row_it != matrix.rows.end(); ++row_it)
+      {
+        rows.push_back(row_it->second);
+      }
+    }
 
-        double result;
-        if (average == "median")
-        {
-          result = Math::median(ab_it->second.begin(), ab_it->second.end());
-        }
-        else if (average == "mean")
-        {
-          result = Math::mean(ab_it->second.begin(), ab_it->second.end());
-        }
-        else if (average == "weighted_mean")
-        {
-          double sum_intensities = 0;
-          double sum_intensities_squared = 0;
-          for (DoubleList::const_iterator it_intensities =
-                 ab_it->second.begin(); it_intensities != ab_it->second.end();
-               ++it_intensities)
-          {
-            sum_intensities += (*it_intensities);
-            sum_intensities_squared += (*it_intensities) * (*it_intensities);
-          }
-          result = sum_intensities_squared / sum_intensities;
-        }
-        else // "sum"
+    result.assign(n_columns, numeric_limits<double>::quiet_NaN());
+    DoubleList abundances; // peptide abundances of the current sample
+    for (Size col = 0; col < n_columns; ++col)
+    {
+      // consider only the peptides selected above for quantification:
+      abundances.clear();
+      for (vector<Size>::iterator row_it = rows.begin(); row_it != rows.end();
+           ++row_it)
+      {
+        double value = matrix.abundances[*row_it * n_columns + col];
+        if (!boost::math::isnan(value)) abundances.push_back(value);
+      }
+      if (abundances.empty()) continue; // no data for this sample
+
+      if (!include_all && (top > 0) && (abundances.size() < top))
+      {
+        continue; // not enough peptide abundances for this sample
+      }
+      if ((top > 0) && (abundances.size() > top))
+      {
+        // sort descending, keep only the best "top" values:
+        partial_sort(abundances.begin(), abundances.begin() + top,
+                     abundances.end(), greater<double>());
+        abundances.resize(top);
+      }
+
+      if (average == "median")
+      {
+        result[col] = Math::median(abundances.begin(), abundances.end());
+      }
+      else if (average == "mean")
+      {
+        result[col] = Math::mean(abundances.begin(), abundances.end());
+      }
+      else if (average == "weighted_mean")
+      {
+        double sum_intensities = 0;
+        double sum_intensities_squared = 0;
+        for (DoubleList::const_iterator it_intensities = abundances.begin();
+             it_intensities != abundances.end(); ++it_intensities)
         {
-          result = Math::sum(ab_it->second.begin(), ab_it->second.end());
+          sum_intensities += (*it_intensities);
+          sum_intensities_squared += (*it_intensities) * (*it_intensities);
         }
-        prot_it->second.total_abundances[ab_it->first] = result;
+        result[col] = sum_intensities_squared / sum_intensities;
+      }
+      else // "sum"
+      {
+        result[col] = Math::sum(abundances.begin(), abundances.end());
       }
-
-      // update statistics:
-      if (prot_it->second.total_abundances.empty()) stats_.too_few_peptides++;
-      else stats_.quant_proteins++;
     }
   }
 
@@ -508,12 +682,21 @@ namespace OpenMS
       }
       countPeptides_(cons_it->getPeptideIdentifications());
       PeptideHit hit = getAnnotation_(cons_it->getPeptideIdentifications());
+      if (hit == PeptideHit())
+      {
+        continue; // annotation for the feature is ambiguous or missing
+      }
+      // look up the peptide only once for all features (samples):
+      SampleAbundances& abundances =
+        pep_quant_[hit.getSequence()].abundances[hit.getCharge()];
       for (ConsensusFeature::HandleSetType::const_iterator feat_it =
              cons_it->getFeatures().begin(); feat_it !=
            cons_it->getFeatures().end(); ++feat_it)
       {
-        quantifyFeature_(*feat_it, hit); // updates "stats_.quant_features"
+        // new map element is initialized with 0:
+        abundances[feat_it->getMapIndex()] += feat_it->getIntensity();
       }
+      stats_.quant_features += cons_it->getFeatures().size();
     }
     countPeptides_(consensus.getUnassignedPeptideIdentifications());
     stats_.total_peptides = pep_quant_.size();
@@ -41,14 +41,21 @@
 #include <OpenMS/CONCEPT/LogStream.h>
 
 
+#include <algorithm>
 #include <numeric>
 #include <iostream>
 #include <fstream>
 #include <cmath>
 #include <ctime>
+#include <stdexcept>
 
+#include <boost/exception_ptr.hpp>
 #include <boost/math/distributions/normal.hpp>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 using namespace std;
 using boost::math::cdf;
 
@@ -157,7 +164,8 @@ namespace OpenMS
     border_length_(0),
     training_set_(NULL),
     training_problem_(NULL),
-    training_data_(SVMData())
+    training_data_(SVMData()),
+    kernel_memory_limit_(1024)
   {
     param_ = (struct svm_parameter*) malloc(sizeof(struct svm_parameter));
     initParameters_();
@@ -339,6 +347,16 @@ namespace OpenMS
     }
   }
 
+  void SVMWrapper::setKernelMemoryLimit(Size megabytes)
+  {
+    kernel_memory_limit_ = megabytes;
+  }
+
+  Size SVMWrapper::getKernelMemoryLimit() const
+  {
+    return kernel_memory_limit_;
+  }
+
   void SVMWrapper::setTrainingSample(svm_problem* training_sample)
   {
     training_set_ = training_sample;
@@ -421,7 +439,20 @@ namespace OpenMS
       {
         SVMWrapper::calculateGaussTable(border_length_, sigma_, gauss_table_);
       }
-      training_problem_ = computeKernelMatrix(problem, problem);
+      if (hasGramMatrix_(problem))
+      {
+        // kernel values were already computed (e.g. during cross validation)
+        vector<Size> rows(problem.sequences.size());
+        for (Size i = 0; i < rows.size(); ++i)
+        {
+          rows[i] = i;
+        }
+        training_problem_ = kernelMatrix_(problem, rows, rows, true);
+      }
+      else
+      {
+        training_problem_ = computeKernelMatrix(problem, problem);
+      }
 
       if (svm_check_parameter(training_problem_, param_) == NULL)
       {
@@ -536,11 +567,13 @@ namespace OpenMS
           problem = computeKernelMatrix(problem, training_set_);
         }
       }
-      results.reserve(problem->l);
-      for (Int i = 0; i < problem->l; i++)
+      results.resize(problem->l);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 64)
+#endif
+      for (SignedSize i = 0; i < (SignedSize)problem->l; i++)
       {
-        double label = svm_predict(model_, problem->x[i]);
-        results.push_back(label);
+        results[i] = svm_predict(model_, problem->x[i]);
       }
 
       if (kernel_type_ == OLIGO)
@@ -571,10 +604,13 @@ namespace OpenMS
       else if (model_ != NULL)
       {
         struct svm_problem* prediction_problem = computeKernelMatrix(problem, training_data_);
-        for (Size i = 0; i < problem.sequences.size(); i++)
+        results.resize(problem.sequences.size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 64)
+#endif
+        for (SignedSize i = 0; i < (SignedSize)problem.sequences.size(); i++)
         {
-          double label = svm_predict(model_, prediction_problem->x[i]);
-          results.push_back(label);
+          results[i] = svm_predict(model_, prediction_problem->x[i]);
         }
 
         LibSVMEncoder::destroyProblem(prediction_problem);
@@ -653,14 +689,6 @@ namespace OpenMS
                                           Size                                  number,
                                           vector<SVMData>& problems)
   {
-    vector<Size> indices;
-    vector<Size>::iterator indices_iterator;
-
-    for (Size i = 0; i < problems.size(); ++i)
-    {
-      problems[i].labels.clear();
-      problems[i].sequences.clear();
-    }
     problems.clear();
 
     if (number == 1)
@@ -669,50 +697,59 @@ namespace OpenMS
     }
     else if (number > 1)
     {
-      // Creating the particular partition instances
-      for (Size i = 0; i < number; i++)
-      {
-        problems.push_back(SVMData());
-      }
+      vector<vector<Size> > partition_indices;
+      createRandomPartitionIndices_(problem.sequences.size(), number, partition_indices);
 
-      // Creating indices
-      for (Size  i = 0; i < problem.sequences.size(); i++)
+      problems.resize(number, SVMData());
+      for (Size partition_index = 0; partition_index < number; partition_index++)
       {
-        indices.push_back(i);
+        const vector<Size>& indices = partition_indices[partition_index];
+        problems[partition_index].sequences.resize(indices.size(), std::vector<std::pair<int, double> >());
+        problems[partition_index].labels.resize(indices.size(), 0.);
+        for (Size k = 0; k < indices.size(); ++k)
+        {
+          problems[partition_index].sequences[k] = problem.sequences[indices[k]];
+          problems[partition_index].labels[k] = problem.labels[indices[k]];
+        }
       }
-      // Shuffling the indices => random indices
-      random_shuffle(indices.begin(), indices.end());
+    }
+  }
 
-      indices_iterator = indices.begin();
+  void SVMWrapper::createRandomPartitionIndices_(Size size, Size number, vector<vector<Size> >& partitions)
+  {
+    partitions.clear();
+    if (number == 0)
+    {
+      return;
+    }
 
-      for (Size partition_index = 0;
-           partition_index < number;
-           partition_index++)
-      {
-        Size actual_partition_size = 0;
-        // determining the number of elements in this partition
-        Size partition_count = (problem.sequences.size() / number);
-        if (problem.sequences.size() % number > partition_index)
-        {
-          partition_count++;
-        }
+    // Creating indices
+    vector<Size> indices;
+    for (Size i = 0; i < size; i++)
+    {
+      indices.push_back(i);
+    }
+    if (number == 1)
+    {
+      partitions.push_back(indices);
+      return;
+    }
 
-        // filling the actual partition with 'partition_count' elements
-        while (actual_partition_size < partition_count)
-        {
-          if (actual_partition_size == 0)
-          {
-            problems[partition_index].sequences.resize(partition_count, std::vector<std::pair<int, double> >());
-            problems[partition_index].labels.resize(partition_count, 0.);
-          }
-          problems[partition_index].sequences[actual_partition_size] =
-            problem.sequences[*indices_iterator];
-          problems[partition_index].labels[actual_partition_size] =
-            problem.labels[*indices_iterator];
-          ++actual_partition_size;
-          ++indices_iterator;
-        }
+    // Shuffling the indices => random indices
+    random_shuffle(indices.begin(), indices.end());
+
+    vector<Size>::const_iterator indices_iterator = indices.begin();
+    partitions.resize(number);
+    for (Size partition_index = 0; partition_index < number; partition_index++)
+    {
+      // determining the number of elements in this partition
+      Size partition_count = (size / number);
+      if (size % number > partition_index)
+      {
+        partition_count++;
       }
+      partitions[partition_index].assign(indices_iterator, indices_iterator + partition_count);
+      indices_iterator += partition_count;
     }
   }
 
@@ -853,13 +890,7 @@ namespace OpenMS
 
     bool found = false; // does a valid grid search cell (with a certain parameter combination) exist?
     Size counter = 0;
-    vector<svm_problem*> partitions_ul;
-    svm_problem** training_data_ul = NULL;
-    vector<SVMData> partitions_l;
-    vector<SVMData> training_data_l;
     double temp_performance = 0;
-    vector<double> predicted_labels;
-    vector<double> real_labels;
     vector<double> performances;
     Size max_index = 0;
     double max = 0;
@@ -911,101 +942,167 @@ namespace OpenMS
     work_steps *= number_of_runs * number_of_partitions;
     startProgress(0, work_steps, "SVM-CrossValidation");
 
-    // for every run (each run is identical, except for random partitioning of the data)
-    for (Size i = 0; i < number_of_runs; i++)
+    // enumerate all grid cells (parameter combinations)
+    vector<vector<double> > grid_cells;
+    found = true;
+    while (found)
     {
-      for (Size index = 0; index < start_values_map.size(); ++index)
+      for (Size v = 0; v < start_values_map.size(); ++v)
       {
-        best_values[index] = 0;
+        // testing whether actual parameters are in the defined range
+        if (actual_values[v] > end_values[v])
+          throw Exception::InvalidParameter(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "RTModel CV parameters are out of range!");
       }
-      double max_performance = 0;
+      grid_cells.push_back(actual_values);
+      found = nextGrid_(start_values, step_sizes, end_values, additive_step_sizes, actual_values);
+    }
+    const Size number_of_cells = grid_cells.size();
+
+    // create the random partitions of all runs (each run is identical, except for random partitioning of the data)
+    vector<vector<vector<Size> > > partition_indices(number_of_runs);
+    vector<vector<svm_problem*> > partitions_ul(number_of_runs);
+    vector<vector<svm_problem*> > training_data_ul(number_of_runs);
+    for (Size i = 0; i < number_of_runs; i++)
+    {
       if (is_labeled)
-        createRandomPartitions(problem_l, number_of_partitions, partitions_l);
+      {
+        createRandomPartitionIndices_(problem_l.sequences.size(), number_of_partitions, partition_indices[i]);
+      }
       else
-        createRandomPartitions(problem_ul, number_of_partitions, partitions_ul);
+      {
+        createRandomPartitions(problem_ul, number_of_partitions, partitions_ul[i]);
+        for (Size j = 0; j < number_of_partitions; j++)
+        {
+          training_data_ul[i].push_back(SVMWrapper::mergePartitions(partitions_ul[i], j));
+        }
+      }
+    }
 
-      counter = 0;
-      found = true;
+    // The oligo kernel depends on sigma, so the grid cells are processed in groups of equal sigma. Within such a
+    // group, the kernel values of all pairs of sequences are computed only once (Gram matrix) and every
+    // combination of run, grid cell and partition is trained and evaluated independently (in parallel).
+    Size sigma_index = start_values_map.size();
+    for (Size v = 0; v < start_values_map.size(); ++v)
+    {
+      if (actual_types[v] == SIGMA) sigma_index = v;
+    }
+    vector<double> sigma_values;
+    for (Size c = 0; c < number_of_cells; ++c)
+    {
+      double sigma = (sigma_index < start_values_map.size()) ? grid_cells[c][sigma_index] : sigma_;
+      if (find(sigma_values.begin(), sigma_values.end(), sigma) == sigma_values.end()) sigma_values.push_back(sigma);
+    }
 
+    // performance of each fold, indexed by (run * number_of_cells + cell) * number_of_partitions + partition
+    vector<double> fold_performances(number_of_runs * number_of_cells * number_of_partitions, 0.0);
+    vector<char> fold_success(fold_performances.size(), 0);
+    for (Size s = 0; s < sigma_values.size(); ++s)
+    {
+      if (sigma_index < start_values_map.size())
+      {
+        setParameter(SIGMA, sigma_values[s]);
+      }
+      bool use_gram = false;
       if (is_labeled)
-        training_data_l.resize(number_of_partitions, SVMData());
-      else
-        training_data_ul = new svm_problem*[number_of_partitions];
-      for (Size j = 0; j < number_of_partitions; j++)
       {
-        if (is_labeled)
-          SVMWrapper::mergePartitions(partitions_l, j, training_data_l[j]);
-        else
-          training_data_ul[j] = SVMWrapper::mergePartitions(partitions_ul, j);
+        updateGramMatrix_(problem_l);
+        use_gram = hasGramMatrix_(problem_l);
       }
 
-      while (found) // do grid search
+      vector<Size> folds;
+      for (Size t = 0; t < fold_performances.size(); ++t)
       {
+        Size c = (t / number_of_partitions) % number_of_cells;
+        if (sigma_index >= start_values_map.size() || grid_cells[c][sigma_index] == sigma_values[s]) folds.push_back(t);
+      }
+
+      // each fold holds its own kernel matrix, so the memory limit bounds the number of parallel folds
+      const int fold_threads = getFoldThreads_(is_labeled ? problem_l.sequences.size() : (Size)problem_ul->l, number_of_partitions);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1) num_threads(fold_threads)
+#endif
+      for (SignedSize f = 0; f < (SignedSize)folds.size(); ++f)
+      {
+        const Size t = folds[f];
+        const Size j = t % number_of_partitions;
+        const Size c = (t / number_of_partitions) % number_of_cells;
+        const Size i = t / (number_of_partitions * number_of_cells);
+
         // setting svm parameters
+        svm_parameter param = *param_;
         for (Size v = 0; v < start_values_map.size(); ++v)
         {
-          // testing whether actual parameters are in the defined range
-          if (actual_values[v] > end_values[v])
-            throw Exception::InvalidParameter(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "RTModel CV parameters are out of range!");
-          setParameter(actual_types[v], actual_values[v]);
+          setParameter_(param, actual_types[v], grid_cells[c][v]);
         }
 
-        temp_performance = 0;
-
-        vector<double>::iterator it_start, it_end;
-
-        // loop over PARTITIONS
-        for (Size j = 0; j < number_of_partitions; j++)
+        vector<double> fold_predicted_labels;
+        vector<double> fold_real_labels;
+        bool success;
+        if (is_labeled)
         {
-          setProgress(work_steps_count++);
-
-          bool success;
-          if (is_labeled)
-            success = train(training_data_l[j]);
-          else
-            success = train(training_data_ul[j]);
+          success = evaluateFold_(param, problem_l, partition_indices[i], j, use_gram, fold_predicted_labels);
+          for (Size k = 0; k < partition_indices[i][j].size(); ++k)
+          {
+            fold_real_labels.push_back(problem_l.labels[partition_indices[i][j][k]]);
+          }
+        }
+        else
+        {
+          success = evaluateFold_(param, training_data_ul[i][j], partitions_ul[i][j], fold_predicted_labels);
+          getLabels(partitions_ul[i][j], fold_real_labels);
+        }
 
-          if (success)
+        if (success)
+        {
+          if (param.svm_type == C_SVC || param.svm_type == NU_SVC)
           {
-            if (is_labeled)
+            if (mcc_as_performance_measure)
             {
-              predict(partitions_l[j], predicted_labels);
-
-              it_start = partitions_l[j].labels.begin();
-              it_end = partitions_l[j].labels.end();
+              fold_performances[t] =
+                OpenMS::Math::matthewsCorrelationCoefficient(fold_predicted_labels.begin(), fold_predicted_labels.end(), fold_real_labels.begin(), fold_real_labels.end());
             }
             else
             {
-              predict(partitions_ul[j], predicted_labels);
-              getLabels(partitions_ul[j], real_labels);
-
-              it_start = real_labels.begin();
-              it_end = real_labels.end();
+              fold_performances[t] =
+                OpenMS::Math::classificationRate(fold_predicted_labels.begin(), fold_predicted_labels.end(), fold_real_labels.begin(), fold_real_labels.end());
             }
+          }
+          else if (param.svm_type == NU_SVR || param.svm_type == EPSILON_SVR)
+          {
+            fold_performances[t] =
+              Math::pearsonCorrelationCoefficient(fold_predicted_labels.begin(), fold_predicted_labels.end(), fold_real_labels.begin(), fold_real_labels.end());
+          }
+          fold_success[t] = 1;
+        }
 
-            if (param_->svm_type == C_SVC || param_->svm_type == NU_SVC)
-            {
-              if (mcc_as_performance_measure)
-              {
-                temp_performance +=
-                  OpenMS::Math::matthewsCorrelationCoefficient(predicted_labels.begin(), predicted_labels.end(), it_start, it_end);
-              }
-              else
-              {
-                temp_performance +=
-                  OpenMS::Math::classificationRate(predicted_labels.begin(), predicted_labels.end(), it_start, it_end);
-              }
-            }
-            else if (param_->svm_type == NU_SVR || param_->svm_type == EPSILON_SVR)
-            {
-              temp_performance +=
-                Math::pearsonCorrelationCoefficient(predicted_labels.begin(), predicted_labels.end(), it_start, it_end);
-            }
+        IF_MASTERTHREAD setProgress(work_steps_count);
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+        ++work_steps_count;
+      }
+    }
 
-            if (param_->kernel_type == PRECOMPUTED)
-            {
-              LibSVMEncoder::destroyProblem(training_problem_);
-            }
+    // collect the performances (in the same order as a sequential grid search)
+    for (Size i = 0; i < number_of_runs; i++)
+    {
+      for (Size index = 0; index < start_values_map.size(); ++index)
+      {
+        best_values[index] = 0;
+      }
+      double max_performance = 0;
+
+      for (Size c = 0; c < number_of_cells; ++c)
+      {
+        temp_performance = 0;
+
+        // loop over PARTITIONS
+        for (Size j = 0; j < number_of_partitions; j++)
+        {
+          const Size t = (i * number_of_cells + c) * number_of_partitions + j;
+          if (fold_success[t])
+          {
+            temp_performance += fold_performances[t];
 
             if (output && j == number_of_partitions - 1)
             {
@@ -1015,27 +1112,27 @@ namespace OpenMS
                 switch (actual_types[k])
                 {
                 case C:
-                  performances_file << "C: " << actual_values[k];
+                  performances_file << "C: " << grid_cells[c][k];
                   break;
 
                 case NU:
-                  performances_file << "NU: " << actual_values[k];
+                  performances_file << "NU: " << grid_cells[c][k];
                   break;
 
                 case DEGREE:
-                  performances_file << "DEGREE: " << actual_values[k];
+                  performances_file << "DEGREE: " << grid_cells[c][k];
                   break;
 
                 case P:
-                  performances_file << "P: " << actual_values[k];
+                  performances_file << "P: " << grid_cells[c][k];
                   break;
 
                 case GAMMA:
-                  performances_file << "GAMMA: " << actual_values[k];
+                  performances_file << "GAMMA: " << grid_cells[c][k];
                   break;
 
                 case SIGMA:
-                  performances_file << "SIGMA: " << actual_values[k];
+                  performances_file << "SIGMA: " << grid_cells[c][k];
                   break;
 
                 default:
@@ -1065,7 +1162,7 @@ namespace OpenMS
           max_performance = temp_performance;
           for (Size index = 0; index < start_values_map.size(); ++index)
           {
-            best_values[index] = actual_values[index];
+            best_values[index] = grid_cells[c][index];
           }
         }
 
@@ -1075,23 +1172,28 @@ namespace OpenMS
         }
         else // 2nd+ run, add performance (will be averaged later)
         {
-          performances[counter] = performances[counter] + temp_performance;
-          counter++;
+          performances[c] = performances[c] + temp_performance;
         }
-
-        // trying to find new parameter combination
-        found = nextGrid_(start_values, step_sizes, end_values, additive_step_sizes, actual_values);
       } // ! grid search
 
       if (!is_labeled)
       {
-        for (Size k = 0; k < number_of_partitions; k++)
+        for (Size k = 0; k < training_data_ul[i].size(); k++)
+        {
+          if (training_data_ul[i][k] != NULL)
+          {
+            delete[] training_data_ul[i][k]->x;
+            delete[] training_data_ul[i][k]->y;
+            delete training_data_ul[i][k]; // delete individual objects
+          }
+        }
+        // the partitions share the data points with 'problem_ul' (unless there is only one)
+        for (Size k = 0; number_of_partitions > 1 && k < partitions_ul[i].size(); k++)
         {
-          delete[] training_data_ul[k]->x;
-          delete[] training_data_ul[k]->y;
-          delete training_data_ul[k]; // delete individual objects
+          delete[] partitions_ul[i][k]->x;
+          delete[] partitions_ul[i][k]->y;
+          delete partitions_ul[i][k];
         }
-        delete[] training_data_ul; // delete array of pointers
       }
 
       // not essential...
@@ -1303,10 +1405,13 @@ namespace OpenMS
 
     if (model_ != NULL)
     {
-      for (Size i = 0; i < vectors.size(); i++)
+      results.resize(vectors.size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 64)
+#endif
+      for (SignedSize i = 0; i < (SignedSize)vectors.size(); i++)
       {
-        double label = svm_predict(model_, vectors[i]);
-        results.push_back(label);
+        results[i] = svm_predict(model_, vectors[i]);
       }
     }
   }
@@ -1595,7 +1700,6 @@ namespace OpenMS
 
   svm_problem* SVMWrapper::computeKernelMatrix(svm_problem* problem1, svm_problem* problem2)
   {
-    double temp = 0;
     svm_problem* kernel_matrix;
 
     if (problem1 == NULL || problem2 == NULL)
@@ -1617,13 +1721,18 @@ namespace OpenMS
       kernel_matrix->x[i][problem2->l + 1].index = -1;
     }
 
+    // rows are independent (in the symmetric case, each entry is written by the row of its smaller index);
+    // called from the parallel cross validation, the rows are computed by the calling thread
     if (problem1 == problem2)
     {
-      for (Size i = 0; i < number_of_sequences; i++)
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 16) if (!omp_in_parallel())
+#endif
+      for (SignedSize i = 0; i < (SignedSize)number_of_sequences; i++)
       {
         for (Size j = i; j < number_of_sequences; j++)
         {
-          temp = SVMWrapper::kernelOligo(problem1->x[i], problem2->x[j], gauss_table_);
+          double temp = SVMWrapper::kernelOligo(problem1->x[i], problem2->x[j], gauss_table_);
           kernel_matrix->x[i][j + 1].index = (Int)j + 1;
           kernel_matrix->x[i][j + 1].value = temp;
           kernel_matrix->x[j][i + 1].index = (Int)i + 1;
@@ -1633,11 +1742,14 @@ namespace OpenMS
     }
     else
     {
-      for (Size i = 0; i < number_of_sequences; i++)
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 16) if (!omp_in_parallel())
+#endif
+      for (SignedSize i = 0; i < (SignedSize)number_of_sequences; i++)
       {
         for (Size j = 0; j < (Size) problem2->l; j++)
         {
-          temp = SVMWrapper::kernelOligo(problem1->x[i], problem2->x[j], gauss_table_);
+          double temp = SVMWrapper::kernelOligo(problem1->x[i], problem2->x[j], gauss_table_);
 
           kernel_matrix->x[i][j + 1].index = (Int)j + 1;
           kernel_matrix->x[i][j + 1].value = temp;
@@ -1649,7 +1761,6 @@ namespace OpenMS
 
   svm_problem* SVMWrapper::computeKernelMatrix(const SVMData& problem1, const SVMData& problem2)
   {
-    double temp = 0;
     svm_problem* kernel_matrix;
 
     if (problem1.labels.empty() || problem2.labels.empty())
@@ -1678,33 +1789,80 @@ namespace OpenMS
       kernel_matrix->x[i][problem2.labels.size() + 1].index = -1;
     }
 
+    // rows are independent (in the symmetric case, each entry is written by the row of its smaller index);
+    // exceptions cannot leave a parallel region, the one of the first failing row is kept
+    SignedSize failed_row = -1;
+    boost::exception_ptr error;
     if (&problem1 == &problem2)
     {
-      for (Size i = 0; i < number_of_sequences; i++)
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 16) if (!omp_in_parallel())
+#endif
+      for (SignedSize i = 0; i < (SignedSize)number_of_sequences; i++)
       {
-        for (Size j = i; j < number_of_sequences; j++)
+        try
         {
-          temp = SVMWrapper::kernelOligo(problem1.sequences[i], problem2.sequences[j], gauss_table_);
-          kernel_matrix->x[i][j + 1].index = int(j) + 1;
-          kernel_matrix->x[i][j + 1].value = temp;
-          kernel_matrix->x[j][i + 1].index = int(i) + 1;
-          kernel_matrix->x[j][i + 1].value = temp;
+          for (Size j = i; j < number_of_sequences; j++)
+          {
+            double temp = SVMWrapper::kernelOligo(problem1.sequences[i], problem2.sequences[j], gauss_table_);
+            kernel_matrix->x[i][j + 1].index = int(j) + 1;
+            kernel_matrix->x[i][j + 1].value = temp;
+            kernel_matrix->x[j][i + 1].index = int(i) + 1;
+            kernel_matrix->x[j][i + 1].value = temp;
+          }
+        }
+        catch (...)
+        {
+#ifdef _OPENMP
+#pragma omp critical (OPENMS_SVMWrapper_kernel_error)
+#endif
+          {
+            if (failed_row < 0 || i < failed_row)
+            {
+              failed_row = i;
+              error = boost::current_exception();
+            }
+          }
         }
       }
     }
     else
     {
-      for (Size i = 0; i < number_of_sequences; i++)
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 16) if (!omp_in_parallel())
+#endif
+      for (SignedSize i = 0; i < (SignedSize)number_of_sequences; i++)
       {
-        for (Size j = 0; j < problem2.labels.size(); j++)
+        try
         {
-          temp = SVMWrapper::kernelOligo(problem1.sequences[i], problem2.sequences[j], gauss_table_);
+          for (Size j = 0; j < problem2.labels.size(); j++)
+          {
+            double temp = SVMWrapper::kernelOligo(problem1.sequences[i], problem2.sequences[j], gauss_table_);
 
-          kernel_matrix->x[i][j + 1].index = int(j) + 1;
-          kernel_matrix->x[i][j + 1].value = temp;
+            kernel_matrix->x[i][j + 1].index = int(j) + 1;
+            kernel_matrix->x[i][j + 1].value = temp;
+          }
+        }
+        catch (...)
+        {
+#ifdef _OPENMP
+#pragma omp critical (OPENMS_SVMWrapper_kernel_error)
+#endif
+          {
+            if (failed_row < 0 || i < failed_row)
+            {
+              failed_row = i;
+              error = boost::current_exception();
+            }
+          }
         }
       }
     }
+    if (error)
+    {
+      LibSVMEncoder::destroyProblem(kernel_matrix);
+      boost::rethrow_exception(error);
+    }
     return kernel_matrix;
   }
 
@@ -1799,9 +1957,6 @@ namespace OpenMS
   {
     vector<pair<double, double> > points;
     vector<double>                                      differences;
-    vector<SVMData>                                         partitions;
-    SVMData                                                             training_data;
-    vector<double>                                      predicted_labels;
     Size                                                                    counter = 0;
     Size                                                                    target = 0;
     ofstream                                                            file("points.txt");
@@ -1816,35 +1971,53 @@ namespace OpenMS
 
 
     // creation of points (measured rt, predicted rt)
+    // All random partitions are created first. The kernel values of all pairs of sequences are computed once,
+    // and the folds are then trained and evaluated in parallel.
+    vector<vector<vector<Size> > > partition_indices(number_of_runs);
     for (Size i = 0; i < number_of_runs; ++i)
     {
-      createRandomPartitions(data, number_of_partitions, partitions);
+      createRandomPartitionIndices_(data.sequences.size(), number_of_partitions, partition_indices[i]);
+    }
+    updateGramMatrix_(data);
+    const bool use_gram = hasGramMatrix_(data);
 
+    vector<vector<double> > fold_predictions(number_of_runs * number_of_partitions);
+    vector<char> fold_success(fold_predictions.size(), 0);
+    const int fold_threads = getFoldThreads_(data.sequences.size(), number_of_partitions);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1) num_threads(fold_threads)
+#endif
+    for (SignedSize t = 0; t < (SignedSize)fold_predictions.size(); ++t)
+    {
+      const Size i = t / number_of_partitions;
+      const Size j = t % number_of_partitions;
+      fold_success[t] = evaluateFold_(*param_, data, partition_indices[i], j, use_gram, fold_predictions[t]);
+    }
+
+    for (Size i = 0; i < number_of_runs; ++i)
+    {
       for (Size j = 0; j < number_of_partitions; ++j)
       {
-        SVMWrapper::mergePartitions(partitions, j, training_data);
-        if (train(training_data))
+        const Size t = i * number_of_partitions + j;
+        if (fold_success[t])
         {
-          predict(partitions[j], predicted_labels);
-          vector<double>::iterator pred_it = predicted_labels.begin();
-          vector<double>::iterator real_it = partitions[j].labels.begin();
-          while (pred_it != predicted_labels.end()
-                && real_it != partitions[j].labels.end())
+          const vector<Size>& test_indices = partition_indices[i][j];
+          for (Size k = 0; k < fold_predictions[t].size() && k < test_indices.size(); ++k)
           {
-            points.push_back(make_pair(*real_it, *pred_it));
-            differences.push_back(abs(*real_it - *pred_it));
-            file << *real_it << " " << *pred_it << endl;
+            double real = data.labels[test_indices[k]];
+            double predicted = fold_predictions[t][k];
+            points.push_back(make_pair(real, predicted));
+            differences.push_back(abs(real - predicted));
+            file << real << " " << predicted << endl;
 
-            if (*real_it < minimum)
+            if (real < minimum)
             {
-              minimum = *real_it;
+              minimum = real;
             }
-            if (*real_it > maximum)
+            if (real > maximum)
             {
-              maximum = *real_it;
+              maximum = real;
             }
-            ++pred_it;
-            ++real_it;
           }
         }
       }
@@ -2048,4 +2221,266 @@ namespace OpenMS
     }
   }
 
+  void SVMWrapper::setParameter_(svm_parameter& param, SVM_parameter_type type, double value)
+  {
+    switch (type)
+    {
+    case (DEGREE):
+      param.degree = (int)value;
+      break;
+
+    case (C):
+      param.C = value;
+      break;
+
+    case (P):
+      param.p = value;
+      break;
+
+    case (NU):
+      param.nu = value;
+      break;
+
+    case (GAMMA):
+      param.gamma = value;
+      break;
+
+    default:
+      break;
+    }
+  }
+
+  void SVMWrapper::destroyModel_(svm_model* model)
+  {
+    if (model != NULL)
+    {
+#if OPENMS_LIBSVM_VERSION_MAJOR == 2
+      svm_destroy_model(model);
+#else
+      svm_free_and_destroy_model(&model);
+#endif
+    }
+  }
+
+  bool SVMWrapper::hasGramMatrix_(const SVMData& data) const
+  {
+    return !data.sequences.empty()
+           && gram_matrix_.size() == data.sequences.size() * data.sequences.size()
+           && gram_gauss_table_ == gauss_table_
+           && gram_sequences_ == data.sequences;
+  }
+
+  void SVMWrapper::updateGramMatrix_(const SVMData& data)
+  {
+    if (border_length_ != gauss_table_.size())
+    {
+      SVMWrapper::calculateGaussTable(border_length_, sigma_, gauss_table_);
+    }
+    if (hasGramMatrix_(data))
+    {
+      return;
+    }
+
+    gram_matrix_.clear();
+    gram_sequences_.clear();
+    gram_gauss_table_.clear();
+
+    // too large to be kept: kernel values are computed on the fly (see kernelMatrix_())
+    const double gram_megabytes = (double)data.sequences.size() * data.sequences.size() * sizeof(double) / (1024.0 * 1024.0);
+    if (gram_megabytes > kernel_memory_limit_)
+    {
+      LOG_DEBUG << "SVMWrapper: Gram matrix of " << data.sequences.size() << " sequences exceeds the kernel memory limit, kernel values are computed on the fly." << std::endl;
+      return;
+    }
+
+    // both argument orders are computed, as the oligo kernel is symmetric only up to rounding
+    const Size n = data.sequences.size();
+    vector<double> gram_matrix(n * n);
+    // exceptions cannot leave a parallel region, the one of the first failing row is kept
+    SignedSize failed_row = -1;
+    boost::exception_ptr error;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 16)
+#endif
+    for (SignedSize i = 0; i < (SignedSize)n; ++i)
+    {
+      try
+      {
+        for (Size j = 0; j < n; ++j)
+        {
+          gram_matrix[i * n + j] = SVMWrapper::kernelOligo(data.sequences[i], data.sequences[j], gauss_table_);
+        }
+      }
+      catch (...)
+      {
+#ifdef _OPENMP
+#pragma omp critical (OPENMS_SVMWrapper_kernel_error)
+#endif
+        {
+          if (failed_row < 0 || i < failed_row)
+          {
+            failed_row = i;
+            error = boost::current_exception();
+          }
+        }
+      }
+    }
+    if (error)
+    {
+      boost::rethrow_exception(error);
+    }
+
+    gram_matrix_.swap(gram_matrix);
+    gram_sequences_ = data.sequences;
+    gram_gauss_table_ = gauss_table_;
+  }
+
+  svm_problem* SVMWrapper::kernelMatrix_(const SVMData& data, const vector<Size>& rows, const vector<Size>& columns, bool use_gram) const
+  {
+    if (rows.empty() || columns.empty())
+    {
+      return NULL;
+    }
+
+    const Size n = data.sequences.size();
+    const bool symmetric = (&rows == &columns);
+    svm_problem* kernel_matrix = new svm_problem;
+    kernel_matrix->l = (int) rows.size();
+    kernel_matrix->x = new svm_node*[rows.size()];
+    kernel_matrix->y = new double[rows.size()];
+
+    for (Size i = 0; i < rows.size(); i++)
+    {
+      svm_node* row = new svm_node[columns.size() + 2];
+      row[0].index = 0;
+      row[0].value = i + 1;
+      for (Size j = 0; j < columns.size(); j++)
+      {
+        // use the same argument order of the kernel as computeKernelMatrix()
+        Size first = rows[i];
+        Size second = columns[j];
+        if (symmetric && j < i)
+        {
+          std::swap(first, second);
+        }
+        row[j + 1].index = int(j) + 1;
+        row[j + 1].value = use_gram ? gram_matrix_[first * n + second]
+                                    : SVMWrapper::kernelOligo(data.sequences[first], data.sequences[second], gauss_table_);
+      }
+      row[columns.size() + 1].index = -1;
+      kernel_matrix->x[i] = row;
+      kernel_matrix->y[i] = data.labels[rows[i]];
+    }
+    return kernel_matrix;
+  }
+
+  int SVMWrapper::getFoldThreads_(Size number_of_sequences, Size number_of_partitions) const
+  {
+    int threads = 1;
+#ifdef _OPENMP
+    threads = omp_get_max_threads();
+#endif
+    if (kernel_type_ != OLIGO || number_of_partitions == 0)
+    {
+      return threads;
+    }
+
+    // training and test kernel matrix of one fold: every sequence against all training sequences
+    const double training_size = (double)number_of_sequences * (number_of_partitions - 1) / number_of_partitions;
+    const double fold_megabytes = number_of_sequences * (training_size + 2) * sizeof(svm_node) / (1024.0 * 1024.0);
+    if (fold_megabytes * threads > kernel_memory_limit_)
+    {
+      threads = std::max(1, (int)(kernel_memory_limit_ / fold_megabytes));
+    }
+    return threads;
+  }
+
+  bool SVMWrapper::evaluateFold_(svm_parameter param,
+                                 const SVMData& data,
+                                 const vector<vector<Size> >& partitions,
+                                 Size test_partition,
+                                 bool use_gram,
+                                 vector<double>& predicted_labels) const
+  {
+    predicted_labels.clear();
+
+    // the training data consists of all other partitions (in the same order as in mergePartitions())
+    vector<Size> training_rows;
+    for (Size k = 0; k < partitions.size(); ++k)
+    {
+      if (k != test_partition)
+      {
+        training_rows.insert(training_rows.end(), partitions[k].begin(), partitions[k].end());
+      }
+    }
+
+    svm_problem* training_problem = kernelMatrix_(data, training_rows, training_rows, use_gram);
+    if (training_problem == NULL || svm_check_parameter(training_problem, &param) != NULL)
+    {
+      LibSVMEncoder::destroyProblem(training_problem);
+      return false;
+    }
+    svm_model* model = svm_train(training_problem, &param);
+    if (model == NULL)
+    {
+      LibSVMEncoder::destroyProblem(training_problem);
+      return false;
+    }
+
+    svm_problem* test_problem = kernelMatrix_(data, partitions[test_partition], training_rows, use_gram);
+    if (test_problem != NULL)
+    {
+      for (Int i = 0; i < test_problem->l; ++i)
+      {
+        predicted_labels.push_back(svm_predict(model, test_problem->x[i]));
+      }
+    }
+
+    // the model refers to the support vectors of the training problem
+    destroyModel_(model);
+    LibSVMEncoder::destroyProblem(test_problem);
+    LibSVMEncoder::destroyProblem(training_problem);
+    return true;
+  }
+
+  bool SVMWrapper::evaluateFold_(svm_parameter param,
+                                 svm_problem* training_data,
+                                 svm_problem* test_data,
+                                 vector<double>& predicted_labels)
+  {
+    predicted_labels.clear();
+
+    if (training_data == NULL || test_data == NULL || svm_check_parameter(training_data, &param) != NULL)
+    {
+      return false;
+    }
+
+    svm_problem* training_problem = training_data;
+    svm_problem* test_problem = test_data;
+    if (kernel_type_ == OLIGO)
+    {
+      training_problem = computeKernelMatrix(training_data, training_data);
+      test_problem = computeKernelMatrix(test_data, training_data);
+    }
+
+    svm_model* model = svm_train(training_problem, &param);
+    const bool trained = (model != NULL);
+    if (trained)
+    {
+      for (Int i = 0; i < test_problem->l; ++i)
+      {
+        predicted_labels.push_back(svm_predict(model, test_problem->x[i]));
+      }
+    }
+
+    // the model refers to the support vectors of the training problem
+    destroyModel_(model);
+    if (kernel_type_ == OLIGO)
+    {
+      LibSVMEncoder::destroyProblem(test_problem);
+      LibSVMEncoder::destroyProblem(training_problem);
+    }
+    return trained;
+  }
+
 } // namespace OpenMS
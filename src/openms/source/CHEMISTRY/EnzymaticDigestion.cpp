@@ -241,6 +241,19 @@ namespace OpenMS
   }
 
   void EnzymaticDigestion::digestUnmodifiedString(const StringView sequence, std::vector<StringView>& output, Size min_length, Size max_length) const
+  {
+    std::vector<std::pair<Size, Size> > positions;
+    digestUnmodifiedString(sequence, positions, min_length, max_length);
+
+    output.clear();
+    output.reserve(positions.size());
+    for (std::vector<std::pair<Size, Size> >::const_iterator it = positions.begin(); it != positions.end(); ++it)
+    {
+      output.push_back(sequence.substr(it->first, it->first + it->second - 1));
+    }
+  }
+
+  void EnzymaticDigestion::digestUnmodifiedString(const StringView sequence, std::vector<std::pair<Size, Size> >& output, Size min_length, Size max_length) const
   {
     // initialization
     output.clear();
@@ -260,7 +273,7 @@ namespace OpenMS
     {
       if (sequence.size() >= min_length && sequence.size() <= max_length)
       {
-        output.push_back(sequence);
+        output.push_back(std::make_pair(Size(0), sequence.size()));
       }
       return;
     }
@@ -271,7 +284,7 @@ namespace OpenMS
       Size l = pep_positions[i] - pep_positions[i - 1];
       if (l >= min_length && l <= max_length)
       {
-        output.push_back(sequence.substr(pep_positions[i - 1], pep_positions[i] - 1));
+        output.push_back(std::make_pair(pep_positions[i - 1], l));
       }
     }
 
@@ -279,7 +292,7 @@ namespace OpenMS
     Size l = sequence.size() - pep_positions[count - 1];
     if (l >= min_length && l <= max_length)
     {
-      output.push_back(sequence.substr(pep_positions[count - 1], sequence.size() - 1));
+      output.push_back(std::make_pair(pep_positions[count - 1], l));
     }
 
     // generate fragments with missed cleavages
@@ -290,7 +303,7 @@ namespace OpenMS
         Size l = pep_positions[j + i] - pep_positions[j - 1];
         if (l >= min_length && l <= max_length)
         {
-          output.push_back(sequence.substr(pep_positions[j - 1], pep_positions[j + i] - 1));
+          output.push_back(std::make_pair(pep_positions[j - 1], l));
         }
       }
 
@@ -298,7 +311,7 @@ namespace OpenMS
       Size l = sequence.size() - pep_positions[count - i - 1];
       if (l >= min_length && l <= max_length)
       {
-        output.push_back(sequence.substr(pep_positions[count - i - 1], sequence.size() - 1 ));
+        output.push_back(std::make_pair(pep_positions[count - i - 1], l));
       }
     }
   }
@@ -0,0 +1,495 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2016.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: Timo Sachsenberg $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CHEMISTRY/PeptideCatalogue.h>
+
+#include <OpenMS/CHEMISTRY/Residue.h>
+#include <OpenMS/CHEMISTRY/ResidueDB.h>
+#include <OpenMS/CONCEPT/LogStream.h>
+#include <OpenMS/SYSTEM/File.h>
+
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define PEPTIDE_CATALOGUE_IDENTIFIER 8096
+
+using std::vector;
+
+namespace OpenMS
+{
+
+  namespace
+  {
+    /// a peptide in the digested protein database
+    struct Occurrence_
+    {
+      Size protein;
+      Size start;
+      Size length;
+      double mass;
+    };
+
+    /// orders occurrences by mass and sequence (so identical peptides are adjacent), then by position in the database
+    struct OccurrenceLess_
+    {
+      explicit OccurrenceLess_(const vector<FASTAFile::FASTAEntry>& proteins) :
+        proteins_(proteins)
+      {
+      }
+
+      bool operator()(const Occurrence_& a, const Occurrence_& b) const
+      {
+        if (a.mass != b.mass) return a.mass < b.mass;
+        if (a.length != b.length) return a.length < b.length;
+        int cmp = std::memcmp(proteins_[a.protein].sequence.data() + a.start, proteins_[b.protein].sequence.data() + b.start, a.length);
+        if (cmp != 0) return cmp < 0;
+        if (a.protein != b.protein) return a.protein < b.protein;
+        return a.start < b.start;
+      }
+
+      const vector<FASTAFile::FASTAEntry>& proteins_;
+    };
+
+    /// appends a flat array to the stream
+    template <typename T>
+    void writeArray_(std::ofstream& ofs, const vector<T>& data)
+    {
+      Size n = data.size();
+      ofs.write((const char*) &n, sizeof(n));
+      if (n > 0)
+      {
+        ofs.write((const char*) &data[0], n * sizeof(T));
+      }
+    }
+
+    /// reads a flat array from a memory mapped buffer, advancing @p pos
+    template <typename T>
+    void readArray_(const char* data, Size data_size, Size& pos, vector<T>& result, const String& filename)
+    {
+      Size n = 0;
+      if (pos + sizeof(n) > data_size)
+      {
+        throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename, "Unexpected end of peptide catalogue.");
+      }
+      std::memcpy(&n, data + pos, sizeof(n));
+      pos += sizeof(n);
+      if (n > (data_size - pos) / sizeof(T))
+      {
+        throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename, "Unexpected end of peptide catalogue.");
+      }
+      result.resize(n);
+      if (n > 0)
+      {
+        std::memcpy(&result[0], data + pos, n * sizeof(T));
+      }
+      pos += n * sizeof(T);
+    }
+  }
+
+  PeptideCatalogue::PeptideCatalogue()
+  {
+    clear();
+  }
+
+  PeptideCatalogue::~PeptideCatalogue()
+  {
+  }
+
+  void PeptideCatalogue::build(const vector<FASTAFile::FASTAEntry>& proteins, const EnzymaticDigestion& digestion, Size min_length, Size max_length)
+  {
+    clear();
+
+    // residue masses by one letter code (ResidueDB is not accessed in the parallel section);
+    // summed like in AASequence::getMonoWeight() to get identical masses
+    vector<double> residue_mass(256, 0.0);
+    vector<bool> is_residue(256, false);
+    for (Size c = 0; c < 256; ++c)
+    {
+      const Residue* residue = ResidueDB::getInstance()->getResidue((unsigned char)c);
+      if (residue != 0)
+      {
+        residue_mass[c] = residue->getMonoWeight(Residue::Internal);
+        is_residue[c] = true;
+      }
+    }
+    const double internal_to_full = Residue::getInternalToFull().getMonoWeight();
+
+    // digest the proteins in parallel, every thread collects its own peptides
+#ifdef _OPENMP
+    Size threads = omp_get_max_threads();
+#else
+    Size threads = 1;
+#endif
+    vector<vector<Occurrence_> > thread_occurrences(threads);
+    Size skipped = 0;
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 100) reduction(+: skipped)
+#endif
+    for (SignedSize p = 0; p < (SignedSize)proteins.size(); ++p)
+    {
+#ifdef _OPENMP
+      vector<Occurrence_>& occurrences = thread_occurrences[omp_get_thread_num()];
+#else
+      vector<Occurrence_>& occurrences = thread_occurrences[0];
+#endif
+      const String& sequence = proteins[p].sequence;
+      vector<std::pair<Size, Size> > peptides;
+      digestion.digestUnmodifiedString(sequence, peptides, min_length, max_length);
+      for (Size i = 0; i < peptides.size(); ++i)
+      {
+        Occurrence_ occurrence;
+        occurrence.protein = p;
+        occurrence.start = peptides[i].first;
+        occurrence.length = peptides[i].second;
+        occurrence.mass = 0.0;
+        bool valid = true;
+        for (Size j = occurrence.start; j < occurrence.start + occurrence.length; ++j)
+        {
+          unsigned char c = sequence[j];
+          valid = valid && is_residue[c];
+          occurrence.mass += residue_mass[c];
+        }
+        if (!valid)
+        {
+          ++skipped;
+          continue;
+        }
+        occurrence.mass += internal_to_full;
+        occurrences.push_back(occurrence);
+      }
+    }
+
+    if (skipped > 0)
+    {
+      LOG_WARN << "Warning: " << skipped << " peptides with unknown amino acids were skipped during digestion." << std::endl;
+    }
+
+    // distribute the occurrences into (1 Da) mass buckets; identical peptides end up in the same bucket
+    Size n = 0;
+    Size buckets = 1;
+    for (Size t = 0; t < threads; ++t)
+    {
+      n += thread_occurrences[t].size();
+      for (Size i = 0; i < thread_occurrences[t].size(); ++i)
+      {
+        buckets = std::max(buckets, (Size)thread_occurrences[t][i].mass + 1);
+      }
+    }
+    vector<Size> bucket_offset(buckets + 1, 0);
+    for (Size t = 0; t < threads; ++t)
+    {
+      for (Size i = 0; i < thread_occurrences[t].size(); ++i)
+      {
+        ++bucket_offset[(Size)thread_occurrences[t][i].mass + 1];
+      }
+    }
+    for (Size b = 0; b < buckets; ++b)
+    {
+      bucket_offset[b + 1] += bucket_offset[b];
+    }
+    vector<Occurrence_> all(n);
+    {
+      vector<Size> fill(bucket_offset.begin(), bucket_offset.end() - 1);
+      for (Size t = 0; t < threads; ++t)
+      {
+        for (Size i = 0; i < thread_occurrences[t].size(); ++i)
+        {
+          all[fill[(Size)thread_occurrences[t][i].mass]++] = thread_occurrences[t][i];
+        }
+        vector<Occurrence_>().swap(thread_occurrences[t]);
+      }
+    }
+
+    // sort the buckets in parallel, afterwards all occurrences are sorted by mass and sequence
+    OccurrenceLess_ less(proteins);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (SignedSize b = 0; b < (SignedSize)buckets; ++b)
+    {
+      std::sort(all.begin() + bucket_offset[b], all.begin() + bucket_offset[b + 1], less);
+    }
+
+    // merge identical peptides
+    protein_identifiers_.reserve(proteins.size());
+    for (Size p = 0; p < proteins.size(); ++p)
+    {
+      protein_identifiers_.push_back(proteins[p].identifier);
+    }
+    peptide_offset_.clear();
+    occurrence_offset_.clear();
+    occurrence_protein_.reserve(n);
+    occurrence_start_.reserve(n);
+    occurrence_aa_before_.reserve(n);
+    occurrence_aa_after_.reserve(n);
+    for (Size i = 0; i < n; ++i)
+    {
+      const Occurrence_& occurrence = all[i];
+      const String& sequence = proteins[occurrence.protein].sequence;
+      const Occurrence_* previous = (i == 0) ? 0 : &all[i - 1];
+      if (previous == 0 || previous->mass != occurrence.mass || previous->length != occurrence.length ||
+          std::memcmp(proteins[previous->protein].sequence.data() + previous->start, sequence.data() + occurrence.start, occurrence.length) != 0)
+      {
+        peptide_offset_.push_back(residues_.size());
+        occurrence_offset_.push_back(occurrence_protein_.size());
+        residues_.insert(residues_.end(), sequence.begin() + occurrence.start, sequence.begin() + occurrence.start + occurrence.length);
+        mass_.push_back(occurrence.mass);
+      }
+      occurrence_protein_.push_back(occurrence.protein);
+      occurrence_start_.push_back(occurrence.start);
+      occurrence_aa_before_.push_back(occurrence.start == 0 ? PeptideEvidence::N_TERMINAL_AA : sequence[occurrence.start - 1]);
+      occurrence_aa_after_.push_back(occurrence.start + occurrence.length == sequence.size() ? PeptideEvidence::C_TERMINAL_AA : sequence[occurrence.start + occurrence.length]);
+    }
+    peptide_offset_.push_back(residues_.size());
+    occurrence_offset_.push_back(occurrence_protein_.size());
+  }
+
+  void PeptideCatalogue::clear()
+  {
+    tag_.clear();
+    protein_identifiers_.clear();
+    residues_.clear();
+    peptide_offset_.assign(1, 0);
+    mass_.clear();
+    occurrence_offset_.assign(1, 0);
+    occurrence_protein_.clear();
+    occurrence_start_.clear();
+    occurrence_aa_before_.clear();
+    occurrence_aa_after_.clear();
+  }
+
+  Size PeptideCatalogue::size() const
+  {
+    return mass_.size();
+  }
+
+  bool PeptideCatalogue::empty() const
+  {
+    return mass_.empty();
+  }
+
+  String PeptideCatalogue::getSequence(Size index) const
+  {
+    return String(residues_.begin() + peptide_offset_[index], residues_.begin() + peptide_offset_[index + 1]);
+  }
+
+  Size PeptideCatalogue::getLength(Size index) const
+  {
+    return peptide_offset_[index + 1] - peptide_offset_[index];
+  }
+
+  double PeptideCatalogue::getMonoWeight(Size index) const
+  {
+    return mass_[index];
+  }
+
+  void PeptideCatalogue::getPeptidesInMassRange(double min_mass, double max_mass, Size& first, Size& last) const
+  {
+    first = std::lower_bound(mass_.begin(), mass_.end(), min_mass) - mass_.begin();
+    last = std::upper_bound(mass_.begin() + first, mass_.end(), max_mass) - mass_.begin();
+    if (last < first)
+    {
+      last = first;
+    }
+  }
+
+  Size PeptideCatalogue::getNumberOfOccurrences(Size index) const
+  {
+    return occurrence_offset_[index + 1] - occurrence_offset_[index];
+  }
+
+  void PeptideCatalogue::getPeptideEvidences(Size index, vector<PeptideEvidence>& evidences) const
+  {
+    Size length = getLength(index);
+    for (Size i = occurrence_offset_[index]; i < occurrence_offset_[index + 1]; ++i)
+    {
+      PeptideEvidence evidence;
+      evidence.setProteinAccession(protein_identifiers_[occurrence_protein_[i]]);
+      evidence.setStart((Int)occurrence_start_[i]);
+      evidence.setEnd((Int)(occurrence_start_[i] + length - 1));
+      evidence.setAABefore(occurrence_aa_before_[i]);
+      evidence.setAAAfter(occurrence_aa_after_[i]);
+      evidences.push_back(evidence);
+    }
+  }
+
+  Size PeptideCatalogue::getNumberOfProteins() const
+  {
+    return protein_identifiers_.size();
+  }
+
+  const String& PeptideCatalogue::getProteinIdentifier(Size index) const
+  {
+    return protein_identifiers_[index];
+  }
+
+  void PeptideCatalogue::setTag(const String& tag)
+  {
+    tag_ = tag;
+  }
+
+  const String& PeptideCatalogue::getTag() const
+  {
+    return tag_;
+  }
+
+  void PeptideCatalogue::store(const String& filename) const
+  {
+    std::ofstream ofs(filename.c_str(), std::ios::binary);
+    if (!ofs)
+    {
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+    }
+    int identifier = PEPTIDE_CATALOGUE_IDENTIFIER;
+    ofs.write((const char*) &identifier, sizeof(identifier));
+
+    vector<char> tag(tag_.begin(), tag_.end());
+    writeArray_(ofs, tag);
+
+    // protein identifiers are stored as one concatenated string with their end offsets
+    vector<Size> identifier_end;
+    identifier_end.reserve(protein_identifiers_.size());
+    vector<char> identifiers;
+    for (Size i = 0; i < protein_identifiers_.size(); ++i)
+    {
+      identifiers.insert(identifiers.end(), protein_identifiers_[i].begin(), protein_identifiers_[i].end());
+      identifier_end.push_back(identifiers.size());
+    }
+    writeArray_(ofs, identifier_end);
+    writeArray_(ofs, identifiers);
+
+    writeArray_(ofs, residues_);
+    writeArray_(ofs, peptide_offset_);
+    writeArray_(ofs, mass_);
+    writeArray_(ofs, occurrence_offset_);
+    writeArray_(ofs, occurrence_protein_);
+    writeArray_(ofs, occurrence_start_);
+    writeArray_(ofs, occurrence_aa_before_);
+    writeArray_(ofs, occurrence_aa_after_);
+
+    if (!ofs)
+    {
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+    }
+  }
+
+  void PeptideCatalogue::load(const String& filename)
+  {
+    if (!File::exists(filename))
+    {
+      throw Exception::FileNotFound(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+    }
+    if (File::empty(filename))
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename, "Peptide catalogue is empty.");
+    }
+
+    boost::iostreams::mapped_file_source file(filename);
+    const char* data = file.data();
+    Size data_size = file.size();
+    Size pos = 0;
+
+    int identifier = 0;
+    if (data_size >= sizeof(identifier))
+    {
+      std::memcpy(&identifier, data, sizeof(identifier));
+      pos += sizeof(identifier);
+    }
+    if (identifier != PEPTIDE_CATALOGUE_IDENTIFIER)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename, "File is not a peptide catalogue.");
+    }
+
+    clear();
+    vector<char> tag;
+    readArray_(data, data_size, pos, tag, filename);
+    tag_ = String(std::string(tag.begin(), tag.end()));
+
+    vector<Size> identifier_end;
+    vector<char> identifiers;
+    readArray_(data, data_size, pos, identifier_end, filename);
+    readArray_(data, data_size, pos, identifiers, filename);
+
+    readArray_(data, data_size, pos, residues_, filename);
+    readArray_(data, data_size, pos, peptide_offset_, filename);
+    readArray_(data, data_size, pos, mass_, filename);
+    readArray_(data, data_size, pos, occurrence_offset_, filename);
+    readArray_(data, data_size, pos, occurrence_protein_, filename);
+    readArray_(data, data_size, pos, occurrence_start_, filename);
+    readArray_(data, data_size, pos, occurrence_aa_before_, filename);
+    readArray_(data, data_size, pos, occurrence_aa_after_, filename);
+
+    Size n = mass_.size();
+    Size m = occurrence_protein_.size();
+    bool valid = peptide_offset_.size() == n + 1 && peptide_offset_.back() == residues_.size() &&
+                 occurrence_offset_.size() == n + 1 && occurrence_offset_.back() == m &&
+                 occurrence_start_.size() == m && occurrence_aa_before_.size() == m && occurrence_aa_after_.size() == m &&
+                 (identifier_end.empty() || identifier_end.back() == identifiers.size());
+    for (Size i = 0; valid && i < m; ++i)
+    {
+      valid = occurrence_protein_[i] < identifier_end.size();
+    }
+    // together with the check of the last offset, this keeps all identifiers within bounds
+    for (Size i = 1; valid && i < identifier_end.size(); ++i)
+    {
+      valid = identifier_end[i - 1] <= identifier_end[i];
+    }
+    for (Size i = 0; valid && i < n; ++i)
+    {
+      valid = peptide_offset_[i] <= peptide_offset_[i + 1] && occurrence_offset_[i] <= occurrence_offset_[i + 1];
+    }
+    if (!valid)
+    {
+      clear();
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename, "Inconsistent peptide catalogue.");
+    }
+
+    protein_identifiers_.reserve(identifier_end.size());
+    Size begin = 0;
+    for (Size i = 0; i < identifier_end.size(); ++i)
+    {
+      protein_identifiers_.push_back(String(std::string(identifiers.begin() + begin, identifiers.begin() + identifier_end[i])));
+      begin = identifier_end[i];
+    }
+  }
+
+} // namespace OpenMS
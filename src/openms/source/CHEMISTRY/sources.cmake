@@ -18,6 +18,7 @@ ModificationDefinitionsSet.cpp
 ModificationsDB.cpp
 ModifierRep.cpp
 PepIterator.cpp
+PeptideCatalogue.cpp
 Residue.cpp
 ResidueDB.cpp
 ResidueModification.cpp
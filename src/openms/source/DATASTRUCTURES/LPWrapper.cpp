@@ -631,6 +631,10 @@ namespace OpenMS
 #endif
                        )
   {
+    // several (COIN-OR) problems may be solved concurrently, but the log is not thread-safe
+#ifdef _OPENMP
+#pragma omp critical (OPENMS_LPWrapper_log)
+#endif
     LOG_INFO << "Using solver '" << (solver_ == LPWrapper::SOLVER_GLPK ? "glpk" : "coinor") << "' ...\n";
     if (solver_ == LPWrapper::SOLVER_GLPK)
     {
@@ -729,6 +733,9 @@ namespace OpenMS
       {
         solution_.push_back(model.solver()->getColSolution()[i]);
       }
+#ifdef _OPENMP
+#pragma omp critical (OPENMS_LPWrapper_log)
+#endif
       LOG_INFO << (model.isProvenOptimal() ? "Optimal solution found!" : "No solution found!") << "\n";
       return model.status();
     }
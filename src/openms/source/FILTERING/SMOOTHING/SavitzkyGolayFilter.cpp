@@ -38,6 +38,7 @@
 #include <Eigen/Core>
 #include <Eigen/SVD>
 
+#include <algorithm>
 #include <cmath>
 #include <iostream>//DEBUG
 
@@ -108,4 +109,57 @@ namespace OpenMS
       }
     }
   }
+
+  void SavitzkyGolayFilter::convolve_(const double * input, Size n, double * output) const
+  {
+    const Size mid = frame_size_ / 2;
+
+    // compute the transient on (the first mid + 1 points all use the first frame)
+    for (Size i = 0; i <= mid; ++i)
+    {
+      double help = 0;
+      for (Size j = 0; j < frame_size_; ++j)
+      {
+        help += input[j] * coeffs_[(i + 1) * frame_size_ - 1 - j];
+      }
+      output[i] = help;
+    }
+
+    // compute the steady state output
+    // The coefficients are applied one after another to a whole block of points. The inner loop then runs
+    // over contiguous data (and can be vectorized), while each sum is still accumulated in the same order.
+    const double * coeffs = &coeffs_[mid * frame_size_];
+    const Size block_size = 2048;
+    for (Size begin = mid + 1; begin + mid < n; begin += block_size)
+    {
+      const Size count = std::min(block_size, n - mid - begin);
+      double * out = output + begin;
+      for (Size i = 0; i < count; ++i)
+      {
+        out[i] = 0;
+      }
+      for (Size j = 0; j < frame_size_; ++j)
+      {
+        const double c = coeffs[j];
+        const double * in = input + begin - mid + j;
+        for (Size i = 0; i < count; ++i)
+        {
+          out[i] += in[i] * c;
+        }
+      }
+    }
+
+    // compute the transient off (the last mid points all use the last frame)
+    const double * last_frame = input + n - frame_size_;
+    for (Size i = 0; i < mid; ++i)
+    {
+      double help = 0;
+      for (Size j = 0; j < frame_size_; ++j)
+      {
+        help += last_frame[j] * coeffs_[i * frame_size_ + j];
+      }
+      output[n - 1 - i] = help;
+    }
+  }
+
 }
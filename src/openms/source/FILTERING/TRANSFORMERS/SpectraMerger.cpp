@@ -37,6 +37,8 @@
 #include <OpenMS/DATASTRUCTURES/ListUtils.h>
 #include <OpenMS/CONCEPT/ProgressLogger.h>
 
+#include <algorithm>
+
 using namespace std;
 namespace OpenMS
 {
@@ -114,4 +116,113 @@ namespace OpenMS
     return *this;
   }
 
+  namespace
+  {
+    /// orders indices into a precursor list by m/z
+    struct PrecursorMZLess_
+    {
+      explicit PrecursorMZLess_(const vector<BaseFeature>& data) :
+        data_(data)
+      {
+      }
+
+      bool operator()(Size a, Size b) const
+      {
+        return data_[a].getMZ() < data_[b].getMZ();
+      }
+
+      const vector<BaseFeature>& data_;
+    };
+
+    /// find the representative of @p i (with path halving)
+    Size findRoot_(vector<Size>& parent, Size i)
+    {
+      while (parent[i] != i)
+      {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+      }
+      return i;
+    }
+  }
+
+  void SpectraMerger::clusterPrecursors_(const vector<BaseFeature>& data, vector<vector<Size> >& clusters) const
+  {
+    clusters.clear();
+
+    SpectraDistance_ llc;
+    llc.setParameters(param_.copy("precursor_method:", true));
+    double mz_tolerance = param_.getValue("precursor_method:mz_tolerance");
+
+    // sort by m/z, so only a window of neighbours has to be compared
+    vector<Size> order(data.size());
+    for (Size i = 0; i < order.size(); ++i)
+    {
+      order[i] = i;
+    }
+    sort(order.begin(), order.end(), PrecursorMZLess_(data));
+
+    // links of each precursor to its (higher m/z) neighbours
+    vector<vector<Size> > links(data.size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1000)
+#endif
+    for (SignedSize i = 0; i < (SignedSize)order.size(); ++i)
+    {
+      const BaseFeature& first = data[order[i]];
+      for (Size j = i + 1; (j < order.size()) && (data[order[j]].getMZ() - first.getMZ() <= mz_tolerance); ++j)
+      {
+        if (llc(first, data[order[j]]) > 0)
+        {
+          links[order[i]].push_back(order[j]);
+        }
+      }
+    }
+
+    // connected components
+    vector<Size> parent(data.size());
+    for (Size i = 0; i < parent.size(); ++i)
+    {
+      parent[i] = i;
+    }
+    for (Size i = 0; i < links.size(); ++i)
+    {
+      for (Size k = 0; k < links[i].size(); ++k)
+      {
+        Size root_a = findRoot_(parent, i);
+        Size root_b = findRoot_(parent, links[i][k]);
+        // the smaller index becomes the root, so it also leads the cluster
+        if (root_a < root_b)
+        {
+          parent[root_b] = root_a;
+        }
+        else if (root_b < root_a)
+        {
+          parent[root_a] = root_b;
+        }
+      }
+      vector<Size>().swap(links[i]);
+    }
+
+    // roots are the smallest element of their cluster, so clusters are created in order of their first element
+    vector<Size> cluster_index(data.size(), data.size());
+    vector<Size> cluster_size(data.size(), 0);
+    for (Size i = 0; i < data.size(); ++i)
+    {
+      ++cluster_size[findRoot_(parent, i)];
+    }
+    for (Size i = 0; i < data.size(); ++i)
+    {
+      Size root = findRoot_(parent, i);
+      if (cluster_size[root] <= 1) continue;
+      if (root == i)
+      {
+        cluster_index[i] = clusters.size();
+        clusters.push_back(vector<Size>());
+        clusters.back().reserve(cluster_size[root]);
+      }
+      clusters[cluster_index[root]].push_back(i);
+    }
+  }
+
 }
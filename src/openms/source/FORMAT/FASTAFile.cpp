@@ -137,21 +137,26 @@ namespace OpenMS
 
     for (vector<FASTAEntry>::const_iterator it = data.begin(); it != data.end(); ++it)
     {
-      outfile << ">" << it->identifier << " " << it->description << "\n";
+      writeEntry(outfile, *it);
+    }
+    outfile.close();
+  }
 
-      String tmp(it->sequence);
-      while (tmp.size() > 80) // surprisingly fast, even though its using erase(). For-loop with substr() is much SLOWER!
-      {
-        outfile << tmp.prefix(80) << "\n";
-        tmp.erase(0, 80);
-      }
+  void FASTAFile::writeEntry(std::ostream& os, const FASTAEntry& entry)
+  {
+    os << ">" << entry.identifier << " " << entry.description << "\n";
 
-      if (tmp.size() > 0)
-      {
-        outfile << tmp << "\n";
-      }
+    String tmp(entry.sequence);
+    while (tmp.size() > 80) // surprisingly fast, even though its using erase(). For-loop with substr() is much SLOWER!
+    {
+      os << tmp.prefix(80) << "\n";
+      tmp.erase(0, 80);
+    }
+
+    if (tmp.size() > 0)
+    {
+      os << tmp << "\n";
     }
-    outfile.close();
   }
 
 } // namespace OpenMS
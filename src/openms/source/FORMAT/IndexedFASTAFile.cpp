@@ -0,0 +1,371 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2016.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: Timo Sachsenberg $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/FORMAT/IndexedFASTAFile.h>
+
+#include <OpenMS/CONCEPT/LogStream.h>
+#include <OpenMS/SYSTEM/File.h>
+
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include <QtCore/QDateTime>
+#include <QtCore/QFileInfo>
+
+#include <cstring>
+#include <fstream>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define INDEXED_FASTA_FILE_IDENTIFIER 8095
+
+using std::vector;
+
+namespace OpenMS
+{
+
+  namespace
+  {
+    /// size and modification time of a file, used to detect outdated index files
+    void getFileStamp_(const String& filename, Size& size, Size& modified)
+    {
+      QFileInfo info(filename.toQString());
+      size = (Size)info.size();
+      modified = (Size)info.lastModified().toTime_t();
+    }
+
+    /// same whitespace as String::removeWhitespaces()
+    inline bool isWhitespace_(char c)
+    {
+      return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+  }
+
+  IndexedFASTAFile::IndexedFASTAFile() :
+    filename_(),
+    file_(0),
+    data_(0),
+    data_size_(0),
+    offsets_()
+  {
+  }
+
+  IndexedFASTAFile::~IndexedFASTAFile()
+  {
+    close();
+  }
+
+  void IndexedFASTAFile::open(const String& filename, bool use_index_file)
+  {
+    close();
+
+    if (!File::exists(filename))
+    {
+      throw Exception::FileNotFound(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+    }
+    if (!File::readable(filename))
+    {
+      throw Exception::FileNotReadable(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+    }
+
+    // empty files cannot be mapped
+    if (!File::empty(filename))
+    {
+      try
+      {
+        file_ = new boost::iostreams::mapped_file_source(filename);
+      }
+      catch (std::exception&)
+      {
+        file_ = 0;
+        throw Exception::FileNotReadable(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+      }
+      data_ = file_->data();
+      data_size_ = file_->size();
+    }
+    filename_ = filename;
+
+    String index_filename = getIndexFilename(filename);
+    if (use_index_file && loadIndex_(index_filename))
+    {
+      return;
+    }
+
+    try
+    {
+      buildIndex_();
+    }
+    catch (Exception::ParseError&)
+    {
+      close();
+      throw;
+    }
+
+    if (use_index_file)
+    {
+      try
+      {
+        storeIndex(index_filename);
+      }
+      catch (Exception::UnableToCreateFile&)
+      {
+        LOG_WARN << "Warning: Could not write FASTA index file '" << index_filename << "'. The index will be rebuilt next time." << std::endl;
+      }
+    }
+  }
+
+  void IndexedFASTAFile::close()
+  {
+    delete file_;
+    file_ = 0;
+    data_ = 0;
+    data_size_ = 0;
+    offsets_.clear();
+    filename_.clear();
+  }
+
+  bool IndexedFASTAFile::isOpen() const
+  {
+    return !filename_.empty();
+  }
+
+  const String& IndexedFASTAFile::getFilename() const
+  {
+    return filename_;
+  }
+
+  Size IndexedFASTAFile::size() const
+  {
+    return offsets_.empty() ? 0 : offsets_.size() - 1;
+  }
+
+  IndexedFASTAFile::EntryView IndexedFASTAFile::getEntryView(Size index) const
+  {
+    if (index >= size())
+    {
+      throw Exception::IndexOverflow(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, index, size());
+    }
+
+    // skip the '>'
+    const char* begin = data_ + offsets_[index] + 1;
+    const char* end = data_ + offsets_[index + 1];
+
+    const char* header_end = begin;
+    while (header_end != end && *header_end != '\n' && *header_end != '\r')
+    {
+      ++header_end;
+    }
+    const char* sequence_begin = header_end;
+    if (sequence_begin != end && *sequence_begin == '\r')
+    {
+      ++sequence_begin;
+    }
+    if (sequence_begin != end && *sequence_begin == '\n')
+    {
+      ++sequence_begin;
+    }
+
+    EntryView view;
+    view.header = begin;
+    view.header_length = header_end - begin;
+    view.sequence = sequence_begin;
+    view.sequence_length = end - sequence_begin;
+    return view;
+  }
+
+  void IndexedFASTAFile::getEntry(Size index, FASTAFile::FASTAEntry& entry) const
+  {
+    EntryView view = getEntryView(index);
+
+    // split the header like FASTAFile::load()
+    String id(std::string(view.header, view.header_length));
+    id.trim();
+    String::size_type position = id.find_first_of(" \v\t");
+    if (position == String::npos)
+    {
+      entry.identifier = id;
+      entry.description = "";
+    }
+    else
+    {
+      entry.identifier = id.substr(0, position);
+      entry.description = id.suffix(id.size() - position - 1);
+    }
+
+    entry.sequence.clear();
+    entry.sequence.reserve(view.sequence_length);
+    for (const char* c = view.sequence; c != view.sequence + view.sequence_length; ++c)
+    {
+      if (!isWhitespace_(*c))
+      {
+        entry.sequence += *c;
+      }
+    }
+  }
+
+  void IndexedFASTAFile::storeIndex(const String& index_filename) const
+  {
+    std::ofstream ofs(index_filename.c_str(), std::ios::binary);
+    if (!ofs)
+    {
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, index_filename);
+    }
+
+    int identifier = INDEXED_FASTA_FILE_IDENTIFIER;
+    Size fasta_size = 0, fasta_modified = 0;
+    getFileStamp_(filename_, fasta_size, fasta_modified);
+    Size n = size();
+    ofs.write((const char*) &identifier, sizeof(identifier));
+    ofs.write((const char*) &fasta_size, sizeof(fasta_size));
+    ofs.write((const char*) &fasta_modified, sizeof(fasta_modified));
+    ofs.write((const char*) &n, sizeof(n));
+    if (n > 0)
+    {
+      ofs.write((const char*) &offsets_[0], n * sizeof(Size));
+    }
+
+    if (!ofs)
+    {
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, index_filename);
+    }
+  }
+
+  String IndexedFASTAFile::getIndexFilename(const String& filename)
+  {
+    return filename + ".fidx";
+  }
+
+  void IndexedFASTAFile::buildIndex_()
+  {
+    offsets_.clear();
+
+    // every chunk collects the record starts in its part of the file
+#ifdef _OPENMP
+    SignedSize chunks = omp_get_max_threads();
+#else
+    SignedSize chunks = 1;
+#endif
+    vector<vector<Size> > chunk_offsets(chunks);
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (SignedSize c = 0; c < chunks; ++c)
+    {
+      const char* begin = data_ + data_size_ * c / chunks;
+      const char* end = data_ + data_size_ * (c + 1) / chunks;
+      const char* p = (begin == end) ? 0 : (const char*) std::memchr(begin, '>', end - begin);
+      while (p != 0)
+      {
+        if (p == data_ || *(p - 1) == '\n' || *(p - 1) == '\r')
+        {
+          chunk_offsets[c].push_back(p - data_);
+        }
+        ++p;
+        p = (p == end) ? 0 : (const char*) std::memchr(p, '>', end - p);
+      }
+    }
+
+    Size n = 0;
+    for (Size c = 0; c < chunk_offsets.size(); ++c)
+    {
+      n += chunk_offsets[c].size();
+    }
+    offsets_.reserve(n + 1);
+    for (Size c = 0; c < chunk_offsets.size(); ++c)
+    {
+      offsets_.insert(offsets_.end(), chunk_offsets[c].begin(), chunk_offsets[c].end());
+    }
+
+    // only whitespace is allowed before the first record
+    Size first = offsets_.empty() ? data_size_ : offsets_[0];
+    for (Size i = 0; i < first; ++i)
+    {
+      if (!isWhitespace_(data_[i]))
+      {
+        offsets_.clear();
+        throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename_, "Error while parsing FASTA file '" + filename_ + "'! The file does not start with a FASTA record ('>').");
+      }
+    }
+
+    offsets_.push_back(data_size_);
+  }
+
+  bool IndexedFASTAFile::loadIndex_(const String& index_filename)
+  {
+    if (!File::exists(index_filename) || !File::readable(index_filename))
+    {
+      return false;
+    }
+
+    std::ifstream ifs(index_filename.c_str(), std::ios::binary);
+    int identifier = 0;
+    Size fasta_size = 0, fasta_modified = 0, n = 0;
+    ifs.read((char*) &identifier, sizeof(identifier));
+    ifs.read((char*) &fasta_size, sizeof(fasta_size));
+    ifs.read((char*) &fasta_modified, sizeof(fasta_modified));
+    ifs.read((char*) &n, sizeof(n));
+
+    Size current_size = 0, current_modified = 0;
+    getFileStamp_(filename_, current_size, current_modified);
+    if (!ifs || identifier != INDEXED_FASTA_FILE_IDENTIFIER || fasta_size != current_size ||
+        fasta_modified != current_modified || fasta_size != data_size_ || n > data_size_)
+    {
+      return false;
+    }
+
+    offsets_.resize(n);
+    if (n > 0)
+    {
+      ifs.read((char*) &offsets_[0], n * sizeof(Size));
+    }
+
+    // sanity check (without touching all records)
+    bool valid = ifs.good();
+    for (Size i = 0; valid && i < n; ++i)
+    {
+      valid = offsets_[i] < data_size_ && (i == 0 || offsets_[i - 1] < offsets_[i]);
+    }
+    if (!valid || (n > 0 && (data_[offsets_[0]] != '>' || data_[offsets_[n - 1]] != '>')))
+    {
+      offsets_.clear();
+      return false;
+    }
+
+    offsets_.push_back(data_size_);
+    return true;
+  }
+
+} // namespace OpenMS
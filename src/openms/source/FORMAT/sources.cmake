@@ -25,6 +25,7 @@ GzipIfstream.cpp
 GzipInputStream.cpp
 IBSpectraFile.cpp
 IdXMLFile.cpp
+IndexedFASTAFile.cpp
 IndexedMzMLFile.cpp
 IndexedMzMLFileLoader.cpp
 InspectInfile.cpp
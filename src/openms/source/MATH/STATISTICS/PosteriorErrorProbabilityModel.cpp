@@ -59,7 +59,11 @@ namespace OpenMS
       DefaultParamHandler("PosteriorErrorProbabilityModel"),
       incorrectly_assigned_fit_param_(GaussFitter::GaussFitResult(-1, -1, -1)),
       correctly_assigned_fit_param_(GaussFitter::GaussFitResult(-1, -1, -1)),
-      negative_prior_(0.5), max_incorrectly_(0), max_correctly_(0), smallest_score_(0)
+      negative_prior_(0.5), max_incorrectly_(0), max_correctly_(0), smallest_score_(0),
+      has_initial_parameters_(false),
+      initial_incorrectly_assigned_fit_param_(GaussFitter::GaussFitResult(-1, -1, -1)),
+      initial_correctly_assigned_fit_param_(GaussFitter::GaussFitResult(-1, -1, -1)),
+      initial_negative_prior_(0.5), initial_smallest_score_(0)
     {
       defaults_.setValue("out_plot", "", "If given, the some output files will be saved in the following manner: <out_plot>_scores.txt for the scores and <out_plot> which contains the fitted values for each step of the EM-algorithm, e.g., out_plot = /usr/home/OMSSA123 leads to /usr/home/OMSSA123_scores.txt, /usr/home/OMSSA123 will be written. If no directory is specified, e.g. instead of '/usr/home/OMSSA123' just OMSSA123, the files will be written into the working directory.", ListUtils::create<String>("advanced,output file"));
       defaults_.setValue("number_of_bins", 100, "Number of bins used for visualization. Only needed if each iteration step of the EM-Algorithm will be visualized", ListUtils::create<String>("advanced"));
@@ -77,6 +81,33 @@ namespace OpenMS
     {
     }
 
+    void PosteriorErrorProbabilityModel::setInitialParameters(const GaussFitter::GaussFitResult& incorrect, const GaussFitter::GaussFitResult& correct, double negative_prior, double smallest_score)
+    {
+      if (!(incorrect.sigma > 0) || !(correct.sigma > 0))
+      {
+        throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "The standard deviations of the initial distributions must be positive.", String(incorrect.sigma) + ", " + String(correct.sigma));
+      }
+      if (!(negative_prior > 0) || !(negative_prior < 1))
+      {
+        throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "The initial negative prior must be in (0, 1).", String(negative_prior));
+      }
+      initial_incorrectly_assigned_fit_param_ = incorrect;
+      initial_correctly_assigned_fit_param_ = correct;
+      initial_negative_prior_ = negative_prior;
+      initial_smallest_score_ = smallest_score;
+      has_initial_parameters_ = true;
+    }
+
+    void PosteriorErrorProbabilityModel::setInitialParameters(const PosteriorErrorProbabilityModel& model)
+    {
+      setInitialParameters(model.getIncorrectlyAssignedFitResult(), model.getCorrectlyAssignedFitResult(), model.getNegativePrior(), model.smallest_score_);
+    }
+
+    void PosteriorErrorProbabilityModel::clearInitialParameters()
+    {
+      has_initial_parameters_ = false;
+    }
+
     bool PosteriorErrorProbabilityModel::fit(std::vector<double>& search_engine_scores)
     {
       if (search_engine_scores.empty())
@@ -121,9 +152,24 @@ namespace OpenMS
       correctly_assigned_fit_param_.sigma = incorrectly_assigned_fit_param_.sigma;
       correctly_assigned_fit_param_.A = 1.0   / sqrt(2 * Constants::PI * pow(correctly_assigned_fit_param_.sigma, 2));
 
+      if (has_initial_parameters_)
+      {
+        // warm start: move the distributions of the previous fit to the shifted scores of this fit
+        double shift = fabs(smallest_score_) - fabs(initial_smallest_score_);
+        incorrectly_assigned_fit_param_ = initial_incorrectly_assigned_fit_param_;
+        incorrectly_assigned_fit_param_.x0 += shift;
+        incorrectly_assigned_fit_param_.A = 1 / sqrt(2 * Constants::PI * pow(incorrectly_assigned_fit_param_.sigma, 2));
+        correctly_assigned_fit_param_ = initial_correctly_assigned_fit_param_;
+        correctly_assigned_fit_param_.x0 += shift;
+        correctly_assigned_fit_param_.A = 1 / sqrt(2 * Constants::PI * pow(correctly_assigned_fit_param_.sigma, 2));
+        negative_prior_ = initial_negative_prior_;
+      }
+
+      // the EM algorithm works on contiguous arrays and evaluates the (Gaussian) densities directly
       vector<double> incorrect_density;
       vector<double> correct_density;
-      fillDensities(x_scores, incorrect_density, correct_density);
+      vector<double> posteriors(x_scores.size());
+      fillGaussDensities_(x_scores, incorrect_density, correct_density);
 
       double maxlike = computeMaxLikelihood(incorrect_density, correct_density);
       //-------------------------------------------------------------
@@ -156,22 +202,39 @@ namespace OpenMS
       int delta = 6;
       int itns = 0;
       
+      const Size n = x_scores.size();
+      const double* x = &x_scores[0];
+      double* posterior = &posteriors[0];
       do
       {
-        //E-STEP
-        double one_minus_sum_posterior = one_minus_sum_post(incorrect_density, correct_density);
-        double sum_posterior = sum_post(incorrect_density, correct_density);
+        //E-STEP (fused with the sums needed for the new means)
+        double one_minus_sum_posterior(0), sum_posterior(0), sum_positive_x0(0), sum_negative_x0(0);
+        const double* incorrect = &incorrect_density[0];
+        const double* correct = &correct_density[0];
+        for (Size i = 0; i < n; ++i)
+        {
+          const double negative = negative_prior_ * incorrect[i];
+          const double p = negative / (negative + (1 - negative_prior_) * correct[i]);
+          posterior[i] = p;
+          one_minus_sum_posterior += 1 - p;
+          sum_posterior += p;
+          sum_positive_x0 += (1 - p) * x[i];
+          sum_negative_x0 += p * x[i];
+        }
 
         //new mean
-        double sum_positive_x0 = sum_pos_x0(x_scores, incorrect_density, correct_density);
-        double sum_negative_x0 = sum_neg_x0(x_scores, incorrect_density, correct_density);
-
         double positive_mean = sum_positive_x0 / one_minus_sum_posterior;
         double negative_mean = sum_negative_x0 / sum_posterior;
 
         //new standard deviation
-        double sum_positive_sigma = sum_pos_sigma(x_scores, incorrect_density, correct_density, positive_mean);
-        double sum_negative_sigma = sum_neg_sigma(x_scores, incorrect_density, correct_density, negative_mean);
+        double sum_positive_sigma(0), sum_negative_sigma(0);
+        for (Size i = 0; i < n; ++i)
+        {
+          const double positive_diff = x[i] - positive_mean;
+          const double negative_diff = x[i] - negative_mean;
+          sum_positive_sigma += (1 - posterior[i]) * (positive_diff * positive_diff);
+          sum_negative_sigma += posterior[i] * (negative_diff * negative_diff);
+        }
 
         //update parameters
         correctly_assigned_fit_param_.x0 = positive_mean;
@@ -190,8 +253,7 @@ namespace OpenMS
 
 
         //compute new prior probabilities negative peptides
-        fillDensities(x_scores, incorrect_density, correct_density);
-        sum_posterior = sum_post(incorrect_density, correct_density);
+        sum_posterior = fillGaussDensities_(x_scores, incorrect_density, correct_density);
         negative_prior_ = sum_posterior / x_scores.size();
 
         double new_maxlike(computeMaxLikelihood(incorrect_density, correct_density));
@@ -204,8 +266,13 @@ namespace OpenMS
         {
           if (itns >= max_itns)
           {
-            LOG_WARN << "Number of iterations exceeded. Convergence criterion not met. Last likelihood increase: " << (new_maxlike - maxlike) << endl;
-            LOG_WARN << "Algorithm returns probabilites for suboptimal fit. You might want to try raising the max. number of iterations and have a look at the distribution." << endl;
+#ifdef _OPENMP
+#pragma omp critical (OPENMS_PosteriorErrorProbabilityModel_log)
+#endif
+            {
+              LOG_WARN << "Number of iterations exceeded. Convergence criterion not met. Last likelihood increase: " << (new_maxlike - maxlike) << endl;
+              LOG_WARN << "Algorithm returns probabilites for suboptimal fit. You might want to try raising the max. number of iterations and have a look at the distribution." << endl;
+            }
           }
           stop_em_init = true;
           sum_posterior = sum_post(incorrect_density, correct_density);
@@ -281,6 +348,33 @@ namespace OpenMS
       }
     }
 
+    double PosteriorErrorProbabilityModel::fillGaussDensities_(const vector<double>& x_scores, vector<double>& incorrect_density, vector<double>& correct_density) const
+    {
+      incorrect_density.resize(x_scores.size());
+      correct_density.resize(x_scores.size());
+
+      // same as getGauss(), with the constant terms taken out of the loop
+      const double incorrect_A = incorrectly_assigned_fit_param_.A;
+      const double incorrect_x0 = incorrectly_assigned_fit_param_.x0;
+      const double incorrect_denominator = 2 * pow(incorrectly_assigned_fit_param_.sigma, 2);
+      const double correct_A = correctly_assigned_fit_param_.A;
+      const double correct_x0 = correctly_assigned_fit_param_.x0;
+      const double correct_denominator = 2 * pow(correctly_assigned_fit_param_.sigma, 2);
+
+      double post(0);
+      for (Size i = 0; i < x_scores.size(); ++i)
+      {
+        const double incorrect_diff = x_scores[i] - incorrect_x0;
+        const double correct_diff = x_scores[i] - correct_x0;
+        const double incorrect = incorrect_A * exp(-1.0 * (incorrect_diff * incorrect_diff) / incorrect_denominator);
+        const double correct = correct_A * exp(-1.0 * (correct_diff * correct_diff) / correct_denominator);
+        incorrect_density[i] = incorrect;
+        correct_density[i] = correct;
+        post += ((negative_prior_ * incorrect) / ((negative_prior_ * incorrect) + (1 - negative_prior_) * correct));
+      }
+      return post;
+    }
+
     double PosteriorErrorProbabilityModel::computeMaxLikelihood(vector<double>& incorrect_density, vector<double>& correct_density)
     {
       double maxlike(0);
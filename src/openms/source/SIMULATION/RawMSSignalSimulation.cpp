@@ -209,6 +209,13 @@ namespace OpenMS
 
     defaults_.setSectionDescription("noise", "Parameters modeling noise in mass spectrometry measurements.");
 
+    // MEMORY
+    defaults_.setValue("memory:feature_batch_size", 0, "Number of features (in order of retention time) that are sampled as one batch. After each batch, the signals of all threads are merged into the map and the RT range of the batch is compressed. "
+                                                       "Smaller batches usually lower the peak memory, but this is no strict bound (the memory still depends on the size of the features and of the map). "
+                                                       "Set to 0 to sample all features in one batch (default, fastest).", ListUtils::create<String>("advanced"));
+    defaults_.setMinInt("memory:feature_batch_size", 0);
+    defaults_.setSectionDescription("memory", "Memory usage of the raw signal simulation (LC-MS only).");
+
     defaultsToParam_();
   }
 
@@ -445,56 +452,104 @@ namespace OpenMS
       Size compress_size_intermediate = 20000 / thread_count; // compress map every X features, (10.000 feature are ~ 2 GB at 0.002 sampling rate)
       Size compress_count = 0; // feature count (for each thread)
 
+      // The features are sampled in batches. After each batch, the signals of all threads are merged into the map and the
+      // RT range covered by the batch is compressed. Sorting the features by RT turns the batches into RT slices of the map.
+      // By default, all features are sampled in one batch (in their original order), which gives the same output as before.
+      Size batch_size = (UInt)param_.getValue("memory:feature_batch_size");
+      std::vector<Size> feature_order(features.size());
+      for (Size f = 0; f < features.size(); ++f)
+      {
+        feature_order[f] = f;
+      }
+      if (batch_size == 0 || batch_size >= features.size())
+      {
+        batch_size = std::max(features.size(), Size(1)); // one batch (in the original order)
+      }
+      else
+      {
+        std::stable_sort(feature_order.begin(), feature_order.end(), FeatureRTLess_(features));
+      }
+
+      for (Size batch_start = 0; batch_start < features.size(); batch_start += batch_size)
+      {
+        const Size batch_end = std::min(batch_start + batch_size, features.size());
+
 #ifdef _OPENMP
 #pragma omp parallel for firstprivate(compress_count)
 #endif
-      for (SignedSize f = 0; f < (SignedSize)features.size(); ++f)
-      {
+        for (SignedSize f = batch_start; f < (SignedSize)batch_end; ++f)
+        {
 #ifdef _OPENMP // update experiment index if necessary
-        const int current_thread = omp_get_thread_num();
+          const int current_thread = omp_get_thread_num();
 #else
-        const int current_thread(0);
+          const int current_thread(0);
 #endif
-        add2DSignal_(features[f], *(experiments[current_thread]), *(experiments_ct[current_thread]));
+          add2DSignal_(features[feature_order[f]], *(experiments[current_thread]), *(experiments_ct[current_thread]));
 
-        // progresslogger, only master thread sets progress (no barrier here)
+          // progresslogger, only master thread sets progress (no barrier here)
 #ifdef _OPENMP
 #pragma omp atomic
 #endif
-        ++progress;
-        if (current_thread == 0)
-        {
-          this->setProgress(progress);
-        }
+          ++progress;
+          if (current_thread == 0)
+          {
+            this->setProgress(progress);
+          }
 
-        // intermediate compress to avoid memory problems
-        ++compress_count;
-        if (compress_count > compress_size_intermediate)
-        {
-          compress_count = 0;
-          compressSignals_(*(experiments[current_thread]));
-        }
-      } // ! raw signal sim
+          // intermediate compress to avoid memory problems
+          ++compress_count;
+          if (compress_count > compress_size_intermediate)
+          {
+            compress_count = 0;
+            compressSignals_(*(experiments[current_thread]));
+          }
+        } // ! raw signal sim
 
 #ifdef _OPENMP // merge back other experiments
-      for (Size i = 1; i < experiments.size(); ++i)
-      {
-        // copy peak data from temporal experiment
-        for (Size scan = 0; scan < experiment.size(); ++scan)
+        const bool batched = (batch_size < features.size());
+        for (Size i = 1; i < experiments.size(); ++i)
         {
-          if ((*experiments[i])[scan].empty())
-            continue; // we do not care if the spectrum wasn't touched at all
-          // append all points from temp to org
-          experiment[scan].insert(experiment[scan].end(), (*experiments[i])[scan].begin(), (*experiments[i])[scan].end());
-          // delete from child experiment to save memory (otherwise the merge would double it!)
-          (*experiments[i])[scan].clear(false);
-
-          // peak GT ( small, so no need to compress)
-          experiment_ct[scan].insert(experiment_ct[scan].end(), (*experiments_ct[i])[scan].begin(), (*experiments_ct[i])[scan].end());
+          // copy peak data from temporal experiment
+          for (Size scan = 0; scan < experiment.size(); ++scan)
+          {
+            // With a single batch, the ground truth of a scan is only merged if the thread sampled raw
+            // signal in it (as always). In batched mode it is merged in any case, as the thread-local
+            // ground truth is cleared after each batch.
+            if ((*experiments[i])[scan].empty() && !batched) continue; // we do not care if the spectrum wasn't touched at all
+
+            // append all points from temp to org
+            experiment[scan].insert(experiment[scan].end(), (*experiments[i])[scan].begin(), (*experiments[i])[scan].end());
+            // delete from child experiment to save memory (otherwise the merge would double it!)
+            (*experiments[i])[scan].clear(false);
+
+            // peak GT ( small, so no need to compress)
+            experiment_ct[scan].insert(experiment_ct[scan].end(), (*experiments_ct[i])[scan].begin(), (*experiments_ct[i])[scan].end());
+            (*experiments_ct[i])[scan].clear(false);
+          }
+        }
+#endif
 
+        if (batch_end < features.size())
+        {
+          // compress the RT slice of this batch (the sampled RT range of a feature is stored in its convex hulls)
+          SimTypes::SimCoordinateType rt_min = std::numeric_limits<SimTypes::SimCoordinateType>::max();
+          SimTypes::SimCoordinateType rt_max = -std::numeric_limits<SimTypes::SimCoordinateType>::max();
+          for (Size f = batch_start; f < batch_end; ++f)
+          {
+            const std::vector<ConvexHull2D>& hulls = features[feature_order[f]].getConvexHulls();
+            for (Size h = 0; h < hulls.size(); ++h)
+            {
+              DBoundingBox<2> box = hulls[h].getBoundingBox();
+              rt_min = std::min(rt_min, box.minX());
+              rt_max = std::max(rt_max, box.maxX());
+            }
+          }
+          if (rt_min <= rt_max)
+          {
+            compressSignals_(experiment, experiment.RTBegin(rt_min) - experiment.begin(), experiment.RTEnd(rt_max) - experiment.begin());
+          }
         }
       }
-#endif
 
     } // ! 1D or 2D
 
@@ -1183,6 +1238,11 @@ namespace OpenMS
 
   // TODO: add instrument specific sampling technique
   void RawMSSignalSimulation::compressSignals_(SimTypes::MSSimExperiment& experiment)
+  {
+    compressSignals_(experiment, 0, experiment.size());
+  }
+
+  void RawMSSignalSimulation::compressSignals_(SimTypes::MSSimExperiment& experiment, Size scan_begin, Size scan_end)
   {
     if (experiment.size() < 1 || experiment[0].getInstrumentSettings().getScanWindows().size() < 1)
     {
@@ -1209,7 +1269,7 @@ namespace OpenMS
 
     Size point_count_before(0), point_count_after(0);
     SimTypes::SimPointType p;
-    for (Size i = 0; i < experiment.size(); ++i)
+    for (Size i = scan_begin; i < std::min(scan_end, experiment.size()); ++i)
     {
       if (experiment[i].size() <= 1)
         continue;
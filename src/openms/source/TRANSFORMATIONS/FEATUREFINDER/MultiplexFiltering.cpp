@@ -63,12 +63,29 @@ namespace OpenMS
   MultiplexFiltering::MultiplexFiltering(const MSExperiment<Peak1D>& exp_picked, const std::vector<MultiplexIsotopicPeakPattern> patterns, int peaks_per_peptide_min, int peaks_per_peptide_max, bool missing_peaks, double intensity_cutoff, double mz_tolerance, bool mz_tolerance_unit, double peptide_similarity, double averagine_similarity, double averagine_similarity_scaling, String averigine_type) :
     exp_picked_(exp_picked), patterns_(patterns), peaks_per_peptide_min_(peaks_per_peptide_min), peaks_per_peptide_max_(peaks_per_peptide_max), missing_peaks_(missing_peaks), intensity_cutoff_(intensity_cutoff), mz_tolerance_(mz_tolerance), mz_tolerance_unit_(mz_tolerance_unit), peptide_similarity_(peptide_similarity), averagine_similarity_(averagine_similarity), averagine_similarity_scaling_(averagine_similarity_scaling), averagine_type_(averigine_type)
   {
+    // check here, since the filters run in parallel (see getAveragineSimilarity_())
+    if (averagine_type_ != "peptide" && averagine_type_ != "RNA" && averagine_type_ != "DNA")
+    {
+      throw Exception::InvalidParameter(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "Averagine type unrecognized.");
+    }
   }
 
   int MultiplexFiltering::positionsAndBlacklistFilter_(const MultiplexIsotopicPeakPattern& pattern, int spectrum,
                                                       const vector<double>& peak_position, int peak,
                                                       vector<double>& mz_shifts_actual,
                                                       vector<int>& mz_shifts_actual_indices) const
+  {
+    if (!positionsFilter_(pattern, peak_position, peak, mz_shifts_actual, mz_shifts_actual_indices))
+    {
+      return -1;
+    }
+    blacklistFilter_(pattern, spectrum, mz_shifts_actual, mz_shifts_actual_indices);
+    return countPeaksInAllPeptides_(pattern, mz_shifts_actual, mz_shifts_actual_indices);
+  }
+
+  bool MultiplexFiltering::positionsFilter_(const MultiplexIsotopicPeakPattern& pattern, const vector<double>& peak_position, int peak,
+                                            vector<double>& mz_shifts_actual, vector<int>& mz_shifts_actual_indices) const
   {
     // Try to find peaks at the expected m/z positions
     // loop over expected m/z shifts of a peak pattern
@@ -98,7 +115,7 @@ namespace OpenMS
     }
 
     // early out: Need to find at least (peaks_per_peptide * number_of_peptides) isotopic peaks.
-    if (found_peaks < peaks_per_peptide_min_ * pattern.getMassShiftCount()) return -1;
+    if (found_peaks < peaks_per_peptide_min_ * pattern.getMassShiftCount()) return false;
 
     // remove peaks which run into the next peptide
     // i.e. the isotopic peak of one peptide lies to the right of the mono-isotopic peak of the next one
@@ -119,6 +136,14 @@ namespace OpenMS
       }
     }
 
+    return true;
+  }
+
+  bool MultiplexFiltering::blacklistFilter_(const MultiplexIsotopicPeakPattern& pattern, int spectrum,
+                                            vector<double>& mz_shifts_actual, vector<int>& mz_shifts_actual_indices) const
+  {
+    bool removed = false;
+
     // remove blacklisted peaks
     // loop over isotopes in peptides
     for (int isotope = 0; isotope < peaks_per_peptide_max_; ++isotope)
@@ -138,11 +163,18 @@ namespace OpenMS
           {
             mz_shifts_actual[mz_position] = std::numeric_limits<double>::quiet_NaN();
             mz_shifts_actual_indices[mz_position] = -1;
+            removed = true;
           }
         }
       }
     }
 
+    return removed;
+  }
+
+  int MultiplexFiltering::countPeaksInAllPeptides_(const MultiplexIsotopicPeakPattern& pattern,
+                                                   vector<double>& mz_shifts_actual, vector<int>& mz_shifts_actual_indices) const
+  {
     // count how many isotopic peaks seen simultaneously in all of the peptides
     // and (optionally) remove peaks following missing ones
     int peaks_found_in_all_peptides = peaks_per_peptide_max_;
@@ -420,7 +452,7 @@ namespace OpenMS
     else
     {
         throw Exception::InvalidParameter(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
-          "Averagine type unrecognized.");;
+          "Averagine type unrecognized.");
     }
 
     for (IsotopeDistribution::Iterator it = distribution.begin(); it != distribution.end(); ++it)
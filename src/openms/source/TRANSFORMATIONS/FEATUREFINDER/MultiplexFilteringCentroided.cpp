@@ -117,130 +117,101 @@ namespace OpenMS
   vector<MultiplexFilterResult> MultiplexFilteringCentroided::filter()
   {
     // progress logger
-    unsigned progress = 0;
     startProgress(0, patterns_.size() * exp_picked_.size(), "filtering LC-MS data");
 
     // list of filter results for each peak pattern
     vector<MultiplexFilterResult> filter_results;
 
-    // loop over patterns
-    for (unsigned pattern = 0; pattern < patterns_.size(); ++pattern)
+    // indices of the (non-empty) spectra in exp_picked_ and their peak positions (once for all patterns)
+    vector<int> spectra;
+    vector<vector<double> > peak_position(exp_picked_.size());
+    for (MSExperiment<Peak1D>::Iterator it_rt_picked = exp_picked_.begin(); it_rt_picked < exp_picked_.end(); ++it_rt_picked)
     {
-      // data structure storing peaks which pass all filters
-      MultiplexFilterResult result;
-
-      // iterate over spectra
-      for (MSExperiment<Peak1D>::Iterator it_rt_picked = exp_picked_.begin(); it_rt_picked < exp_picked_.end(); ++it_rt_picked)
+      // skip empty spectra
+      if (it_rt_picked->empty())
       {
-        // skip empty spectra
-        if (it_rt_picked->empty())
-        {
-          continue;
-        }
-
-        setProgress(++progress);
+        continue;
+      }
 
-        int spectrum = it_rt_picked - exp_picked_.begin(); // index of the spectrum in exp_picked_
-        double rt_picked = it_rt_picked->getRT();
+      int spectrum = it_rt_picked - exp_picked_.begin();
+      spectra.push_back(spectrum);
+      peak_position[spectrum].reserve(it_rt_picked->size());
+      for (MSSpectrum<Peak1D>::Iterator it_mz = it_rt_picked->begin(); it_mz < it_rt_picked->end(); ++it_mz)
+      {
+        peak_position[spectrum].push_back(it_mz->getMZ());
+      }
+    }
 
-        // vectors of peak details
-        vector<double> peak_position;
-        vector<double> peak_intensity;
-        peak_position.reserve(it_rt_picked->size());
-        peak_intensity.reserve(it_rt_picked->size());
-        for (MSSpectrum<Peak1D>::Iterator it_mz = it_rt_picked->begin(); it_mz < it_rt_picked->end(); ++it_mz)
-        {
-          peak_position.push_back(it_mz->getMZ());
-          peak_intensity.push_back(it_mz->getIntensity());
-        }
+    // loop over patterns
+    // (in order, since peaks blacklisted by a pattern are unavailable to all later ones)
+    for (unsigned pattern = 0; pattern < patterns_.size(); ++pattern)
+    {
+      // Filter all peaks of all spectra in parallel, ignoring the blacklist.
+      vector<vector<PeakCandidate> > candidates(spectra.size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 10)
+#endif
+      for (SignedSize i = 0; i < (SignedSize) spectra.size(); ++i)
+      {
+        int spectrum = spectra[i];
 
         // iterate over peaks in spectrum (mz)
-        for (unsigned peak = 0; peak < peak_position.size(); ++peak)
+        for (unsigned peak = 0; peak < peak_position[spectrum].size(); ++peak)
         {
-
           /**
-           * Filter (1): m/z position and blacklist filter
-           * Are there non-black peaks with the expected relative m/z shifts?
+           * Filter (1): m/z position filter
+           * Are there peaks with the expected relative m/z shifts?
            */
-          vector<double> mz_shifts_actual; // actual m/z shifts (differ slightly from expected m/z shifts)
-          vector<int> mz_shifts_actual_indices; // peak indices in the spectrum corresponding to the actual m/z shifts
-
-          mz_shifts_actual.reserve(patterns_[pattern].getMZShiftCount());
-          mz_shifts_actual_indices.reserve(patterns_[pattern].getMZShiftCount());
-
-          int peaks_found_in_all_peptides = positionsAndBlacklistFilter_(patterns_[pattern], spectrum, peak_position, peak, mz_shifts_actual, mz_shifts_actual_indices);
-          if (peaks_found_in_all_peptides < peaks_per_peptide_min_)
+          PeakCandidate candidate;
+          candidate.peak = peak;
+          candidate.mz_shifts_positions.reserve(patterns_[pattern].getMZShiftCount());
+          candidate.mz_shifts_positions_indices.reserve(patterns_[pattern].getMZShiftCount());
+          if (!positionsFilter_(patterns_[pattern], peak_position[spectrum], peak, candidate.mz_shifts_positions, candidate.mz_shifts_positions_indices))
           {
             continue;
           }
 
-          /**
-           * Filter (2): blunt intensity filter
-           * Are the mono-isotopic peak intensities of all peptides above the cutoff?
-           */
-          bool bluntVeto = monoIsotopicPeakIntensityFilter_(patterns_[pattern], spectrum, mz_shifts_actual_indices);
-          if (bluntVeto)
-          {
-            continue;
-          }
+          filterPeak_(patterns_[pattern], spectrum, peak_position[spectrum][peak], candidate.mz_shifts_positions, candidate.mz_shifts_positions_indices, candidate);
+          candidates[i].push_back(candidate);
+        }
+      }
 
-          /**
-           * Filter (3): non-local intensity filter
-           * Are the peak intensities of all peptides above the cutoff?
-           */
-          std::vector<double> intensities_actual; // peak intensities @ m/z peak position + actual m/z shift
-          int peaks_found_in_all_peptides_centroided = nonLocalIntensityFilter_(patterns_[pattern], spectrum, mz_shifts_actual_indices, intensities_actual, peaks_found_in_all_peptides);
-          if (peaks_found_in_all_peptides_centroided < peaks_per_peptide_min_)
-          {
-            continue;
-          }
+      // data structure storing peaks which pass all filters
+      MultiplexFilterResult result;
 
-          /**
-           * Filter (4): zeroth peak filter
-           * There should not be a significant peak to the left of the mono-isotopic
-           * (i.e. first) peak.
-           */
-          bool zero_peak = zerothPeakFilter_(patterns_[pattern], intensities_actual);
-          if (zero_peak)
-          {
-            continue;
-          }
+      // Apply the blacklist in order of spectra and peaks.
+      for (Size i = 0; i < spectra.size(); ++i)
+      {
+        int spectrum = spectra[i]; // index of the spectrum in exp_picked_
+        double rt_picked = exp_picked_[spectrum].getRT();
 
+        for (vector<PeakCandidate>::iterator candidate = candidates[i].begin(); candidate != candidates[i].end(); ++candidate)
+        {
           /**
-           * Filter (5): peptide similarity filter
-           * How similar are the isotope patterns of the peptides?
+           * Filter (1): blacklist filter
+           * Are peaks of the pattern blacklisted (by previous patterns or peaks)?
            */
-          bool peptide_similarity = peptideSimilarityFilter_(patterns_[pattern], intensities_actual, peaks_found_in_all_peptides_centroided);
-          if (!peptide_similarity)
+          if (blacklistFilter_(patterns_[pattern], spectrum, candidate->mz_shifts_positions, candidate->mz_shifts_positions_indices))
           {
-            continue;
+            // filter this peak again without the blacklisted peaks
+            filterPeak_(patterns_[pattern], spectrum, peak_position[spectrum][candidate->peak], candidate->mz_shifts_positions, candidate->mz_shifts_positions_indices, *candidate);
           }
 
-          /**
-           * Filter (6): averagine similarity filter
-           * Does each individual isotope pattern resemble a peptide?
-           */
-          bool averagine_similarity = averagineSimilarityFilter_(patterns_[pattern], intensities_actual, peaks_found_in_all_peptides_centroided, peak_position[peak]);
-          if (!averagine_similarity)
+          if (candidate->passed)
           {
-            continue;
-          }
-
-          /**
-           * All filters passed.
-           */
-          // add the peak to the result
-          vector<MultiplexFilterResultRaw> results_raw;
-          result.addFilterResultPeak(peak_position[peak], rt_picked, mz_shifts_actual, intensities_actual, results_raw);
-
-          // blacklist peaks in the current spectrum and the two neighbouring ones
-          blacklistPeaks_(patterns_[pattern], spectrum, mz_shifts_actual_indices, peaks_found_in_all_peptides_centroided);
+            // add the peak to the result
+            result.addFilterResultPeak(peak_position[spectrum][candidate->peak], rt_picked, candidate->mz_shifts_actual, candidate->intensities_actual, candidate->results_raw);
 
+            // blacklist peaks in the current spectrum and the two neighbouring ones
+            blacklistPeaks_(patterns_[pattern], spectrum, candidate->mz_shifts_actual_indices, candidate->peaks_to_blacklist);
+          }
         }
       }
 
       // add results of this pattern to list
       filter_results.push_back(result);
+
+      setProgress((pattern + 1) * exp_picked_.size());
     }
 
     endProgress();
@@ -248,6 +219,83 @@ namespace OpenMS
     return filter_results;
   }
 
+  void MultiplexFilteringCentroided::filterPeak_(const MultiplexIsotopicPeakPattern& pattern, int spectrum, double mz, std::vector<double> mz_shifts_actual, std::vector<int> mz_shifts_actual_indices, PeakCandidate& candidate) const
+  {
+    candidate.peaks_to_blacklist = -1;
+    candidate.passed = false;
+    candidate.mz_shifts_actual.clear();
+    candidate.mz_shifts_actual_indices.clear();
+    candidate.intensities_actual.clear();
+    candidate.results_raw.clear();
+
+    int peaks_found_in_all_peptides = countPeaksInAllPeptides_(pattern, mz_shifts_actual, mz_shifts_actual_indices);
+    if (peaks_found_in_all_peptides < peaks_per_peptide_min_)
+    {
+      return;
+    }
+
+    /**
+     * Filter (2): blunt intensity filter
+     * Are the mono-isotopic peak intensities of all peptides above the cutoff?
+     */
+    bool bluntVeto = monoIsotopicPeakIntensityFilter_(pattern, spectrum, mz_shifts_actual_indices);
+    if (bluntVeto)
+    {
+      return;
+    }
+
+    /**
+     * Filter (3): non-local intensity filter
+     * Are the peak intensities of all peptides above the cutoff?
+     */
+    std::vector<double> intensities_actual; // peak intensities @ m/z peak position + actual m/z shift
+    int peaks_found_in_all_peptides_centroided = nonLocalIntensityFilter_(pattern, spectrum, mz_shifts_actual_indices, intensities_actual, peaks_found_in_all_peptides);
+    if (peaks_found_in_all_peptides_centroided < peaks_per_peptide_min_)
+    {
+      return;
+    }
+
+    /**
+     * Filter (4): zeroth peak filter
+     * There should not be a significant peak to the left of the mono-isotopic
+     * (i.e. first) peak.
+     */
+    bool zero_peak = zerothPeakFilter_(pattern, intensities_actual);
+    if (zero_peak)
+    {
+      return;
+    }
+
+    /**
+     * Filter (5): peptide similarity filter
+     * How similar are the isotope patterns of the peptides?
+     */
+    bool peptide_similarity = peptideSimilarityFilter_(pattern, intensities_actual, peaks_found_in_all_peptides_centroided);
+    if (!peptide_similarity)
+    {
+      return;
+    }
+
+    /**
+     * Filter (6): averagine similarity filter
+     * Does each individual isotope pattern resemble a peptide?
+     */
+    bool averagine_similarity = averagineSimilarityFilter_(pattern, intensities_actual, peaks_found_in_all_peptides_centroided, mz);
+    if (!averagine_similarity)
+    {
+      return;
+    }
+
+    /**
+     * All filters passed.
+     */
+    candidate.passed = true;
+    candidate.peaks_to_blacklist = peaks_found_in_all_peptides_centroided;
+    candidate.mz_shifts_actual.swap(mz_shifts_actual);
+    candidate.mz_shifts_actual_indices.swap(mz_shifts_actual_indices);
+    candidate.intensities_actual.swap(intensities_actual);
+  }
+
   int MultiplexFilteringCentroided::nonLocalIntensityFilter_(const MultiplexIsotopicPeakPattern& pattern, int spectrum_index, const std::vector<int>& mz_shifts_actual_indices, std::vector<double>& intensities_actual, int peaks_found_in_all_peptides) const
   {
     MSExperiment<Peak1D>::ConstIterator it_rt = exp_picked_.begin() + spectrum_index;
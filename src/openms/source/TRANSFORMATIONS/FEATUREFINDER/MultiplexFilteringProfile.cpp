@@ -49,6 +49,7 @@
 #include <vector>
 #include <algorithm>
 #include <iostream>
+#include <boost/shared_ptr.hpp>
 #include <QDir>
 
 #include <QDir>
@@ -128,183 +129,151 @@ namespace OpenMS
   vector<MultiplexFilterResult> MultiplexFilteringProfile::filter()
   {
     // progress logger
-    unsigned progress = 0;
     startProgress(0, patterns_.size() * exp_profile_.size(), "filtering LC-MS data");
 
     // list of filter results for each peak pattern
     vector<MultiplexFilterResult> filter_results;
+    if (patterns_.empty())
+    {
+      endProgress();
+      return filter_results;
+    }
 
-    // loop over patterns
-    for (unsigned pattern = 0; pattern < patterns_.size(); ++pattern)
+    // indices of the (non-empty) spectra in exp_profile_, exp_picked_ and boundaries_
+    vector<int> spectra;
+    for (Size i = 0; i < exp_profile_.size(); ++i)
     {
-      // data structure storing peaks which pass all filters
-      MultiplexFilterResult result;
+      // skip empty spectra
+      if (exp_profile_[i].size() == 0 || exp_picked_[i].size() == 0 || boundaries_[i].size() == 0)
+      {
+        continue;
+      }
 
-      // iterate over spectra
-      MSExperiment<Peak1D>::Iterator it_rt_profile;
-      MSExperiment<Peak1D>::ConstIterator it_rt_picked;
-      vector<vector<PeakPickerHiRes::PeakBoundary> >::const_iterator it_rt_boundaries;
-      for (it_rt_profile = exp_profile_.begin(), it_rt_picked = exp_picked_.begin(), it_rt_boundaries = boundaries_.begin();
-           it_rt_profile < exp_profile_.end() && it_rt_picked < exp_picked_.end() && it_rt_boundaries < boundaries_.end();
-           ++it_rt_profile, ++it_rt_picked, ++it_rt_boundaries)
+      if (exp_picked_[i].size() != boundaries_[i].size())
       {
-        // skip empty spectra
-        if ((*it_rt_profile).size() == 0 || (*it_rt_picked).size() == 0 || (*it_rt_boundaries).size() == 0)
-        {
-          continue;
-        }
-        
-        if ((*it_rt_picked).size() != (*it_rt_boundaries).size())
-        {
-          throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Number of peaks and number of peak boundaries differ.");
-        }
+        throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Number of peaks and number of peak boundaries differ.");
+      }
+      spectra.push_back(i);
+    }
 
-        setProgress(++progress);
-
-        int spectrum = it_rt_profile - exp_profile_.begin(); // index of the spectrum in exp_profile_, exp_picked_ and boundaries_
-        double rt_picked = it_rt_picked->getRT();
-
-        // spline fit profile data
-        SplineSpectrum spline(*it_rt_profile);
-        SplineSpectrum::Navigator nav = spline.getNavigator();
-
-        // vectors of peak details
-        vector<double> peak_position;
-        vector<double> peak_min;
-        vector<double> peak_max;
-        vector<double> peak_intensity;
-        MSSpectrum<Peak1D>::ConstIterator it_mz;
-        vector<PeakPickerHiRes::PeakBoundary>::const_iterator it_mz_boundary;
-        for (it_mz = it_rt_picked->begin(), it_mz_boundary = it_rt_boundaries->begin();
-             it_mz < it_rt_picked->end() && it_mz_boundary < it_rt_boundaries->end();
-             ++it_mz, ++it_mz_boundary)
-        {
-          peak_position.push_back(it_mz->getMZ());
-          peak_min.push_back((*it_mz_boundary).mz_min);
-          peak_max.push_back((*it_mz_boundary).mz_max);
-          peak_intensity.push_back(it_mz->getIntensity());
-        }
+    // spline fit profile data and collect peak details (once for all patterns)
+    vector<boost::shared_ptr<SplineSpectrum> > splines(exp_profile_.size());
+    vector<vector<double> > peak_position(exp_profile_.size());
+    vector<vector<double> > peak_min(exp_profile_.size());
+    vector<vector<double> > peak_max(exp_profile_.size());
+    vector<vector<double> > peak_intensity(exp_profile_.size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 10)
+#endif
+    for (SignedSize i = 0; i < (SignedSize) spectra.size(); ++i)
+    {
+      int spectrum = spectra[i];
+      try
+      {
+        splines[spectrum] = boost::shared_ptr<SplineSpectrum>(new SplineSpectrum(exp_profile_[spectrum]));
+      }
+      catch (Exception::BaseException&)
+      {
+        // fitted again below (outside of the parallel region)
+      }
+
+      const MSSpectrum<Peak1D>& spectrum_picked = exp_picked_[spectrum];
+      for (Size peak = 0; peak < spectrum_picked.size(); ++peak)
+      {
+        peak_position[spectrum].push_back(spectrum_picked[peak].getMZ());
+        peak_min[spectrum].push_back(boundaries_[spectrum][peak].mz_min);
+        peak_max[spectrum].push_back(boundaries_[spectrum][peak].mz_max);
+        peak_intensity[spectrum].push_back(spectrum_picked[peak].getIntensity());
+      }
+    }
+    for (Size i = 0; i < spectra.size(); ++i)
+    {
+      if (!splines[spectra[i]])
+      {
+        // throws the original exception
+        splines[spectra[i]] = boost::shared_ptr<SplineSpectrum>(new SplineSpectrum(exp_profile_[spectra[i]]));
+      }
+      // throws for spectra without spline packages
+      splines[spectra[i]]->getNavigator();
+    }
+
+    // loop over patterns
+    // (in order, since peaks blacklisted by a pattern are unavailable to all later ones)
+    for (unsigned pattern = 0; pattern < patterns_.size(); ++pattern)
+    {
+      // Filter all peaks of all spectra in parallel, ignoring the blacklist.
+      vector<vector<PeakCandidate> > candidates(spectra.size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 10)
+#endif
+      for (SignedSize i = 0; i < (SignedSize) spectra.size(); ++i)
+      {
+        int spectrum = spectra[i];
+        SplineSpectrum::Navigator nav = splines[spectrum]->getNavigator();
 
         // iterate over peaks in spectrum (mz)
-        for (unsigned peak = 0; peak < peak_position.size(); ++peak)
+        for (unsigned peak = 0; peak < peak_position[spectrum].size(); ++peak)
         {
-
           /**
-           * Filter (1): m/z position and blacklist filter
-           * Are there non-black peaks with the expected relative m/z shifts?
+           * Filter (1): m/z position filter
+           * Are there peaks with the expected relative m/z shifts?
            */
-          vector<double> mz_shifts_actual; // actual m/z shifts (differ slightly from expected m/z shifts)
-          vector<int> mz_shifts_actual_indices; // peak indices in the spectrum corresponding to the actual m/z shifts
-          
-          mz_shifts_actual.reserve(patterns_[pattern].getMZShiftCount());
-          mz_shifts_actual_indices.reserve(patterns_[pattern].getMZShiftCount());
-          
-          int peaks_found_in_all_peptides = positionsAndBlacklistFilter_(patterns_[pattern], spectrum, peak_position, peak, mz_shifts_actual, mz_shifts_actual_indices);
-          if (peaks_found_in_all_peptides < peaks_per_peptide_min_)
+          PeakCandidate candidate;
+          candidate.peak = peak;
+          candidate.mz_shifts_positions.reserve(patterns_[pattern].getMZShiftCount());
+          candidate.mz_shifts_positions_indices.reserve(patterns_[pattern].getMZShiftCount());
+          if (!positionsFilter_(patterns_[pattern], peak_position[spectrum], peak, candidate.mz_shifts_positions, candidate.mz_shifts_positions_indices))
           {
             continue;
           }
 
+          filterPeak_(patterns_[pattern], spectrum, peak_min[spectrum][peak], peak_max[spectrum][peak], peak_intensity[spectrum], nav,
+                      candidate.mz_shifts_positions, candidate.mz_shifts_positions_indices, candidate);
+          candidates[i].push_back(candidate);
+        }
+      }
+
+      // data structure storing peaks which pass all filters
+      MultiplexFilterResult result;
+
+      // Apply the blacklist in order of spectra and peaks.
+      for (Size i = 0; i < spectra.size(); ++i)
+      {
+        int spectrum = spectra[i]; // index of the spectrum in exp_profile_, exp_picked_ and boundaries_
+        double rt_picked = exp_picked_[spectrum].getRT();
+
+        for (vector<PeakCandidate>::iterator candidate = candidates[i].begin(); candidate != candidates[i].end(); ++candidate)
+        {
           /**
-           * Filter (2): blunt intensity filter
-           * Are the mono-isotopic peak intensities of all peptides above the cutoff?
+           * Filter (1): blacklist filter
+           * Are peaks of the pattern blacklisted (by previous patterns or peaks)?
            */
-          bool bluntVeto = monoIsotopicPeakIntensityFilter_(patterns_[pattern], spectrum, mz_shifts_actual_indices);
-          if (bluntVeto)
+          if (blacklistFilter_(patterns_[pattern], spectrum, candidate->mz_shifts_positions, candidate->mz_shifts_positions_indices))
           {
-            continue;
+            // filter this peak again without the blacklisted peaks
+            SplineSpectrum::Navigator nav = splines[spectrum]->getNavigator();
+            filterPeak_(patterns_[pattern], spectrum, peak_min[spectrum][candidate->peak], peak_max[spectrum][candidate->peak], peak_intensity[spectrum], nav,
+                        candidate->mz_shifts_positions, candidate->mz_shifts_positions_indices, *candidate);
           }
 
-          // Arrangement of peaks looks promising. Now scan through the spline fitted data.
-          vector<MultiplexFilterResultRaw> results_raw; // raw data points of this peak that will pass the remaining filters
-          bool blacklisted = false; // Has this peak already been blacklisted?
-          for (double mz = peak_min[peak]; mz < peak_max[peak]; mz = nav.getNextMz(mz))
+          // blacklist peaks in the current spectrum and the two neighbouring ones
+          if (candidate->peaks_to_blacklist >= 0)
           {
-            /**
-             * Filter (3): non-local intensity filter
-             * Are the spline interpolated intensities at m/z above the threshold?
-             */
-            vector<double> intensities_actual; // spline interpolated intensities @ m/z + actual m/z shift
-            int peaks_found_in_all_peptides_spline = nonLocalIntensityFilter_(patterns_[pattern], mz_shifts_actual, mz_shifts_actual_indices, nav, intensities_actual, peaks_found_in_all_peptides, mz);
-            if (peaks_found_in_all_peptides_spline < peaks_per_peptide_min_)
-            {
-              continue;
-            }
-
-            /**
-             * Filter (4): zeroth peak filter
-             * There should not be a significant peak to the left of the mono-isotopic
-             * (i.e. first) peak.
-             */
-            bool zero_peak = zerothPeakFilter_(patterns_[pattern], intensities_actual);
-            if (zero_peak)
-            {
-              continue;
-            }
-
-            /**
-             * Filter (5): peptide similarity filter
-             * How similar are the isotope patterns of the peptides?
-             */
-            bool peptide_similarity = peptideSimilarityFilter_(patterns_[pattern], intensities_actual, peaks_found_in_all_peptides_spline);
-            if (!peptide_similarity)
-            {
-              continue;
-            }
-
-            /**
-             * Filter (6): averagine similarity filter
-             * Does each individual isotope pattern resemble a peptide?
-             */
-            bool averagine_similarity = averagineSimilarityFilter_(patterns_[pattern], intensities_actual, peaks_found_in_all_peptides_spline, mz);
-            if (!averagine_similarity)
-            {
-              continue;
-            }
-
-            /**
-             * All filters passed.
-             */
-            // add raw data point to list that passed all filters
-            MultiplexFilterResultRaw result_raw(mz, mz_shifts_actual, intensities_actual);
-            results_raw.push_back(result_raw);
-            
-            // blacklist peaks in the current spectrum and the two neighbouring ones
-            if (!blacklisted)
-            {
-              blacklistPeaks_(patterns_[pattern], spectrum, mz_shifts_actual_indices, peaks_found_in_all_peptides_spline);
-              blacklisted = true;
-            }
-
+            blacklistPeaks_(patterns_[pattern], spectrum, candidate->mz_shifts_actual_indices, candidate->peaks_to_blacklist);
           }
 
           // add the peak with its corresponding raw data to the result
-          if (results_raw.size() > 2)
+          if (candidate->passed)
           {
-            // Scanning over the profile of the peak, we want at least three raw data points to pass all filters.
-            vector<double> intensities_actual;
-            for (unsigned i = 0; i < mz_shifts_actual_indices.size(); ++i)
-            {
-              int index = mz_shifts_actual_indices[i];
-              if (index == -1)
-              {
-                // no peak found
-                intensities_actual.push_back(std::numeric_limits<double>::quiet_NaN());
-              }
-              else
-              {
-                intensities_actual.push_back(peak_intensity[mz_shifts_actual_indices[i]]);
-              }
-            }
-            result.addFilterResultPeak(peak_position[peak], rt_picked, mz_shifts_actual, intensities_actual, results_raw);
+            result.addFilterResultPeak(peak_position[spectrum][candidate->peak], rt_picked, candidate->mz_shifts_actual, candidate->intensities_actual, candidate->results_raw);
           }
-
         }
-
       }
 
       // add results of this pattern to list
       filter_results.push_back(result);
+
+      setProgress((pattern + 1) * exp_profile_.size());
     }
 
     endProgress();
@@ -312,6 +281,116 @@ namespace OpenMS
     return filter_results;
   }
 
+  void MultiplexFilteringProfile::filterPeak_(const MultiplexIsotopicPeakPattern& pattern, int spectrum, double peak_min, double peak_max, const std::vector<double>& peak_intensity, SplineSpectrum::Navigator& nav, std::vector<double> mz_shifts_actual, std::vector<int> mz_shifts_actual_indices, PeakCandidate& candidate) const
+  {
+    candidate.peaks_to_blacklist = -1;
+    candidate.passed = false;
+    candidate.mz_shifts_actual.clear();
+    candidate.mz_shifts_actual_indices.clear();
+    candidate.intensities_actual.clear();
+    candidate.results_raw.clear();
+
+    int peaks_found_in_all_peptides = countPeaksInAllPeptides_(pattern, mz_shifts_actual, mz_shifts_actual_indices);
+    if (peaks_found_in_all_peptides < peaks_per_peptide_min_)
+    {
+      return;
+    }
+
+    /**
+     * Filter (2): blunt intensity filter
+     * Are the mono-isotopic peak intensities of all peptides above the cutoff?
+     */
+    bool bluntVeto = monoIsotopicPeakIntensityFilter_(pattern, spectrum, mz_shifts_actual_indices);
+    if (bluntVeto)
+    {
+      return;
+    }
+
+    // Arrangement of peaks looks promising. Now scan through the spline fitted data.
+    vector<MultiplexFilterResultRaw> results_raw; // raw data points of this peak that will pass the remaining filters
+    for (double mz = peak_min; mz < peak_max; mz = nav.getNextMz(mz))
+    {
+      /**
+       * Filter (3): non-local intensity filter
+       * Are the spline interpolated intensities at m/z above the threshold?
+       */
+      vector<double> intensities_actual; // spline interpolated intensities @ m/z + actual m/z shift
+      int peaks_found_in_all_peptides_spline = nonLocalIntensityFilter_(pattern, mz_shifts_actual, mz_shifts_actual_indices, nav, intensities_actual, peaks_found_in_all_peptides, mz);
+      if (peaks_found_in_all_peptides_spline < peaks_per_peptide_min_)
+      {
+        continue;
+      }
+
+      /**
+       * Filter (4): zeroth peak filter
+       * There should not be a significant peak to the left of the mono-isotopic
+       * (i.e. first) peak.
+       */
+      bool zero_peak = zerothPeakFilter_(pattern, intensities_actual);
+      if (zero_peak)
+      {
+        continue;
+      }
+
+      /**
+       * Filter (5): peptide similarity filter
+       * How similar are the isotope patterns of the peptides?
+       */
+      bool peptide_similarity = peptideSimilarityFilter_(pattern, intensities_actual, peaks_found_in_all_peptides_spline);
+      if (!peptide_similarity)
+      {
+        continue;
+      }
+
+      /**
+       * Filter (6): averagine similarity filter
+       * Does each individual isotope pattern resemble a peptide?
+       */
+      bool averagine_similarity = averagineSimilarityFilter_(pattern, intensities_actual, peaks_found_in_all_peptides_spline, mz);
+      if (!averagine_similarity)
+      {
+        continue;
+      }
+
+      /**
+       * All filters passed.
+       */
+      // add raw data point to list that passed all filters
+      MultiplexFilterResultRaw result_raw(mz, mz_shifts_actual, intensities_actual);
+      results_raw.push_back(result_raw);
+
+      // the peaks are blacklisted as seen by the first data point which passed all filters
+      if (candidate.peaks_to_blacklist < 0)
+      {
+        candidate.peaks_to_blacklist = peaks_found_in_all_peptides_spline;
+        candidate.mz_shifts_actual_indices = mz_shifts_actual_indices;
+      }
+    }
+
+    // Scanning over the profile of the peak, we want at least three raw data points to pass all filters.
+    if (results_raw.size() > 2)
+    {
+      vector<double> intensities_actual;
+      for (unsigned i = 0; i < mz_shifts_actual_indices.size(); ++i)
+      {
+        int index = mz_shifts_actual_indices[i];
+        if (index == -1)
+        {
+          // no peak found
+          intensities_actual.push_back(std::numeric_limits<double>::quiet_NaN());
+        }
+        else
+        {
+          intensities_actual.push_back(peak_intensity[mz_shifts_actual_indices[i]]);
+        }
+      }
+      candidate.passed = true;
+      candidate.mz_shifts_actual = mz_shifts_actual;
+      candidate.intensities_actual = intensities_actual;
+      candidate.results_raw.swap(results_raw);
+    }
+  }
+
   int MultiplexFilteringProfile::nonLocalIntensityFilter_(const MultiplexIsotopicPeakPattern& pattern, const vector<double>& mz_shifts_actual, const vector<int>& mz_shifts_actual_indices, SplineSpectrum::Navigator nav, std::vector<double>& intensities_actual, int peaks_found_in_all_peptides, double mz) const
   {
     // calculate intensities
@@ -35,52 +35,55 @@
 
 #include <OpenMS/TRANSFORMATIONS/RAW2PEAK/ContinuousWaveletTransformNumIntegration.h>
 
+#include <algorithm>
+
 namespace OpenMS
 {
   double ContinuousWaveletTransformNumIntegration::integrate_
     (const std::vector<double> & processed_input,
+    const std::vector<double> & kernel,
     double spacing_data,
-    int index)
+    int index) const
   {
     double v = 0.;
-    int half_width = (int)wavelet_.size();
-    int index_in_data = (int)floor((half_width * spacing_) / spacing_data);
+    int index_in_data = (int)kernel.size() - 1;
     int offset_data_left = ((index - index_in_data) < 0) ? 0 : (index - index_in_data);
     int offset_data_right = ((index + index_in_data) > (int)processed_input.size() - 1) ? (int)processed_input.size() - 2 : (index + index_in_data);
 
     // integrate from i until offset_data_left
+    for (int i = index; i > offset_data_left; --i)
     {
-      int index_w_r = 0;
-      for (int i = index; i > offset_data_left; --i)
-      {
-        int index_w_l = (int)Math::round(((index - (i - 1)) * spacing_data) / spacing_);
-        // we could also use:
-        // v += spacing_data / 2. * (...), but this can be factored out (see below) for faster computation
-        v += (processed_input[i] * wavelet_[index_w_r] + processed_input[i - 1] * wavelet_[index_w_l]);
-        index_w_r = index_w_l;
-      }
+      v += (processed_input[i] * kernel[index - i] + processed_input[i - 1] * kernel[index - (i - 1)]);
     }
 
     // integrate from i+1 until offset_data_right
+    for (int i = index; i < offset_data_right; ++i)
     {
-      int index_w_l = 0;
-      for (int i = index; i < offset_data_right; ++i)
-      {
-        int index_w_r = (int)Math::round((((i + 1) - index) * spacing_data) / spacing_);
-        v += (processed_input[i + 1] * wavelet_[index_w_r] + processed_input[i] * wavelet_[index_w_l]);
-        index_w_l = index_w_r;
-      }
+      v += (processed_input[i + 1] * kernel[(i + 1) - index] + processed_input[i] * kernel[i - index]);
     }
 
     // multiply by (spacing_data / 2.), but change order for better numerical stability
     return v / 2./ sqrt(scale_) * spacing_data;
   }
 
+  void ContinuousWaveletTransformNumIntegration::tabulateWavelet_(double spacing_data, std::vector<double> & kernel) const
+  {
+    int half_width = (int)wavelet_.size();
+    int index_in_data = (int)floor((half_width * spacing_) / spacing_data);
+    kernel.resize(index_in_data + 1);
+    for (int j = 0; j <= index_in_data; ++j)
+    {
+      Size index_w = (Size)Math::round((j * spacing_data) / spacing_);
+      kernel[j] = wavelet_[std::min(index_w, wavelet_.size() - 1)];
+    }
+  }
+
   void ContinuousWaveletTransformNumIntegration::init(double scale, double spacing)
   {
     // will set members for scale_ and spacing_
     ContinuousWaveletTransform::init(scale, spacing);
     int number_of_points = (int)(ceil(5 * scale_ / spacing_)) + 1;
+    wavelet_.clear();
     wavelet_.reserve(number_of_points);
     wavelet_.push_back(1.);
 
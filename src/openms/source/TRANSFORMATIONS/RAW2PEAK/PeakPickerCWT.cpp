@@ -67,7 +67,11 @@ namespace OpenMS
     scale_(0.0),
     peak_corr_bound_(0.0),
     noise_level_(0.0),
-    optimization_(false)
+    optimization_(false),
+    wt_(),
+    wt_deconvolution_(),
+    peak_bound_cwt_(0.0),
+    peak_bound_ms2_level_cwt_(0.0)
   {
     defaults_.setValue("signal_to_noise", 1.0, "Minimal signal to noise ratio for a peak to be picked.");
     defaults_.setMinFloat("signal_to_noise", 0.0);
@@ -217,6 +221,22 @@ namespace OpenMS
     signal_to_noise_ = (float)param_.getValue("signal_to_noise");
 
     deconvolution_ = param_.getValue("deconvolution:deconvolution").toBool();
+
+    // initialize the wavelet transforms once (instead of for every spectrum and peak)
+    double spacing = (double)param_.getValue("wavelet_transform:spacing");
+    double scaling_DC = (float)param_.getValue("deconvolution:scaling");
+    peak_bound_cwt_ = 0.0;
+    peak_bound_ms2_level_cwt_ = 0.0;
+    if (scale_ > 0 && spacing > 0)
+    {
+      initializeWT_(wt_, peak_bound_, peak_bound_cwt_);
+      initializeWT_(wt_, peak_bound_ms2_level_, peak_bound_ms2_level_cwt_);
+    }
+    if (scaling_DC > 0 && spacing > 0)
+    {
+      // scaling for charge 2 (see deconvolutePeak_())
+      wt_deconvolution_.init(scaling_DC / 2, spacing);
+    }
   }
 
   bool PeakPickerCWT::getMaxPosition_(
@@ -715,9 +735,8 @@ namespace OpenMS
     float scaling_DC = (float) param_.getValue("deconvolution:scaling");
     double resolution = 10;
     // init and calculate the transform of the signal in the convoluted region
-    // first take the scaling for charge 2
-    ContinuousWaveletTransformNumIntegration wtDC;
-    wtDC.init(scaling_DC / 2, (double)param_.getValue("wavelet_transform:spacing"));
+    // first take the scaling for charge 2 (initialized in updateMembers_())
+    ContinuousWaveletTransformNumIntegration wtDC(wt_deconvolution_);
     wtDC.transform(shape.getLeftEndpoint(), shape.getRightEndpoint(), resolution);
     
 #ifdef DEBUG_DECONV
@@ -1067,8 +1086,9 @@ namespace OpenMS
     // pick peaks on each scan
     startProgress(0, input.size(), "picking peaks");
     Size progress = 0;
+    // spectra differ a lot in size and number of peaks
 #ifdef _OPENMP
-#pragma omp parallel for
+#pragma omp parallel for schedule(dynamic, 10)
 #endif
     for (SignedSize i = 0; i < (SignedSize)input.size(); ++i)
     {
@@ -1120,13 +1140,11 @@ namespace OpenMS
     output.getFloatDataArrays()[5].setName("peakShape");
     output.getFloatDataArrays()[6].setName("SignalToNoise");
 
-    /// The continuous wavelet "transformer"
-    ContinuousWaveletTransformNumIntegration wt;
+    /// The continuous wavelet "transformer" (every spectrum is picked with its own copy)
+    ContinuousWaveletTransformNumIntegration wt(wt_);
     /// The minimal height which defines a peak in the CWT
-    double peak_bound_ms_cwt = 0.0;
     double bound = (input.getMSLevel() <= 1 ? peak_bound_ : peak_bound_ms2_level_);
-    // now initialize every time as every spectrum is picked with its own cwt
-    initializeWT_(wt, bound, peak_bound_ms_cwt);
+    double peak_bound_ms_cwt = (input.getMSLevel() <= 1 ? peak_bound_cwt_ : peak_bound_ms2_level_cwt_);
 
     //create the peak shapes vector
     std::vector<PeakShape> peak_shapes;
@@ -1163,14 +1181,28 @@ namespace OpenMS
     // start the peak picking until no more maxima can be found in the wavelet transform
     UInt number_of_peaks = 0;
 
+    // raw data regions which were removed (set to zero) since the last transform
+    std::vector<std::pair<PeakIterator, PeakIterator> > removed_regions;
+    bool transformed = false;
+
     do
     {
       number_of_peaks = 0;
       Int peak_left_index, peak_right_index;
 
       // compute the continuous wavelet transform with resolution 1
+      // (afterwards, only recompute it where removed peaks changed the signal)
       const double resolution = 1;
-      wt.transform(it_pick_begin, it_pick_end, resolution);
+      if (!transformed)
+      {
+        wt.transform(it_pick_begin, it_pick_end, resolution);
+        transformed = true;
+      }
+      for (Size r = 0; r < removed_regions.size(); ++r)
+      {
+        wt.update(raw_peak_array.begin(), raw_peak_array.end(), removed_regions[r].first, removed_regions[r].second);
+      }
+      removed_regions.clear();
       PeakArea_ area;
 
       // search for maximum positions in the cwt and extract potential peaks
@@ -1250,6 +1282,7 @@ namespace OpenMS
         {
           pi->setIntensity(0.);
         }
+        removed_regions.push_back(std::make_pair(area.left, area.right + 1));
 
         // search for the next peak
         it_pick_begin = area.right;
@@ -0,0 +1,157 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2016.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: Timo Sachsenberg $
+// --------------------------------------------------------------------------
+
+#ifndef OPENMS_VISUAL_INTENSITYPYRAMID_H
+#define OPENMS_VISUAL_INTENSITYPYRAMID_H
+
+// OpenMS_GUI config
+#include <OpenMS/VISUAL/OpenMS_GUIConfig.h>
+
+#include <OpenMS/KERNEL/MSExperiment.h>
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QMutex>
+
+#include <vector>
+
+namespace OpenMS
+{
+  /**
+      @brief Multi-resolution grid of maximum and summed MS1 intensities (level of detail for the 2D view)
+
+      The RT x m/z plane of an experiment is divided into a regular grid of cells which store the
+      maximum and the sum of all MS1 peak intensities they contain. Each further level halves the
+      resolution in both dimensions, so that the number of cells that have to be visited for a given
+      screen resolution is bounded independently of the size of the data.
+
+      The pyramid is meant to be built once, possibly in a background thread (see build()). Until the
+      build has finished, isReady() returns @em false and the pyramid must not be queried.
+
+      @ingroup Visual
+  */
+  class OPENMS_GUI_DLLAPI IntensityPyramid
+  {
+public:
+    /// Experiment type the pyramid is built from
+    typedef MSExperiment<Peak1D> ExperimentType;
+
+    /// One resolution level (row-major storage: index = rt_bin * mz_bins + mz_bin)
+    struct Level
+    {
+      /// Number of cells in RT dimension
+      Size rt_bins;
+      /// Number of cells in m/z dimension
+      Size mz_bins;
+      /// Width of a cell in RT dimension
+      double rt_step;
+      /// Width of a cell in m/z dimension
+      double mz_step;
+      /// Maximum intensity of each cell (negative for empty cells)
+      std::vector<float> max_intensity;
+      /// Summed intensity of each cell
+      std::vector<float> sum_intensity;
+    };
+
+    /// Constructor
+    IntensityPyramid();
+
+    /**
+        @brief Builds the pyramid from the MS1 spectra of @p exp
+
+        Blocks until the pyramid is complete or cancel() was called. Only call this once per object.
+
+        @note @p exp is read without locking, it must not be modified until build() has returned.
+        When building in a background thread, whoever modifies the data has to cancel() first.
+
+        @param exp The (RT-sorted) experiment
+        @param rt_bins Number of RT cells of the finest level
+        @param mz_bins Number of m/z cells of the finest level
+    */
+    void build(const ExperimentType & exp, Size rt_bins = 1024, Size mz_bins = 4096);
+
+    /// Aborts a running build and waits until it has returned. The pyramid stays empty afterwards.
+    void cancel();
+
+    /// Returns if the pyramid is completely built (never blocks)
+    bool isReady() const;
+
+    /// Returns the number of levels (0 is the finest level)
+    Size getLevelCount() const;
+
+    /// Returns a level
+    const Level & getLevel(Size index) const;
+
+    /**
+        @brief Returns the coarsest level whose cells are not larger than the given extent
+
+        Returns getLevelCount() if even the finest level is too coarse.
+    */
+    Size findLevel(double rt_extent, double mz_extent) const;
+
+    /**
+        @brief Returns the maximum intensity of all cells of level @p index whose centers lie in the given area
+
+        Returns a negative value if there are no (non-empty) cells.
+    */
+    float getMaxIntensity(Size index, double rt_min, double rt_max, double mz_min, double mz_max) const;
+
+    /// Returns the summed intensity of all cells of level @p index whose centers lie in the given area
+    double getSumIntensity(Size index, double rt_min, double rt_max, double mz_min, double mz_max) const;
+
+protected:
+    /// Determines the half-open cell range whose centers lie in [@p min, @p max)
+    void cellRange_(double min, double max, double origin, double step, Size bins, Size & first, Size & last) const;
+
+    /// The levels, finest first
+    std::vector<Level> levels_;
+    /// Lower RT bound of the grid
+    double rt_min_;
+    /// Lower m/z bound of the grid
+    double mz_min_;
+    /// Flag that indicates that the build finished
+    bool ready_;
+    /// Flag that requests aborting a running build
+    QAtomicInt cancel_;
+    /// Held while building
+    mutable QMutex mutex_;
+
+private:
+    /// Not implemented
+    IntensityPyramid(const IntensityPyramid &);
+
+    /// Not implemented
+    IntensityPyramid & operator=(const IntensityPyramid &);
+  };
+}
+#endif // OPENMS_VISUAL_INTENSITYPYRAMID_H
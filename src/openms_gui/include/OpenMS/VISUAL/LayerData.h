@@ -53,6 +53,8 @@
 
 namespace OpenMS
 {
+  class IntensityPyramid;
+
   /**
   @brief Class that stores the data for one layer
 
@@ -140,6 +142,7 @@ public:
       modifiable(false),
       modified(false),
       label(L_NONE),
+      intensity_pyramid(),
       features(new FeatureMapType()),
       consensus(new ConsensusMapType()),
       peaks(new ExperimentType()),
@@ -307,6 +310,14 @@ public:
     /// Label type
     LabelType label;
 
+    /**
+      @brief Precomputed intensity levels of detail of the peak data (2D view, may be null)
+
+      The pyramid is built in the background and reads @em peaks while doing so. Cancel it before
+      modifying the peaks in place and rebuild it afterwards (Spectrum2DCanvas::updateLayer).
+    */
+    boost::shared_ptr<IntensityPyramid> intensity_pyramid;
+
 private:
     /// feature data
     FeatureMapSharedPtrType features;
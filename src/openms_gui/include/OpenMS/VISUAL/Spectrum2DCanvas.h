@@ -188,6 +188,16 @@ protected:
     */
     void paintMaximumIntensities_(Size layer_index, Size rt_pixel_count, Size mz_pixel_count, QPainter& p);
 
+    /**
+      @brief Starts building the intensity pyramid of a (large) peak layer in the background.
+
+      A previously built or running pyramid of the layer is discarded. The build reads the layer's
+      peak data directly (no copy), so the data must not be modified until the pyramid was cancelled.
+
+      @param layer_index The index of the layer.
+    */
+    void startIntensityPyramid_(Size layer_index);
+
     /**
       @brief Paints the precursor peaks.
 
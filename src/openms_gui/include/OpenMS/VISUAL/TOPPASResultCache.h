@@ -0,0 +1,121 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2016.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Johannes Veit $
+// $Authors: Chris Bielow $
+// --------------------------------------------------------------------------
+
+#ifndef OPENMS_VISUAL_TOPPASRESULTCACHE_H
+#define OPENMS_VISUAL_TOPPASRESULTCACHE_H
+
+// OpenMS_GUI config
+#include <OpenMS/VISUAL/OpenMS_GUIConfig.h>
+
+#include <OpenMS/DATASTRUCTURES/Param.h>
+#include <OpenMS/DATASTRUCTURES/String.h>
+
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+
+#include <map>
+
+class QDir;
+
+namespace OpenMS
+{
+  /**
+      @brief A directory of cached results of TOPP tools, used by TOPPAS to skip unchanged tools
+
+      Each entry is stored in a subdirectory named by its key (see computeKey()). An entry is only
+      used once it is complete, i.e. all output files were copied successfully.
+
+      The size of the cache can be bounded: after an entry is stored, the least recently used (i.e.
+      stored or restored) complete entries are removed until the size of all complete entries is
+      within the bound. The entry just stored is never removed.
+
+      @ingroup TOPPAS_elements
+  */
+  class OPENMS_GUI_DLLAPI TOPPASResultCache
+  {
+public:
+    /// files of a tool (in the order of the files) by parameter index
+    typedef std::map<Int, QStringList> FileMap;
+
+    /**
+      @brief Constructor
+
+      @param cache_dir the directory of the cache
+      @param max_size maximal size (in bytes) of the cached files of all entries (0 for no limit)
+    */
+    explicit TOPPASResultCache(const QString& cache_dir, Size max_size = 0);
+
+    /// Destructor
+    virtual ~TOPPASResultCache();
+
+    /// Returns the directory of the cache
+    const QString& getCacheDir() const;
+
+    /// Returns the maximal size (in bytes) of all entries (0 for no limit)
+    Size getMaxSize() const;
+
+    /**
+      @brief Computes the key of a tool run
+
+      @param tool description of the tool (e.g. name, type, version); any change invalidates the entry
+      @param param the parameters of the tool; the files of parameters tagged "input file" enter by content
+      @param input_files the input files (by content)
+      @param output_files the output files (by name, as their directory is not fixed)
+    */
+    String computeKey(const String& tool, const Param& param, const FileMap& input_files, const FileMap& output_files) const;
+
+    /// Copies the cached files of entry @p key to @p output_files. Returns false if the entry is missing or incomplete.
+    bool restore(const String& key, const FileMap& output_files) const;
+
+    /// Stores @p output_files as entry @p key and removes the least recently used entries if the cache is too large. Returns false if the files could not be stored.
+    bool store(const String& key, const FileMap& output_files) const;
+
+protected:
+    /// Returns the name of the cached file @p index of parameter @p param in entry @p entry_dir
+    QString cachedFile_(const QString& entry_dir, Int param, int index) const;
+
+    /// Marks the entry in @p entry_dir as complete and records the time of its last use. Returns false if this fails.
+    bool markUsed_(const QDir& entry_dir) const;
+
+    /// Removes the least recently used complete entries (except @p keep) until the cache is within its maximal size
+    void evict_(const String& keep) const;
+
+    /// directory of the cache
+    QString cache_dir_;
+    /// maximal size (in bytes) of all entries (0 for no limit)
+    Size max_size_;
+  };
+}
+
+#endif // OPENMS_VISUAL_TOPPASRESULTCACHE_H
@@ -243,6 +243,19 @@ public:
     void setDescription(const QString & desc);
     /// sets the maximum number of jobs
     void setAllowedThreads(int num_threads);
+    /**
+      @brief Sets the directory for cached results of tools (empty to disable the cache)
+
+      Tools whose executable, parameters and input files (by content) are the same as in a previous run
+      are not executed again; instead, their output files are copied from the cache.
+    */
+    void setCacheDir(const QString & dir);
+    /// Returns the directory for cached results of tools (empty if the cache is disabled)
+    const QString & getCacheDir() const;
+    /// Sets the maximal size (in bytes) of the cached results (0 for no limit); least recently used results are removed first
+    void setCacheMaxSize(Size max_size);
+    /// Returns the maximal size (in bytes) of the cached results (0 for no limit)
+    Size getCacheMaxSize() const;
     /// returns the hovering edge
     TOPPASEdge* getHoveringEdge();
     /// Checks whether all output vertices are finished, and if yes, emits entirePipelineFinished() (called by finished output vertices)
@@ -362,6 +375,10 @@ protected:
     QString description_text_;
     /// maximum number of allowed threads
     int allowed_threads_;
+    /// directory for cached results of tools (empty if the cache is disabled)
+    QString cache_dir_;
+    /// maximal size (in bytes) of the cached results (0 for no limit)
+    Size cache_max_size_;
     /// last node where 'resume' was started
     TOPPASToolVertex* resume_source_;
 
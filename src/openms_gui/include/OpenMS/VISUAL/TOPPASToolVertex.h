@@ -39,6 +39,7 @@
 #include <OpenMS/VISUAL/OpenMS_GUIConfig.h>
 
 #include <OpenMS/VISUAL/TOPPASVertex.h>
+#include <OpenMS/VISUAL/TOPPASResultCache.h>
 #include <OpenMS/DATASTRUCTURES/Param.h>
 
 #include <QtCore/QVector>
@@ -257,6 +258,14 @@ protected:
     void writeParam_(const Param& param, const QString& ini_file);
     /// Helper method for finding good boundaries for wrapping the tool name. Returns a string with whitespaces at the preferred boundaries.
     QString toolnameWithWhitespacesForFancyWordWrapping_(QPainter* painter, const QString& str);
+    /// Computes the key of round @p round in the result cache from the tool, its parameters, the content of the @p input_files and the output file names
+    String getCacheKey_(const RoundPackage& input_files, int round) const;
+    /// Copies the output files of round @p round from the result cache. Returns false if they are not cached.
+    bool restoreFromCache_(int round) const;
+    /// Stores the output files of all executed (i.e. not cached) rounds in the result cache
+    void storeInCache_() const;
+    /// Returns the output files of round @p round by parameter index
+    TOPPASResultCache::FileMap getOutputFileMap_(int round) const;
 
     /// The name of the tool
     String name_;
@@ -274,6 +283,11 @@ protected:
     /// Breakpoint set?
     bool breakpoint_set_;
 
+    /// key of each round in the result cache (empty if the cache is disabled)
+    std::vector<String> cache_keys_;
+    /// whether the output files of each round were taken from the result cache
+    std::vector<bool> cache_hits_;
+
     /// smart naming of round-based filenames
     /// when basename is not unique we take the preceding directory name
     void smartFileNames_(std::vector<QStringList>& filenames);
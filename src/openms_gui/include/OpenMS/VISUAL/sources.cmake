@@ -64,6 +64,7 @@ ColorSelector.h
 EnhancedTabBar.h
 GUIProgressLoggerImpl.h
 HistogramWidget.h
+IntensityPyramid.h
 LayerData.h
 MetaDataBrowser.h
 MultiGradient.h
@@ -93,6 +94,7 @@ TOPPASTabBar.h
 TOPPASTreeView.h
 TOPPASResource.h
 TOPPASResources.h
+TOPPASResultCache.h
 TOPPViewIdentificationViewBehavior.h
 TOPPViewSpectraViewBehavior.h
 EnhancedWorkspace.h
@@ -59,6 +59,7 @@
 #include <OpenMS/VISUAL/ColorSelector.h>
 #include <OpenMS/VISUAL/EnhancedTabBar.h>
 #include <OpenMS/VISUAL/EnhancedWorkspace.h>
+#include <OpenMS/VISUAL/IntensityPyramid.h>
 #include <OpenMS/VISUAL/MetaDataBrowser.h>
 #include <OpenMS/VISUAL/MultiGradientSelector.h>
 #include <OpenMS/VISUAL/ParamEditor.h>
@@ -3935,6 +3936,11 @@ namespace OpenMS
         // reload data
         if (layer.type == LayerData::DT_PEAK) //peak data
         {
+          // stop reading the data in the background before it is replaced
+          if (layer.intensity_pyramid)
+          {
+            layer.intensity_pyramid->cancel();
+          }
           try
           {
             FileHandler().loadExperiment(layer.filename, *layer.getPeakData());
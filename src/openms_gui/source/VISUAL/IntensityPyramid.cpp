@@ -0,0 +1,253 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2016.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: Timo Sachsenberg $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/VISUAL/IntensityPyramid.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace std;
+
+namespace OpenMS
+{
+  IntensityPyramid::IntensityPyramid() :
+    levels_(),
+    rt_min_(0.0),
+    mz_min_(0.0),
+    ready_(false),
+    cancel_(0),
+    mutex_()
+  {
+  }
+
+  void IntensityPyramid::build(const ExperimentType & exp, Size rt_bins, Size mz_bins)
+  {
+    QMutexLocker locker(&mutex_);
+    ready_ = false;
+    levels_.clear();
+    if (cancel_ != 0)
+    {
+      return;
+    }
+
+    // determine the range of the MS1 data
+    bool has_data = false;
+    double rt_max = 0.0, mz_max = 0.0;
+    for (ExperimentType::ConstIterator it = exp.begin(); it != exp.end(); ++it)
+    {
+      if (it->getMSLevel() != 1 || it->empty())
+      {
+        continue;
+      }
+      if (!has_data)
+      {
+        rt_min_ = it->getRT();
+        rt_max = it->getRT();
+        mz_min_ = it->front().getMZ();
+        mz_max = it->back().getMZ();
+        has_data = true;
+      }
+      rt_min_ = min(rt_min_, it->getRT());
+      rt_max = max(rt_max, it->getRT());
+      mz_min_ = min(mz_min_, it->front().getMZ());
+      mz_max = max(mz_max, it->back().getMZ());
+    }
+    if (!has_data)
+    {
+      ready_ = true;
+      return;
+    }
+
+    // reserve all levels up front, so that references to them stay valid while reducing
+    Size level_count = 1;
+    for (Size r = max(rt_bins, (Size)1), m = max(mz_bins, (Size)1); min(r, m) > 1; r = (r + 1) / 2, m = (m + 1) / 2)
+    {
+      ++level_count;
+    }
+    levels_.reserve(level_count);
+
+    // finest level: bin all MS1 peaks
+    levels_.push_back(Level());
+    Level & base = levels_.back();
+    base.rt_bins = max(rt_bins, (Size)1);
+    base.mz_bins = max(mz_bins, (Size)1);
+    base.rt_step = (rt_max > rt_min_) ? (rt_max - rt_min_) / base.rt_bins : 1.0;
+    base.mz_step = (mz_max > mz_min_) ? (mz_max - mz_min_) / base.mz_bins : 1.0;
+    base.max_intensity.assign(base.rt_bins * base.mz_bins, -1.0f);
+    base.sum_intensity.assign(base.rt_bins * base.mz_bins, 0.0f);
+
+    for (ExperimentType::ConstIterator it = exp.begin(); it != exp.end(); ++it)
+    {
+      if (cancel_ != 0)
+      {
+        levels_.clear();
+        return;
+      }
+      if (it->getMSLevel() != 1 || it->empty())
+      {
+        continue;
+      }
+      Size rt_bin = min((Size)((it->getRT() - rt_min_) / base.rt_step), base.rt_bins - 1);
+      float * max_row = &base.max_intensity[rt_bin * base.mz_bins];
+      float * sum_row = &base.sum_intensity[rt_bin * base.mz_bins];
+      for (ExperimentType::SpectrumType::ConstIterator p_it = it->begin(); p_it != it->end(); ++p_it)
+      {
+        Size mz_bin = min((Size)((p_it->getMZ() - mz_min_) / base.mz_step), base.mz_bins - 1);
+        max_row[mz_bin] = max(max_row[mz_bin], p_it->getIntensity());
+        sum_row[mz_bin] += p_it->getIntensity();
+      }
+    }
+
+    // coarser levels: combine 2x2 cells of the previous level
+    while (levels_.size() < level_count)
+    {
+      if (cancel_ != 0)
+      {
+        levels_.clear();
+        return;
+      }
+      levels_.push_back(Level());
+      const Level & prev = levels_[levels_.size() - 2];
+      Level & next = levels_.back();
+      next.rt_bins = (prev.rt_bins + 1) / 2;
+      next.mz_bins = (prev.mz_bins + 1) / 2;
+      next.rt_step = prev.rt_step * 2.0;
+      next.mz_step = prev.mz_step * 2.0;
+      next.max_intensity.assign(next.rt_bins * next.mz_bins, -1.0f);
+      next.sum_intensity.assign(next.rt_bins * next.mz_bins, 0.0f);
+      for (Size r = 0; r < prev.rt_bins; ++r)
+      {
+        Size prev_row = r * prev.mz_bins, next_row = (r / 2) * next.mz_bins;
+        for (Size m = 0; m < prev.mz_bins; ++m)
+        {
+          Size next_index = next_row + m / 2;
+          next.max_intensity[next_index] = max(next.max_intensity[next_index], prev.max_intensity[prev_row + m]);
+          next.sum_intensity[next_index] += prev.sum_intensity[prev_row + m];
+        }
+      }
+    }
+
+    ready_ = true;
+  }
+
+  void IntensityPyramid::cancel()
+  {
+    cancel_.fetchAndStoreOrdered(1);
+    QMutexLocker locker(&mutex_);
+    levels_.clear();
+    ready_ = false;
+  }
+
+  bool IntensityPyramid::isReady() const
+  {
+    if (!mutex_.tryLock())
+    {
+      return false;
+    }
+    bool ready = ready_;
+    mutex_.unlock();
+    return ready;
+  }
+
+  Size IntensityPyramid::getLevelCount() const
+  {
+    return levels_.size();
+  }
+
+  const IntensityPyramid::Level & IntensityPyramid::getLevel(Size index) const
+  {
+    return levels_[index];
+  }
+
+  Size IntensityPyramid::findLevel(double rt_extent, double mz_extent) const
+  {
+    for (Size i = levels_.size(); i > 0; --i)
+    {
+      if (levels_[i - 1].rt_step <= rt_extent && levels_[i - 1].mz_step <= mz_extent)
+      {
+        return i - 1;
+      }
+    }
+    return levels_.size();
+  }
+
+  void IntensityPyramid::cellRange_(double min, double max, double origin, double step, Size bins, Size & first, Size & last) const
+  {
+    // centers are located at origin + (i + 0.5) * step
+    double first_pos = std::ceil((min - origin) / step - 0.5);
+    double last_pos = std::ceil((max - origin) / step - 0.5);
+    first = (Size)std::max(0.0, std::min(first_pos, (double)bins));
+    last = (Size)std::max((double)first, std::min(last_pos, (double)bins));
+  }
+
+  float IntensityPyramid::getMaxIntensity(Size index, double rt_min, double rt_max, double mz_min, double mz_max) const
+  {
+    const Level & level = levels_[index];
+    Size rt_first, rt_last, mz_first, mz_last;
+    cellRange_(rt_min, rt_max, rt_min_, level.rt_step, level.rt_bins, rt_first, rt_last);
+    cellRange_(mz_min, mz_max, mz_min_, level.mz_step, level.mz_bins, mz_first, mz_last);
+
+    float max_intensity = -1.0f;
+    for (Size r = rt_first; r < rt_last; ++r)
+    {
+      const float * row = &level.max_intensity[r * level.mz_bins];
+      for (Size m = mz_first; m < mz_last; ++m)
+      {
+        max_intensity = max(max_intensity, row[m]);
+      }
+    }
+    return max_intensity;
+  }
+
+  double IntensityPyramid::getSumIntensity(Size index, double rt_min, double rt_max, double mz_min, double mz_max) const
+  {
+    const Level & level = levels_[index];
+    Size rt_first, rt_last, mz_first, mz_last;
+    cellRange_(rt_min, rt_max, rt_min_, level.rt_step, level.rt_bins, rt_first, rt_last);
+    cellRange_(mz_min, mz_max, mz_min_, level.mz_step, level.mz_bins, mz_first, mz_last);
+
+    double sum = 0.0;
+    for (Size r = rt_first; r < rt_last; ++r)
+    {
+      const float * row = &level.sum_intensity[r * level.mz_bins];
+      for (Size m = mz_first; m < mz_last; ++m)
+      {
+        sum += row[m];
+      }
+    }
+    return sum;
+  }
+
+} // namespace OpenMS
@@ -42,6 +42,7 @@
 #include <OpenMS/FORMAT/IdXMLFile.h>
 #include <OpenMS/VISUAL/DIALOGS/Spectrum2DPrefDialog.h>
 #include <OpenMS/VISUAL/ColorSelector.h>
+#include <OpenMS/VISUAL/IntensityPyramid.h>
 #include <OpenMS/VISUAL/MultiGradientSelector.h>
 #include <OpenMS/VISUAL/DIALOGS/FeatureEditDialog.h>
 #include <OpenMS/SYSTEM/FileWatcher.h>
@@ -56,6 +57,7 @@
 #include <QtGui/QBitmap>
 #include <QtGui/QPolygon>
 #include <QtCore/QTime>
+#include <QtCore/QtConcurrentRun>
 #include <QtGui/QComboBox>
 #include <QtGui/QFileDialog>
 #include <QtGui/QMessageBox>
@@ -72,6 +74,9 @@
 #define CANVAS_COVERAGE_MIN_LIMITHIGH 0.5
 #define CANVAS_COVERAGE_MIN_LIMITLOW 0.1
 
+// peak maps with at least this number of peaks get an intensity pyramid for fast zoomed-out painting
+#define INTENSITY_PYRAMID_MIN_PEAKS 2000000
+
 
 using namespace std;
 
@@ -79,6 +84,15 @@ namespace OpenMS
 {
   using namespace Internal;
 
+  namespace
+  {
+    // runs in a worker thread; the shared pointers keep data and pyramid alive even if the layer is closed meanwhile
+    void buildIntensityPyramid(boost::shared_ptr<const IntensityPyramid::ExperimentType> exp, boost::shared_ptr<IntensityPyramid> pyramid)
+    {
+      pyramid->build(*exp);
+    }
+  }
+
   Spectrum2DCanvas::Spectrum2DCanvas(const Param & preferences, QWidget * parent) :
     SpectrumCanvas(preferences, parent),
     projection_mz_(),
@@ -654,6 +668,40 @@ namespace OpenMS
     double rt_step_size = (rt_max - rt_min) / rt_pixel_count;
     double mz_step_size = (mz_max - mz_min) / mz_pixel_count;
 
+    // use the precomputed maxima if available and not finer than needed (filters can only be applied to raw peaks)
+    const IntensityPyramid * pyramid = layer.intensity_pyramid.get();
+    if (pyramid != 0 && layer.filters.size() == 0 && pyramid->isReady())
+    {
+      Size level = pyramid->findLevel(rt_step_size, mz_step_size);
+      if (level < pyramid->getLevelCount())
+      {
+        for (Size rt = 0; rt < rt_pixel_count; ++rt)
+        {
+          double rt_start = rt_min + rt_step_size * rt;
+          double rt_end = rt_start + rt_step_size;
+
+          // reached the end of data
+          if (rt_end >= (--map.end())->getRT()) break;
+
+          for (Size mz = 0; mz < mz_pixel_count; ++mz)
+          {
+            double mz_start = mz_min + mz_step_size * mz;
+            float max = pyramid->getMaxIntensity(level, rt_start, rt_end, mz_start, mz_start + mz_step_size);
+            if (max >= 0.0)
+            {
+              QPoint pos;
+              dataToWidget_(mz_start + 0.5 * mz_step_size, rt_start + 0.5 * rt_step_size, pos);
+              if (pos.y() < image_height && pos.x() < image_width)
+              {
+                buffer_.setPixel(pos.x(), pos.y(), heightColor_(max, layer.gradient, snap_factor).rgb());
+              }
+            }
+          }
+        }
+        return;
+      }
+    }
+
     // start at first visible RT scan
     Size scan_index = std::distance(map.begin(), map.RTBegin(rt_min));
     //iterate over all pixels (RT dimension)
@@ -1218,6 +1266,27 @@ namespace OpenMS
     showProjectionInfo(peak_count, intensity_sum, intensity_max);
   }
 
+  void Spectrum2DCanvas::startIntensityPyramid_(Size layer_index)
+  {
+    LayerData & layer = getLayer_(layer_index);
+    if (layer.intensity_pyramid)
+    {
+      layer.intensity_pyramid->cancel();
+      layer.intensity_pyramid.reset();
+    }
+    if (layer.type != LayerData::DT_PEAK || layer.getPeakData()->getSize() < INTENSITY_PYRAMID_MIN_PEAKS)
+    {
+      return;
+    }
+
+    // The worker reads the layer data itself (it skips everything but MS1).
+    // Code that modifies the peaks in place cancels the pyramid first and
+    // restarts it afterwards via updateLayer().
+    boost::shared_ptr<const IntensityPyramid::ExperimentType> exp(layer.getPeakData());
+    layer.intensity_pyramid.reset(new IntensityPyramid());
+    QtConcurrent::run(buildIntensityPyramid, exp, layer.intensity_pyramid);
+  }
+
   bool Spectrum2DCanvas::finishAdding_()
   {
     // unselect all peaks
@@ -1244,6 +1313,7 @@ namespace OpenMS
       {
         setLayerFlag(LayerData::P_PRECURSORS, true); // show precursors if no MS1 data is contained
       }
+      startIntensityPyramid_(current_layer_);
     }
     else if (layers_.back().type == LayerData::DT_FEATURE)  //feature data
     {
@@ -2818,6 +2888,9 @@ namespace OpenMS
 
   void Spectrum2DCanvas::updateLayer(Size i)
   {
+    //the data might have changed
+    startIntensityPyramid_(i);
+
     //update nearest peak
     selected_peak_.clear();
     recalculateRanges_(0, 1, 2);
@@ -0,0 +1,274 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2016.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Johannes Veit $
+// $Authors: Chris Bielow $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/VISUAL/TOPPASResultCache.h>
+
+#include <OpenMS/CONCEPT/LogStream.h>
+#include <OpenMS/FORMAT/FileHandler.h>
+#include <OpenMS/SYSTEM/File.h>
+
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+
+#include <algorithm>
+#include <vector>
+
+namespace OpenMS
+{
+  TOPPASResultCache::TOPPASResultCache(const QString& cache_dir, Size max_size) :
+    cache_dir_(cache_dir),
+    max_size_(max_size)
+  {
+  }
+
+  TOPPASResultCache::~TOPPASResultCache()
+  {
+  }
+
+  const QString& TOPPASResultCache::getCacheDir() const
+  {
+    return cache_dir_;
+  }
+
+  Size TOPPASResultCache::getMaxSize() const
+  {
+    return max_size_;
+  }
+
+  String TOPPASResultCache::computeKey(const String& tool, const Param& param, const FileMap& input_files, const FileMap& output_files) const
+  {
+    QCryptographicHash crypto(QCryptographicHash::Sha1);
+
+    String entry = tool + "\n";
+    crypto.addData(entry.c_str(), (int) entry.size());
+
+    // the parameters; files given by parameters (e.g. databases) enter by content
+    for (Param::ParamIterator it = param.begin(); it != param.end(); ++it)
+    {
+      entry = it.getName() + "=" + it->value.toString();
+      if (it->tags.count("input file") > 0)
+      {
+        StringList files;
+        if (it->value.valueType() == DataValue::STRING_LIST)
+        {
+          files = it->value;
+        }
+        else
+        {
+          files.push_back(it->value.toString());
+        }
+        for (Size i = 0; i < files.size(); ++i)
+        {
+          if (!files[i].empty() && File::readable(files[i]))
+          {
+            entry += " " + FileHandler::computeFileHash(files[i]);
+          }
+        }
+      }
+      entry += "\n";
+      crypto.addData(entry.c_str(), (int) entry.size());
+    }
+
+    // the input files (by content)
+    for (FileMap::const_iterator it = input_files.begin(); it != input_files.end(); ++it)
+    {
+      entry = String("in ") + it->first + ":";
+      for (int i = 0; i < it->second.size(); ++i)
+      {
+        entry += " " + FileHandler::computeFileHash(it->second[i]);
+      }
+      entry += "\n";
+      crypto.addData(entry.c_str(), (int) entry.size());
+    }
+
+    // the output files (the directory is the same in each run)
+    for (FileMap::const_iterator it = output_files.begin(); it != output_files.end(); ++it)
+    {
+      entry = String("out ") + it->first + ":";
+      for (int i = 0; i < it->second.size(); ++i)
+      {
+        entry += " " + String(QFileInfo(it->second[i]).fileName());
+      }
+      entry += "\n";
+      crypto.addData(entry.c_str(), (int) entry.size());
+    }
+
+    return String((QString)crypto.result().toHex());
+  }
+
+  bool TOPPASResultCache::restore(const String& key, const FileMap& output_files) const
+  {
+    QDir entry_dir(cache_dir_ + QDir::separator() + key.toQString());
+    if (!entry_dir.exists("complete")) // entries are only complete once all files were copied
+    {
+      return false;
+    }
+
+    for (FileMap::const_iterator it = output_files.begin(); it != output_files.end(); ++it)
+    {
+      for (int i = 0; i < it->second.size(); ++i)
+      {
+        QString cached_file = cachedFile_(entry_dir.path(), it->first, i);
+        if (QFile::exists(it->second[i]))
+        {
+          QFile::remove(it->second[i]);
+        }
+        if (!QFile::copy(cached_file, it->second[i]))
+        {
+          LOG_WARN << "Could not copy cached result '" << String(cached_file) << "' to '" << String(it->second[i]) << "'.\n";
+          return false;
+        }
+      }
+    }
+    markUsed_(entry_dir); // only affects the order of eviction
+    return true;
+  }
+
+  bool TOPPASResultCache::store(const String& key, const FileMap& output_files) const
+  {
+    QDir entry_dir(cache_dir_ + QDir::separator() + key.toQString());
+    if (!entry_dir.mkpath("."))
+    {
+      LOG_WARN << "Could not create the cache directory '" << String(entry_dir.absolutePath()) << "'.\n";
+      return false;
+    }
+    // an existing entry is incomplete while it is overwritten
+    if (entry_dir.exists("complete"))
+    {
+      entry_dir.remove("complete");
+    }
+
+    for (FileMap::const_iterator it = output_files.begin(); it != output_files.end(); ++it)
+    {
+      for (int i = 0; i < it->second.size(); ++i)
+      {
+        QString cached_file = cachedFile_(entry_dir.path(), it->first, i);
+        if (QFile::exists(cached_file))
+        {
+          QFile::remove(cached_file);
+        }
+        if (!QFile::copy(it->second[i], cached_file))
+        {
+          LOG_WARN << "Could not copy '" << String(it->second[i]) << "' to the cache directory '" << String(entry_dir.absolutePath()) << "'.\n";
+          return false;
+        }
+      }
+    }
+
+    if (!markUsed_(entry_dir))
+    {
+      LOG_WARN << "Could not complete the cache entry '" << String(entry_dir.absolutePath()) << "'.\n";
+      return false;
+    }
+    evict_(key);
+    return true;
+  }
+
+  QString TOPPASResultCache::cachedFile_(const QString& entry_dir, Int param, int index) const
+  {
+    return QDir(entry_dir).filePath(QString::number(param) + "_" + QString::number(index));
+  }
+
+  bool TOPPASResultCache::markUsed_(const QDir& entry_dir) const
+  {
+    // the marker of a complete entry holds the time of its last use (in ms)
+    QFile complete(entry_dir.filePath("complete"));
+    if (!complete.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+      return false;
+    }
+    complete.write(QByteArray::number(QDateTime::currentMSecsSinceEpoch()));
+    complete.close();
+    return true;
+  }
+
+  void TOPPASResultCache::evict_(const String& keep) const
+  {
+    if (max_size_ == 0)
+    {
+      return;
+    }
+
+    // complete entries by time of last use (and name), with their size
+    std::vector<std::pair<std::pair<qint64, QString>, qint64> > entries;
+    qint64 total_size = 0;
+    QDir cache_dir(cache_dir_);
+    QStringList names = cache_dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (int i = 0; i < names.size(); ++i)
+    {
+      QDir entry_dir(cache_dir.filePath(names[i]));
+      QFile complete(entry_dir.filePath("complete"));
+      if (!complete.open(QIODevice::ReadOnly)) // incomplete entries may still be written
+      {
+        continue;
+      }
+      qint64 last_use = complete.readAll().trimmed().toLongLong(); // 0 (i.e. oldest) if unknown
+      complete.close();
+
+      qint64 size = 0; // size of the cached files (the marker is negligible)
+      QFileInfoList files = entry_dir.entryInfoList(QDir::Files);
+      for (int j = 0; j < files.size(); ++j)
+      {
+        if (files[j].fileName() != "complete")
+        {
+          size += files[j].size();
+        }
+      }
+      total_size += size;
+      entries.push_back(std::make_pair(std::make_pair(last_use, names[i]), size));
+    }
+    std::sort(entries.begin(), entries.end());
+
+    // remove the least recently used entries first
+    for (Size i = 0; i < entries.size() && total_size > (qint64) max_size_; ++i)
+    {
+      String name(entries[i].first.second);
+      if (name == keep)
+      {
+        continue;
+      }
+      // removing the marker first makes sure that a partially removed entry is never used
+      cache_dir.remove(entries[i].first.second + QDir::separator() + "complete");
+      if (!File::removeDirRecursively(String(cache_dir.filePath(entries[i].first.second))))
+      {
+        LOG_WARN << "Could not remove the cache entry '" << name << "'.\n";
+      }
+      total_size -= entries[i].second;
+    }
+  }
+
+}
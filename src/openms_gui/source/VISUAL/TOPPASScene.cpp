@@ -87,6 +87,8 @@ namespace OpenMS
     dry_run_(true),
     threads_active_(0),
     allowed_threads_(1),
+    cache_dir_(),
+    cache_max_size_(0),
     resume_source_(0)
   {
     /*	ATTENTION!
@@ -2347,6 +2349,26 @@ namespace OpenMS
     allowed_threads_ = num_jobs;
   }
 
+  void TOPPASScene::setCacheDir(const QString& dir)
+  {
+    cache_dir_ = dir;
+  }
+
+  const QString& TOPPASScene::getCacheDir() const
+  {
+    return cache_dir_;
+  }
+
+  void TOPPASScene::setCacheMaxSize(Size max_size)
+  {
+    cache_max_size_ = max_size;
+  }
+
+  Size TOPPASScene::getCacheMaxSize() const
+  {
+    return cache_max_size_;
+  }
+
   bool TOPPASScene::isGUIMode() const
   {
     return gui_;
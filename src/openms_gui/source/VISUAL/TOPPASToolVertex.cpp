@@ -37,8 +37,10 @@
 #include <OpenMS/FORMAT/FileHandler.h>
 #include <OpenMS/FORMAT/ParamXMLFile.h>
 #include <OpenMS/SYSTEM/File.h>
+#include <OpenMS/CONCEPT/VersionInfo.h>
 #include <OpenMS/VISUAL/TOPPASInputFileListVertex.h>
 #include <OpenMS/VISUAL/TOPPASOutputFileListVertex.h>
+#include <OpenMS/VISUAL/TOPPASResultCache.h>
 #include <OpenMS/VISUAL/TOPPASScene.h>
 #include <OpenMS/VISUAL/DIALOGS/TOPPASToolConfigDialog.h>
 #include <OpenMS/VISUAL/MISC/GUIHelpers.h>
@@ -48,6 +50,7 @@
 #include <QtCore/QFile>
 #include <QtCore/QFileInfo>
 #include <QtCore/QDir>
+#include <QtCore/QDateTime>
 #include <QtCore/QRegExp>
 
 #include <QSvgRenderer>
@@ -578,6 +581,8 @@ namespace OpenMS
     /// update round status
     round_total_ = (int) pkg.size(); // take number of rounds from previous tool(s) - should all be equal
     round_counter_ = 0; // once round_counter_ reaches round_total_, we are done
+    cache_keys_.assign(round_total_, String());
+    cache_hits_.assign(round_total_, false);
 
     QStringList shared_args;
     if (type_ != "")
@@ -701,9 +706,20 @@ namespace OpenMS
       writeParam_(param_tmp, ini_file_iteration);
       args << "-ini" << ini_file_iteration;
 
+      // unchanged rounds of a previous run are taken from the result cache (if enabled) instead of running the tool
+      if (!ts->isDryRun() && !ts->getCacheDir().isEmpty())
+      {
+        cache_keys_[round] = getCacheKey_(pkg[round], round);
+        cache_hits_[round] = restoreFromCache_(round);
+        if (cache_hits_[round])
+        {
+          ts->logTOPPOutput((String("\nUsing cached results for '") + name_ + "' (round " + (round + 1) + "/" + round_total_ + ")\n").toQString());
+        }
+      }
+
       // create process
       QProcess* p;
-      if (!ts->isDryRun())
+      if (!ts->isDryRun() && !cache_hits_[round])
       {
         p = new QProcess();
       }
@@ -777,6 +793,7 @@ namespace OpenMS
         }
         if (!ts->isDryRun())
         {
+          storeInCache_();
           renameOutput_(); // rename generated files by content
           emit toolFinished();
         }
@@ -870,6 +887,59 @@ namespace OpenMS
     return true;
   }
 
+  String TOPPASToolVertex::getCacheKey_(const RoundPackage& input_files, int round) const
+  {
+    // the tool (a new version or a rebuilt executable invalidates the cache)
+    String tool = name_ + "\n" + type_ + "\n" + VersionInfo::getVersion();
+    try
+    {
+      tool += "\n" + String(QFileInfo(File::findExecutable(name_).toQString()).lastModified().toString(Qt::ISODate));
+    }
+    catch (Exception::FileNotFound&)
+    {
+      // the tool will fail to start anyway
+    }
+
+    TOPPASResultCache::FileMap in_files;
+    for (RoundPackageConstIt it = input_files.begin(); it != input_files.end(); ++it)
+    {
+      in_files[it->second.edge->getTargetInParam()] = it->second.filenames.get();
+    }
+
+    return TOPPASResultCache(getScene_()->getCacheDir()).computeKey(tool, param_, in_files, getOutputFileMap_(round));
+  }
+
+  bool TOPPASToolVertex::restoreFromCache_(int round) const
+  {
+    return TOPPASResultCache(getScene_()->getCacheDir()).restore(cache_keys_[round], getOutputFileMap_(round));
+  }
+
+  void TOPPASToolVertex::storeInCache_() const
+  {
+    TOPPASResultCache cache(getScene_()->getCacheDir(), getScene_()->getCacheMaxSize());
+    for (Size round = 0; round < cache_keys_.size(); ++round)
+    {
+      if (cache_hits_[round] || cache_keys_[round].empty())
+      {
+        continue;
+      }
+      if (!cache.store(cache_keys_[round], getOutputFileMap_((int) round)))
+      {
+        LOG_WARN << "Could not store the results of '" << name_ << "' in the cache directory '" << String(cache.getCacheDir()) << "'.\n";
+      }
+    }
+  }
+
+  TOPPASResultCache::FileMap TOPPASToolVertex::getOutputFileMap_(int round) const
+  {
+    TOPPASResultCache::FileMap files;
+    for (RoundPackageConstIt it = output_files_[round].begin(); it != output_files_[round].end(); ++it)
+    {
+      files[it->first] = it->second.filenames.get();
+    }
+    return files;
+  }
+
   const Param& TOPPASToolVertex::getParam()
   {
     return param_;
@@ -12,6 +12,7 @@ EnhancedTabBarWidgetInterface.cpp
 EnhancedWorkspace.cpp
 GUIProgressLoggerImpl.cpp
 HistogramWidget.cpp
+IntensityPyramid.cpp
 LayerData.cpp
 ListEditor.cpp
 MetaDataBrowser.cpp
@@ -36,6 +37,7 @@ TOPPASMergerVertex.cpp
 TOPPASOutputFileListVertex.cpp
 TOPPASResource.cpp
 TOPPASResources.cpp
+TOPPASResultCache.cpp
 TOPPASScene.cpp
 TOPPASSplitterVertex.cpp
 TOPPASTabBar.cpp
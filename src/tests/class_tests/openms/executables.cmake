@@ -169,6 +169,7 @@ set(format_executables_list
   GzipInputStream_test
   IBSpectraFile_test
   IdXMLFile_test
+  IndexedFASTAFile_test
   IndexedMzMLDecoder_test
   IndexedMzMLFile_test
   IndexedMzMLFileLoader_test
@@ -367,6 +368,7 @@ set(chemistry_executables_list
   CrossLinksDB_test
   ModifierRep_test
   PepIterator_test
+  PeptideCatalogue_test
   ResidueDB_test
   ResidueModification_test
   Residue_test
@@ -483,6 +485,7 @@ set(analysis_executables_list
   SVMWrapper_test
   SimplePairFinder_test
   SimpleSVM_test
+  SpectralLibraryIndex_test
   StablePairFinder_test
   #TargetedExperimentHelper_test
   TransformationDescription_test
@@ -599,6 +602,8 @@ if(NOT DISABLE_OPENSWATH)
     DIAPrescoring_test
     OpenSwathMRMFeatureAccessOpenMS_test
     SpectrumAddition_test
+    AddedSpectraCache_test
+    SwathMapPrefetcher_test
     OpenSwathSpectrumAccessOpenMS_test
     OpenSwathDataAccessHelper_test
     MRMFeatureScoring_test
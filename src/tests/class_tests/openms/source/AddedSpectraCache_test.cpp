@@ -0,0 +1,198 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2016.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/ANALYSIS/OPENSWATH/AddedSpectraCache.h>
+///////////////////////////
+
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessOpenMS.h>
+
+using namespace OpenMS;
+using namespace std;
+
+namespace
+{
+  OpenSwath::SpectrumPtr createSpectrum(Size nr_points)
+  {
+    OpenSwath::SpectrumPtr spectrum(new OpenSwath::Spectrum());
+    for (Size i = 0; i < nr_points; ++i)
+    {
+      spectrum->getMZArray()->data.push_back(100.0 + i);
+      spectrum->getIntensityArray()->data.push_back(1.0);
+    }
+    return spectrum;
+  }
+}
+
+START_TEST(AddedSpectraCache, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+AddedSpectraCache* ptr = 0;
+AddedSpectraCache* nullPointer = 0;
+
+START_SECTION(AddedSpectraCache(Size max_points = 10000000))
+{
+  ptr = new AddedSpectraCache();
+  TEST_NOT_EQUAL(ptr, nullPointer)
+  TEST_EQUAL(ptr->getMaxPoints(), 10000000)
+}
+END_SECTION
+
+START_SECTION(~AddedSpectraCache())
+{
+  delete ptr;
+}
+END_SECTION
+
+boost::shared_ptr<MSExperiment<> > exp(new MSExperiment<>);
+OpenSwath::SpectrumAccessPtr map1(new SpectrumAccessOpenMS(exp));
+OpenSwath::SpectrumAccessPtr map2(new SpectrumAccessOpenMS(exp));
+
+START_SECTION((bool lookup(const OpenSwath::SpectrumAccessPtr& swath_map, int scan_index, int nr_spectra_to_add, double spacing, const std::string& addition_method, OpenSwath::SpectrumPtr& spectrum)))
+{
+  AddedSpectraCache cache(100);
+  OpenSwath::SpectrumPtr spectrum = createSpectrum(10);
+  OpenSwath::SpectrumPtr result;
+
+  TEST_EQUAL(cache.lookup(map1, 5, 3, 0.005, "resample", result), false)
+  cache.insert(map1, 5, 3, 0.005, "resample", spectrum);
+  TEST_EQUAL(cache.lookup(map1, 5, 3, 0.005, "resample", result), true)
+  TEST_EQUAL(result == spectrum, true)
+
+  // all parts of the key need to match
+  TEST_EQUAL(cache.lookup(map2, 5, 3, 0.005, "resample", result), false)
+  TEST_EQUAL(cache.lookup(map1, 6, 3, 0.005, "resample", result), false)
+  TEST_EQUAL(cache.lookup(map1, 5, 5, 0.005, "resample", result), false)
+  TEST_EQUAL(cache.lookup(map1, 5, 3, 0.01, "resample", result), false)
+  TEST_EQUAL(cache.lookup(map1, 5, 3, 0.005, "merge", result), false)
+
+  TEST_EQUAL(cache.getHits(), 1)
+  TEST_EQUAL(cache.getMisses(), 6)
+
+  // entries of destroyed maps are never returned
+  OpenSwath::SpectrumAccessPtr map3(new SpectrumAccessOpenMS(exp));
+  cache.insert(map3, 1, 3, 0.005, "resample", spectrum);
+  TEST_EQUAL(cache.size(), 2)
+  boost::weak_ptr<OpenSwath::ISpectrumAccess> map3_ref(map3);
+  map3.reset();
+  TEST_EQUAL(map3_ref.expired(), true)
+  OpenSwath::SpectrumAccessPtr map4(new SpectrumAccessOpenMS(exp));
+  TEST_EQUAL(cache.lookup(map4, 1, 3, 0.005, "resample", result), false)
+}
+END_SECTION
+
+START_SECTION((void insert(const OpenSwath::SpectrumAccessPtr& swath_map, int scan_index, int nr_spectra_to_add, double spacing, const std::string& addition_method, const OpenSwath::SpectrumPtr& spectrum)))
+{
+  AddedSpectraCache cache(25);
+  OpenSwath::SpectrumPtr result;
+
+  cache.insert(map1, 1, 3, 0.005, "resample", createSpectrum(10));
+  cache.insert(map1, 2, 3, 0.005, "resample", createSpectrum(10));
+  TEST_EQUAL(cache.size(), 2)
+  TEST_EQUAL(cache.getNrPoints(), 20)
+
+  // use spectrum 1, spectrum 2 is now least recently used and gets evicted
+  TEST_EQUAL(cache.lookup(map1, 1, 3, 0.005, "resample", result), true)
+  cache.insert(map1, 3, 3, 0.005, "resample", createSpectrum(10));
+  TEST_EQUAL(cache.size(), 2)
+  TEST_EQUAL(cache.getNrPoints(), 20)
+  TEST_EQUAL(cache.lookup(map1, 1, 3, 0.005, "resample", result), true)
+  TEST_EQUAL(cache.lookup(map1, 2, 3, 0.005, "resample", result), false)
+  TEST_EQUAL(cache.lookup(map1, 3, 3, 0.005, "resample", result), true)
+
+  // re-inserting replaces the entry
+  cache.insert(map1, 3, 3, 0.005, "resample", createSpectrum(5));
+  TEST_EQUAL(cache.size(), 2)
+  TEST_EQUAL(cache.getNrPoints(), 15)
+
+  // spectra larger than the cache are not stored
+  cache.insert(map1, 4, 3, 0.005, "resample", createSpectrum(30));
+  TEST_EQUAL(cache.size(), 2)
+  TEST_EQUAL(cache.lookup(map1, 4, 3, 0.005, "resample", result), false)
+}
+END_SECTION
+
+START_SECTION(void clear())
+{
+  AddedSpectraCache cache(100);
+  OpenSwath::SpectrumPtr result;
+  cache.insert(map1, 1, 3, 0.005, "resample", createSpectrum(10));
+  TEST_EQUAL(cache.lookup(map1, 1, 3, 0.005, "resample", result), true)
+  cache.clear();
+  TEST_EQUAL(cache.size(), 0)
+  TEST_EQUAL(cache.getNrPoints(), 0)
+  TEST_EQUAL(cache.getHits(), 0)
+  TEST_EQUAL(cache.getMisses(), 0)
+}
+END_SECTION
+
+START_SECTION(Size getHits() const)
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION(Size getMisses() const)
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION(Size size() const)
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION(Size getNrPoints() const)
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION(Size getMaxPoints() const)
+{
+  AddedSpectraCache cache(42);
+  TEST_EQUAL(cache.getMaxPoints(), 42)
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -84,6 +84,34 @@ START_SECTION((template <typename InputPeakIterator> void transform(InputPeakIte
   TEST_REAL_SIMILAR(transformer.getSpacing(),spacing)
 END_SECTION
 
+START_SECTION((template <typename InputPeakIterator> void update(InputPeakIterator begin_input, InputPeakIterator end_input, InputPeakIterator begin_changed, InputPeakIterator end_changed)))
+  ContinuousWaveletTransformNumIntegration transformer, reference;
+  transformer.init(0.5, 0.1);
+  reference.init(0.5, 0.1);
+  std::vector<Peak1D> raw_data(60);
+  for (Size i = 0; i < raw_data.size(); ++i)
+  {
+    raw_data[i].setMZ(100.0 + i * 0.1);
+    Int offset = (Int)(i % 20) - 10;
+    raw_data[i].setIntensity(abs(offset) <= 2 ? 10.0 - offset * offset : 0.0);
+  }
+  transformer.transform(raw_data.begin(), raw_data.end(), 1.);
+
+  // remove the middle peak and update only the affected region
+  for (Size i = 28; i <= 32; ++i)
+  {
+    raw_data[i].setIntensity(0.0);
+  }
+  transformer.update(raw_data.begin(), raw_data.end(), raw_data.begin() + 28, raw_data.begin() + 33);
+  reference.transform(raw_data.begin(), raw_data.end(), 1.);
+
+  TEST_EQUAL(transformer.getSize(), reference.getSize())
+  for (Size i = 0; i < (Size)reference.getSize(); ++i)
+  {
+    TEST_REAL_SIMILAR(transformer[i], reference[i])
+  }
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 END_TEST
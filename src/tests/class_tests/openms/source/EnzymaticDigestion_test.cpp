@@ -429,6 +429,31 @@ START_SECTION((bool digestUnmodifiedString(const StringView sequence, std::vecto
 
 END_SECTION
 
+START_SECTION((void digestUnmodifiedString(const StringView sequence, std::vector<std::pair<Size, Size> >& output, Size min_length = 1, Size max_length = 0) const))
+    EnzymaticDigestion ed;
+    vector<pair<Size, Size> > out;
+
+    std::string s = "ARCRDRE";
+    ed.digestUnmodifiedString(s, out);
+    TEST_EQUAL(out.size(), 4)
+    TEST_EQUAL(out[0].first, 0)
+    TEST_EQUAL(out[0].second, 2)
+    TEST_EQUAL(out[3].first, 6)
+    TEST_EQUAL(out[3].second, 1)
+
+    // same peptides (and order) as the StringView variant
+    ed.setMissedCleavages(2);
+    s = "ACKDEKPLRRKGH";
+    vector<StringView> views;
+    ed.digestUnmodifiedString(s, views, 2, 8);
+    ed.digestUnmodifiedString(s, out, 2, 8);
+    TEST_EQUAL(out.size(), views.size())
+    for (Size i = 0; i < out.size(); ++i)
+    {
+      TEST_EQUAL(s.substr(out[i].first, out[i].second), views[i].getString())
+    }
+END_SECTION
+
 START_SECTION((bool isValidProduct(const AASequence &protein, Size pep_pos, Size pep_length, bool methionine_cleavage)))
     EnzymaticDigestion ed;
     ed.setEnzyme("Trypsin");
@@ -37,6 +37,7 @@
 
 ///////////////////////////
 
+#include <sstream>
 #include <string>
 
 #include <OpenMS/FORMAT/FASTAFile.h>
@@ -182,6 +183,13 @@ START_SECTION((void store(const String& filename, const std::vector< FASTAEntry
   TEST_EQUAL(data==data2,true);
 END_SECTION
 
+START_SECTION((static void writeEntry(std::ostream& os, const FASTAEntry& entry)))
+  FASTAFile::FASTAEntry entry("P1", "description", String(100, 'A'));
+  stringstream ss;
+  FASTAFile::writeEntry(ss, entry);
+  TEST_EQUAL(ss.str(), ">P1 description\n" + String(80, 'A') + "\n" + String(20, 'A') + "\n")
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 END_TEST
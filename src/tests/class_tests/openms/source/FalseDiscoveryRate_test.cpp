@@ -235,6 +235,48 @@ START_SECTION((void apply(std::vector<ProteinIdentification>& ids)))
 }
 END_SECTION
 
+START_SECTION((void calculateFDRs(const std::vector<double> &target_scores, const std::vector<double> &decoy_scores, std::vector<double> &target_fdrs, std::vector<double> &decoy_fdrs, bool q_value, bool higher_score_better) const))
+{
+  double t[] = {7.0, 10.0, 8.0, 9.0};
+  double d[] = {8.5, 6.0};
+  vector<double> target_scores(t, t + 4), decoy_scores(d, d + 2), target_fdrs, decoy_fdrs;
+
+  ptr->calculateFDRs(target_scores, decoy_scores, target_fdrs, decoy_fdrs, true, true);
+  TEST_EQUAL(target_fdrs.size(), 4)
+  TEST_EQUAL(decoy_fdrs.size(), 2)
+  TEST_REAL_SIMILAR(target_fdrs[0], 0.25)
+  TEST_REAL_SIMILAR(target_fdrs[1], 0.0)
+  TEST_REAL_SIMILAR(target_fdrs[2], 0.25)
+  TEST_REAL_SIMILAR(target_fdrs[3], 0.0)
+  // equidistant decoy gets the value of the worse target
+  TEST_REAL_SIMILAR(decoy_fdrs[0], 0.25)
+  TEST_REAL_SIMILAR(decoy_fdrs[1], 0.25)
+
+  ptr->calculateFDRs(target_scores, decoy_scores, target_fdrs, decoy_fdrs, false, true);
+  TEST_REAL_SIMILAR(target_fdrs[0], 0.25)
+  TEST_REAL_SIMILAR(target_fdrs[1], 0.0)
+  TEST_REAL_SIMILAR(target_fdrs[2], 1.0 / 3.0)
+  TEST_REAL_SIMILAR(target_fdrs[3], 0.0)
+  TEST_REAL_SIMILAR(decoy_fdrs[0], 0.0)
+  TEST_REAL_SIMILAR(decoy_fdrs[1], 0.25)
+
+  // same with inverted scores
+  for (Size i = 0; i < target_scores.size(); ++i) target_scores[i] = -target_scores[i];
+  for (Size i = 0; i < decoy_scores.size(); ++i) decoy_scores[i] = -decoy_scores[i];
+  ptr->calculateFDRs(target_scores, decoy_scores, target_fdrs, decoy_fdrs, true, false);
+  TEST_REAL_SIMILAR(target_fdrs[0], 0.25)
+  TEST_REAL_SIMILAR(target_fdrs[1], 0.0)
+  TEST_REAL_SIMILAR(target_fdrs[2], 0.25)
+  TEST_REAL_SIMILAR(target_fdrs[3], 0.0)
+  TEST_REAL_SIMILAR(decoy_fdrs[0], 0.25)
+
+  // no targets
+  ptr->calculateFDRs(vector<double>(), decoy_scores, target_fdrs, decoy_fdrs, true, false);
+  TEST_EQUAL(target_fdrs.empty(), true)
+  TEST_REAL_SIMILAR(decoy_fdrs[0], 0.0)
+}
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 END_TEST
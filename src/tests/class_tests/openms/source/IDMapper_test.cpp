@@ -405,6 +405,54 @@ START_SECTION((template < typename FeatureType > void annotate(FeatureMap< Featu
 END_SECTION
 
 
+START_SECTION([EXTRA] void annotate(FeatureMap& map, ...) with unidentified precursors)
+{
+  // two features without convex hulls -> centroids are used for matching
+  FeatureMap fm;
+  Feature f;
+  f.setRT(100.0);
+  f.setMZ(500.0);
+  f.setCharge(2);
+  fm.push_back(f);
+  f.setRT(200.0);
+  f.setMZ(600.0);
+  fm.push_back(f);
+
+  // three MS2 spectra: matching feature 0, matching nothing (m/z) and matching feature 1
+  MSExperiment<Peak1D> spectra;
+  double rts[] = {101.0, 150.0, 199.0};
+  double mzs[] = {500.001, 700.0, 600.001};
+  for (Size i = 0; i < 3; ++i)
+  {
+    MSSpectrum<Peak1D> spec;
+    spec.setMSLevel(2);
+    spec.setRT(rts[i]);
+    vector<Precursor> precursors(1);
+    precursors[0].setMZ(mzs[i]);
+    precursors[0].setCharge(2);
+    spec.setPrecursors(precursors);
+    spectra.addSpectrum(spec);
+  }
+
+  IDMapper mapper;
+  Param p = mapper.getParameters();
+  p.setValue("rt_tolerance", 5.0);
+  p.setValue("mz_tolerance", 0.01);
+  p.setValue("mz_measure", "Da");
+  mapper.setParameters(p);
+
+  vector<PeptideIdentification> ids;
+  vector<ProteinIdentification> protein_ids;
+  mapper.annotate(fm, ids, protein_ids, true, true, spectra);
+
+  TEST_EQUAL(fm[0].getPeptideIdentifications().size(), 1)
+  TEST_EQUAL(fm[0].getPeptideIdentifications()[0].getHits().size(), 0)
+  TEST_EQUAL(fm[0].getPeptideIdentifications()[0].getMetaValue("spectrum_index"), 0)
+  TEST_EQUAL(fm[1].getPeptideIdentifications().size(), 1)
+  TEST_EQUAL(fm[1].getPeptideIdentifications()[0].getMetaValue("spectrum_index"), 2)
+}
+END_SECTION
+
 START_SECTION((void annotate(ConsensusMap& map, const std::vector<PeptideIdentification>& ids, const std::vector<ProteinIdentification>& protein_ids, bool measure_from_subelements=false)))
 {
   IDMapper mapper;
@@ -67,7 +67,7 @@ START_SECTION(virtual ~ILPDCWrapper())
 END_SECTION
 
 
-START_SECTION((double compute(const FeatureMap fm, PairsType &pairs, Size verbose_level) const))
+START_SECTION((double compute(const FeatureMap &fm, PairsType &pairs, Size verbose_level) const))
 {
   EmpiricalFormula ef("H1");
   Adduct a(+1, 1, ef.getMonoWeight(), "H1", 0.1, 0, "");
@@ -83,8 +83,21 @@ START_SECTION((double compute(const FeatureMap fm, PairsType &pairs, Size verbos
   // check that it runs without pairs (i.e. all clusters are singletons)
   TEST_EQUAL(pairs.size(), 0);
 
-  // real data test
-
+  // two independent groups of edges; feature 0 can only have one charge
+  fm.resize(5);
+  pairs.push_back(ChargePair(0, 1, 1, 2, Compomer(1, 1.0, -0.1), 0.0, false));
+  pairs.push_back(ChargePair(3, 4, 1, 1, Compomer(0, 0.0, -0.5), 0.0, false));
+  pairs.push_back(ChargePair(0, 2, 2, 3, Compomer(1, 1.0, -1.0), 0.0, false));
+
+  double score = iw.compute(fm, pairs, 1);
+  TEST_REAL_SIMILAR(score, exp(-0.1) + exp(-0.5))
+  TEST_EQUAL(pairs.size(), 3)
+  for (Size i = 0; i < pairs.size(); ++i)
+  {
+    // pairs are reordered by the ILP
+    bool expected_active = (pairs[i].getElementIndex(1) != 2);
+    TEST_EQUAL(pairs[i].isActive(), expected_active)
+  }
 
 }
 END_SECTION
@@ -0,0 +1,197 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2016.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: Timo Sachsenberg $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/FORMAT/IndexedFASTAFile.h>
+///////////////////////////
+
+#include <OpenMS/SYSTEM/File.h>
+
+#include <fstream>
+
+using namespace OpenMS;
+using namespace std;
+
+START_TEST(IndexedFASTAFile, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+IndexedFASTAFile* ptr = 0;
+IndexedFASTAFile* null_ptr = 0;
+START_SECTION((IndexedFASTAFile()))
+  ptr = new IndexedFASTAFile();
+  TEST_NOT_EQUAL(ptr, null_ptr)
+  TEST_EQUAL(ptr->isOpen(), false)
+  TEST_EQUAL(ptr->size(), 0)
+END_SECTION
+
+START_SECTION((virtual ~IndexedFASTAFile()))
+  delete ptr;
+END_SECTION
+
+vector<FASTAFile::FASTAEntry> reference;
+FASTAFile().load(OPENMS_GET_TEST_DATA_PATH("FASTAFile_test.fasta"), reference);
+
+START_SECTION((void open(const String& filename, bool use_index_file = false)))
+  IndexedFASTAFile file;
+  TEST_EXCEPTION(Exception::FileNotFound, file.open("IndexedFASTAFile_test_this_file_does_not_exist"))
+
+  file.open(OPENMS_GET_TEST_DATA_PATH("FASTAFile_test.fasta"));
+  TEST_EQUAL(file.isOpen(), true)
+  TEST_EQUAL(file.size(), 5)
+
+  // text before the first record
+  String tmp_filename;
+  NEW_TMP_FILE(tmp_filename);
+  {
+    ofstream os(tmp_filename.c_str());
+    os << "no record\n>P1\nPEPTIDE\n";
+  }
+  TEST_EXCEPTION(Exception::ParseError, file.open(tmp_filename))
+  TEST_EQUAL(file.isOpen(), false)
+
+  // empty file
+  NEW_TMP_FILE(tmp_filename);
+  {
+    ofstream os(tmp_filename.c_str());
+  }
+  file.open(tmp_filename);
+  TEST_EQUAL(file.isOpen(), true)
+  TEST_EQUAL(file.size(), 0)
+
+  // Windows line endings, leading empty lines and '>' within the header
+  NEW_TMP_FILE(tmp_filename);
+  {
+    ofstream os(tmp_filename.c_str(), ios::binary);
+    os << "\r\n>P1 first>protein\r\nPEP\r\nTIDE\r\n>P2\r\n\r\nAAA";
+  }
+  file.open(tmp_filename);
+  TEST_EQUAL(file.size(), 2)
+  FASTAFile::FASTAEntry entry;
+  file.getEntry(0, entry);
+  TEST_EQUAL(entry.identifier, "P1")
+  TEST_EQUAL(entry.description, "first>protein")
+  TEST_EQUAL(entry.sequence, "PEPTIDE")
+  file.getEntry(1, entry);
+  TEST_EQUAL(entry.identifier, "P2")
+  TEST_EQUAL(entry.description, "")
+  TEST_EQUAL(entry.sequence, "AAA")
+END_SECTION
+
+START_SECTION((void close()))
+  IndexedFASTAFile file;
+  file.open(OPENMS_GET_TEST_DATA_PATH("FASTAFile_test.fasta"));
+  file.close();
+  TEST_EQUAL(file.isOpen(), false)
+  TEST_EQUAL(file.size(), 0)
+  TEST_EQUAL(file.getFilename(), "")
+END_SECTION
+
+START_SECTION((bool isOpen() const))
+  NOT_TESTABLE // tested above
+END_SECTION
+
+START_SECTION((const String& getFilename() const))
+  IndexedFASTAFile file;
+  file.open(OPENMS_GET_TEST_DATA_PATH("FASTAFile_test.fasta"));
+  TEST_EQUAL(file.getFilename(), OPENMS_GET_TEST_DATA_PATH("FASTAFile_test.fasta"))
+END_SECTION
+
+START_SECTION((Size size() const))
+  NOT_TESTABLE // tested above
+END_SECTION
+
+START_SECTION((EntryView getEntryView(Size index) const))
+  IndexedFASTAFile file;
+  file.open(OPENMS_GET_TEST_DATA_PATH("FASTAFile_test.fasta"));
+  IndexedFASTAFile::EntryView view = file.getEntryView(1);
+  TEST_EQUAL(String(string(view.header, view.header_length)), "Q9CQV8|1433B_MOUSE This is the description of the second protein")
+  TEST_EQUAL(String(string(view.sequence, 10)), "TMDKSELVQK")
+  TEST_EQUAL(view.sequence[view.sequence_length - 1], '\n')
+  TEST_EXCEPTION(Exception::IndexOverflow, file.getEntryView(5))
+END_SECTION
+
+START_SECTION((void getEntry(Size index, FASTAFile::FASTAEntry& entry) const))
+  IndexedFASTAFile file;
+  file.open(OPENMS_GET_TEST_DATA_PATH("FASTAFile_test.fasta"));
+  TEST_EQUAL(file.size(), reference.size())
+  for (Size i = 0; i < file.size(); ++i)
+  {
+    FASTAFile::FASTAEntry entry;
+    file.getEntry(i, entry);
+    TEST_EQUAL(entry == reference[i], true)
+  }
+  FASTAFile::FASTAEntry entry;
+  TEST_EXCEPTION(Exception::IndexOverflow, file.getEntry(5, entry))
+END_SECTION
+
+START_SECTION((void storeIndex(const String& index_filename) const))
+  String tmp_filename;
+  NEW_TMP_FILE(tmp_filename);
+  FASTAFile().store(tmp_filename, reference);
+  String index_filename = IndexedFASTAFile::getIndexFilename(tmp_filename);
+  TEST_EQUAL(File::exists(index_filename), false)
+
+  // the index file is written on first use ...
+  IndexedFASTAFile file;
+  file.open(tmp_filename, true);
+  TEST_EQUAL(File::exists(index_filename), true)
+  TEST_EQUAL(file.size(), 5)
+
+  // ... and read afterwards
+  IndexedFASTAFile file2;
+  file2.open(tmp_filename, true);
+  TEST_EQUAL(file2.size(), 5)
+  for (Size i = 0; i < file2.size(); ++i)
+  {
+    FASTAFile::FASTAEntry entry;
+    file2.getEntry(i, entry);
+    TEST_EQUAL(entry == reference[i], true)
+  }
+  File::remove(index_filename);
+
+  TEST_EXCEPTION(Exception::UnableToCreateFile, file.storeIndex("/bla/bluff/blblb/sdfhsdjf/test.fidx"))
+END_SECTION
+
+START_SECTION((static String getIndexFilename(const String& filename)))
+  TEST_EQUAL(IndexedFASTAFile::getIndexFilename("db.fasta"), "db.fasta.fidx")
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -572,6 +572,37 @@ START_SECTION(([EXTRA] purity computation without interpolation))
 }
 END_SECTION
 
+START_SECTION(([EXTRA] errors of the purity computation are passed on))
+{
+  MSExperiment<Peak1D> exp_purity;
+  MzMLFile().load(OPENMS_GET_TEST_DATA_PATH("IsobaricChannelExtractor_6.mzML"), exp_purity);
+
+  // the precursor purity cannot be computed from an empty precursor scan
+  for (Size i = 0; i < exp_purity.size(); ++i)
+  {
+    if (exp_purity[i].getMSLevel() == 1) exp_purity[i].clear(false);
+  }
+
+  IsobaricChannelExtractor ice(q_method);
+  Param p = ice.getParameters();
+  p.setValue("select_activation", "");
+  ice.setParameters(p);
+
+  // the error is rethrown as a copy of its BaseException part
+  ConsensusMap cm_out;
+  String error_name;
+  try
+  {
+    ice.extractChannels(exp_purity, cm_out);
+  }
+  catch (Exception::BaseException& e)
+  {
+    error_name = e.getName();
+  }
+  TEST_STRING_EQUAL(error_name, "Precondition failed")
+}
+END_SECTION
+
 // extra test for tmt10plex to ensure high-res extraction works
 START_SECTION(([EXTRA] TMT 10plex support))
 {
@@ -751,6 +782,52 @@ START_SECTION(([EXTRA] TMT 10plex support))
 }
 END_SECTION
 
+START_SECTION(([IsobaricChannelExtractor::ExtractionConsumer] void finish()))
+{
+  // streaming the data has to give the same results as the in-memory
+  // extraction, independent of the batch size
+  MSExperiment<Peak1D> exp_purity;
+  MzMLFile().load(OPENMS_GET_TEST_DATA_PATH("IsobaricChannelExtractor_6.mzML"), exp_purity);
+
+  IsobaricChannelExtractor ice(q_method);
+  Param p = ice.getParameters();
+  p.setValue("select_activation", "");
+  ice.setParameters(p);
+
+  ConsensusMap cm_expected;
+  ice.extractChannels(exp_purity, cm_expected);
+
+  for (Size batch_size = 1; batch_size <= 6; batch_size += 5)
+  {
+    ConsensusMap cm_out;
+    IsobaricChannelExtractor::ExtractionConsumer consumer(ice, cm_out, batch_size);
+    MzMLFile().transform(OPENMS_GET_TEST_DATA_PATH("IsobaricChannelExtractor_6.mzML"), &consumer);
+    consumer.finish();
+
+    TEST_EQUAL(cm_out.size(), 5)
+    ABORT_IF(cm_out.size() != 5)
+    TEST_EQUAL(cm_out.getFileDescriptions().size(), 4)
+
+    TEST_REAL_SIMILAR(cm_out[0].getMetaValue("precursor_purity"), 1.0)
+    TEST_REAL_SIMILAR(cm_out[1].getMetaValue("precursor_purity"), 0.692434)
+    TEST_REAL_SIMILAR(cm_out[2].getMetaValue("precursor_purity"), 0.824561)
+    TEST_REAL_SIMILAR(cm_out[3].getMetaValue("precursor_purity"), 0.731295)
+    TEST_REAL_SIMILAR(cm_out[4].getMetaValue("precursor_purity"), 1.0)
+
+    for (Size i = 0; i < cm_out.size(); ++i)
+    {
+      TEST_EQUAL(cm_out[i].getMetaValue("scan_id"), cm_expected[i].getMetaValue("scan_id"))
+      TEST_REAL_SIMILAR(cm_out[i].getIntensity(), cm_expected[i].getIntensity())
+    }
+  }
+
+  // no spectra at all
+  ConsensusMap cm_empty;
+  IsobaricChannelExtractor::ExtractionConsumer empty_consumer(ice, cm_empty);
+  TEST_EXCEPTION(Exception::MissingInformation, empty_consumer.finish())
+}
+END_SECTION
+
 delete q_method;
 
 /////////////////////////////////////////////////////////////
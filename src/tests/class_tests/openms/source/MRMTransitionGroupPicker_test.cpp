@@ -216,6 +216,84 @@ START_SECTION((template < typename SpectrumT, typename TransitionT > void pickTr
 }
 END_SECTION
 
+START_SECTION((template <typename SpectrumT, typename TransitionT> void pickTransitionGroups(std::vector<MRMTransitionGroup<SpectrumT, TransitionT>*>& transition_groups)))
+{
+  MRMTransitionGroupPicker trgroup_picker;
+
+  // reference: pick a single group
+  MRMTransitionGroupType reference;
+  setup_transition_group(reference);
+  trgroup_picker.pickTransitionGroup(reference);
+  TEST_EQUAL(reference.getFeatures().size(), 1)
+
+  // an empty batch is fine
+  std::vector<MRMTransitionGroupType*> batch;
+  trgroup_picker.pickTransitionGroups(batch);
+
+  // a batch of identical groups (and an empty one) gives the same result for each of them
+  std::vector<MRMTransitionGroupType> groups(20);
+  for (Size i = 0; i < groups.size(); ++i)
+  {
+    if (i != 7) setup_transition_group(groups[i]);
+    batch.push_back(&groups[i]);
+  }
+  trgroup_picker.pickTransitionGroups(batch);
+
+  for (Size i = 0; i < groups.size(); ++i)
+  {
+    if (i == 7)
+    {
+      TEST_EQUAL(groups[i].getFeatures().size(), 0)
+      continue;
+    }
+    TEST_EQUAL(groups[i].getFeatures().size(), reference.getFeatures().size())
+    ABORT_IF(groups[i].getFeatures().size() != 1)
+    MRMFeature mrmfeature = groups[i].getFeatures()[0];
+    TEST_REAL_SIMILAR(mrmfeature.getRT(), reference.getFeatures()[0].getRT())
+    TEST_REAL_SIMILAR(mrmfeature.getIntensity(), reference.getFeatures()[0].getIntensity())
+    TEST_REAL_SIMILAR(mrmfeature.getMetaValue("leftWidth"), reference.getFeatures()[0].getMetaValue("leftWidth"))
+    TEST_REAL_SIMILAR(mrmfeature.getMetaValue("rightWidth"), reference.getFeatures()[0].getMetaValue("rightWidth"))
+    TEST_REAL_SIMILAR(mrmfeature.getFeature("1").getIntensity(), 59989.8287208466)
+    TEST_REAL_SIMILAR(mrmfeature.getFeature("2").getIntensity(), 507385.32)
+  }
+
+  // "smoothed" background subtraction is not available, the error is passed
+  // on from within the parallel picking (as a copy of its BaseException part)
+  Param picker_param = trgroup_picker.getDefaults();
+  picker_param.setValue("background_subtraction", "smoothed");
+  trgroup_picker.setParameters(picker_param);
+  String error_name;
+  try
+  {
+    trgroup_picker.pickTransitionGroups(batch);
+  }
+  catch (Exception::BaseException& e)
+  {
+    error_name = e.getName();
+  }
+  TEST_STRING_EQUAL(error_name, "NotImplemented")
+
+#ifndef WITH_CRAWDAD
+  // an unavailable peak picker is reported before any group is picked
+  std::vector<MRMTransitionGroupType> unpicked_groups(3);
+  std::vector<MRMTransitionGroupType*> unpicked_batch;
+  for (Size i = 0; i < unpicked_groups.size(); ++i)
+  {
+    setup_transition_group(unpicked_groups[i]);
+    unpicked_batch.push_back(&unpicked_groups[i]);
+  }
+  picker_param = trgroup_picker.getDefaults();
+  picker_param.setValue("PeakPickerMRM:method", "crawdad");
+  trgroup_picker.setParameters(picker_param);
+  TEST_EXCEPTION(Exception::IllegalArgument, trgroup_picker.pickTransitionGroups(unpicked_batch))
+  for (Size i = 0; i < unpicked_groups.size(); ++i)
+  {
+    TEST_EQUAL(unpicked_groups[i].getFeatures().size(), 0)
+  }
+#endif
+}
+END_SECTION
+
 START_SECTION((template <typename SpectrumT, typename TransitionT> MRMFeature createMRMFeature(MRMTransitionGroup<SpectrumT, TransitionT>& transition_group, std::vector<SpectrumT>& picked_chroms, int& chr_idx, int& peak_idx)))
 {
   MRMTransitionGroupType transition_group;
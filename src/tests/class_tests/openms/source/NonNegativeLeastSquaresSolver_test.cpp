@@ -115,6 +115,47 @@ START_SECTION((static Int solve(const Matrix< double > &A, const Matrix< double
 END_SECTION
 
 
+START_SECTION(([EXTRA] concurrent solves give the same results as serial ones))
+{
+  // many small problems with different dimensions (as in MetaProSIP's decompositions)
+  const Size problem_count = 200;
+  std::vector<Matrix<double> > As(problem_count), bs(problem_count), serial_xs(problem_count), parallel_xs(problem_count);
+  for (Size p = 0; p < problem_count; ++p)
+  {
+    const Size rows = 5 + p % 7;
+    const Size cols = 2 + p % 4;
+    As[p] = Matrix<double>(rows, cols, 0.0);
+    bs[p] = Matrix<double>(rows, 1, 0.0);
+    for (Size i = 0; i < rows; ++i)
+    {
+      for (Size j = 0; j < cols; ++j)
+      {
+        As[p](i, j) = double((i * 7 + j * 13 + p * 3) % 17) / 17.0;
+      }
+      bs[p](i, 0) = double((i * 5 + p) % 11) - 3.0;
+    }
+    NonNegativeLeastSquaresSolver::solve(As[p], bs[p], serial_xs[p]);
+  }
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+  for (SignedSize p = 0; p < (SignedSize)problem_count; ++p)
+  {
+    NonNegativeLeastSquaresSolver::solve(As[p], bs[p], parallel_xs[p]);
+  }
+
+  for (Size p = 0; p < problem_count; ++p)
+  {
+    TEST_EQUAL(parallel_xs[p].rows(), serial_xs[p].rows())
+    for (Size i = 0; i < std::min(parallel_xs[p].rows(), serial_xs[p].rows()); ++i)
+    {
+      TEST_EQUAL(parallel_xs[p](i, 0), serial_xs[p](i, 0))
+    }
+  }
+}
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 END_TEST
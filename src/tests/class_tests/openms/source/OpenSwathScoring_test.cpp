@@ -217,6 +217,54 @@ START_SECTION((OpenSwath::SpectrumPtr getAddedSpectra_(OpenSwath::SpectrumAccess
 }
 END_SECTION
 
+START_SECTION((void setAddedSpectraCache(AddedSpectraCachePtr spectra_cache, const AddedSpectraCache::MapIdentities& map_ids)))
+{
+  MSExperiment<>* eptr = new MSExperiment<>;
+  MSSpectrum<> s;
+  Peak1D p;
+  p.setMZ(20.0);
+  p.setIntensity(200.0);
+  s.push_back(p);
+  s.setRT(10.0);
+  eptr->addSpectrum(s);
+  s.setRT(20.0);
+  eptr->addSpectrum(s);
+  s.setRT(30.0);
+  eptr->addSpectrum(s);
+  boost::shared_ptr<MSExperiment<> > swath_map (eptr);
+  OpenSwath::SpectrumAccessPtr swath_ptr = SimpleOpenMSSpectraFactory::getSpectrumAccessOpenMSPtr(swath_map);
+
+  OpenSwath_Scores_Usage su;
+  AddedSpectraCachePtr cache(new AddedSpectraCache());
+
+  // two threads reading from their own clones of the same map share the cached spectra
+  OpenSwath::SpectrumAccessPtr clone1 = swath_ptr->lightClone();
+  OpenSwath::SpectrumAccessPtr clone2 = swath_ptr->lightClone();
+  AddedSpectraCache::MapIdentities map_ids;
+  map_ids[clone1.get()] = swath_ptr;
+  map_ids[clone2.get()] = swath_ptr;
+
+  OpenSwathScoring sc;
+  sc.initialize(1.0, 3, 0.005, su);
+  sc.setAddedSpectraCache(cache, map_ids);
+  OpenSwath::SpectrumPtr sp1 = sc.getAddedSpectra_(clone1, 20.0, 3);
+  OpenSwath::SpectrumPtr sp2 = sc.getAddedSpectra_(clone2, 20.0, 3);
+  TEST_EQUAL(cache->getMisses(), 1)
+  TEST_EQUAL(cache->getHits(), 1)
+  TEST_EQUAL(sp1 == sp2, true)
+  TEST_EQUAL(sp2->getIntensityArray()->data.size(), 1);
+  TEST_REAL_SIMILAR(sp2->getIntensityArray()->data[0], 600.0);
+
+  // maps without identity are not cached
+  OpenSwath::SpectrumAccessPtr clone3 = swath_ptr->lightClone();
+  OpenSwath::SpectrumPtr sp3 = sc.getAddedSpectra_(clone3, 20.0, 3);
+  TEST_EQUAL(cache->getMisses(), 1)
+  TEST_EQUAL(cache->getHits(), 1)
+  TEST_EQUAL(cache->size(), 1)
+  TEST_REAL_SIMILAR(sp3->getIntensityArray()->data[0], 600.0);
+}
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 END_TEST
@@ -164,6 +164,30 @@ START_SECTION((template <typename PeakType, typename ChromatogramPeakT> void pic
   }
 END_SECTION
 
+START_SECTION([EXTRA] pickExperiment propagates exceptions of individual spectra)
+{
+  // manual S/N mode without a maximal intensity fails for every spectrum
+  PeakPickerHiRes pp_invalid;
+  Param p_invalid = param;
+  p_invalid.setValue("SignalToNoise:auto_mode", -1);
+  p_invalid.setValue("SignalToNoise:max_intensity", -1);
+  pp_invalid.setParameters(p_invalid);
+
+  // the error of the first failing spectrum is rethrown (as a copy of its BaseException part)
+  MSExperiment<Peak1D> tmp_exp;
+  String error_name;
+  try
+  {
+    pp_invalid.pickExperiment(input, tmp_exp);
+  }
+  catch (Exception::BaseException& e)
+  {
+    error_name = e.getName();
+  }
+  TEST_STRING_EQUAL(error_name, "InvalidValue")
+}
+END_SECTION
+
 output.clear(true);
 
 ///////////////////////////////////////////
@@ -343,6 +343,59 @@ START_SECTION((const ProteinQuant& getProteinResults()))
 }
 END_SECTION
 
+// testing peptide selection with several samples (results of the original, map-based implementation)
+START_SECTION((const ProteinQuant& getProteinResults()))
+{
+  ConsensusMap consensus;
+  ConsensusXMLFile().load(OPENMS_GET_TEST_DATA_PATH("ProteinQuantifier_input.consensusXML"), consensus);
+  PeptideAndProteinQuant quantifier;
+  PeptideAndProteinQuant::ProteinData protein;
+  Param parameters;
+
+  // top 2 peptides per sample
+  parameters.setValue("top", 2);
+  parameters.setValue("average", "mean");
+  quantifier.setParameters(parameters);
+  quantifier.readQuantData(consensus);
+  quantifier.quantifyPeptides();
+  quantifier.quantifyProteins();
+  protein = quantifier.getProteinResults().find("Protein")->second;
+  TEST_EQUAL(protein.total_abundances.size(), 3);
+  TEST_REAL_SIMILAR(protein.total_abundances[0], 600);
+  TEST_REAL_SIMILAR(protein.total_abundances[1], 115);
+  TEST_REAL_SIMILAR(protein.total_abundances[2], 515);
+  TEST_EQUAL(protein.abundances.size(), 4);
+  TEST_EQUAL(protein.id_count, 4);
+
+  // samples with fewer than 3 peptides are not quantified
+  parameters.setValue("top", 3);
+  parameters.setValue("average", "median");
+  parameters.setValue("include_all", "false");
+  quantifier.setParameters(parameters);
+  quantifier.readQuantData(consensus);
+  quantifier.quantifyPeptides();
+  quantifier.quantifyProteins();
+  protein = quantifier.getProteinResults().find("Protein")->second;
+  TEST_EQUAL(protein.total_abundances.size(), 2);
+  TEST_REAL_SIMILAR(protein.total_abundances[0], 200);
+  TEST_REAL_SIMILAR(protein.total_abundances[1], 30);
+
+  // only peptides quantified in all samples
+  parameters.setValue("top", 0);
+  parameters.setValue("average", "sum");
+  parameters.setValue("consensus:fix_peptides", "true");
+  quantifier.setParameters(parameters);
+  quantifier.readQuantData(consensus);
+  quantifier.quantifyPeptides();
+  quantifier.quantifyProteins();
+  protein = quantifier.getProteinResults().find("Protein")->second;
+  TEST_EQUAL(protein.total_abundances.size(), 3);
+  TEST_REAL_SIMILAR(protein.total_abundances[0], 30);
+  TEST_REAL_SIMILAR(protein.total_abundances[1], 30);
+  TEST_REAL_SIMILAR(protein.total_abundances[2], 30);
+}
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 END_TEST
@@ -0,0 +1,253 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2016.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: Timo Sachsenberg $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/CHEMISTRY/PeptideCatalogue.h>
+///////////////////////////
+
+#include <OpenMS/CHEMISTRY/AASequence.h>
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+using namespace OpenMS;
+using namespace std;
+
+START_TEST(PeptideCatalogue, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+PeptideCatalogue* ptr = 0;
+PeptideCatalogue* null_ptr = 0;
+START_SECTION((PeptideCatalogue()))
+  ptr = new PeptideCatalogue();
+  TEST_NOT_EQUAL(ptr, null_ptr)
+  TEST_EQUAL(ptr->size(), 0)
+  TEST_EQUAL(ptr->empty(), true)
+END_SECTION
+
+START_SECTION((virtual ~PeptideCatalogue()))
+  delete ptr;
+END_SECTION
+
+vector<FASTAFile::FASTAEntry> proteins;
+proteins.push_back(FASTAFile::FASTAEntry("P1", "", "MKPEPTIDERAAAK"));
+proteins.push_back(FASTAFile::FASTAEntry("P2", "", "AAAKGGR"));
+proteins.push_back(FASTAFile::FASTAEntry("P3", "", "PE1K"));
+
+EnzymaticDigestion digestion;
+digestion.setEnzyme("Trypsin");
+
+PeptideCatalogue catalogue;
+catalogue.build(proteins, digestion);
+
+START_SECTION((void build(const std::vector<FASTAFile::FASTAEntry>& proteins, const EnzymaticDigestion& digestion, Size min_length = 1, Size max_length = 0)))
+  // sorted by mass, AAAK occurs twice, PE1K is skipped
+  TEST_EQUAL(catalogue.size(), 3)
+  TEST_EQUAL(catalogue.getSequence(0), "GGR")
+  TEST_EQUAL(catalogue.getSequence(1), "AAAK")
+  TEST_EQUAL(catalogue.getSequence(2), "MKPEPTIDER")
+  TEST_EQUAL(catalogue.getNumberOfProteins(), 3)
+
+  PeptideCatalogue other;
+  other.build(proteins, digestion, 4);
+  TEST_EQUAL(other.size(), 2)
+  TEST_EQUAL(other.getSequence(0), "AAAK")
+
+  digestion.setMissedCleavages(1);
+  other.build(proteins, digestion);
+  TEST_EQUAL(other.size(), 5)
+  TEST_EQUAL(other.getSequence(4), "MKPEPTIDERAAAK")
+  digestion.setMissedCleavages(0);
+
+  other.build(vector<FASTAFile::FASTAEntry>(), digestion);
+  TEST_EQUAL(other.empty(), true)
+END_SECTION
+
+START_SECTION((void clear()))
+  PeptideCatalogue other;
+  other.build(proteins, digestion);
+  other.setTag("tag");
+  other.clear();
+  TEST_EQUAL(other.size(), 0)
+  TEST_EQUAL(other.getNumberOfProteins(), 0)
+  TEST_EQUAL(other.getTag(), "")
+END_SECTION
+
+START_SECTION((Size size() const))
+  NOT_TESTABLE // tested above
+END_SECTION
+
+START_SECTION((bool empty() const))
+  TEST_EQUAL(catalogue.empty(), false)
+END_SECTION
+
+START_SECTION((String getSequence(Size index) const))
+  NOT_TESTABLE // tested above
+END_SECTION
+
+START_SECTION((Size getLength(Size index) const))
+  TEST_EQUAL(catalogue.getLength(0), 3)
+  TEST_EQUAL(catalogue.getLength(2), 10)
+END_SECTION
+
+START_SECTION((double getMonoWeight(Size index) const))
+  for (Size i = 0; i < catalogue.size(); ++i)
+  {
+    TEST_REAL_SIMILAR(catalogue.getMonoWeight(i), AASequence::fromString(catalogue.getSequence(i)).getMonoWeight())
+  }
+END_SECTION
+
+START_SECTION((void getPeptidesInMassRange(double min_mass, double max_mass, Size& first, Size& last) const))
+  Size first, last;
+  double mass = catalogue.getMonoWeight(1);
+  catalogue.getPeptidesInMassRange(mass - 0.01, mass + 0.01, first, last);
+  TEST_EQUAL(first, 1)
+  TEST_EQUAL(last, 2)
+  catalogue.getPeptidesInMassRange(0.0, 10000.0, first, last);
+  TEST_EQUAL(first, 0)
+  TEST_EQUAL(last, 3)
+  catalogue.getPeptidesInMassRange(10000.0, 20000.0, first, last);
+  TEST_EQUAL(first, last)
+END_SECTION
+
+START_SECTION((Size getNumberOfOccurrences(Size index) const))
+  TEST_EQUAL(catalogue.getNumberOfOccurrences(0), 1)
+  TEST_EQUAL(catalogue.getNumberOfOccurrences(1), 2)
+  TEST_EQUAL(catalogue.getNumberOfOccurrences(2), 1)
+END_SECTION
+
+START_SECTION((void getPeptideEvidences(Size index, std::vector<PeptideEvidence>& evidences) const))
+  vector<PeptideEvidence> evidences;
+  catalogue.getPeptideEvidences(1, evidences);
+  TEST_EQUAL(evidences.size(), 2)
+  ABORT_IF(evidences.size() != 2)
+  TEST_EQUAL(evidences[0].getProteinAccession(), "P1")
+  TEST_EQUAL(evidences[0].getStart(), 10)
+  TEST_EQUAL(evidences[0].getEnd(), 13)
+  TEST_EQUAL(evidences[0].getAABefore(), 'R')
+  TEST_EQUAL(evidences[0].getAAAfter(), PeptideEvidence::C_TERMINAL_AA)
+  TEST_EQUAL(evidences[1].getProteinAccession(), "P2")
+  TEST_EQUAL(evidences[1].getStart(), 0)
+  TEST_EQUAL(evidences[1].getEnd(), 3)
+  TEST_EQUAL(evidences[1].getAABefore(), PeptideEvidence::N_TERMINAL_AA)
+  TEST_EQUAL(evidences[1].getAAAfter(), 'G')
+END_SECTION
+
+START_SECTION((Size getNumberOfProteins() const))
+  NOT_TESTABLE // tested above
+END_SECTION
+
+START_SECTION((const String& getProteinIdentifier(Size index) const))
+  TEST_EQUAL(catalogue.getProteinIdentifier(1), "P2")
+END_SECTION
+
+START_SECTION((void setTag(const String& tag)))
+  catalogue.setTag("Trypsin;0");
+  TEST_EQUAL(catalogue.getTag(), "Trypsin;0")
+END_SECTION
+
+START_SECTION((const String& getTag() const))
+  NOT_TESTABLE // tested above
+END_SECTION
+
+START_SECTION((void store(const String& filename) const))
+  TEST_EXCEPTION(Exception::UnableToCreateFile, catalogue.store("/bla/bluff/blblb/sdfhsdjf/test.bin"))
+END_SECTION
+
+START_SECTION((void load(const String& filename)))
+  String tmp_filename;
+  NEW_TMP_FILE(tmp_filename);
+  catalogue.store(tmp_filename);
+
+  PeptideCatalogue loaded;
+  loaded.load(tmp_filename);
+  TEST_EQUAL(loaded.getTag(), "Trypsin;0")
+  TEST_EQUAL(loaded.size(), catalogue.size())
+  TEST_EQUAL(loaded.getNumberOfProteins(), 3)
+  TEST_EQUAL(loaded.getProteinIdentifier(2), "P3")
+  for (Size i = 0; i < loaded.size(); ++i)
+  {
+    TEST_EQUAL(loaded.getSequence(i), catalogue.getSequence(i))
+    TEST_REAL_SIMILAR(loaded.getMonoWeight(i), catalogue.getMonoWeight(i))
+    TEST_EQUAL(loaded.getNumberOfOccurrences(i), catalogue.getNumberOfOccurrences(i))
+  }
+  vector<PeptideEvidence> evidences;
+  loaded.getPeptideEvidences(1, evidences);
+  TEST_EQUAL(evidences.size(), 2)
+  ABORT_IF(evidences.size() != 2)
+  TEST_EQUAL(evidences[1].getProteinAccession(), "P2")
+  TEST_EQUAL(evidences[1].getAAAfter(), 'G')
+
+  TEST_EXCEPTION(Exception::FileNotFound, loaded.load("PeptideCatalogue_test_this_file_does_not_exist"))
+  TEST_EXCEPTION(Exception::ParseError, loaded.load(OPENMS_GET_TEST_DATA_PATH("FASTAFile_test.fasta")))
+
+  // truncated catalogue
+  String truncated_filename;
+  NEW_TMP_FILE(truncated_filename);
+  {
+    std::ifstream is(tmp_filename.c_str(), std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+    std::ofstream os(truncated_filename.c_str(), std::ios::binary);
+    os.write(content.data(), content.size() / 2);
+  }
+  TEST_EXCEPTION(Exception::ParseError, loaded.load(truncated_filename))
+
+  // identifier end offsets that are not increasing (2 4 6 -> 5 4 6)
+  String corrupted_filename;
+  NEW_TMP_FILE(corrupted_filename);
+  {
+    std::ifstream is(tmp_filename.c_str(), std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+    // file identifier, tag ("Trypsin;0") and the number of identifiers precede the first end offset
+    Size first_end_pos = sizeof(int) + sizeof(Size) + 9 + sizeof(Size);
+    Size first_end = 0;
+    std::memcpy(&first_end, content.data() + first_end_pos, sizeof(Size));
+    TEST_EQUAL(first_end, 2)
+    first_end = 5;
+    content.replace(first_end_pos, sizeof(Size), (const char*) &first_end, sizeof(Size));
+    std::ofstream os(corrupted_filename.c_str(), std::ios::binary);
+    os.write(content.data(), content.size());
+  }
+  TEST_EXCEPTION(Exception::ParseError, loaded.load(corrupted_filename))
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -206,6 +206,93 @@ START_SECTION((void fit( std::vector<double>& search_engine_scores, std::vector<
 
 END_SECTION
 
+START_SECTION((void setInitialParameters(const GaussFitter::GaussFitResult& incorrect, const GaussFitter::GaussFitResult& correct, double negative_prior, double smallest_score)))
+{
+  PosteriorErrorProbabilityModel model;
+  GaussFitter::GaussFitResult valid(1.0, 1.5, 0.5), invalid(1.0, 1.5, 0.0);
+  TEST_EXCEPTION(Exception::InvalidValue, model.setInitialParameters(invalid, valid, 0.5, 0.0))
+  TEST_EXCEPTION(Exception::InvalidValue, model.setInitialParameters(valid, invalid, 0.5, 0.0))
+  TEST_EXCEPTION(Exception::InvalidValue, model.setInitialParameters(valid, valid, 1.0, 0.0))
+  TEST_EXCEPTION(Exception::InvalidValue, model.setInitialParameters(valid, valid, 0.0, 0.0))
+}
+END_SECTION
+
+START_SECTION((void setInitialParameters(const PosteriorErrorProbabilityModel& model)))
+{
+  vector<double> scores;
+  CsvFile gauss_mix(OPENMS_GET_TEST_DATA_PATH("GaussMix_2_1D.csv"), ';');
+  StringList gauss_mix_strings;
+  gauss_mix.getRow(0, gauss_mix_strings);
+  for (StringList::const_iterator it = gauss_mix_strings.begin(); it != gauss_mix_strings.end(); ++it)
+  {
+    if (!it->empty()) scores.push_back(it->toDouble());
+  }
+  Param param;
+  param.setValue("incorrectly_assigned", "Gauss");
+
+  PosteriorErrorProbabilityModel previous;
+  previous.setParameters(param);
+  vector<double> previous_scores(scores);
+  TEST_EQUAL(previous.fit(previous_scores), true)
+
+  // a similar score distribution: the first 1500 scores
+  vector<double> similar_scores(scores.begin(), scores.begin() + 1500);
+  vector<double> cold_scores(similar_scores), warm_scores(similar_scores);
+
+  PosteriorErrorProbabilityModel cold;
+  cold.setParameters(param);
+  TEST_EQUAL(cold.fit(cold_scores), true)
+
+  PosteriorErrorProbabilityModel warm;
+  warm.setParameters(param);
+  warm.setInitialParameters(previous);
+  TEST_EQUAL(warm.fit(warm_scores), true)
+
+  TOLERANCE_ABSOLUTE(0.01)
+  TEST_REAL_SIMILAR(warm.getCorrectlyAssignedFitResult().x0, cold.getCorrectlyAssignedFitResult().x0)
+  TEST_REAL_SIMILAR(warm.getCorrectlyAssignedFitResult().sigma, cold.getCorrectlyAssignedFitResult().sigma)
+  TEST_REAL_SIMILAR(warm.getIncorrectlyAssignedFitResult().x0, cold.getIncorrectlyAssignedFitResult().x0)
+  TEST_REAL_SIMILAR(warm.getIncorrectlyAssignedFitResult().sigma, cold.getIncorrectlyAssignedFitResult().sigma)
+  TEST_REAL_SIMILAR(warm.getNegativePrior(), cold.getNegativePrior())
+  TEST_REAL_SIMILAR(warm.computeProbability(2.5), cold.computeProbability(2.5))
+}
+END_SECTION
+
+START_SECTION((void clearInitialParameters()))
+{
+  vector<double> scores;
+  CsvFile gauss_mix(OPENMS_GET_TEST_DATA_PATH("GaussMix_2_1D.csv"), ';');
+  StringList gauss_mix_strings;
+  gauss_mix.getRow(0, gauss_mix_strings);
+  for (StringList::const_iterator it = gauss_mix_strings.begin(); it != gauss_mix_strings.end(); ++it)
+  {
+    if (!it->empty()) scores.push_back(it->toDouble());
+  }
+  Param param;
+  param.setValue("incorrectly_assigned", "Gauss");
+
+  vector<double> cold_scores(scores), cleared_scores(scores);
+  PosteriorErrorProbabilityModel cold;
+  cold.setParameters(param);
+  TEST_EQUAL(cold.fit(cold_scores), true)
+
+  // a starting point far away from the cold fit, which is discarded again
+  PosteriorErrorProbabilityModel cleared;
+  cleared.setParameters(param);
+  cleared.setInitialParameters(GaussFitter::GaussFitResult(1.0, 0.1, 5.0), GaussFitter::GaussFitResult(1.0, 9.0, 0.1), 0.9, 0.0);
+  cleared.clearInitialParameters();
+  TEST_EQUAL(cleared.fit(cleared_scores), true)
+
+  // the same computation as the cold fit, so the results are identical
+  TEST_EQUAL(cleared.getCorrectlyAssignedFitResult().x0, cold.getCorrectlyAssignedFitResult().x0)
+  TEST_EQUAL(cleared.getCorrectlyAssignedFitResult().sigma, cold.getCorrectlyAssignedFitResult().sigma)
+  TEST_EQUAL(cleared.getIncorrectlyAssignedFitResult().x0, cold.getIncorrectlyAssignedFitResult().x0)
+  TEST_EQUAL(cleared.getIncorrectlyAssignedFitResult().sigma, cold.getIncorrectlyAssignedFitResult().sigma)
+  TEST_EQUAL(cleared.getNegativePrior(), cold.getNegativePrior())
+  TEST_EQUAL(cleared.computeProbability(2.5), cold.computeProbability(2.5))
+}
+END_SECTION
+
 START_SECTION((void fillDensities(std::vector<double>& x_scores,std::vector<double>& incorrect_density,std::vector<double>& correct_density)))
 NOT_TESTABLE
 //tested in fit
@@ -39,9 +39,48 @@
 #include <OpenMS/SIMULATION/RawMSSignalSimulation.h>
 ///////////////////////////
 
+#include <OpenMS/CHEMISTRY/AASequence.h>
+#include <OpenMS/CONCEPT/Constants.h>
+
 using namespace OpenMS;
 using namespace std;
 
+// an LC-MS map of 100 scans and a few overlapping features (not sorted by RT), as prepared by the previous simulation steps
+void createSimulationInput(SimTypes::FeatureMapSim& features, SimTypes::MSSimExperiment& experiment)
+{
+  ScanWindow window;
+  window.begin = 400.0;
+  window.end = 1200.0;
+  experiment.resize(100);
+  for (Size i = 0; i < experiment.size(); ++i)
+  {
+    experiment[i].setRT(double(i));
+    experiment[i].setMSLevel(1);
+    experiment[i].setMetaValue("distortion", 1.0);
+    experiment[i].getInstrumentSettings().getScanWindows().push_back(window);
+  }
+  experiment.updateRanges();
+
+  const char* sequences[] = {"PEPTIDEK", "LIVAGHK", "SAMPLER", "TESTPEPTIDER", "ACDEFGHIK", "WYLLLK"};
+  for (Size i = 0; i < 6; ++i)
+  {
+    AASequence sequence = AASequence::fromString(sequences[i]);
+    PeptideIdentification id;
+    id.insertHit(PeptideHit(1.0, 1, 2, sequence));
+    Feature feature;
+    feature.getPeptideIdentifications().push_back(id);
+    feature.setRT(15.0 + ((i * 5) % 6) * 12.0);
+    feature.setMZ((sequence.getMonoWeight() + 2 * Constants::PROTON_MASS_U) / 2);
+    feature.setCharge(2);
+    feature.setIntensity(1000.0 * (i + 1));
+    feature.setMetaValue("charge_adducts", "H2");
+    feature.setMetaValue("RT_egh_variance", 9.0);
+    feature.setMetaValue("RT_egh_tau", 0.0);
+    features.push_back(feature);
+  }
+}
+
+
 START_TEST(RawMSSignalSimulation, "$Id$")
 
 /////////////////////////////////////////////////////////////
@@ -95,7 +134,54 @@ END_SECTION
 
 START_SECTION((void generateRawSignals(SimTypes::FeatureMapSim &features, SimTypes::MSSimExperiment &experiment, SimTypes::MSSimExperiment &experiment_ct, SimTypes::FeatureMapSim &contaminants)))
 {
-  // TODO
+  // sampling in RT batches ("memory:feature_batch_size") gives the same maps as sampling all features at once
+  SimTypes::FeatureMapSim features, features_batch, contaminants, contaminants_batch;
+  SimTypes::MSSimExperiment experiment, experiment_batch;
+  createSimulationInput(features, experiment);
+  features_batch = features;
+  experiment_batch = experiment;
+  SimTypes::MSSimExperiment experiment_ct = experiment, experiment_ct_batch = experiment;
+
+  RawMSSignalSimulation sim(empty_rnd_gen);
+  sim.generateRawSignals(features, experiment, experiment_ct, contaminants);
+
+  RawMSSignalSimulation sim_batch(empty_rnd_gen);
+  Param p = sim_batch.getParameters();
+  p.setValue("memory:feature_batch_size", 2);
+  sim_batch.setParameters(p);
+  sim_batch.generateRawSignals(features_batch, experiment_batch, experiment_ct_batch, contaminants_batch);
+
+  TEST_EQUAL(experiment_batch.size(), experiment.size())
+  TEST_EQUAL(experiment_ct_batch.size(), experiment_ct.size())
+  Size peak_count(0);
+  for (Size i = 0; i < experiment.size(); ++i)
+  {
+    peak_count += experiment[i].size();
+    TEST_EQUAL(experiment_batch[i].size(), experiment[i].size())
+    for (Size j = 0; j < std::min(experiment[i].size(), experiment_batch[i].size()); ++j)
+    {
+      TEST_REAL_SIMILAR(experiment_batch[i][j].getMZ(), experiment[i][j].getMZ())
+      TEST_REAL_SIMILAR(experiment_batch[i][j].getIntensity(), experiment[i][j].getIntensity())
+    }
+
+    // the ground truth is not compressed, i.e. the order of its points depends on the order of the features
+    experiment_ct[i].sortByPosition();
+    experiment_ct_batch[i].sortByPosition();
+    TEST_EQUAL(experiment_ct_batch[i].size(), experiment_ct[i].size())
+    for (Size j = 0; j < std::min(experiment_ct[i].size(), experiment_ct_batch[i].size()); ++j)
+    {
+      TEST_REAL_SIMILAR(experiment_ct_batch[i][j].getMZ(), experiment_ct[i][j].getMZ())
+      TEST_REAL_SIMILAR(experiment_ct_batch[i][j].getIntensity(), experiment_ct[i][j].getIntensity())
+    }
+  }
+  TEST_EQUAL(peak_count > 0, true)
+
+  TEST_EQUAL(features_batch.size(), features.size())
+  for (Size f = 0; f < features.size(); ++f)
+  {
+    TEST_REAL_SIMILAR(features_batch[f].getIntensity(), features[f].getIntensity())
+    TEST_EQUAL(features_batch[f].getConvexHulls().size(), features[f].getConvexHulls().size())
+  }
 }
 END_SECTION
 
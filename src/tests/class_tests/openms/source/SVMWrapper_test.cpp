@@ -43,6 +43,10 @@
 #include <string>
 #include <vector>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 ///////////////////////////
 
 START_TEST(SVMWrapper, "$Id$")
@@ -873,6 +877,87 @@ START_SECTION((void setParameter(SVM_parameter_type type, Int value)))
 	TEST_EQUAL(svm.getIntParameter(SVMWrapper::PROBABILITY), 1)
 END_SECTION
 
+START_SECTION((void setKernelMemoryLimit(Size megabytes)))
+  SVMWrapper svm2;
+  svm2.setKernelMemoryLimit(17);
+  TEST_EQUAL(svm2.getKernelMemoryLimit(), 17)
+END_SECTION
+
+START_SECTION((Size getKernelMemoryLimit() const))
+  SVMWrapper svm2;
+  TEST_EQUAL(svm2.getKernelMemoryLimit(), 1024)
+END_SECTION
+
+START_SECTION(([EXTRA] cross validation and prediction do not depend on the number of threads and the kernel memory limit))
+  SVMData problem;
+  for (Size i = 0; i < 20; ++i)
+  {
+    vector<pair<Int, double> > sequence;
+    for (Int k = 1; k <= 6; ++k)
+    {
+      sequence.push_back(make_pair(k, double((i * 7 + k * 3) % 5 + (i % 2) * k)));
+    }
+    problem.sequences.push_back(sequence);
+    problem.labels.push_back(i % 2 == 0 ? -1.0 : 1.0);
+  }
+
+  map<SVMWrapper::SVM_parameter_type, double> start_values;
+  map<SVMWrapper::SVM_parameter_type, double> step_sizes;
+  map<SVMWrapper::SVM_parameter_type, double> end_values;
+  start_values.insert(make_pair(SVMWrapper::C, 0.1));
+  step_sizes.insert(make_pair(SVMWrapper::C, 10));
+  end_values.insert(make_pair(SVMWrapper::C, 100));
+  start_values.insert(make_pair(SVMWrapper::SIGMA, 1));
+  step_sizes.insert(make_pair(SVMWrapper::SIGMA, 2));
+  end_values.insert(make_pair(SVMWrapper::SIGMA, 5));
+
+#ifdef _OPENMP
+  const int max_threads = omp_get_max_threads();
+#endif
+
+  // 0: serial, 1: parallel, 2: parallel without precomputed kernel values
+  vector<double> qualities;
+  vector<map<SVMWrapper::SVM_parameter_type, double> > best_parameters(3);
+  vector<vector<double> > predictions(3);
+  for (Size run = 0; run < 3; ++run)
+  {
+#ifdef _OPENMP
+    omp_set_num_threads(run == 0 ? 1 : max_threads);
+#endif
+    SVMWrapper svm2;
+    svm2.setParameter(SVMWrapper::SVM_TYPE, C_SVC);
+    svm2.setParameter(SVMWrapper::KERNEL_TYPE, SVMWrapper::OLIGO);
+    svm2.setParameter(SVMWrapper::BORDER_LENGTH, 6);
+    if (run == 2)
+    {
+      svm2.setKernelMemoryLimit(0);
+    }
+
+    srand(42);
+    qualities.push_back(svm2.performCrossValidation(0, problem, true, start_values, step_sizes, end_values, 4, 2, best_parameters[run], false, false));
+
+    svm2.setParameter(SVMWrapper::C, best_parameters[run][SVMWrapper::C]);
+    svm2.setParameter(SVMWrapper::SIGMA, best_parameters[run][SVMWrapper::SIGMA]);
+    svm2.train(problem);
+    svm2.predict(problem, predictions[run]);
+  }
+#ifdef _OPENMP
+  omp_set_num_threads(max_threads);
+#endif
+
+  for (Size run = 1; run < 3; ++run)
+  {
+    TEST_REAL_SIMILAR(qualities[run], qualities[0])
+    TEST_REAL_SIMILAR(best_parameters[run][SVMWrapper::C], best_parameters[0][SVMWrapper::C])
+    TEST_REAL_SIMILAR(best_parameters[run][SVMWrapper::SIGMA], best_parameters[0][SVMWrapper::SIGMA])
+    TEST_EQUAL(predictions[run].size(), problem.sequences.size())
+    for (Size i = 0; i < predictions[run].size(); ++i)
+    {
+      TEST_REAL_SIMILAR(predictions[run][i], predictions[0][i])
+    }
+  }
+END_SECTION
+
 START_SECTION((virtual ~SVMWrapper()))
 	delete ptr;
 END_SECTION
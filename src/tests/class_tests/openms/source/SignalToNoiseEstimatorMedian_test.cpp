@@ -114,6 +114,41 @@ START_SECTION([EXTRA](virtual void init(const PeakIterator& it_begin, const Peak
 
 END_SECTION
 
+START_SECTION([EXTRA](exact median))
+{
+  MSSpectrum < > raw_data;
+  DTAFile dta_file;
+  dta_file.load(OPENMS_GET_TEST_DATA_PATH("SignalToNoiseEstimator_test.dta"), raw_data);
+
+  SignalToNoiseEstimatorMedian< MSSpectrum < > > sne;
+  Param p;
+  p.setValue("win_len", 40.0);
+  p.setValue("noise_for_empty_window", 2.0);
+  p.setValue("min_required_elements", 10);
+  p.setValue("median_mode", "exact");
+  sne.setParameters(p);
+  sne.init(raw_data);
+  TEST_EQUAL(sne.getHistogramRightmostPercent(), 0.0)
+
+  // compare to the median of each window computed by sorting
+  for (MSSpectrum< >::const_iterator it = raw_data.begin(); it != raw_data.end(); ++it)
+  {
+    std::vector<double> window;
+    for (MSSpectrum< >::const_iterator w_it = raw_data.begin(); w_it != raw_data.end(); ++w_it)
+    {
+      if (w_it->getMZ() >= it->getMZ() - 20.0 && w_it->getMZ() <= it->getMZ() + 20.0) window.push_back(w_it->getIntensity());
+    }
+    double noise = 2.0;
+    if (window.size() >= 10)
+    {
+      std::sort(window.begin(), window.end());
+      noise = std::max(1.0, window[(window.size() + 1) / 2 - 1]);
+    }
+    TEST_REAL_SIMILAR(sne.getSignalToNoise(it), it->getIntensity() / noise)
+  }
+}
+END_SECTION
+
 
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
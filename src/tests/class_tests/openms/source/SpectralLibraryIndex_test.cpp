@@ -0,0 +1,227 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2016.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: Timo Sachsenberg $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/ANALYSIS/ID/SpectralLibraryIndex.h>
+#include <OpenMS/CHEMISTRY/AASequence.h>
+///////////////////////////
+
+#include <fstream>
+
+using namespace OpenMS;
+using namespace std;
+
+START_TEST(SpectralLibraryIndex, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+SpectralLibraryIndex* ptr = 0;
+SpectralLibraryIndex* null_ptr = 0;
+START_SECTION(SpectralLibraryIndex())
+{
+  ptr = new SpectralLibraryIndex();
+  TEST_NOT_EQUAL(ptr, null_ptr)
+  TEST_EQUAL(ptr->size(), 0)
+  TEST_EQUAL(ptr->empty(), true)
+}
+END_SECTION
+
+START_SECTION(virtual ~SpectralLibraryIndex())
+{
+  delete ptr;
+}
+END_SECTION
+
+// three library entries, added out of precursor order
+SpectralLibraryIndex index;
+{
+  const double precursors[] = {600.5, 400.2, 500.3};
+  const char* sequences[] = {"PEPTIDER", "DFPIANGER", "TESTPEPTIDEK"};
+  for (Size i = 0; i < 3; ++i)
+  {
+    PeakSpectrum spec;
+    spec.setRT(10.0 * (i + 1));
+    vector<Precursor> prec(1);
+    prec[0].setMZ(precursors[i]);
+    spec.setPrecursors(prec);
+    for (Size p = 0; p <= i; ++p)
+    {
+      Peak1D peak;
+      peak.setMZ(100.0 * (p + 1));
+      peak.setIntensity(p + 1.0);
+      spec.push_back(peak);
+    }
+    index.addEntry(spec, PeptideHit(0, 0, Int(i + 1), AASequence::fromString(sequences[i])));
+  }
+}
+
+START_SECTION((void addEntry(const PeakSpectrum& spectrum, const PeptideHit& hit)))
+{
+  TEST_EQUAL(index.size(), 3)
+  SpectralLibraryIndex tmp;
+  TEST_EXCEPTION(Exception::MissingInformation, tmp.addEntry(PeakSpectrum(), PeptideHit()))
+}
+END_SECTION
+
+START_SECTION((void sortByPrecursorMZ()))
+{
+  index.sortByPrecursorMZ();
+  TEST_REAL_SIMILAR(index.getPrecursorMZ(0), 400.2)
+  TEST_REAL_SIMILAR(index.getPrecursorMZ(1), 500.3)
+  TEST_REAL_SIMILAR(index.getPrecursorMZ(2), 600.5)
+}
+END_SECTION
+
+START_SECTION((void getEntriesInRange(double min_mz, double max_mz, Size& first, Size& last) const))
+{
+  Size first, last;
+  index.getEntriesInRange(450.0, 650.0, first, last);
+  TEST_EQUAL(first, 1)
+  TEST_EQUAL(last, 3)
+  index.getEntriesInRange(400.2, 400.2, first, last);
+  TEST_EQUAL(first, 0)
+  TEST_EQUAL(last, 1)
+  index.getEntriesInRange(700.0, 800.0, first, last);
+  TEST_EQUAL(first, last)
+}
+END_SECTION
+
+START_SECTION((double getPrecursorMZ(Size index) const))
+{
+  TEST_REAL_SIMILAR(index.getPrecursorMZ(2), 600.5)
+}
+END_SECTION
+
+START_SECTION((double getRT(Size index) const))
+{
+  TEST_REAL_SIMILAR(index.getRT(0), 20.0)
+  TEST_REAL_SIMILAR(index.getRT(1), 30.0)
+  TEST_REAL_SIMILAR(index.getRT(2), 10.0)
+}
+END_SECTION
+
+START_SECTION((Int getCharge(Size index) const))
+{
+  TEST_EQUAL(index.getCharge(0), 2)
+  TEST_EQUAL(index.getCharge(1), 3)
+  TEST_EQUAL(index.getCharge(2), 1)
+}
+END_SECTION
+
+START_SECTION((void getSpectrum(Size index, PeakSpectrum& spectrum) const))
+{
+  PeakSpectrum spec;
+  index.getSpectrum(1, spec);
+  TEST_EQUAL(spec.size(), 3)
+  TEST_REAL_SIMILAR(spec[2].getMZ(), 300.0)
+  TEST_REAL_SIMILAR(spec[2].getIntensity(), 3.0)
+  TEST_REAL_SIMILAR(spec.getRT(), 30.0)
+  TEST_REAL_SIMILAR(spec.getPrecursors()[0].getMZ(), 500.3)
+  index.getSpectrum(2, spec);
+  TEST_EQUAL(spec.size(), 1)
+}
+END_SECTION
+
+START_SECTION((PeptideHit getPeptideHit(Size index) const))
+{
+  PeptideHit hit = index.getPeptideHit(0);
+  TEST_EQUAL(hit.getSequence().toString(), "DFPIANGER")
+  TEST_EQUAL(hit.getCharge(), 2)
+}
+END_SECTION
+
+START_SECTION((void setTag(const String& tag)))
+{
+  index.setTag("remove_peaks_below_threshold=2.01");
+  TEST_EQUAL(index.getTag(), "remove_peaks_below_threshold=2.01")
+}
+END_SECTION
+
+START_SECTION((const String& getTag() const))
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION((void store(const String& filename) const))
+{
+  NOT_TESTABLE // tested with load
+}
+END_SECTION
+
+START_SECTION((void load(const String& filename)))
+{
+  String tmp_filename;
+  NEW_TMP_FILE(tmp_filename);
+  index.store(tmp_filename);
+
+  SpectralLibraryIndex loaded;
+  loaded.load(tmp_filename);
+  TEST_EQUAL(loaded.size(), 3)
+  TEST_EQUAL(loaded.getTag(), "remove_peaks_below_threshold=2.01")
+  TEST_EQUAL(loaded.getPeptideHit(2).getSequence().toString(), "PEPTIDER")
+  TEST_EQUAL(loaded.getCharge(1), 3)
+  PeakSpectrum spec;
+  loaded.getSpectrum(1, spec);
+  TEST_EQUAL(spec.size(), 3)
+  TEST_REAL_SIMILAR(spec[1].getMZ(), 200.0)
+  TEST_REAL_SIMILAR(spec[1].getIntensity(), 2.0)
+
+  String unused_tmp_filename;
+  NEW_TMP_FILE(unused_tmp_filename);
+  TEST_EXCEPTION(Exception::FileNotFound, loaded.load(unused_tmp_filename))
+  TEST_EXCEPTION(Exception::ParseError, loaded.load(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML")))
+
+  // peak offsets that are not monotonic (0 6 5 6 instead of 0 2 5 6) are rejected
+  {
+    std::fstream fs(tmp_filename.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+    // identifier, tag, precursor m/z, RT, charge, size and first entry of the peak offsets
+    Size pos = sizeof(int) + sizeof(Size) + index.getTag().size() + 2 * (sizeof(Size) + 3 * sizeof(double)) +
+               sizeof(Size) + 3 * sizeof(Int) + 2 * sizeof(Size);
+    Size offset = 6;
+    fs.seekp(pos);
+    fs.write((const char*) &offset, sizeof(offset));
+  }
+  TEST_EXCEPTION(Exception::ParseError, loaded.load(tmp_filename))
+  TEST_EQUAL(loaded.size(), 0)
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
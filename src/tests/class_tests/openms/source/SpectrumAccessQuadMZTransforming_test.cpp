@@ -36,6 +36,7 @@
 #include <OpenMS/test_config.h>
 
 #include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SimpleOpenMSSpectraAccessFactory.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessOpenMSInMemory.h>
 
 ///////////////////////////
 #include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessQuadMZTransforming.h>
@@ -174,6 +175,61 @@ START_SECTION(boost::shared_ptr<OpenSwath::ISpectrumAccess> lightClone() const)
 }
 END_SECTION
 
+START_SECTION([EXTRA] getSpectrumById does not modify shared spectra of the underlying access)
+{
+  boost::shared_ptr<MSExperiment<Peak1D> > exp2 = getData();
+  OpenSwath::SpectrumAccessPtr expptr2 = SimpleOpenMSSpectraFactory::getSpectrumAccessOpenMSPtr(exp2);
+  OpenSwath::SpectrumAccessPtr in_memory(new SpectrumAccessOpenMSInMemory(*expptr2));
+  boost::shared_ptr<SpectrumAccessQuadMZTransforming> ptr2(new SpectrumAccessQuadMZTransforming(in_memory, 10, 5, 2, false));
+
+  // repeated access must not apply the correction again
+  for (Size i = 0; i < 3; ++i)
+  {
+    OpenSwath::SpectrumPtr spec1 = ptr2->getSpectrumById(0);
+    TEST_REAL_SIMILAR(spec1->getMZArray()->data[0], 10 + 100*5 + 100*100* 2)
+    TEST_REAL_SIMILAR(spec1->getMZArray()->data[1], 10 + 500*5 + 500*500* 2)
+    TEST_REAL_SIMILAR(spec1->getIntensityArray()->data[1], 150)
+  }
+  TEST_REAL_SIMILAR(in_memory->getSpectrumById(0)->getMZArray()->data[0], 100)
+  TEST_REAL_SIMILAR(in_memory->getSpectrumById(0)->getMZArray()->data[1], 500)
+
+  // ppm domain
+  boost::shared_ptr<SpectrumAccessQuadMZTransforming> ptr3(new SpectrumAccessQuadMZTransforming(in_memory, 10, 5, 2, true));
+  OpenSwath::SpectrumPtr spec2 = ptr3->getSpectrumById(0);
+  TEST_REAL_SIMILAR(spec2->getMZArray()->data[0], 100 - (10 + 100*5 + 100*100* 2) * 100 / 1e6)
+  TEST_REAL_SIMILAR(spec2->getMZArray()->data[1], 500 - (10 + 500*5 + 500*500* 2) * 500 / 1e6)
+  TEST_REAL_SIMILAR(in_memory->getSpectrumById(0)->getMZArray()->data[0], 100)
+}
+END_SECTION
+
+START_SECTION([EXTRA] caching of transformed spectra)
+{
+  boost::shared_ptr<MSExperiment<Peak1D> > exp2 = getData();
+  OpenSwath::SpectrumAccessPtr expptr2 = SimpleOpenMSSpectraFactory::getSpectrumAccessOpenMSPtr(exp2);
+
+  boost::shared_ptr<SpectrumAccessQuadMZTransforming> uncached(new SpectrumAccessQuadMZTransforming(expptr2, 10, 5, 2, false));
+  TEST_EQUAL(uncached->isCaching(), false)
+  TEST_NOT_EQUAL(uncached->getSpectrumById(0).get(), uncached->getSpectrumById(0).get())
+
+  boost::shared_ptr<SpectrumAccessQuadMZTransforming> ptr2(new SpectrumAccessQuadMZTransforming(expptr2, 10, 5, 2, false, true));
+  TEST_EQUAL(ptr2->isCaching(), true)
+  OpenSwath::SpectrumPtr spec1 = ptr2->getSpectrumById(0);
+  TEST_REAL_SIMILAR(spec1->getMZArray()->data[0], 10 + 100*5 + 100*100* 2)
+  TEST_REAL_SIMILAR(spec1->getMZArray()->data[1], 10 + 500*5 + 500*500* 2)
+  TEST_EQUAL(ptr2->getSpectrumById(0).get(), spec1.get())
+
+  // light clones share the cache
+  boost::shared_ptr<OpenSwath::ISpectrumAccess> clone_ptr = ptr2->lightClone();
+  TEST_EQUAL(clone_ptr->getSpectrumById(0).get(), spec1.get())
+
+  ptr2->clearCache();
+  OpenSwath::SpectrumPtr spec2 = clone_ptr->getSpectrumById(0);
+  TEST_NOT_EQUAL(spec2.get(), spec1.get())
+  TEST_REAL_SIMILAR(spec2->getMZArray()->data[0], 10 + 100*5 + 100*100* 2)
+  TEST_EQUAL(ptr2->getSpectrumById(0).get(), spec2.get())
+}
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 END_TEST
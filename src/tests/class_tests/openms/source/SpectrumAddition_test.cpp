@@ -48,7 +48,7 @@ START_TEST(SpectrumAddition, "$Id$")
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 
-START_SECTION((static OpenSwath::SpectrumPtr addUpSpectra(std::vector< OpenSwath::SpectrumPtr > all_spectra, double sampling_rate, double filter_zeros)) )
+START_SECTION((static OpenSwath::SpectrumPtr addUpSpectra(const std::vector< OpenSwath::SpectrumPtr >& all_spectra, double sampling_rate, bool filter_zeros)) )
 {
   OpenSwath::SpectrumPtr spec1(new OpenSwath::Spectrum());
   OpenSwath::BinaryDataArrayPtr mass1(new OpenSwath::BinaryDataArray);
@@ -127,7 +127,49 @@ START_SECTION((static OpenSwath::SpectrumPtr addUpSpectra(std::vector< OpenSwath
 }
 END_SECTION
 
-START_SECTION((static OpenMS::MSSpectrum<> addUpSpectra(std::vector< OpenMS::Spectrum<> all_spectra, double sampling_rate, bool filter_zeros) ))
+START_SECTION((static OpenSwath::SpectrumPtr mergeSpectra(const std::vector< OpenSwath::SpectrumPtr >& all_spectra, double mz_tolerance, bool filter_zeros)) )
+{
+  OpenSwath::SpectrumPtr spec1(new OpenSwath::Spectrum());
+  OpenSwath::SpectrumPtr spec2(new OpenSwath::Spectrum());
+
+  static const double mz1[] = {100.0, 101.0, 102.0, 103.0};
+  static const double int1[] = {1.0, 2.0, 0.0, 4.0};
+  static const double mz2[] = {100.002, 101.5, 103.004};
+  static const double int2[] = {3.0, 5.0, 4.0};
+  spec1->getMZArray()->data.assign(mz1, mz1 + 4);
+  spec1->getIntensityArray()->data.assign(int1, int1 + 4);
+  spec2->getMZArray()->data.assign(mz2, mz2 + 3);
+  spec2->getIntensityArray()->data.assign(int2, int2 + 3);
+
+  std::vector<OpenSwath::SpectrumPtr> all_spectra;
+  OpenSwath::SpectrumPtr empty_result = SpectrumAddition::mergeSpectra(all_spectra, 0.005, false);
+  TEST_EQUAL(empty_result->getMZArray()->data.size(), 0)
+
+  all_spectra.push_back(spec1);
+  all_spectra.push_back(spec2);
+
+  OpenSwath::SpectrumPtr result = SpectrumAddition::mergeSpectra(all_spectra, 0.005, false);
+  TEST_EQUAL(result->getMZArray()->data.size(), 5)
+  TEST_REAL_SIMILAR(result->getMZArray()->data[0], (100.0 * 1 + 100.002 * 3) / 4.0)
+  TEST_REAL_SIMILAR(result->getIntensityArray()->data[0], 4.0)
+  TEST_REAL_SIMILAR(result->getMZArray()->data[1], 101.0)
+  TEST_REAL_SIMILAR(result->getMZArray()->data[2], 101.5)
+  TEST_REAL_SIMILAR(result->getMZArray()->data[3], 102.0)
+  TEST_REAL_SIMILAR(result->getIntensityArray()->data[3], 0.0)
+  TEST_REAL_SIMILAR(result->getMZArray()->data[4], 103.002)
+  TEST_REAL_SIMILAR(result->getIntensityArray()->data[4], 8.0)
+
+  OpenSwath::SpectrumPtr result_filtered = SpectrumAddition::mergeSpectra(all_spectra, 0.005, true);
+  TEST_EQUAL(result_filtered->getMZArray()->data.size(), 4)
+  TEST_REAL_SIMILAR(result_filtered->getMZArray()->data[3], 103.002)
+
+  // peaks are only fused if they are within the tolerance of the first peak of a group
+  OpenSwath::SpectrumPtr result_tight = SpectrumAddition::mergeSpectra(all_spectra, 0.001, true);
+  TEST_EQUAL(result_tight->getMZArray()->data.size(), 6)
+}
+END_SECTION
+
+START_SECTION((static OpenMS::MSSpectrum<> addUpSpectra(const std::vector< OpenMS::MSSpectrum<> >& all_spectra, double sampling_rate, bool filter_zeros) ))
 {
   // Intensity
   static const double arr1[] = {
@@ -42,6 +42,7 @@
 #include <OpenMS/ANALYSIS/OPENSWATH/MRMFeatureFinderScoring.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/OPENSWATHALGO/DATAACCESS/SwathMap.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SimpleOpenMSSpectraAccessFactory.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessTransforming.h>
 
 using namespace OpenMS;
 
@@ -197,6 +198,31 @@ START_SECTION( static void correctMZ(OpenMS::MRMFeatureFinderScoring::Transition
       TEST_REAL_SIMILAR(data[3], -0.0219795 + 1.00003 * 800.02) // 800.02199576900
   }
 
+  // corrected spectra can be kept in memory
+  {
+      std::vector< OpenSwath::SwathMap > swath_maps;
+      swath_maps.push_back(map);
+      SwathMapMassCorrection::correctMZ(transition_group_map, swath_maps, "unweighted_regression", 1.0, false, true);
+      SpectrumAccessTransforming* corrected_map = dynamic_cast<SpectrumAccessTransforming*>(swath_maps[0].sptr.get());
+      TEST_NOT_EQUAL(corrected_map, (SpectrumAccessTransforming*)NULL)
+      ABORT_IF(corrected_map == NULL)
+      TEST_EQUAL(corrected_map->isCaching(), true)
+      OpenSwath::SpectrumPtr spectrum = swath_maps[0].sptr->getSpectrumById(0);
+      TEST_EQUAL(swath_maps[0].sptr->getSpectrumById(0) == spectrum, true)
+      TEST_REAL_SIMILAR(spectrum->getMZArray()->data[0], -0.0219795 + 1.00003 * 500.02)
+      TEST_REAL_SIMILAR(spectrum->getMZArray()->data[3], -0.0219795 + 1.00003 * 800.02)
+
+      // the MS1 map is never cached
+      std::vector< OpenSwath::SwathMap > ms1_maps;
+      ms1_maps.push_back(map);
+      ms1_maps[0].ms1 = true;
+      SwathMapMassCorrection::correctMZ(transition_group_map, ms1_maps, "unweighted_regression", 1.0, false, true);
+      corrected_map = dynamic_cast<SpectrumAccessTransforming*>(ms1_maps[0].sptr.get());
+      TEST_NOT_EQUAL(corrected_map, (SpectrumAccessTransforming*)NULL)
+      ABORT_IF(corrected_map == NULL)
+      TEST_EQUAL(corrected_map->isCaching(), false)
+  }
+
   {
       std::vector< OpenSwath::SwathMap > swath_maps;
       swath_maps.push_back(map);
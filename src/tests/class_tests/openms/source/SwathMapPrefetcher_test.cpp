@@ -0,0 +1,177 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2016.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/ANALYSIS/OPENSWATH/SwathMapPrefetcher.h>
+///////////////////////////
+
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessOpenMS.h>
+
+using namespace OpenMS;
+using namespace std;
+
+namespace
+{
+  OpenSwath::SwathMap createSwathMap(Size nr_spectra)
+  {
+    boost::shared_ptr<MSExperiment<> > exp(new MSExperiment<>);
+    for (Size i = 0; i < nr_spectra; ++i)
+    {
+      MSSpectrum<> spectrum;
+      spectrum.setMSLevel(2);
+      spectrum.setRT(10.0 * i);
+      Peak1D p;
+      p.setMZ(500.0);
+      p.setIntensity(100.0);
+      spectrum.push_back(p);
+      p.setMZ(600.0);
+      spectrum.push_back(p);
+      exp->addSpectrum(spectrum);
+    }
+    OpenSwath::SwathMap swath_map;
+    swath_map.sptr = OpenSwath::SpectrumAccessPtr(new SpectrumAccessOpenMS(exp));
+    return swath_map;
+  }
+}
+
+START_TEST(SwathMapPrefetcher, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+std::vector<OpenSwath::SwathMap> swath_maps;
+swath_maps.push_back(createSwathMap(3));
+swath_maps.push_back(createSwathMap(5));
+swath_maps.push_back(createSwathMap(7));
+
+std::vector<Size> load_order;
+load_order.push_back(2);
+load_order.push_back(0);
+
+SwathMapPrefetcher* ptr = 0;
+SwathMapPrefetcher* nullPointer = 0;
+
+START_SECTION((SwathMapPrefetcher(const std::vector<OpenSwath::SwathMap>& swath_maps, const std::vector<Size>& load_order, Size memory_budget)))
+{
+  ptr = new SwathMapPrefetcher(swath_maps, load_order, 1024);
+  TEST_NOT_EQUAL(ptr, nullPointer)
+  TEST_EQUAL(ptr->getMemoryUsage(), 0)
+}
+END_SECTION
+
+START_SECTION(~SwathMapPrefetcher())
+{
+  delete ptr;
+}
+END_SECTION
+
+START_SECTION((OpenSwath::SpectrumAccessPtr acquire(Size map_index)))
+{
+  // a budget of zero still loads every map that is requested
+  SwathMapPrefetcher prefetcher(swath_maps, load_order, 0);
+  prefetcher.start();
+
+  OpenSwath::SpectrumAccessPtr map = prefetcher.acquire(2);
+  TEST_EQUAL(map->getNrSpectra(), 7)
+  TEST_NOT_EQUAL(map.get(), swath_maps[2].sptr.get())
+  TEST_EQUAL(map->getSpectrumById(3)->getMZArray()->data.size(), 2)
+  TEST_REAL_SIMILAR(map->getSpectrumMetaById(3).RT, 30.0)
+
+  map = prefetcher.acquire(0);
+  TEST_EQUAL(map->getNrSpectra(), 3)
+  TEST_NOT_EQUAL(map.get(), swath_maps[0].sptr.get())
+
+  // maps that are not in the load order are passed through
+  map = prefetcher.acquire(1);
+  TEST_EQUAL(map.get(), swath_maps[1].sptr.get())
+}
+END_SECTION
+
+START_SECTION((void release(Size map_index)))
+{
+  SwathMapPrefetcher prefetcher(swath_maps, load_order, 1024 * 1024);
+  prefetcher.start();
+
+  prefetcher.acquire(2);
+  prefetcher.acquire(0);
+  // peak data plus the overhead of each spectrum
+  Size memory_both = prefetcher.getMemoryUsage();
+  TEST_EQUAL(memory_both > (7 + 3) * 2 * 2 * sizeof(double), true)
+  prefetcher.release(2);
+  Size memory_first = prefetcher.getMemoryUsage();
+  TEST_EQUAL(memory_first > 3 * 2 * 2 * sizeof(double), true)
+  TEST_EQUAL(memory_first < memory_both, true)
+  prefetcher.release(0);
+  TEST_EQUAL(prefetcher.getMemoryUsage(), 0)
+}
+END_SECTION
+
+START_SECTION((void stop()))
+{
+  SwathMapPrefetcher prefetcher(swath_maps, load_order, 0);
+  prefetcher.start();
+  prefetcher.stop();
+  prefetcher.wait();
+
+  // requested maps are still available (loaded or passed through)
+  TEST_EQUAL(prefetcher.acquire(0)->getNrSpectra(), 3)
+}
+END_SECTION
+
+START_SECTION(([EXTRA] acquire without the background thread))
+{
+  // workers load their own maps if the background thread has not started them
+  SwathMapPrefetcher prefetcher(swath_maps, load_order, 0);
+
+  OpenSwath::SpectrumAccessPtr map = prefetcher.acquire(0);
+  TEST_EQUAL(map->getNrSpectra(), 3)
+  TEST_NOT_EQUAL(map.get(), swath_maps[0].sptr.get())
+  TEST_EQUAL(prefetcher.getMemoryUsage() > 0, true)
+  prefetcher.release(0);
+  TEST_EQUAL(prefetcher.getMemoryUsage(), 0)
+}
+END_SECTION
+
+START_SECTION((Size getMemoryUsage() const))
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
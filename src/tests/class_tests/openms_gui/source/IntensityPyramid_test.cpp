@@ -0,0 +1,190 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2016.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: Timo Sachsenberg $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+
+#include <OpenMS/VISUAL/IntensityPyramid.h>
+
+///////////////////////////
+
+using namespace OpenMS;
+using namespace std;
+
+START_TEST(IntensityPyramid, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+IntensityPyramid* ptr = 0;
+IntensityPyramid* null_ptr = 0;
+START_SECTION((IntensityPyramid()))
+{
+  ptr = new IntensityPyramid();
+  TEST_NOT_EQUAL(ptr, null_ptr)
+  TEST_EQUAL(ptr->isReady(), false)
+  TEST_EQUAL(ptr->getLevelCount(), 0)
+}
+END_SECTION
+
+START_SECTION((~IntensityPyramid()))
+{
+  delete ptr;
+}
+END_SECTION
+
+// MS1 peaks at (RT, m/z, intensity): (0, 100, 1), (0, 150, 4), (5, 125, 2), (10, 200, 3) and one MS2 peak
+IntensityPyramid::ExperimentType exp;
+exp.resize(4);
+exp[0].setRT(0.0);
+exp[0].setMSLevel(1);
+exp[1].setRT(5.0);
+exp[1].setMSLevel(1);
+exp[2].setRT(6.0);
+exp[2].setMSLevel(2);
+exp[3].setRT(10.0);
+exp[3].setMSLevel(1);
+Peak1D p;
+p.setMZ(100.0);
+p.setIntensity(1.0f);
+exp[0].push_back(p);
+p.setMZ(150.0);
+p.setIntensity(4.0f);
+exp[0].push_back(p);
+p.setMZ(125.0);
+p.setIntensity(2.0f);
+exp[1].push_back(p);
+p.setMZ(100.0);
+p.setIntensity(100.0f);
+exp[2].push_back(p);
+p.setMZ(200.0);
+p.setIntensity(3.0f);
+exp[3].push_back(p);
+
+START_SECTION((void build(const ExperimentType &exp, Size rt_bins=1024, Size mz_bins=4096)))
+{
+  IntensityPyramid pyramid;
+  pyramid.build(exp, 2, 4);
+  TEST_EQUAL(pyramid.isReady(), true)
+  TEST_EQUAL(pyramid.getLevelCount(), 2)
+
+  const IntensityPyramid::Level& base = pyramid.getLevel(0);
+  TEST_EQUAL(base.rt_bins, 2)
+  TEST_EQUAL(base.mz_bins, 4)
+  TEST_REAL_SIMILAR(base.rt_step, 5.0)
+  TEST_REAL_SIMILAR(base.mz_step, 25.0)
+  TEST_REAL_SIMILAR(base.max_intensity[0], 1.0)
+  TEST_EQUAL(base.max_intensity[1] < 0.0, true)
+  TEST_REAL_SIMILAR(base.max_intensity[2], 4.0)
+  TEST_REAL_SIMILAR(base.max_intensity[5], 2.0)
+  TEST_REAL_SIMILAR(base.max_intensity[7], 3.0)
+
+  const IntensityPyramid::Level& top = pyramid.getLevel(1);
+  TEST_EQUAL(top.rt_bins, 1)
+  TEST_EQUAL(top.mz_bins, 2)
+  TEST_REAL_SIMILAR(top.max_intensity[0], 2.0)
+  TEST_REAL_SIMILAR(top.max_intensity[1], 4.0)
+  TEST_REAL_SIMILAR(top.sum_intensity[0], 3.0)
+  TEST_REAL_SIMILAR(top.sum_intensity[1], 7.0)
+
+  // no MS1 data
+  IntensityPyramid empty;
+  empty.build(IntensityPyramid::ExperimentType());
+  TEST_EQUAL(empty.isReady(), true)
+  TEST_EQUAL(empty.getLevelCount(), 0)
+}
+END_SECTION
+
+IntensityPyramid pyramid;
+pyramid.build(exp, 2, 4);
+
+START_SECTION((Size findLevel(double rt_extent, double mz_extent) const))
+{
+  TEST_EQUAL(pyramid.findLevel(10.0, 50.0), 1)
+  TEST_EQUAL(pyramid.findLevel(100.0, 30.0), 0)
+  TEST_EQUAL(pyramid.findLevel(1.0, 1.0), 2)
+}
+END_SECTION
+
+START_SECTION((float getMaxIntensity(Size index, double rt_min, double rt_max, double mz_min, double mz_max) const))
+{
+  TEST_REAL_SIMILAR(pyramid.getMaxIntensity(0, 0.0, 5.0, 100.0, 200.0), 4.0)
+  TEST_REAL_SIMILAR(pyramid.getMaxIntensity(0, 5.0, 10.0, 100.0, 200.0), 3.0)
+  TEST_REAL_SIMILAR(pyramid.getMaxIntensity(1, 0.0, 20.0, 100.0, 150.0), 2.0)
+  TEST_EQUAL(pyramid.getMaxIntensity(0, 0.0, 5.0, 130.0, 135.0) < 0.0, true)
+  TEST_EQUAL(pyramid.getMaxIntensity(0, 20.0, 30.0, 100.0, 200.0) < 0.0, true)
+}
+END_SECTION
+
+START_SECTION((double getSumIntensity(Size index, double rt_min, double rt_max, double mz_min, double mz_max) const))
+{
+  TEST_REAL_SIMILAR(pyramid.getSumIntensity(0, 0.0, 10.0, 100.0, 200.0), 10.0)
+  TEST_REAL_SIMILAR(pyramid.getSumIntensity(1, 0.0, 10.0, 100.0, 200.0), 10.0)
+  TEST_REAL_SIMILAR(pyramid.getSumIntensity(0, 0.0, 5.0, 100.0, 200.0), 5.0)
+}
+END_SECTION
+
+START_SECTION((void cancel()))
+{
+  IntensityPyramid cancelled;
+  cancelled.cancel();
+  cancelled.build(exp, 2, 4);
+  TEST_EQUAL(cancelled.isReady(), false)
+  TEST_EQUAL(cancelled.getLevelCount(), 0)
+}
+END_SECTION
+
+START_SECTION((bool isReady() const))
+{
+  TEST_EQUAL(pyramid.isReady(), true)
+}
+END_SECTION
+
+START_SECTION((Size getLevelCount() const))
+{
+  TEST_EQUAL(pyramid.getLevelCount(), 2)
+}
+END_SECTION
+
+START_SECTION((const Level& getLevel(Size index) const))
+{
+  TEST_EQUAL(pyramid.getLevel(1).mz_bins, 2)
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
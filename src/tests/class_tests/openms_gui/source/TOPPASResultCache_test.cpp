@@ -0,0 +1,211 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2016.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Johannes Veit $
+// $Authors: Chris Bielow $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+
+///////////////////////////
+
+#include <OpenMS/VISUAL/TOPPASResultCache.h>
+#include <OpenMS/FORMAT/TextFile.h>
+#include <OpenMS/SYSTEM/File.h>
+///////////////////////////
+
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+
+using namespace OpenMS;
+
+START_TEST(TOPPASResultCache, "$Id$")
+
+/////////////////////////////////////////////////////////////
+
+String cache_dir = File::getTempDirectory() + "/TOPPASResultCache_test_" + File::getUniqueName();
+String work_dir = cache_dir + "_work";
+QDir().mkpath(cache_dir.toQString());
+QDir().mkpath(work_dir.toQString());
+
+// writes a file with the given content
+#define WRITE_FILE(name, content) { TextFile tf; tf.addLine(content); tf.store(name); }
+
+String input = work_dir + "/input.txt";
+String database = work_dir + "/database.fasta";
+String output = work_dir + "/output.txt";
+WRITE_FILE(input, "input 1")
+WRITE_FILE(database, ">protein\nPEPTIDE")
+
+Param param;
+param.setValue("threshold", 0.5);
+param.setValue("database", database, "", ListUtils::create<String>("input file"));
+
+TOPPASResultCache::FileMap input_files, output_files;
+input_files[0].push_back(input.toQString());
+output_files[1].push_back(output.toQString());
+
+TOPPASResultCache* ptr = 0;
+TOPPASResultCache* null_ptr = 0;
+START_SECTION((TOPPASResultCache(const QString& cache_dir, Size max_size = 0)))
+{
+  ptr = new TOPPASResultCache(cache_dir.toQString());
+  TEST_NOT_EQUAL(ptr, null_ptr)
+}
+END_SECTION
+
+START_SECTION((virtual ~TOPPASResultCache()))
+{
+  delete ptr;
+}
+END_SECTION
+
+START_SECTION((const QString& getCacheDir() const))
+{
+  TOPPASResultCache cache(cache_dir.toQString());
+  TEST_EQUAL(String(cache.getCacheDir()), cache_dir)
+}
+END_SECTION
+
+START_SECTION((Size getMaxSize() const))
+{
+  TEST_EQUAL(TOPPASResultCache(cache_dir.toQString()).getMaxSize(), 0)
+  TEST_EQUAL(TOPPASResultCache(cache_dir.toQString(), 1024).getMaxSize(), 1024)
+}
+END_SECTION
+
+START_SECTION((String computeKey(const String& tool, const Param& param, const FileMap& input_files, const FileMap& output_files) const))
+{
+  TOPPASResultCache cache(cache_dir.toQString());
+  String key = cache.computeKey("Tool", param, input_files, output_files);
+  TEST_EQUAL(key.size(), 40) // SHA1
+  TEST_EQUAL(cache.computeKey("Tool", param, input_files, output_files), key)
+  TEST_NOT_EQUAL(cache.computeKey("OtherTool", param, input_files, output_files), key)
+
+  // output files enter by name only
+  TOPPASResultCache::FileMap moved_output_files;
+  moved_output_files[1].push_back((cache_dir + "/output.txt").toQString());
+  TEST_EQUAL(cache.computeKey("Tool", param, input_files, moved_output_files), key)
+
+  Param other_param = param;
+  other_param.setValue("threshold", 0.6);
+  TEST_NOT_EQUAL(cache.computeKey("Tool", other_param, input_files, output_files), key)
+
+  // the content of input files matters, also of those given as parameters
+  WRITE_FILE(input, "input 2")
+  TEST_NOT_EQUAL(cache.computeKey("Tool", param, input_files, output_files), key)
+  WRITE_FILE(input, "input 1")
+  TEST_EQUAL(cache.computeKey("Tool", param, input_files, output_files), key)
+  WRITE_FILE(database, ">protein\nPEPTIDER")
+  TEST_NOT_EQUAL(cache.computeKey("Tool", param, input_files, output_files), key)
+  WRITE_FILE(database, ">protein\nPEPTIDE")
+  TEST_EQUAL(cache.computeKey("Tool", param, input_files, output_files), key)
+}
+END_SECTION
+
+START_SECTION((bool store(const String& key, const FileMap& output_files) const))
+{
+  TOPPASResultCache cache(cache_dir.toQString());
+  WRITE_FILE(output, "output 1")
+  String key = cache.computeKey("Tool", param, input_files, output_files);
+  TEST_EQUAL(cache.store(key, output_files), true)
+  TEST_EQUAL(File::exists(cache_dir + "/" + key + "/complete"), true)
+
+  // a missing output file is not stored
+  TOPPASResultCache::FileMap missing_files;
+  missing_files[1].push_back((work_dir + "/missing.txt").toQString());
+  TEST_EQUAL(cache.store("missing", missing_files), false)
+  TEST_EQUAL(File::exists(cache_dir + "/missing/complete"), false)
+}
+END_SECTION
+
+START_SECTION((bool restore(const String& key, const FileMap& output_files) const))
+{
+  TOPPASResultCache cache(cache_dir.toQString());
+
+  // cache hit: the output is restored from the cache
+  String key = cache.computeKey("Tool", param, input_files, output_files);
+  WRITE_FILE(output, "overwritten")
+  TEST_EQUAL(cache.restore(key, output_files), true)
+  TEST_EQUAL(*TextFile(output).begin(), "output 1")
+
+  // cache miss after an input changed
+  WRITE_FILE(input, "input 2")
+  String changed_key = cache.computeKey("Tool", param, input_files, output_files);
+  TEST_NOT_EQUAL(changed_key, key)
+  TEST_EQUAL(cache.restore(changed_key, output_files), false)
+  WRITE_FILE(input, "input 1")
+
+  // an incomplete entry (e.g. an interrupted store) is not used
+  File::remove(cache_dir + "/" + key + "/complete");
+  TEST_EQUAL(cache.restore(key, output_files), false)
+}
+END_SECTION
+
+START_SECTION(([EXTRA] eviction of the least recently used entries))
+{
+  String lru_dir = cache_dir + "_lru";
+  QDir().mkpath(lru_dir.toQString());
+  // the output file has 9 bytes ("output 1" and a line break), i.e. two entries fit
+  TOPPASResultCache cache(lru_dir.toQString(), 20);
+  WRITE_FILE(output, "output 1")
+
+  // the time of the last use is recorded in ms, so make sure that it differs between the steps
+#define NEXT_MS { qint64 now = QDateTime::currentMSecsSinceEpoch(); while (QDateTime::currentMSecsSinceEpoch() == now) {} }
+  TEST_EQUAL(cache.store("a", output_files), true)
+  NEXT_MS
+  TEST_EQUAL(cache.store("b", output_files), true)
+  NEXT_MS
+  // "a" is used again after "b" was stored
+  TEST_EQUAL(cache.restore("a", output_files), true)
+  NEXT_MS
+  TEST_EQUAL(cache.store("c", output_files), true)
+  TEST_EQUAL(File::exists(lru_dir + "/a/complete"), true)
+  TEST_EQUAL(File::exists(lru_dir + "/b"), false)
+  TEST_EQUAL(File::exists(lru_dir + "/c/complete"), true)
+#undef NEXT_MS
+
+  // the entry just stored is kept, even if it exceeds the limit on its own
+  TOPPASResultCache small_cache(lru_dir.toQString(), 1);
+  TEST_EQUAL(small_cache.store("d", output_files), true)
+  TEST_EQUAL(File::exists(lru_dir + "/a"), false)
+  TEST_EQUAL(File::exists(lru_dir + "/c"), false)
+  TEST_EQUAL(small_cache.restore("d", output_files), true)
+
+  File::removeDirRecursively(lru_dir);
+}
+END_SECTION
+
+File::removeDirRecursively(cache_dir);
+File::removeDirRecursively(work_dir);
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
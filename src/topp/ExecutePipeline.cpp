@@ -110,6 +110,9 @@ protected:
     registerStringOption_("resource_file", "<file>", "", "A TOPPAS resource file (*.trf) specifying the files this workflow is to be applied to", false);
     registerIntOption_("num_jobs", "<integer>", 1, "Maximum number of jobs running in parallel", false, false);
     setMinInt_("num_jobs", 1);
+    registerStringOption_("cache_dir", "<directory>", "", "Directory for caching the results of the tools. Tools whose parameters and input files (by content) are unchanged since a previous run are not executed again, but their results are copied from the cache.", false, true);
+    registerIntOption_("cache_size", "<MB>", 0, "Maximal size (in MB) of the cache directory (see 'cache_dir'). If it is exceeded, the least recently used results are removed. 0 for no limit.", false, true);
+    setMinInt_("cache_size", 0);
   }
 
   ExitCodes main_(int argc, const char ** argv)
@@ -118,6 +121,7 @@ protected:
     QString out_dir_name = getStringOption_("out_dir").toQString();
     QString resource_file = getStringOption_("resource_file").toQString();
     int num_jobs = getIntOption_("num_jobs");
+    QString cache_dir = getStringOption_("cache_dir").toQString();
 
     QApplication a(argc, const_cast<char **>(argv), false);
 
@@ -137,6 +141,11 @@ protected:
 
     ts.load(toppas_file);
     ts.setAllowedThreads(num_jobs);
+    if (cache_dir != "")
+    {
+      ts.setCacheDir(QDir(cache_dir).absolutePath());
+      ts.setCacheMaxSize((Size)getIntOption_("cache_size") * 1024 * 1024);
+    }
 
     if (resource_file != "")
     {
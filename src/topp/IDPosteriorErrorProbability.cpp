@@ -36,8 +36,11 @@
 #include <OpenMS/APPLICATIONS/TOPPBase.h>
 #include <OpenMS/MATH/STATISTICS/PosteriorErrorProbabilityModel.h>
 #include <OpenMS/FORMAT/IdXMLFile.h>
+#include <OpenMS/FORMAT/ParamXMLFile.h>
 #include <OpenMS/CONCEPT/Exception.h>
 #include <boost/math/special_functions/fpclassify.hpp> // for "isnan"
+#include <boost/shared_ptr.hpp>
+#include <algorithm>
 #include <vector>
 
 using namespace OpenMS;
@@ -86,6 +89,10 @@ using namespace std;
     A peptide hit is assumed to be a target if its q-value is smaller than @p fdr_for_targets_smaller.
     The plots are saved as a Gnuplot file. An attempt is made to call Gnuplot, which will create a PDF file containing all steps of the estimation. If this fails, the user has to run Gnuplot manually - or adjust the PATH environment such that Gnuplot can be found and retry.
 
+    The parameters of the fitted models can be written to an INI file ('model_out'). When processing similar data sets (e.g. several runs of the same sample type),
+    this file can be passed to later runs ('model_in'), whose fits then start from these parameters instead of estimating the starting point from the data (warm start).
+    Models are matched by search engine and charge state; models without a match are fitted as usual.
+
     @note Currently mzIdentML (mzid) is not directly supported as an input/output format of this tool. Convert mzid files to/from idXML using @ref TOPP_IDFileConverter if necessary.
 
     <B>The command line parameters of this tool are:</B>
@@ -121,6 +128,10 @@ protected:
     setValidFormats_("out", ListUtils::create<String>("idXML"));
     registerOutputFile_("out_plot", "<file>", "", "txt file (if gnuplot is available, a corresponding PDF will be created as well.)", false);
     setValidFormats_("out_plot", ListUtils::create<String>("txt"));
+    registerInputFile_("model_in", "<file>", "", "Parameters of previously fitted models (see 'model_out'), used as the starting point of the fits of the same search engine and charge state (warm start).", false, true);
+    setValidFormats_("model_in", ListUtils::create<String>("ini"));
+    registerOutputFile_("model_out", "<file>", "", "Writes the parameters of the fitted models, e.g. to warm start the fits of similar data sets (see 'model_in').", false, true);
+    setValidFormats_("model_out", ListUtils::create<String>("ini"));
 
     registerFlag_("split_charge", "The search engine scores are split by charge if this flag is set. Thus, for each charge state a new model will be computed.");
     registerFlag_("top_hits_only", "If set only the top hits of every PeptideIdentification will be used");
@@ -131,6 +142,29 @@ protected:
     addEmptyLine_();
   }
 
+  /// writes the fitted parameters of @p model to section @p prefix of @p models
+  void storeModel_(Param& models, const String& prefix, PosteriorErrorProbabilityModel& model)
+  {
+    const GaussFitter::GaussFitResult incorrect = model.getIncorrectlyAssignedFitResult();
+    const GaussFitter::GaussFitResult correct = model.getCorrectlyAssignedFitResult();
+    models.setValue(prefix + "incorrect:A", incorrect.A);
+    models.setValue(prefix + "incorrect:x0", incorrect.x0);
+    models.setValue(prefix + "incorrect:sigma", incorrect.sigma);
+    models.setValue(prefix + "correct:A", correct.A);
+    models.setValue(prefix + "correct:x0", correct.x0);
+    models.setValue(prefix + "correct:sigma", correct.sigma);
+    models.setValue(prefix + "negative_prior", model.getNegativePrior());
+    models.setValue(prefix + "smallest_score", model.getSmallestScore());
+  }
+
+  /// uses the parameters in section @p prefix of @p models as the starting point of the fits of @p model
+  void loadModel_(const Param& models, const String& prefix, PosteriorErrorProbabilityModel& model)
+  {
+    GaussFitter::GaussFitResult incorrect(models.getValue(prefix + "incorrect:A"), models.getValue(prefix + "incorrect:x0"), models.getValue(prefix + "incorrect:sigma"));
+    GaussFitter::GaussFitResult correct(models.getValue(prefix + "correct:A"), models.getValue(prefix + "correct:x0"), models.getValue(prefix + "correct:sigma"));
+    model.setInitialParameters(incorrect, correct, models.getValue(prefix + "negative_prior"), models.getValue(prefix + "smallest_score"));
+  }
+
   //there is only one parameter at the moment
   Param getSubsectionDefaults_(const String& /*section*/) const
   {
@@ -239,6 +273,8 @@ protected:
     bool target_decoy_available = false;
     bool ignore_bad_data = getFlag_("ignore_bad_data");
     bool prob_correct = getFlag_("prob_correct");
+    String model_in = getStringOption_("model_in");
+    String model_out = getStringOption_("model_out");
 
     // Set fixed e-value threshold
     smallest_e_value_ = numeric_limits<double>::denorm_min();
@@ -254,8 +290,6 @@ protected:
     vector<double> decoy;
     vector<double> target;
     set<Int> charges;
-    PosteriorErrorProbabilityModel PEP_model;
-    PEP_model.setParameters(fit_algorithm);
     StringList search_engines = ListUtils::create<String>("XTandem,OMSSA,MASCOT,SpectraST,MyriMatch,SimTandem,MSGFPlus,MS-GF+,Comet");
     //-------------------------------------------------------------
     // calculations
@@ -380,25 +414,81 @@ protected:
     }
 
     String out_plot = fit_algorithm.getValue("out_plot").toString().trim();
+
+    // the models (one per search engine and charge state) are independent and can be fitted in parallel
+    vector<map<String, vector<vector<double> > >::iterator> score_its;
     for (map<String, vector<vector<double> > >::iterator score_it = all_scores.begin(); score_it != all_scores.end(); ++score_it)
+    {
+      score_its.push_back(score_it);
+    }
+    vector<boost::shared_ptr<PosteriorErrorProbabilityModel> > PEP_models(score_its.size());
+    vector<char> fit_results(score_its.size(), 0);
+    vector<Int> fit_charges(score_its.size(), -1);
+    for (Size i = 0; i < score_its.size(); ++i)
     {
       vector<String> engine_info;
-      score_it->first.split(splitter, engine_info);
-      String engine = engine_info[0];
-      Int charge = -1;
+      score_its[i]->first.split(splitter, engine_info);
       if (engine_info.size() == 2)
       {
-        charge = engine_info[1].toInt();
+        fit_charges[i] = engine_info[1].toInt();
       }
+      Param model_param = fit_algorithm;
       if (split_charge)
       {
         // only adapt plot output if plot is requested (this badly violates the output rules and needs to change!)
         // one way to fix this: plot charges into a single file (no renaming of output file needed) - but this requires major code restructuring
-        if (!out_plot.empty()) fit_algorithm.setValue("out_plot", out_plot + "_charge_" + String(charge));
-        PEP_model.setParameters(fit_algorithm);
+        if (!out_plot.empty()) model_param.setValue("out_plot", out_plot + "_charge_" + String(fit_charges[i]));
       }
+      PEP_models[i] = boost::shared_ptr<PosteriorErrorProbabilityModel>(new PosteriorErrorProbabilityModel());
+      PEP_models[i]->setParameters(model_param);
+    }
 
-      const bool return_value = PEP_model.fit(score_it->second[0]);
+    // warm start from the models of a previous run (matched by search engine and charge state)
+    if (!model_in.empty())
+    {
+      Param models;
+      ParamXMLFile().load(model_in, models);
+      StringList model_keys;
+      if (models.exists("models")) model_keys = models.getValue("models");
+      for (Size i = 0; i < score_its.size(); ++i)
+      {
+        StringList::const_iterator key_it = find(model_keys.begin(), model_keys.end(), score_its[i]->first);
+        if (key_it == model_keys.end())
+        {
+          writeLog_("No model in '" + model_in + "' for '" + score_its[i]->first + "'. Its starting point is estimated from the data.");
+          continue;
+        }
+        try
+        {
+          loadModel_(models, "model_" + String(key_it - model_keys.begin()) + ":", *PEP_models[i]);
+        }
+        catch (Exception::BaseException& e)
+        {
+          writeLog_("Model for '" + score_its[i]->first + "' in '" + model_in + "' is invalid (" + String(e.what()) + "). Its starting point is estimated from the data.");
+        }
+      }
+    }
+
+    // plotting calls gnuplot and writes to the log, so only fit in parallel without plots
+    const bool parallel_fit = out_plot.empty();
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1) if (parallel_fit)
+#endif
+    for (SignedSize i = 0; i < (SignedSize)score_its.size(); ++i)
+    {
+      fit_results[i] = PEP_models[i]->fit(score_its[i]->second[0]);
+    }
+
+    for (Size i = 0; i < score_its.size(); ++i)
+    {
+      map<String, vector<vector<double> > >::iterator score_it = score_its[i];
+      PosteriorErrorProbabilityModel& PEP_model = *PEP_models[i];
+      vector<String> engine_info;
+      score_it->first.split(splitter, engine_info);
+      String engine = engine_info[0];
+      Int charge = fit_charges[i];
+
+      const bool return_value = fit_results[i];
       if (!return_value) writeLog_("Unable to fit data. Algorithm did not run through for the following search engine: " + engine);
       if (!return_value && !ignore_bad_data) return UNEXPECTED_RESULT;
 
@@ -477,6 +567,20 @@ protected:
     // writing output
     //-------------------------------------------------------------
     file.store(outputfile_name, protein_ids, peptide_ids);
+
+    if (!model_out.empty())
+    {
+      Param models;
+      StringList model_keys;
+      for (Size i = 0; i < score_its.size(); ++i)
+      {
+        if (!fit_results[i]) continue;
+        storeModel_(models, "model_" + String(model_keys.size()) + ":", *PEP_models[i]);
+        model_keys.push_back(score_its[i]->first);
+      }
+      models.setValue("models", model_keys, "search engine (and charge state) of the models");
+      ParamXMLFile().store(model_out, models);
+    }
     return EXECUTION_OK;
   }
 
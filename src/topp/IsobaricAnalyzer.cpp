@@ -186,6 +186,9 @@ protected:
     registerOutputFile_("out", "<file>", "", "output consensusXML file with quantitative information");
     setValidFormats_("out", ListUtils::create<String>("consensusXML"));
 
+    registerStringOption_("processOption", "<name>", "inmemory", "Whether to load all data and process them in-memory or whether to extract the channels on the fly (lowmemory) without loading the whole file into memory first", false, true);
+    setValidStrings_("processOption", ListUtils::create<String>("inmemory,lowmemory"));
+
     registerSubsection_("extraction", "Parameters for the channel extraction.");
     registerSubsection_("quantification", "Parameters for the peptide quantification.");
     for (std::map<String, IsobaricQuantitationMethod*>::iterator it = quant_methods_.begin();
@@ -231,15 +234,6 @@ protected:
     String in = getStringOption_("in");
     String out = getStringOption_("out");
 
-    //-------------------------------------------------------------
-    // loading input
-    //-------------------------------------------------------------
-
-    MzMLFile mz_data_file;
-    MSExperiment<Peak1D> exp;
-    mz_data_file.setLogType(log_type_);
-    mz_data_file.load(in, exp);
-
     //-------------------------------------------------------------
     // init quant method
     //-------------------------------------------------------------
@@ -249,7 +243,7 @@ protected:
     quant_method->setParameters(getParam_().copy(quant_method->getName() + ":", true));
 
     //-------------------------------------------------------------
-    // calculations
+    // loading input & calculations
     //-------------------------------------------------------------
     Param extract_param(getParam_().copy("extraction:", true));
     IsobaricChannelExtractor channel_extractor(quant_method);
@@ -257,8 +251,23 @@ protected:
 
     ConsensusMap consensus_map_raw, consensus_map_quant;
 
+    MzMLFile mz_data_file;
+    mz_data_file.setLogType(log_type_);
+
     // extract channel information
-    channel_extractor.extractChannels(exp, consensus_map_raw);
+    if (getStringOption_("processOption") == "lowmemory")
+    {
+      IsobaricChannelExtractor::ExtractionConsumer consumer(channel_extractor, consensus_map_raw);
+      mz_data_file.transform(in, &consumer);
+      consumer.finish();
+    }
+    else
+    {
+      MSExperiment<Peak1D> exp;
+      mz_data_file.load(in, exp);
+      channel_extractor.extractChannels(exp, consensus_map_raw);
+      consensus_map_raw.setPrimaryMSRunPath(exp.getPrimaryMSRunPath());
+    }
 
     IsobaricQuantifier quantifier(quant_method);
     Param quant_param(getParam_().copy("quantification:", true));
@@ -285,7 +294,7 @@ protected:
     }
 
     consensus_map_quant.ensureUniqueId();
-    consensus_map_quant.setPrimaryMSRunPath(exp.getPrimaryMSRunPath());
+    consensus_map_quant.setPrimaryMSRunPath(consensus_map_raw.getPrimaryMSRunPath());
     ConsensusXMLFile().store(out, consensus_map_quant);
 
     return EXECUTION_OK;
@@ -233,7 +233,9 @@ protected:
       return EXECUTION_OK;
     }
 
-    // Here we deal with SWATH files (can be multiple files)
+    // Here we deal with SWATH files (can be multiple files). Each file writes
+    // its features into its own slot, they are merged in input order below.
+    std::vector<FeatureMap> file_features(file_list.size());
     // Only in OpenMP 3.0 are unsigned loop variables allowed
 #ifdef _OPENMP
 #pragma omp parallel for
@@ -243,7 +245,7 @@ protected:
       MRMFeatureFinderScoring featureFinder;
       MzMLFile swath_file;
       boost::shared_ptr<MapType> swath_map (new MapType());
-      FeatureMap featureFile;
+      FeatureMap& featureFile = file_features[i];
       cout << "Loading file " << file_list[i] << endl;
 
 ////#ifndef _OPENMP
@@ -281,29 +283,29 @@ protected:
         swath_maps[0].sptr = swath_ptr;
         featureFinder.pickExperiment(chromatogram_ptr, featureFile,
                                      transition_exp_used, trafo, swath_maps, transition_group_map);
-
-        // write all features and the protein identifications from tmp_featureFile into featureFile
-#ifdef _OPENMP
-#pragma omp critical (featureFinder)
-#endif
-        {
-          for (FeatureMap::iterator feature_it = featureFile.begin();
-               feature_it != featureFile.end(); ++feature_it)
-          {
-            out_featureFile.push_back(*feature_it);
-          }
-          for (std::vector<ProteinIdentification>::iterator protid_it =
-                 featureFile.getProteinIdentifications().begin();
-               protid_it != featureFile.getProteinIdentifications().end();
-               ++protid_it)
-          {
-            out_featureFile.getProteinIdentifications().push_back(*protid_it);
-          }
-
-        }
       } // end of do_continue
     } // end of loop over all files / end of OpenMP
 
+    // write all features and the protein identifications of the individual files into out_featureFile
+    Size nr_features = 0;
+    for (Size i = 0; i < file_features.size(); ++i)
+    {
+      nr_features += file_features[i].size();
+    }
+    out_featureFile.reserve(nr_features);
+    for (Size i = 0; i < file_features.size(); ++i)
+    {
+      FeatureMap& featureFile = file_features[i];
+      for (FeatureMap::const_iterator feature_it = featureFile.begin(); feature_it != featureFile.end(); ++feature_it)
+      {
+        out_featureFile.push_back(*feature_it);
+      }
+      out_featureFile.getProteinIdentifications().insert(out_featureFile.getProteinIdentifications().end(),
+                                                         featureFile.getProteinIdentifications().begin(),
+                                                         featureFile.getProteinIdentifications().end());
+      featureFile.clear(true);
+    }
+
     addDataProcessing_(out_featureFile, getProcessingInfo_(DataProcessing::QUANTITATION));
     out_featureFile.ensureUniqueId();
     FeatureXMLFile().store(out, out_featureFile);
@@ -36,18 +36,26 @@
 #include <OpenMS/APPLICATIONS/TOPPBase.h>
 #include <OpenMS/METADATA/PeptideIdentification.h>
 #include <OpenMS/CONCEPT/Factory.h>
+#include <OpenMS/ANALYSIS/ID/SpectralLibraryIndex.h>
 #include <OpenMS/FORMAT/MSPFile.h>
 #include <OpenMS/FORMAT/IdXMLFile.h>
+#include <OpenMS/FORMAT/FileHandler.h>
 #include <OpenMS/COMPARISON/SPECTRA/BinnedSpectrum.h>
 #include <OpenMS/COMPARISON/SPECTRA/SpectraSTSimilarityScore.h>
 #include <OpenMS/COMPARISON/SPECTRA/ZhangSimilarityScore.h>
 #include <OpenMS/CHEMISTRY/ModificationsDB.h>
 #include <OpenMS/MATH/MISC/MathFunctions.h>
+#include <OpenMS/SYSTEM/File.h>
 
 #include <ctime>
 #include <vector>
 #include <map>
+#include <queue>
 #include <cmath>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 using namespace OpenMS;
 using namespace std;
 
@@ -74,6 +82,15 @@ using namespace std;
     </table>
 </CENTER>
 
+    The library is preprocessed once and held in a precursor m/z sorted index
+    (see SpectralLibraryIndex). With @p lib_cache the preprocessed index is
+    written to a binary file, which is loaded instead of the MSP library in
+    subsequent runs with the same library (identified by its path and content)
+    and filter settings. An outdated or unreadable cache is rebuilt.
+
+    Query spectra are searched in parallel (see the @p threads parameter); only
+    the best @p top_hits candidates of each query are kept while scoring.
+
     @experimental This TOPP-tool is not well tested and not all features might be properly implemented and tested.
 
     @note Currently mzIdentML (mzid) is not directly supported as an input/output format of this tool. Convert mzid files to/from idXML using @ref TOPP_IDFileConverter if necessary.
@@ -103,10 +120,11 @@ protected:
     setValidFormats_("in", ListUtils::create<String>("mzML"));
     registerInputFile_("lib", "<file>", "", "searchable spectral library (MSP format)");
     setValidFormats_("lib", ListUtils::create<String>("msp"));
+    registerStringOption_("lib_cache", "<file>", "", "binary cache of the preprocessed spectral library. Loaded instead of 'lib' if it exists and was created from the same library (path and content) and filter settings, otherwise (re-)created.", false, true);
     registerOutputFileList_("out", "<files>", ListUtils::create<String>(""), "Output files. Have to be as many as input files");
     setValidFormats_("out", ListUtils::create<String>("idXML"));
     registerDoubleOption_("precursor_mass_tolerance", "<tolerance>", 3, "Precursor mass tolerance, (Th)", false);
-    registerIntOption_("round_precursor_to_integer", "<number>", 10, "many precursor m/z multipling number lead to the same number; are packed in the same vector for faster search.Should be higher for high-resolution data", false, true);
+    registerIntOption_("round_precursor_to_integer", "<number>", 10, "(deprecated, no effect) the library is indexed by exact precursor m/z", false, true);
     // registerDoubleOption_("fragment_mass_tolerance","<tolerance>",0.3,"Fragment mass error",false);
 
     // registerStringOption_("precursor_error_units", "<unit>", "Da", "parent monoisotopic mass error units", false);
@@ -139,6 +157,19 @@ protected:
     addEmptyLine_();
   }
 
+  /// library candidate of a query spectrum, ordered by score
+  struct LibraryCandidate
+  {
+    double score;
+    double dot_bias;
+    Size index;
+
+    bool operator>(const LibraryCandidate& rhs) const
+    {
+      return score > rhs.score;
+    }
+  };
+
   ExitCodes main_(int, const char**)
   {
     //-------------------------------------------------------------
@@ -148,8 +179,8 @@ protected:
     StringList in_spec = getStringList_("in");
     StringList out = getStringList_("out");
     String in_lib = getStringOption_("lib");
+    String lib_cache = getStringOption_("lib_cache");
     String compare_function = getStringOption_("compare_function");
-    Int precursor_mass_multiplier = getIntOption_("round_precursor_to_integer");
     float precursor_mass_tolerance = getDoubleOption_("precursor_mass_tolerance");
     //Int min_precursor_charge = getIntOption_("min_precursor_charge");
     //Int max_precursor_charge = getIntOption_("max_precursor_charge");
@@ -175,33 +206,57 @@ protected:
     }
 
     time_t prog_time = time(NULL);
-    MSPFile spectral_library;
-    RichPeakMap query, library;
+    RichPeakMap query;
     //spectrum which will be identified
     MzMLFile spectra;
     spectra.setLogType(log_type_);
 
     time_t start_build_time = time(NULL);
     //-------------------------------------------------------------
-    //building map for faster search
+    //building index for faster search
     //-------------------------------------------------------------
 
-    //library containing already identified peptide spectra
-    vector<PeptideIdentification> ids;
-    spectral_library.load(in_lib, ids, library);
+    // everything that influences the preprocessed library (including its content); a cache is only reused if this matches
+    String library_tag = File::absolutePath(in_lib) + ";" + FileHandler::computeFileHash(in_lib) + ";" + String(remove_peaks_below_threshold) + ";" +
+                         ListUtils::concatenate(fixed_modifications, ",") + ";" + ListUtils::concatenate(variable_modifications, ",");
+
+    SpectralLibraryIndex MSLibrary;
+    bool cache_loaded = false;
+    if (!lib_cache.empty() && File::exists(lib_cache))
+    {
+      try
+      {
+        MSLibrary.load(lib_cache);
+        if (MSLibrary.getTag() == library_tag)
+        {
+          cache_loaded = true;
+        }
+        else
+        {
+          writeLog_("Spectral library cache '" + lib_cache + "' was created with a different library or settings and will be rebuilt.");
+          MSLibrary.clear();
+        }
+      }
+      catch (Exception::BaseException& e)
+      {
+        writeLog_("Spectral library cache '" + lib_cache + "' could not be read (" + String(e.what()) + ") and will be rebuilt.");
+        MSLibrary.clear();
+      }
+    }
 
-    map<Size, vector<PeakSpectrum> > MSLibrary;
+    if (!cache_loaded)
     {
+      //library containing already identified peptide spectra
+      MSPFile spectral_library;
+      RichPeakMap library;
+      vector<PeptideIdentification> ids;
+      spectral_library.load(in_lib, ids, library);
+
       RichPeakMap::iterator s_it;
       vector<PeptideIdentification>::iterator it;
       ModificationsDB* mdb = ModificationsDB::getInstance();
       for (s_it = library.begin(), it = ids.begin(); s_it < library.end(); ++s_it, ++it)
       {
-        double precursor_MZ = (*s_it).getPrecursors()[0].getMZ();
-        Size MZ_multi = (Size)precursor_MZ * precursor_mass_multiplier;
-        map<Size, vector<PeakSpectrum> >::iterator found;
-        found = MSLibrary.find(MZ_multi);
-
         PeakSpectrum librar;
         bool variable_modifications_ok = true;
         bool fixed_modifications_ok = true;
@@ -243,8 +298,6 @@ protected:
         }
         if (variable_modifications_ok && fixed_modifications_ok)
         {
-          PeptideIdentification& translocate_pid = *it;
-          librar.getPeptideIdentifications().push_back(translocate_pid);
           librar.setPrecursors(s_it->getPrecursors());
           //library entry transformation
           for (UInt l = 0; l < s_it->size(); ++l)
@@ -267,27 +320,36 @@ protected:
               librar.push_back(peak);
             }
           }
-          if (found != MSLibrary.end())
-          {
-            found->second.push_back(librar);
-          }
-          else
-          {
-            vector<PeakSpectrum> tmp;
-            tmp.push_back(librar);
-            MSLibrary.insert(make_pair(MZ_multi, tmp));
-          }
+          MSLibrary.addEntry(librar, it->getHits()[0]);
         }
       }
+      MSLibrary.sortByPrecursorMZ();
+      MSLibrary.setTag(library_tag);
+      if (!lib_cache.empty())
+      {
+        MSLibrary.store(lib_cache);
+      }
     }
     time_t end_build_time = time(NULL);
     cout << "Time needed for preprocessing data: " << (end_build_time - start_build_time) << "\n";
-    //compare function
-    PeakSpectrumCompareFunctor* comparor = Factory<PeakSpectrumCompareFunctor>::create(compare_function);
+
+    //compare function (one per thread)
+#ifdef _OPENMP
+    Size thread_count = omp_get_max_threads();
+#else
+    Size thread_count = 1;
+#endif
+    vector<PeakSpectrumCompareFunctor*> comparors;
+    for (Size t = 0; t < thread_count; ++t)
+    {
+      comparors.push_back(Factory<PeakSpectrumCompareFunctor>::create(compare_function));
+    }
+    bool spectrast_score = (compare_function == "SpectraSTSimilarityScore");
+    // SpectraST scores are rescaled using the runner-up, thus all candidates are kept in this case
+    bool keep_top_hits_only = (top_hits != -1 && !spectrast_score);
     //-------------------------------------------------------------
     // calculations
     //-------------------------------------------------------------
-    double score;
     StringList::iterator in, out_file;
     for (in  = in_spec.begin(), out_file  = out.begin(); in < in_spec.end(); ++in, ++out_file)
     {
@@ -306,16 +368,32 @@ protected:
       ProteinIdentification::SearchParameters searchparam;
       searchparam.precursor_mass_tolerance = precursor_mass_tolerance;
       prot_id.setSearchParameters(searchparam);
-      /***********SEARCH**********/
       for (UInt j = 0; j < query.size(); ++j)
       {
-        //Set identifier for each identifications
-        PeptideIdentification pid;
-        pid.setIdentifier("test");
-        pid.setScoreType(compare_function);
         ProteinHit pr_hit;
         pr_hit.setAccession(j);
         prot_id.insertHit(pr_hit);
+      }
+
+      // results per query spectrum, collected in input order after the search
+      vector<PeptideIdentification> query_ids(query.size());
+      vector<Int> query_searched(query.size(), 0);
+      /***********SEARCH**********/
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 10)
+#endif
+      for (SignedSize j = 0; j < (SignedSize)query.size(); ++j)
+      {
+#ifdef _OPENMP
+        PeakSpectrumCompareFunctor* comparor = comparors[omp_get_thread_num()];
+#else
+        PeakSpectrumCompareFunctor* comparor = comparors[0];
+#endif
+        //Set identifier for each identifications
+        PeptideIdentification& pid = query_ids[j];
+        pid.setIdentifier("test");
+        pid.setScoreType(compare_function);
+        const String accession = prot_id.getHits()[j].getAccession();
         //RichPeak1D to Peak1D transformation for the compare function query
         PeakSpectrum quer;
         bool peak_ok = true;
@@ -328,6 +406,9 @@ protected:
         }
         if (query[j].getPrecursors().empty())
         {
+#ifdef _OPENMP
+#pragma omp critical (SpecLibSearcher_log)
+#endif
           writeLog_("Warning MS2 spectrum without precursor information");
           continue;
         }
@@ -371,54 +452,65 @@ protected:
           {
             charge_one = true;
           }
-          float min_MZ = (query_MZ - precursor_mass_tolerance) * precursor_mass_multiplier;
-          float max_MZ = (query_MZ + precursor_mass_tolerance) * precursor_mass_multiplier;
-          for (Size mz = (Size)min_MZ; mz <= ((Size)max_MZ) + 1; ++mz)
+
+          // keep the best candidates in a heap with the lowest score on top
+          priority_queue<LibraryCandidate, vector<LibraryCandidate>, greater<LibraryCandidate> > candidates;
+          Size first, last;
+          MSLibrary.getEntriesInRange(query_MZ - precursor_mass_tolerance, query_MZ + precursor_mass_tolerance, first, last);
+          PeakSpectrum librar;
+          for (Size i = first; i < last; ++i)
           {
-            map<Size, vector<PeakSpectrum> >::iterator found;
-            found = MSLibrary.find(mz);
-            if (found != MSLibrary.end())
+            if (charge_one && MSLibrary.getCharge(i) != 1)
             {
-              vector<PeakSpectrum>& library = found->second;
-              for (Size i = 0; i < library.size(); ++i)
-              {
-                float this_MZ  = library[i].getPrecursors()[0].getMZ() * precursor_mass_multiplier;
-                if (this_MZ >= min_MZ && max_MZ >= this_MZ && ((charge_one == true && library[i].getPeptideIdentifications()[0].getHits()[0].getCharge() == 1) || charge_one == false))
-                {
-                  PeptideHit hit = library[i].getPeptideIdentifications()[0].getHits()[0];
-                  PeakSpectrum& librar = library[i];
-                  //Special treatment for SpectraST score as it computes a score based on the whole library
-                  if (compare_function == "SpectraSTSimilarityScore")
-                  {
-                    SpectraSTSimilarityScore* sp = static_cast<SpectraSTSimilarityScore*>(comparor);
-                    BinnedSpectrum quer_bin = sp->transform(quer);
-                    BinnedSpectrum librar_bin = sp->transform(librar);
-                    score = (*sp)(quer, librar); //(*sp)(quer_bin,librar_bin);
-                    double dot_bias = sp->dot_bias(quer_bin, librar_bin, score);
-                    hit.setMetaValue("DOTBIAS", dot_bias);
-                  }
-                  else
-                  {
-                    score = (*comparor)(quer, librar);
-                  }
-
-                  DataValue RT(library[i].getRT());
-                  DataValue MZ(library[i].getPrecursors()[0].getMZ());
-                  hit.setMetaValue("RT", RT);
-                  hit.setMetaValue("MZ", MZ);
-                  hit.setScore(score);
-                  PeptideEvidence pe;
-                  pe.setProteinAccession(pr_hit.getAccession());
-                  hit.addPeptideEvidence(pe);
-                  pid.insertHit(hit);
-                }
-              }
+              continue;
+            }
+            MSLibrary.getSpectrum(i, librar);
+            LibraryCandidate candidate;
+            candidate.index = i;
+            candidate.dot_bias = 0.0;
+            //Special treatment for SpectraST score as it computes a score based on the whole library
+            if (spectrast_score)
+            {
+              SpectraSTSimilarityScore* sp = static_cast<SpectraSTSimilarityScore*>(comparor);
+              BinnedSpectrum quer_bin = sp->transform(quer);
+              BinnedSpectrum librar_bin = sp->transform(librar);
+              candidate.score = (*sp)(quer, librar); //(*sp)(quer_bin,librar_bin);
+              candidate.dot_bias = sp->dot_bias(quer_bin, librar_bin, candidate.score);
             }
+            else
+            {
+              candidate.score = (*comparor)(quer, librar);
+            }
+
+            candidates.push(candidate);
+            if (keep_top_hits_only && candidates.size() > (Size)top_hits)
+            {
+              candidates.pop();
+            }
+          }
+
+          for (; !candidates.empty(); candidates.pop())
+          {
+            const LibraryCandidate& candidate = candidates.top();
+            PeptideHit hit = MSLibrary.getPeptideHit(candidate.index);
+            if (spectrast_score)
+            {
+              hit.setMetaValue("DOTBIAS", candidate.dot_bias);
+            }
+            DataValue RT(MSLibrary.getRT(candidate.index));
+            DataValue MZ(MSLibrary.getPrecursorMZ(candidate.index));
+            hit.setMetaValue("RT", RT);
+            hit.setMetaValue("MZ", MZ);
+            hit.setScore(candidate.score);
+            PeptideEvidence pe;
+            pe.setProteinAccession(accession);
+            hit.addPeptideEvidence(pe);
+            pid.insertHit(hit);
           }
         }
         pid.setHigherScoreBetter(true);
         pid.sort();
-        if (compare_function == "SpectraSTSimilarityScore")
+        if (spectrast_score)
         {
           if (!pid.empty() && !pid.getHits().empty())
           {
@@ -459,7 +551,14 @@ protected:
           }
           pid.setHits(hits);
         }
-        peptide_ids.push_back(pid);
+        query_searched[j] = 1;
+      }
+      for (Size j = 0; j < query_ids.size(); ++j)
+      {
+        if (query_searched[j])
+        {
+          peptide_ids.push_back(query_ids[j]);
+        }
       }
       protein_ids.push_back(prot_id);
       //-------------------------------------------------------------
@@ -470,6 +569,10 @@ protected:
       time_t end_time = time(NULL);
       cout << "Search time: " << difftime(end_time, start_time) << " seconds for " << *in << "\n";
     }
+    for (Size t = 0; t < comparors.size(); ++t)
+    {
+      delete comparors[t];
+    }
     time_t end_time = time(NULL);
     cout << "Total time: " << difftime(end_time, prog_time) << " secconds\n";
     return EXECUTION_OK;
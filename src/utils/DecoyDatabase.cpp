@@ -34,8 +34,10 @@
 
 #include <OpenMS/FORMAT/IdXMLFile.h>
 #include <OpenMS/FORMAT/FASTAFile.h>
+#include <OpenMS/FORMAT/IndexedFASTAFile.h>
 #include <OpenMS/METADATA/ProteinIdentification.h>
 #include <OpenMS/APPLICATIONS/TOPPBase.h>
+#include <OpenMS/SYSTEM/File.h>
 
 using namespace OpenMS;
 using namespace std;
@@ -59,6 +61,8 @@ using namespace std;
   This allows you to specify your target database plus a contaminant file and obtain a concatenated
   target-decoy database using a single call, e.g., DecoyDatabase -in human.fasta crap.fasta -out human_TD.fasta
 
+  The input files are read while the output is written, so the output file must not be one of the input files.
+
 
   <B>The command line parameters of this tool are:</B>
   @verbinclude UTILS_DecoyDatabase.cli
@@ -110,100 +114,94 @@ protected:
     bool append = (!getFlag_("only_decoy"));
     bool shuffle = (getStringOption_("method") == "shuffle");
 
-    //-------------------------------------------------------------
-    // reading input
-    //-------------------------------------------------------------
+    if (in.size() == 1)
+    {
+      LOG_WARN << "Warning: Only one FASTA input file was provided, which might not contain contaminants. You probably want to have them! Just add the contaminant file to the input file list 'in'." << endl;
+    }
+
+    String decoy_string(getStringOption_("decoy_string"));
+    bool decoy_string_position_prefix =   (String(getStringOption_("decoy_string_position")) == "prefix" ? true : false);
 
-    vector<FASTAFile::FASTAEntry> proteins;
-    for (Size i=0; i<in.size(); ++i)
+    // the inputs are read while the output is written, so the output must not be one of them
+    for (Size i = 0; i < in.size(); ++i)
     {
-      vector<FASTAFile::FASTAEntry> single_proteins;
-      // this is a little inefficient since it requires copying; appending during load() would be better...
-      FASTAFile().load(in[i], single_proteins);  
-      // append
-      proteins.insert(proteins.end(), single_proteins.begin(), single_proteins.end());
+      if (File::absolutePath(in[i]) == File::absolutePath(out))
+      {
+        writeLog_("Error: The output file '" + out + "' is also given as input. Aborting!");
+        return ILLEGAL_PARAMETERS;
+      }
     }
 
-    if (in.size() == 1)
+    ofstream outfile(out.c_str());
+    if (!outfile.good())
     {
-      LOG_WARN << "Warning: Only one FASTA input file was provided, which might not contain contaminants. You probably want to have them! Just add the contaminant file to the input file list 'in'." << endl;
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, out);
     }
 
+    // the input databases are not loaded, but read entry by entry from the
+    // memory mapped files: first all targets are written, then all decoys
+    IndexedFASTAFile fasta;
+    FASTAFile::FASTAEntry entry;
+
     //-------------------------------------------------------------
-    // calculations
+    // writing targets
     //-------------------------------------------------------------
 
-    String decoy_string(getStringOption_("decoy_string"));
-    bool decoy_string_position_prefix =   (String(getStringOption_("decoy_string_position")) == "prefix" ? true : false);
-    Size num_proteins = proteins.size();
     set<String> identifiers;
-    if (shuffle)
+    for (Size i = 0; i < in.size(); ++i)
     {
-      for (Size i = 0; i < num_proteins; ++i)
+      fasta.open(in[i]);
+      for (Size j = 0; j < fasta.size(); ++j)
       {
-        if (identifiers.find(proteins[i].identifier) != identifiers.end())
-        {
-          LOG_WARN << "DecoyDatabase: Warning, identifier is not unique to sequence file: '" << proteins[i].identifier << "'!" << endl;
-        }
-        identifiers.insert(proteins[i].identifier);
-
-        FASTAFile::FASTAEntry entry = proteins[i];
-
-        String pro_seq, temp;
-        pro_seq = entry.sequence;
-        Size x = pro_seq.size();
-        srand(time(0));
-        while (x != 0)
+        fasta.getEntry(j, entry);
+        if (identifiers.find(entry.identifier) != identifiers.end())
         {
-          Size y = rand() % x;
-          temp += pro_seq[y];
-          pro_seq[y] = pro_seq[x - 1];
-          --x;
+          LOG_WARN << "DecoyDatabase: Warning, identifier is not unique to sequence file: '" << entry.identifier << "'!" << endl;
         }
-        entry.sequence = temp;
+        identifiers.insert(entry.identifier);
 
         if (append)
         {
-          entry.identifier = getIdentifier_(entry.identifier, decoy_string, decoy_string_position_prefix);
-          proteins.push_back(entry);
-        }
-        else
-        {
-          proteins[i].sequence = entry.sequence;
-          proteins[i].identifier = getIdentifier_(proteins[i].identifier, decoy_string, decoy_string_position_prefix);
+          FASTAFile::writeEntry(outfile, entry);
         }
       }
     }
-    else         // !shuffle
+
+    //-------------------------------------------------------------
+    // writing decoys
+    //-------------------------------------------------------------
+
+    for (Size i = 0; i < in.size(); ++i)
     {
-      for (Size i = 0; i < num_proteins; ++i)
+      fasta.open(in[i]);
+      for (Size j = 0; j < fasta.size(); ++j)
       {
-        if (identifiers.find(proteins[i].identifier) != identifiers.end())
+        fasta.getEntry(j, entry);
+        if (shuffle)
         {
-          LOG_WARN << "DecoyDatabase: Warning, identifier is not unique to sequence file: '" << proteins[i].identifier << "'!" << endl;
-        }
-        identifiers.insert(proteins[i].identifier);
-
-        if (append)
-        {
-          FASTAFile::FASTAEntry entry = proteins[i];
-          entry.sequence.reverse();
-          entry.identifier = getIdentifier_(entry.identifier, decoy_string, decoy_string_position_prefix);
-          proteins.push_back(entry);
+          String pro_seq, temp;
+          pro_seq = entry.sequence;
+          Size x = pro_seq.size();
+          srand(time(0));
+          while (x != 0)
+          {
+            Size y = rand() % x;
+            temp += pro_seq[y];
+            pro_seq[y] = pro_seq[x - 1];
+            --x;
+          }
+          entry.sequence = temp;
         }
         else
         {
-          proteins[i].sequence.reverse();
-          proteins[i].identifier = getIdentifier_(proteins[i].identifier, decoy_string, decoy_string_position_prefix);
+          entry.sequence.reverse();
         }
+        entry.identifier = getIdentifier_(entry.identifier, decoy_string, decoy_string_position_prefix);
+        FASTAFile::writeEntry(outfile, entry);
       }
     }
-
-    //-------------------------------------------------------------
-    // writing output
-    //-------------------------------------------------------------
-
-    FASTAFile().store(out, proteins);
+    fasta.close();
+    outfile.close();
 
     return EXECUTION_OK;
   }
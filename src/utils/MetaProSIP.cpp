@@ -156,6 +156,36 @@ struct SIPPeptide
 #endif
 };
 
+///< intermediate state of a peptide feature between the (parallel and serial) analysis stages of MetaProSIP
+struct SIPFeatureAnalysis
+{
+  enum Status {NOT_ANALYZED, NO_ISOTOPIC_PEAKS, ISOTOPIC_PEAKS};
+
+  SIPFeatureAnalysis() :
+    status(NOT_ANALYZED),
+    isotopic_trace_count(0),
+    max_trace_int_rt(0),
+    patterns(0)
+  {
+  }
+
+  Status status; ///< outcome of the isotopic trace extraction
+
+  Size isotopic_trace_count; ///< number of labeling element isotopic traces
+
+  double max_trace_int_rt; ///< rt of the most intense scan of the mono-isotopic trace
+
+  vector<double> isotopic_intensities; ///< intensities of the isotopic traces
+
+  IsotopePatterns averagine_patterns; ///< theoretical patterns of an unidentified feature
+
+  const IsotopePatterns* patterns; ///< theoretical patterns (shared by all features of the same sequence, or averagine_patterns)
+
+  StringList warnings; ///< warnings of a parallel stage, reported after it (the log is not thread-safe)
+
+  SIPPeptide sip_peptide;
+};
+
 ///< comparator for vectors of SIPPeptides based on their size. Used to sort by group size.
 struct SizeLess :
   public std::binary_function<vector<SIPPeptide>, vector<SIPPeptide>, bool>
@@ -284,7 +314,10 @@ public:
 
     // kernel density estimation, TODO: binary search for 5 sigma boundaries
     vector<double> density(101, 0);
-    for (Size i = 0; i != density.size(); ++i)
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (SignedSize i = 0; i < (SignedSize)density.size(); ++i)
     {
       double sum = 0;
       for (MapRateToScoreType::const_iterator mit = hist.begin(); mit != hist.end(); ++mit)
@@ -1279,7 +1312,8 @@ public:
 
     for (Size p = 0; p != n_bins; ++p)
     {
-      map_rate_to_decomposition_weight[(double)p / n_bins * 100.0] = beta(p, 0);
+      // rates are increasing: insert at the end
+      map_rate_to_decomposition_weight.insert(map_rate_to_decomposition_weight.end(), make_pair((double)p / n_bins * 100.0, beta(p, 0)));
     }
 
     // calculate R squared
@@ -2193,32 +2227,15 @@ protected:
   }
 
   ///< Calculates the correlation between measured isotopic_intensities and the theoretical isotopic patterns for all incorporation rates
-  void calculateCorrelation(Size n_element, const vector<double>& isotopic_intensities, IsotopePatterns patterns,
-                            MapRateToScoreType& map_rate_to_correlation_score, String labeling_element, double mass, double min_correlation_distance_to_averagine)
+  ///< Note: option values are passed explicitly as this is called from within parallel regions
+  void calculateCorrelation(Size n_element, const vector<double>& isotopic_intensities, const IsotopePatterns& patterns,
+                            MapRateToScoreType& map_rate_to_correlation_score, double TIC_threshold, double min_observed_peak_fraction, double mass, double min_correlation_distance_to_averagine)
   {
-    double min_observed_peak_fraction = getDoubleOption_("observed_peak_fraction");
-
     if (debug_level_ > 0)
     {
       cout << "Calculating " << patterns.size() << " isotope patterns with " << ADDITIONAL_ISOTOPES << " additional isotopes." << endl;
     }
 
-    double TIC_threshold(0.0);
-    
-    // N15 has smaller RIA resolution and multiple RIA peaks tend to overlap more in correlation. This reduces the width of the pattern leading to better distinction
-    if (labeling_element == "N")
-    {
-      TIC_threshold = getDoubleOption_("pattern_15N_TIC_threshold");
-    } else if (labeling_element == "C")
-    {
-      TIC_threshold = getDoubleOption_("pattern_13C_TIC_threshold");
-    } else if (labeling_element == "H")
-    {
-      TIC_threshold = getDoubleOption_("pattern_2H_TIC_threshold");
-    } else if (labeling_element == "O")
-    {
-      TIC_threshold = getDoubleOption_("pattern_18O_TIC_threshold");
-    }
     double max_incorporation_rate = 100.0;
     double incorporation_step = max_incorporation_rate / (double)n_element;
 
@@ -2598,8 +2615,10 @@ protected:
 
   ///> Collect decomposition coefficients in the merge window around the correlation maximum.
   ///> Final list of RIAs is constructed for the peptide.
+  ///> Warnings are appended to @p warnings instead of being logged, as this is called from within parallel regions.
   void extractIncorporationsAtCorrelationMaxima(SIPPeptide& sip_peptide,
                                                 const IsotopePatterns& patterns,
+                                                StringList& warnings,
                                                 double weight_merge_window = 5.0,
                                                 double min_corr_threshold = 0.5,
                                                 double min_decomposition_weight = 10.0)
@@ -2664,16 +2683,16 @@ protected:
         {
           if (debug_level_ > 1)
           {
-            LOG_WARN << "warning: prevented adding of 0 abundance decomposition at rate " << rate << endl;
-            LOG_WARN << "decomposition: " << endl;
+            warnings.push_back(String("warning: prevented adding of 0 abundance decomposition at rate ") + rate);
+            warnings.push_back("decomposition: ");
             for (MapRateToScoreType::const_iterator it = map_rate_to_decomposition_weight.begin(); it != map_rate_to_decomposition_weight.end(); ++it)
             {
-              LOG_WARN << it->first << " " << it->second << endl;
+              warnings.push_back(String(it->first) + " " + it->second);
             }
-            LOG_WARN << "correlation: " << endl;
+            warnings.push_back("correlation: ");
             for (MapRateToScoreType::const_iterator it = map_rate_to_correlation_score.begin(); it != map_rate_to_correlation_score.end(); ++it)
             {
-              LOG_WARN << it->first << " " << it->second << endl;
+              warnings.push_back(String(it->first) + " " + it->second);
             }
           }
 
@@ -3155,22 +3174,49 @@ protected:
     tm.filterPeakMap(peak_map);
     peak_map.sortSpectra();
 
-    // used to generate plots
-    vector<String> titles;
-    vector<MapRateToScoreType> weight_maps;
-    vector<MapRateToScoreType> normalized_weight_maps;
-    vector<MapRateToScoreType> correlation_maps;
-
     String file_suffix = "_" + String(QFileInfo(in_mzml.toQString()).baseName()) + "_" + String::random(4);
 
+    // options used inside of parallel regions (avoid concurrent parameter access)
+    const bool filter_monoisotopic = getFlag_("filter_monoisotopic");
+    const String collect_method = getStringOption_("collect_method");
+    const double lowRIA_correlation_threshold = getDoubleOption_("lowRIA_correlation_threshold");
+    const double min_observed_peak_fraction = getDoubleOption_("observed_peak_fraction");
+
+    // N15 has smaller RIA resolution and multiple RIA peaks tend to overlap more in correlation. This reduces the width of the pattern leading to better distinction
+    double pattern_TIC_threshold(0.0);
+    if (labeling_element == "N")
+    {
+      pattern_TIC_threshold = getDoubleOption_("pattern_15N_TIC_threshold");
+    } else if (labeling_element == "C")
+    {
+      pattern_TIC_threshold = getDoubleOption_("pattern_13C_TIC_threshold");
+    } else if (labeling_element == "H")
+    {
+      pattern_TIC_threshold = getDoubleOption_("pattern_2H_TIC_threshold");
+    } else if (labeling_element == "O")
+    {
+      pattern_TIC_threshold = getDoubleOption_("pattern_18O_TIC_threshold");
+    }
+
     vector<SIPPeptide> sip_peptides;
 
     Size nPSMs = 0; ///< number of PSMs. If 0 IDMapper has not been called.
     Size spectrum_with_no_isotopic_peaks(0);
     Size spectrum_with_isotopic_peaks(0);
 
-    for (FeatureMap::iterator feature_it = feature_map.begin(); feature_it != feature_map.end(); ++feature_it) // for each peptide feature
+    // The analysis of the peptide features is split into three stages:
+    // 1. (parallel) identification handling and extraction of the isotopic traces from the (read-only) peak map
+    // 2. (serial) calculation of theoretical isotopic patterns. This modifies the isotope distributions in the static ElementDB and can't be run concurrently.
+    // 3. (parallel) decomposition, correlation and extraction of incorporations
+    vector<SIPFeatureAnalysis> analyses(feature_map.size());
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic) reduction(+: nPSMs)
+#endif
+    for (SignedSize f = 0; f < (SignedSize)feature_map.size(); ++f) // for each peptide feature
     {
+      FeatureMap::iterator feature_it = feature_map.begin() + f;
+      SIPFeatureAnalysis& analysis = analyses[f];
       const double feature_hit_center_rt = feature_it->getRT();
 
       // check if out of experiment bounds
@@ -3203,13 +3249,13 @@ protected:
         }
         else
         {
-          LOG_WARN << "Empty peptide hit encountered on feature. Ignoring." << endl;
+          analysis.warnings.push_back("Empty peptide hit encountered on feature. Ignoring.");
         }
       }
 
       tmp_pepid.assignRanks();
 
-      SIPPeptide sip_peptide;
+      SIPPeptide& sip_peptide = analysis.sip_peptide;
       sip_peptide.feature_type = feature_it->getMetaValue("feature_type"); // used to annotate feature type in reporting
 
       // retrieve identification information
@@ -3256,7 +3302,8 @@ protected:
 
       // determine retention time of scans next to the central scan
       vector<double> seeds_rt = findApexRT(feature_it, feature_hit_center_rt, peak_map, 2); // 1 scan at maximum, 2+2 above and below
-      double max_trace_int_rt = seeds_rt[0];
+      const double max_trace_int_rt = seeds_rt[0];
+      analysis.max_trace_int_rt = max_trace_int_rt;
 
       // determine maximum number of peaks and mass difference
       EmpiricalFormula e = feature_hit_aaseq.getFormula();
@@ -3304,6 +3351,7 @@ protected:
       }
 
       isotopic_trace_count = labeling_element != "O" ? element_count : element_count * 2; 
+      analysis.isotopic_trace_count = isotopic_trace_count;
 
       // collect 13C / 15N peaks
       if (debug_level_ >= 10)
@@ -3311,7 +3359,8 @@ protected:
         LOG_DEBUG << "Extract XICs" << endl;
       }
 
-      vector<double> isotopic_intensities = MetaProSIPXICExtraction::extractXICsOfIsotopeTraces(isotopic_trace_count + ADDITIONAL_ISOTOPES, sip_peptide.mass_diff, mz_tolerance_ppm_, rt_tolerance_s, max_trace_int_rt, feature_hit_theoretical_mz, feature_hit_charge, peak_map, xic_threshold);
+      vector<double>& isotopic_intensities = analysis.isotopic_intensities;
+      isotopic_intensities = MetaProSIPXICExtraction::extractXICsOfIsotopeTraces(isotopic_trace_count + ADDITIONAL_ISOTOPES, sip_peptide.mass_diff, mz_tolerance_ppm_, rt_tolerance_s, max_trace_int_rt, feature_hit_theoretical_mz, feature_hit_charge, peak_map, xic_threshold);
 
       // set intensity to zero if not enough neighboring isotopic peaks are present
       for (Size i = 0; i != isotopic_intensities.size(); ++i)
@@ -3355,18 +3404,39 @@ protected:
 
       double TIC = accumulate(isotopic_intensities.begin(), isotopic_intensities.end(), 0.0);
 
-      // collect 13C / 15N peaks
-      if (debug_level_ >= 10)
+      // no Peaks collected
+      if (TIC < 1e-4)
       {
-        LOG_DEBUG << "TIC of XICs: " << TIC << endl;
-        for (Size i = 0; i != isotopic_intensities.size(); ++i)
-        {
-          cout << isotopic_intensities[i] << endl;
-        }
+        analysis.status = SIPFeatureAnalysis::NO_ISOTOPIC_PEAKS;
+        continue;
       }
 
-      // no Peaks collected
-      if (TIC < 1e-4)
+      analysis.status = SIPFeatureAnalysis::ISOTOPIC_PEAKS;
+
+      // store accumulated intensities at theoretical positions
+      sip_peptide.accumulated = isotopicIntensitiesToSpectrum(feature_hit_theoretical_mz, sip_peptide.mass_diff, feature_hit_charge, isotopic_intensities);
+
+      sip_peptide.global_LR = calculateGlobalLR(isotopic_intensities);
+    }
+
+    // calculate isotopic patterns for the given sequence, incoroporation interval/steps
+    map<String, IsotopePatterns> sequence_to_patterns; // features of the same peptide share the (costly) patterns
+    for (Size f = 0; f != analyses.size(); ++f)
+    {
+      SIPFeatureAnalysis& analysis = analyses[f];
+
+      // report warnings of stage 1 in the order of the features
+      for (Size i = 0; i != analysis.warnings.size(); ++i)
+      {
+        LOG_WARN << analysis.warnings[i] << endl;
+      }
+      analysis.warnings.clear();
+
+      if (analysis.status == SIPFeatureAnalysis::NOT_ANALYZED)
+      {
+        continue;
+      }
+      else if (analysis.status == SIPFeatureAnalysis::NO_ISOTOPIC_PEAKS)
       {
         ++spectrum_with_no_isotopic_peaks;
         if (debug_level > 0)
@@ -3375,93 +3445,117 @@ protected:
         }
         continue;
       }
-      else
-      {
-        ++spectrum_with_isotopic_peaks;
-      }
 
-      // store accumulated intensities at theoretical positions
-      sip_peptide.accumulated = isotopicIntensitiesToSpectrum(feature_hit_theoretical_mz, sip_peptide.mass_diff, feature_hit_charge, isotopic_intensities);
+      ++spectrum_with_isotopic_peaks;
 
-      sip_peptide.global_LR = calculateGlobalLR(isotopic_intensities);
+      SIPPeptide& sip_peptide = analysis.sip_peptide;
+      const vector<double>& isotopic_intensities = analysis.isotopic_intensities;
 
-      Size non_zero_isotopic_intensities(0);
-      for (Size i = 0; i != isotopic_intensities.size(); ++i)
+      if (debug_level_ >= 10)
       {
-        if (isotopic_intensities[i] > 0.1)
+        LOG_DEBUG << "TIC of XICs: " << accumulate(isotopic_intensities.begin(), isotopic_intensities.end(), 0.0) << endl;
+        for (Size i = 0; i != isotopic_intensities.size(); ++i)
         {
-          ++non_zero_isotopic_intensities;
+          cout << isotopic_intensities[i] << endl;
         }
       }
 
       if (debug_level > 0)
       {
+        Size non_zero_isotopic_intensities(0);
+        for (Size i = 0; i != isotopic_intensities.size(); ++i)
+        {
+          if (isotopic_intensities[i] > 0.1)
+          {
+            ++non_zero_isotopic_intensities;
+          }
+        }
         cout << "Isotopic intensities found / total: " << non_zero_isotopic_intensities << "/" << isotopic_intensities.size() << endl;
       }
 
-      LOG_INFO << feature_hit.getSequence().toString() << "\trt: " << max_trace_int_rt << endl;
-
-      // correlation filtering
-      MapRateToScoreType map_rate_to_correlation_score;
-
-      IsotopePatterns patterns;
+      LOG_INFO << sip_peptide.sequence.toString() << "\trt: " << analysis.max_trace_int_rt << endl;
 
-      // calculate isotopic patterns for the given sequence, incoroporation interval/steps
       if (sip_peptide.feature_type == FEATURE_STRING || sip_peptide.feature_type == UNASSIGNED_ID_STRING)
       {
-       if (labeling_element == "N")
-       {
-         patterns = MetaProSIPDecomposition::calculateIsotopePatternsFor15NRange(AASequence::fromString(feature_hit_seq));
-       } else if (labeling_element == "C")
-       {
-         patterns = MetaProSIPDecomposition::calculateIsotopePatternsFor13CRange(AASequence::fromString(feature_hit_seq));
-       } else if (labeling_element == "H")
-       {
-         patterns = MetaProSIPDecomposition::calculateIsotopePatternsFor2HRange(AASequence::fromString(feature_hit_seq));
-       } else if (labeling_element == "O")
-       { 
-         patterns = MetaProSIPDecomposition::calculateIsotopePatternsFor18ORange(AASequence::fromString(feature_hit_seq));
-       }
+        const String feature_hit_seq = sip_peptide.sequence.toString();
+        map<String, IsotopePatterns>::const_iterator pattern_it = sequence_to_patterns.find(feature_hit_seq);
+        if (pattern_it == sequence_to_patterns.end())
+        {
+          IsotopePatterns patterns;
+          if (labeling_element == "N")
+          {
+            patterns = MetaProSIPDecomposition::calculateIsotopePatternsFor15NRange(sip_peptide.sequence);
+          } else if (labeling_element == "C")
+          {
+            patterns = MetaProSIPDecomposition::calculateIsotopePatternsFor13CRange(sip_peptide.sequence);
+          } else if (labeling_element == "H")
+          {
+            patterns = MetaProSIPDecomposition::calculateIsotopePatternsFor2HRange(sip_peptide.sequence);
+          } else if (labeling_element == "O")
+          { 
+            patterns = MetaProSIPDecomposition::calculateIsotopePatternsFor18ORange(sip_peptide.sequence);
+          }
+          pattern_it = sequence_to_patterns.insert(make_pair(feature_hit_seq, patterns)).first;
+        }
+        analysis.patterns = &pattern_it->second; // elements of a map are not moved by later insertions
       }
       else if (sip_peptide.feature_type == UNIDENTIFIED_STRING)
       {
-       if (labeling_element == "N")
-       {
-         patterns = MetaProSIPDecomposition::calculateIsotopePatternsFor15NRangeOfAveraginePeptide(sip_peptide.mass_theo);
-       } else if (labeling_element == "C")
-       {
-         patterns = MetaProSIPDecomposition::calculateIsotopePatternsFor13CRangeOfAveraginePeptide(sip_peptide.mass_theo);
-       } else if (labeling_element == "H")
-       {
-         patterns = MetaProSIPDecomposition::calculateIsotopePatternsFor2HRangeOfAveraginePeptide(sip_peptide.mass_theo);
-       } else if (labeling_element == "O")
-       {
-         patterns = MetaProSIPDecomposition::calculateIsotopePatternsFor18ORangeOfAveraginePeptide(sip_peptide.mass_theo);
-       }
+        if (labeling_element == "N")
+        {
+          analysis.averagine_patterns = MetaProSIPDecomposition::calculateIsotopePatternsFor15NRangeOfAveraginePeptide(sip_peptide.mass_theo);
+        } else if (labeling_element == "C")
+        {
+          analysis.averagine_patterns = MetaProSIPDecomposition::calculateIsotopePatternsFor13CRangeOfAveraginePeptide(sip_peptide.mass_theo);
+        } else if (labeling_element == "H")
+        {
+          analysis.averagine_patterns = MetaProSIPDecomposition::calculateIsotopePatternsFor2HRangeOfAveraginePeptide(sip_peptide.mass_theo);
+        } else if (labeling_element == "O")
+        {
+          analysis.averagine_patterns = MetaProSIPDecomposition::calculateIsotopePatternsFor18ORangeOfAveraginePeptide(sip_peptide.mass_theo);
+        }
+        analysis.patterns = &analysis.averagine_patterns;
       }
 
+#ifdef DEBUG_METAPROSIP
       // store theoretical patterns for visualization
-      sip_peptide.patterns = patterns;
-      for (IsotopePatterns::const_iterator pit = sip_peptide.patterns.begin(); pit != sip_peptide.patterns.end(); ++pit)
+      for (IsotopePatterns::const_iterator pit = analysis.patterns->begin(); pit != analysis.patterns->end(); ++pit)
       {
-        PeakSpectrum p = isotopicIntensitiesToSpectrum(feature_hit_theoretical_mz, sip_peptide.mass_diff, feature_hit_charge, pit->second);
+        PeakSpectrum p = isotopicIntensitiesToSpectrum(sip_peptide.mz_theo, sip_peptide.mass_diff, sip_peptide.charge, pit->second);
         p.setMetaValue("rate", (double)pit->first);
         p.setMSLevel(2);
-#ifdef DEBUG_METAPROSIP
         sip_peptide.pattern_spectra.push_back(p);
+      }
 #endif
+    }
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (SignedSize f = 0; f < (SignedSize)analyses.size(); ++f)
+    {
+      SIPFeatureAnalysis& analysis = analyses[f];
+
+      if (analysis.status != SIPFeatureAnalysis::ISOTOPIC_PEAKS)
+      {
+        continue;
       }
 
+      SIPPeptide& sip_peptide = analysis.sip_peptide;
+      const IsotopePatterns& patterns = *analysis.patterns;
+      const Size isotopic_trace_count = analysis.isotopic_trace_count;
+      vector<double>& isotopic_intensities = analysis.isotopic_intensities;
+
       // calculate decomposition into isotopic patterns
       MapRateToScoreType map_rate_to_decomposition_weight;
       MetaProSIPDecomposition::calculateDecompositionWeightsIsotopicPatterns(isotopic_trace_count, isotopic_intensities, patterns, map_rate_to_decomposition_weight, sip_peptide);
 
       // set first intensity to zero and remove first 2 possible RIAs (0% and e.g. 1.07% for carbon)
       MapRateToScoreType tmp_map_rate_to_correlation_score;
-      if (getFlag_("filter_monoisotopic"))
+      if (filter_monoisotopic)
       {
         // calculate correlation of natural RIAs (for later reporting) before we subtract the intensities. This is somewhat redundant but no speed bottleneck.
-        calculateCorrelation(isotopic_trace_count, isotopic_intensities, patterns, tmp_map_rate_to_correlation_score, labeling_element, sip_peptide.mass_theo, -1.0);
+        calculateCorrelation(isotopic_trace_count, isotopic_intensities, patterns, tmp_map_rate_to_correlation_score, pattern_TIC_threshold, min_observed_peak_fraction, sip_peptide.mass_theo, -1.0);
         for (Size i = 0; i != sip_peptide.reconstruction_monoistopic.size(); ++i)
         {
           if (i == 0)
@@ -3477,13 +3571,14 @@ protected:
         }
       }
 
-      sip_peptide.decomposition_map = map_rate_to_decomposition_weight;
+      sip_peptide.decomposition_map.swap(map_rate_to_decomposition_weight);
 
       // calculate Pearson correlation coefficients
-      calculateCorrelation(isotopic_trace_count, isotopic_intensities, patterns, map_rate_to_correlation_score, labeling_element, sip_peptide.mass_theo, min_correlation_distance_to_averagine);
+      MapRateToScoreType map_rate_to_correlation_score;
+      calculateCorrelation(isotopic_trace_count, isotopic_intensities, patterns, map_rate_to_correlation_score, pattern_TIC_threshold, min_observed_peak_fraction, sip_peptide.mass_theo, min_correlation_distance_to_averagine);
 
       // restore original correlation of natural RIAs (take maximum of observed correlations)
-      if (getFlag_("filter_monoisotopic"))
+      if (filter_monoisotopic)
       {
         MapRateToScoreType::iterator dc_it = map_rate_to_correlation_score.begin();
         MapRateToScoreType::const_iterator tmp_dc_it = tmp_map_rate_to_correlation_score.begin();
@@ -3493,23 +3588,33 @@ protected:
         dc_it->second = max(tmp_dc_it->second, dc_it->second);
       }
 
-      sip_peptide.correlation_map = map_rate_to_correlation_score;
+      sip_peptide.correlation_map.swap(map_rate_to_correlation_score);
 
       // determine maximum correlations
-      sip_peptide.correlation_maxima = MetaProSIPInterpolation::getHighPoints(correlation_threshold, map_rate_to_correlation_score);
+      sip_peptide.correlation_maxima = MetaProSIPInterpolation::getHighPoints(correlation_threshold, sip_peptide.correlation_map);
 
       // FOR REPORTING: store incorporation information like e.g. theoretical spectrum for best correlations
-      if (getStringOption_("collect_method") == "correlation_maximum")
+      if (collect_method == "correlation_maximum")
       {
-        extractIncorporationsAtCorrelationMaxima(sip_peptide, patterns, weight_merge_window_, correlation_threshold);
+        extractIncorporationsAtCorrelationMaxima(sip_peptide, patterns, analysis.warnings, weight_merge_window_, correlation_threshold);
       }
-      else if (getStringOption_("collect_method") == "decomposition_maximum")
+      else if (collect_method == "decomposition_maximum")
       {
-        extractIncorporationsAtHeighestDecompositionWeights(sip_peptide, patterns, weight_merge_window_, correlation_threshold, getDoubleOption_("lowRIA_correlation_threshold"));
+        extractIncorporationsAtHeighestDecompositionWeights(sip_peptide, patterns, weight_merge_window_, correlation_threshold, lowRIA_correlation_threshold);
       }
+    }
 
-      // store sip peptide
-      if (sip_peptide.incorporations.size() != 0 && sip_peptide.RR > decomposition_threshold)
+    // store sip peptides (in order of the features)
+    for (Size f = 0; f != analyses.size(); ++f)
+    {
+      // report warnings of stage 3 in the order of the features
+      for (Size i = 0; i != analyses[f].warnings.size(); ++i)
+      {
+        LOG_WARN << analyses[f].warnings[i] << endl;
+      }
+
+      const SIPPeptide& sip_peptide = analyses[f].sip_peptide;
+      if (analyses[f].status == SIPFeatureAnalysis::ISOTOPIC_PEAKS && sip_peptide.incorporations.size() != 0 && sip_peptide.RR > decomposition_threshold)
       {
         if (debug_level > 0)
         {
@@ -3517,15 +3622,8 @@ protected:
         }
         sip_peptides.push_back(sip_peptide);
       }
-
-      MapRateToScoreType map_rate_to_normalized_weight = normalizeToMax(map_rate_to_decomposition_weight);
-
-      // store for plotting
-      titles.push_back(feature_hit_seq + " " + String(feature_hit_center_rt));
-      weight_maps.push_back(map_rate_to_decomposition_weight);
-      normalized_weight_maps.push_back(map_rate_to_normalized_weight);
-      correlation_maps.push_back(map_rate_to_correlation_score);
     }
+    analyses.clear();
 
     LOG_INFO << "Spectra with / without isotopic peaks " << spectrum_with_isotopic_peaks << "/" << spectrum_with_no_isotopic_peaks << endl;
 
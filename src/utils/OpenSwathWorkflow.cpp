@@ -456,6 +456,9 @@ protected:
 
     registerIntOption_("batchSize", "<number>", 0, "The batch size of chromatograms to process (0 means to only have one batch, sensible values are around 500-1000)", false, true);
     setMinInt_("batchSize", 0);
+    registerIntOption_("prefetch_memory", "<MB>", 0, "Load upcoming SWATH windows into memory in a background thread while the current windows are extracted and scored, holding at most this much memory (in MB) for windows loaded ahead (0 disables prefetching). Windows are always processed in memory if prefetching is enabled. Not supported for SONAR data.", false, true);
+    setMinInt_("prefetch_memory", 0);
+    registerFlag_("cache_corrected_spectra", "Keep the m/z corrected spectra of a SWATH window in memory while the window is processed, instead of reading and correcting them again for every batch. Only useful if the windows are not processed in memory (see readOptions and prefetch_memory) and if memory allows it. The MS1 map is never cached.", true);
 
     registerSubsection_("Scoring", "Scoring parameters section");
 
@@ -507,6 +510,7 @@ protected:
       // remove these parameters
       feature_finder_param.remove("add_up_spectra");
       feature_finder_param.remove("spacing_for_spectra_resampling");
+      feature_finder_param.remove("spectra_addition_method");
       feature_finder_param.remove("EMGScoring:statistics:mean");
       feature_finder_param.remove("EMGScoring:statistics:variance");
       return feature_finder_param;
@@ -593,12 +597,15 @@ protected:
    * @param irt_detection_param Parameter set for the detection of the iRTs (outlier detection, peptides per bin etc)
    * @param mz_correction_function If correction in m/z is desired, which function should be used
    * @param debug_level Debug level (writes out the RT normalization chromatograms if larger than 1)
+   * @param sonar Whether the data is SONAR data
+   * @param cache_corrected_spectra Whether the m/z corrected maps keep their spectra in memory
    *
    */
   TransformationDescription loadTrafoFile(String trafo_in, String irt_tr_file,
     std::vector< OpenSwath::SwathMap > & swath_maps, double min_rsq, double min_coverage,
     const Param& feature_finder_param, const ChromExtractParams& cp_irt,
-    const Param& irt_detection_param, const String & mz_correction_function, Size debug_level, bool sonar)
+    const Param& irt_detection_param, const String & mz_correction_function, Size debug_level, bool sonar,
+    bool cache_corrected_spectra)
   {
     TransformationDescription trafo_rtnorm;
     if (!trafo_in.empty())
@@ -623,7 +630,8 @@ protected:
       OpenSwathRetentionTimeNormalization wf;
       wf.setLogType(log_type_);
       trafo_rtnorm = wf.performRTNormalization(irt_transitions, swath_maps, min_rsq, min_coverage,
-          feature_finder_param, cp_irt, irt_detection_param, mz_correction_function, debug_level, sonar);
+          feature_finder_param, cp_irt, irt_detection_param, mz_correction_function, debug_level, sonar,
+          cache_corrected_spectra);
     }
     return trafo_rtnorm;
   }
@@ -831,10 +839,16 @@ protected:
     ///////////////////////////////////
     // Get the transformation information (using iRT peptides)
     ///////////////////////////////////
+    // Optionally keep the m/z corrected spectra in memory instead of reading
+    // and correcting them again for every batch and scored peak group. This is
+    // pointless if the windows are processed in memory anyway (prefetching is
+    // not available for SONAR).
+    bool process_in_memory = load_into_memory || (!sonar && getIntOption_("prefetch_memory") > 0);
+    bool cache_corrected_spectra = getFlag_("cache_corrected_spectra") && !process_in_memory;
     TransformationDescription trafo_rtnorm = loadTrafoFile(trafo_in,
         irt_tr_file, swath_maps, min_rsq, min_coverage, feature_finder_param,
         cp_irt, irt_detection_param, mz_correction_function, debug_level,
-        sonar);
+        sonar, cache_corrected_spectra);
 
     ///////////////////////////////////
     // Load the transitions
@@ -908,7 +922,8 @@ protected:
       OpenSwathWorkflow wf(use_ms1_traces);
       wf.setLogType(log_type_);
       wf.performExtraction(swath_maps, trafo_rtnorm, cp, feature_finder_param, transition_exp,
-          out_featureFile, !out.empty(), tsvwriter, chromConsumer, batchSize, load_into_memory);
+          out_featureFile, !out.empty(), tsvwriter, chromConsumer, batchSize, load_into_memory,
+          (Size)getIntOption_("prefetch_memory") * 1024 * 1024);
     }
 
     if (!out.empty())
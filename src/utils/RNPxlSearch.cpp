@@ -68,6 +68,7 @@
 #include <OpenMS/CHEMISTRY/TheoreticalSpectrumGenerator.h>
 #include <OpenMS/KERNEL/Peak1D.h>
 #include <OpenMS/KERNEL/RichPeak1D.h>
+#include <OpenMS/KERNEL/ComparatorUtils.h>
 #include <OpenMS/FORMAT/IdXMLFile.h>
 #include <OpenMS/FORMAT/TextFile.h>
 
@@ -851,6 +852,135 @@ protected:
     return all_pc_all_feasible_adducts;
   }
 
+  // fragment adduct with all peptide independent information needed to generate partial loss spectra
+  struct FragmentAdductShift_
+  {
+    String name; // name used in annotation (e.g. U-H2O)
+    double mass; // monoisotopic mass of the fragment adduct
+    double series_shift; // mass shift of a, b, y and precursor ions carrying the adduct
+    RichPeak1D RNA_fragment_peak; // annotated peak of the (protonated) fragment adduct
+  };
+
+  // peptide independent part of the partial loss spectra of a precursor adduct
+  struct PrecursorAdductSpectra_
+  {
+    RichPeakSpectrum marker_ions; // A', G', C' marker ions (presence determined by precursor RNA)
+    vector<FragmentAdductShift_> shifts; // all feasible fragment adducts
+  };
+
+  /* @brief Precompute marker ions and fragment adduct shifts for all precursor adducts.
+   * The result is indexed like mm.mod_combinations (i.e., by the rna_mod_index of an AnnotatedHit) and read-only afterwards,
+   * so it can be shared by all threads (this also keeps ModificationsDB lookups out of parallel sections).
+   */
+  vector<PrecursorAdductSpectra_> getPrecursorAdductSpectra_(const RNPxlModificationMassesResult& mm, const map<String, vector<FragmentAdductDefinition_> >& all_feasible_fragment_adducts)
+  {
+    vector<PrecursorAdductSpectra_> adduct_spectra;
+    adduct_spectra.reserve(mm.mod_combinations.size());
+
+    for (std::map<String, std::set<String> >::const_iterator mod_combinations_it = mm.mod_combinations.begin(); mod_combinations_it != mm.mod_combinations.end(); ++mod_combinations_it)
+    {
+      const String& precursor_rna_adduct = *mod_combinations_it->second.begin();
+      adduct_spectra.push_back(PrecursorAdductSpectra_());
+      PrecursorAdductSpectra_& current = adduct_spectra.back();
+
+      RichPeak1D RNA_fragment_peak;
+      RNA_fragment_peak.setIntensity(1.0);
+      if (precursor_rna_adduct.hasSubstring("A"))
+      {
+        RNA_fragment_peak.setMZ(136.0623); // C5H6N5
+        RNA_fragment_peak.setMetaValue("IonName", "RNA:A'");
+        current.marker_ions.push_back(RNA_fragment_peak);
+      }
+
+      if (precursor_rna_adduct.hasSubstring("G"))
+      {
+        RNA_fragment_peak.setMZ(152.0572); //C5H6N5O
+        RNA_fragment_peak.setMetaValue("IonName", "RNA:G'");
+        current.marker_ions.push_back(RNA_fragment_peak);
+      }
+
+      if (precursor_rna_adduct.hasSubstring("C"))
+      {
+        RNA_fragment_peak.setMZ(112.0510); // C4H6N3O
+        RNA_fragment_peak.setMetaValue("IonName", "RNA:C'");
+        current.marker_ions.push_back(RNA_fragment_peak);
+      }
+
+      // all possible RNA fragment shifts in the MS2 (based on the precursor RNA/DNA)
+      const vector<FragmentAdductDefinition_>& partial_loss_modification = all_feasible_fragment_adducts.at(precursor_rna_adduct);
+      for (Size i = 0; i != partial_loss_modification.size(); ++i)
+      {
+        FragmentAdductShift_ shift;
+        shift.name = partial_loss_modification[i].name;
+        shift.mass = partial_loss_modification[i].formula.getMonoWeight();
+        shift.series_shift = ModificationsDB::getInstance()->getModification(shift.name, "", ResidueModification::N_TERM).getDiffMonoMass();
+
+        // RNA mass peak
+        shift.RNA_fragment_peak.setIntensity(1.0);
+        shift.RNA_fragment_peak.setMZ(shift.mass + Constants::PROTON_MASS_U); // there is exactly one RNA fragment modification that we added to this partial loss spectrum. So get the modification and mass to calculate the RNA peak mass.
+        shift.RNA_fragment_peak.setMetaValue("IonName", "RNA:" + shift.name);  // add name (e.g. RNA:U-H2O)
+        current.shifts.push_back(shift);
+      }
+    }
+    return adduct_spectra;
+  }
+
+  // determine the (first) amino acid of a peptide that gives rise to an immonium ion considered for shifted immonium ions
+  bool getImmoniumIon_(const String& unmodified_sequence, char& amino_acid, double& immonium_ion_mass)
+  {
+    if (unmodified_sequence.hasSubstring("Y"))
+    {
+      amino_acid = 'Y';
+      immonium_ion_mass = EmpiricalFormula("C8H10NO").getMonoWeight();
+    }
+    else if (unmodified_sequence.hasSubstring("W"))
+    {
+      amino_acid = 'W';
+      immonium_ion_mass = EmpiricalFormula("C10H11N2").getMonoWeight();
+    }
+    else if (unmodified_sequence.hasSubstring("F"))
+    {
+      amino_acid = 'F';
+      immonium_ion_mass = EmpiricalFormula("C8H10N").getMonoWeight();
+    }
+    else if (unmodified_sequence.hasSubstring("H"))
+    {
+      amino_acid = 'H';
+      immonium_ion_mass = EmpiricalFormula("C5H8N3").getMonoWeight();
+    }
+    else if (unmodified_sequence.hasSubstring("C"))
+    {
+      amino_acid = 'C';
+      immonium_ion_mass = EmpiricalFormula("C2H6NS").getMonoWeight();
+    }
+    else if (unmodified_sequence.hasSubstring("P"))
+    {
+      amino_acid = 'P';
+      immonium_ion_mass = EmpiricalFormula("C4H8N").getMonoWeight();
+    }
+    else if (unmodified_sequence.hasSubstring("L") || unmodified_sequence.hasSubstring("I"))
+    {
+      amino_acid = 'L';
+      immonium_ion_mass = EmpiricalFormula("C5H12N").getMonoWeight();
+    }
+    else if (unmodified_sequence.hasSubstring("K"))
+    {
+      // TODO: add a lysin derived fragment (similar to immonium ion) 84. and 129.10 (ask Aleks)
+      amino_acid = 'K';
+      immonium_ion_mass = 101.10732;
+    }
+    else if (unmodified_sequence.hasSubstring("M"))
+    {
+      amino_acid = 'M';
+      immonium_ion_mass = 104.05285;
+    }
+    else
+    {
+      return false;
+    }
+    return true;
+  }
+
   /* @brief Localization step of the cross-link identification engine.
    * Given a top scoring candidate (based on total loss spectrum) it:
    *  - generates all fragment adducts based on the attached precursor adduct
@@ -867,7 +997,7 @@ protected:
                       Size max_variable_mods_per_peptide, 
                       TheoreticalSpectrumGenerator spectrum_generator, 
                       double fragment_mass_tolerance, bool fragment_mass_tolerance_unit_ppm, 
-                      const map<String, vector<FragmentAdductDefinition_> > & all_feasible_fragment_adducts)
+                      const vector<PrecursorAdductSpectra_>& adduct_spectra)
   {
     assert(exp.size() == annotated_hits.size());
 
@@ -906,8 +1036,9 @@ protected:
       annotated_hits[scan_index].resize(topn);
     }
 
+    // the number of hits (and their cost) differs strongly between spectra: use dynamic scheduling
 #ifdef _OPENMP
-#pragma omp parallel for
+#pragma omp parallel for schedule(dynamic, 10)
 #endif
     for (SignedSize scan_index = 0; scan_index < (SignedSize)annotated_hits.size(); ++scan_index)
     {
@@ -929,161 +1060,92 @@ protected:
           // reannotate much more memory heavy AASequence object
           AASequence fixed_and_variable_modified_peptide = all_modified_peptides[a_it->peptide_mod_index]; 
 
-          // determine RNA on precursor from index in map
-          std::map<String, std::set<String> >::const_iterator mod_combinations_it = mm.mod_combinations.begin();
-          std::advance(mod_combinations_it, a_it->rna_mod_index);
-          String precursor_rna_adduct = *mod_combinations_it->second.begin();
+          // precomputed marker ions and fragment shifts of the RNA on the precursor
+          const PrecursorAdductSpectra_& precursor_adduct_spectra = adduct_spectra[a_it->rna_mod_index];
 
           // generate all partial loss spectra (excluding the complete loss spectrum) merged into one spectrum
-          // first get all possible RNA fragment shifts in the MS2 (based on the precursor RNA/DNA)
-          const vector<FragmentAdductDefinition_>& partial_loss_modification = all_feasible_fragment_adducts.at(precursor_rna_adduct);
-
           RichPeakSpectrum partial_loss_spectrum;
 
-          // generate total loss spectrum for the fixed and variable modified peptide (without RNA)
-          RichPeakSpectrum total_loss_spectrum, a_ions, b_ions, y_ions;
+          // generate the unshifted ion series for all z <= precursor charge only once: they make up the total loss spectrum
+          // and are shifted by each fragment adduct for the partial loss spectrum
+          vector<RichPeakSpectrum> a_ions(precursor_charge), b_ions(precursor_charge), y_ions(precursor_charge), precursor_ions(precursor_charge);
 
           // TODO for ETD: generate MS2 precursor peaks of the MS1 adduct (total RNA) carrying peptide for all z <= precursor charge  
 
           for (Size z = 1; z <= precursor_charge; ++z)
           {
-            spectrum_generator.addPeaks(a_ions, fixed_and_variable_modified_peptide, Residue::AIon, z);
-            spectrum_generator.addPeaks(b_ions, fixed_and_variable_modified_peptide, Residue::BIon, z);
-            spectrum_generator.addPeaks(y_ions, fixed_and_variable_modified_peptide, Residue::YIon, z);
-            // generate MS2 precursor peaks of the total loss peptide for all z <= precursor charge  
-            spectrum_generator.addPrecursorPeaks(total_loss_spectrum, fixed_and_variable_modified_peptide, z);
+            spectrum_generator.addPeaks(a_ions[z - 1], fixed_and_variable_modified_peptide, Residue::AIon, z);
+            spectrum_generator.addPeaks(b_ions[z - 1], fixed_and_variable_modified_peptide, Residue::BIon, z);
+            spectrum_generator.addPeaks(y_ions[z - 1], fixed_and_variable_modified_peptide, Residue::YIon, z);
+            // generate MS2 precursor peaks of the peptide for all z <= precursor charge  
+            spectrum_generator.addPrecursorPeaks(precursor_ions[z - 1], fixed_and_variable_modified_peptide, z);
           }
-          total_loss_spectrum.insert(total_loss_spectrum.end(), a_ions.begin(), a_ions.end());
-          total_loss_spectrum.insert(total_loss_spectrum.end(), b_ions.begin(), b_ions.end());
-          total_loss_spectrum.insert(total_loss_spectrum.end(), y_ions.begin(), y_ions.end());
-
-          total_loss_spectrum.sortByPosition();
-
-          // TODO: generate unshifted immonium ions to gain confidence in identified peptide sequence
 
-          // Add peaks for marker ions A', G', C' marker ions (presence of these are determined by precursor RNA)
-          RichPeak1D RNA_fragment_peak;
-          RNA_fragment_peak.setIntensity(1.0);
-          if (precursor_rna_adduct.hasSubstring("A"))
+          // generate total loss spectrum for the fixed and variable modified peptide (without RNA)
+          RichPeakSpectrum total_loss_spectrum;
+          for (Size z = 0; z != precursor_charge; ++z)
           {
-            RNA_fragment_peak.setMZ(136.0623); // C5H6N5
-            RNA_fragment_peak.setMetaValue("IonName", "RNA:A'");
-            partial_loss_spectrum.push_back(RNA_fragment_peak);
+            total_loss_spectrum.insert(total_loss_spectrum.end(), precursor_ions[z].begin(), precursor_ions[z].end());
           }
-
-          if (precursor_rna_adduct.hasSubstring("G"))
+          for (Size z = 0; z != precursor_charge; ++z)
           {
-            RNA_fragment_peak.setMZ(152.0572); //C5H6N5O
-            RNA_fragment_peak.setMetaValue("IonName", "RNA:G'");
-            partial_loss_spectrum.push_back(RNA_fragment_peak);
+            total_loss_spectrum.insert(total_loss_spectrum.end(), a_ions[z].begin(), a_ions[z].end());
           }
-
-          if (precursor_rna_adduct.hasSubstring("C"))
+          for (Size z = 0; z != precursor_charge; ++z)
           {
-            RNA_fragment_peak.setMZ(112.0510); // C4H6N3O
-            RNA_fragment_peak.setMetaValue("IonName", "RNA:C'");
-            partial_loss_spectrum.push_back(RNA_fragment_peak);
+            total_loss_spectrum.insert(total_loss_spectrum.end(), b_ions[z].begin(), b_ions[z].end());
           }
+          for (Size z = 0; z != precursor_charge; ++z)
+          {
+            total_loss_spectrum.insert(total_loss_spectrum.end(), y_ions[z].begin(), y_ions[z].end());
+          }
+
+          total_loss_spectrum.sortByPosition();
+
+          // TODO: generate unshifted immonium ions to gain confidence in identified peptide sequence
+
+          // Add peaks for marker ions A', G', C' marker ions (presence of these are determined by precursor RNA)
+          partial_loss_spectrum.insert(partial_loss_spectrum.end(), precursor_adduct_spectra.marker_ions.begin(), precursor_adduct_spectra.marker_ions.end());
+
+          // amino acid giving rise to shifted immonium ions (if present in the sequence)
+          char immonium_ion_aa(0);
+          double immonium_ion_mass(0);
+          bool has_immonium_ion = getImmoniumIon_(unmodified_sequence, immonium_ion_aa, immonium_ion_mass);
 
+          const vector<FragmentAdductShift_>& partial_loss_modification = precursor_adduct_spectra.shifts;
           for (Size i = 0; i != partial_loss_modification.size(); ++i)
           {
             // get name and mass of fragment adduct
             const String& fragment_shift_name = partial_loss_modification[i].name; // e.g. U-H2O
-            //cout << fragment_shift_name << "\t" << partial_loss_modification[i].formula.toString() << endl;
-            const double fragment_shift_mass = partial_loss_modification[i].formula.getMonoWeight();
+            const double fragment_shift_mass = partial_loss_modification[i].mass;
 
             // RNA mass peak
-            RichPeak1D RNA_fragment_peak;
-            RNA_fragment_peak.setIntensity(1.0);
-            RNA_fragment_peak.setMZ(fragment_shift_mass + Constants::PROTON_MASS_U); // there is exactly one RNA fragment modification that we added to this partial loss spectrum. So get the modification and mass to calculate the RNA peak mass.
-            RNA_fragment_peak.setMetaValue("IonName", "RNA:" + fragment_shift_name);  // add name (e.g. RNA:U-H2O)
-            partial_loss_spectrum.push_back(RNA_fragment_peak);
+            partial_loss_spectrum.push_back(partial_loss_modification[i].RNA_fragment_peak);
 
             // Add shifted immonium ion peaks if the amino acid is present in the sequence
-            if (unmodified_sequence.hasSubstring("Y"))
-            {
-              double immonium_ion_mz = EmpiricalFormula("C8H10NO").getMonoWeight() + fragment_shift_mass; 
-              partial_loss_spectrum.push_back(FragmentAnnotationHelper::getAnnotatedImmoniumIon('Y', immonium_ion_mz, fragment_shift_name));
-            }
-            else if (unmodified_sequence.hasSubstring("W"))
-            {
-              double immonium_ion_mz = EmpiricalFormula("C10H11N2").getMonoWeight() + fragment_shift_mass;
-              partial_loss_spectrum.push_back(FragmentAnnotationHelper::getAnnotatedImmoniumIon('W', immonium_ion_mz, fragment_shift_name));
-            }
-            else if (unmodified_sequence.hasSubstring("F"))
-            {
-              double immonium_ion_mz = EmpiricalFormula("C8H10N").getMonoWeight() + fragment_shift_mass;
-              partial_loss_spectrum.push_back(FragmentAnnotationHelper::getAnnotatedImmoniumIon('F', immonium_ion_mz, fragment_shift_name));
-            }
-            else if (unmodified_sequence.hasSubstring("H"))
-            {
-              double immonium_ion_mz = EmpiricalFormula("C5H8N3").getMonoWeight() + fragment_shift_mass;
-              partial_loss_spectrum.push_back(FragmentAnnotationHelper::getAnnotatedImmoniumIon('H', immonium_ion_mz, fragment_shift_name));
-            }
-            else if (unmodified_sequence.hasSubstring("C"))
-            {
-              double immonium_ion_mz = EmpiricalFormula("C2H6NS").getMonoWeight() + fragment_shift_mass;
-              partial_loss_spectrum.push_back(FragmentAnnotationHelper::getAnnotatedImmoniumIon('C', immonium_ion_mz, fragment_shift_name));
-            }
-            else if (unmodified_sequence.hasSubstring("P"))
-            {
-              double immonium_ion_mz = EmpiricalFormula("C4H8N").getMonoWeight() + fragment_shift_mass;
-              partial_loss_spectrum.push_back(FragmentAnnotationHelper::getAnnotatedImmoniumIon('P', immonium_ion_mz, fragment_shift_name));
-            }
-            else if (unmodified_sequence.hasSubstring("L") || unmodified_sequence.hasSubstring("I"))
+            if (has_immonium_ion)
             {
-              double immonium_ion_mz = EmpiricalFormula("C5H12N").getMonoWeight() + fragment_shift_mass;
-              partial_loss_spectrum.push_back(FragmentAnnotationHelper::getAnnotatedImmoniumIon('L', immonium_ion_mz, fragment_shift_name));
-            }
-            else if (unmodified_sequence.hasSubstring("K"))
-            {
-              double immonium_ion_mz = 101.10732 + fragment_shift_mass;
-              partial_loss_spectrum.push_back(FragmentAnnotationHelper::getAnnotatedImmoniumIon('K', immonium_ion_mz, fragment_shift_name));
-              // TODO: add a lysin derived fragment (similar to immonium ion) 84. and 129.10 (ask Aleks)
-
-            }
-            else if (unmodified_sequence.hasSubstring("M"))
-            {
-              double immonium_ion_mz = 104.05285 + fragment_shift_mass;
-              partial_loss_spectrum.push_back(FragmentAnnotationHelper::getAnnotatedImmoniumIon('M', immonium_ion_mz, fragment_shift_name));
+              partial_loss_spectrum.push_back(FragmentAnnotationHelper::getAnnotatedImmoniumIon(immonium_ion_aa, immonium_ion_mass + fragment_shift_mass, fragment_shift_name));
             }
 
             // generate all possible shifted ion a,b,y ion peaks by putting the RNA adduct on them
-            double shift = ModificationsDB::getInstance()->getModification(fragment_shift_name, "", ResidueModification::N_TERM).getDiffMonoMass();
+            double shift = partial_loss_modification[i].series_shift;
  
             RichPeakSpectrum shifted_series_peaks;
 
             for (Size z = 1; z <= precursor_charge; ++z)
             {
-              RichPeakSpectrum a_ions, b_ions, y_ions, precursor_ions;
-              spectrum_generator.addPeaks(a_ions, fixed_and_variable_modified_peptide, Residue::AIon, z);
-              spectrum_generator.addPeaks(b_ions, fixed_and_variable_modified_peptide, Residue::BIon, z);
-              spectrum_generator.addPeaks(y_ions, fixed_and_variable_modified_peptide, Residue::YIon, z);
-
-              // generate MS2 precursor peaks of the MS2 adducts carrying peptide for all z <= precursor charge  
-              spectrum_generator.addPrecursorPeaks(precursor_ions, fixed_and_variable_modified_peptide, z);
-
-              for (Size j = 0; j != a_ions.size(); ++j)
+              // shifted ion series and MS2 precursor peaks of the MS2 adducts carrying peptide for all z <= precursor charge
+              Size first_peak = shifted_series_peaks.size();
+              shifted_series_peaks.insert(shifted_series_peaks.end(), a_ions[z - 1].begin(), a_ions[z - 1].end());
+              shifted_series_peaks.insert(shifted_series_peaks.end(), b_ions[z - 1].begin(), b_ions[z - 1].end());
+              shifted_series_peaks.insert(shifted_series_peaks.end(), y_ions[z - 1].begin(), y_ions[z - 1].end());
+              shifted_series_peaks.insert(shifted_series_peaks.end(), precursor_ions[z - 1].begin(), precursor_ions[z - 1].end());
+
+              for (Size j = first_peak; j != shifted_series_peaks.size(); ++j)
               {
-                a_ions[j].setMZ(a_ions[j].getMZ() + shift / static_cast<double>(z));
+                shifted_series_peaks[j].setMZ(shifted_series_peaks[j].getMZ() + shift / static_cast<double>(z));
               }
-              for (Size j = 0; j != b_ions.size(); ++j)
-              {
-                b_ions[j].setMZ(b_ions[j].getMZ() + shift / static_cast<double>(z));
-              }
-              for (Size j = 0; j != y_ions.size(); ++j)
-              {
-                y_ions[j].setMZ(y_ions[j].getMZ() + shift / static_cast<double>(z));
-              }
-              for (Size j = 0; j != precursor_ions.size(); ++j)
-              {
-                precursor_ions[j].setMZ(precursor_ions[j].getMZ() + shift / static_cast<double>(z));
-              }
-
-              shifted_series_peaks.insert(shifted_series_peaks.end(), a_ions.begin(), a_ions.end());
-              shifted_series_peaks.insert(shifted_series_peaks.end(), b_ions.begin(), b_ions.end());
-              shifted_series_peaks.insert(shifted_series_peaks.end(), y_ions.begin(), y_ions.end());
-              shifted_series_peaks.insert(shifted_series_peaks.end(), precursor_ions.begin(), precursor_ions.end());
             }
 
             // annotate generated a,b,y ions with fragment shift name
@@ -1890,6 +1952,7 @@ protected:
     // parse tool parameter and generate all fragment adducts
     map<String, set<FragmentAdductDefinition_> > precursor_to_fragment_adducts = getPrecursorToFragmentAdducts_(getStringList_("RNPxl:fragment_adducts"));
     map<String, vector<FragmentAdductDefinition_> > all_feasible_fragment_adducts = getAllFeasibleFragmentAdducts_(mm, precursor_to_fragment_adducts);
+    vector<PrecursorAdductSpectra_> adduct_spectra = getPrecursorAdductSpectra_(mm, all_feasible_fragment_adducts);
 
     // load MS2 map
     PeakMap spectra;
@@ -1907,10 +1970,10 @@ protected:
     preprocessSpectra_(spectra, fragment_mass_tolerance, fragment_mass_tolerance_unit_ppm, true);
     progresslogger.endProgress();
 
-    // build multimap of precursor mass to scan index
+    // build sorted index of precursor mass to scan index
     Size fractional_mass_filtered(0);
     Size small_peptide_mass_filtered(0);
-    multimap<double, Size> multimap_mass_2_scan_index;
+    vector<pair<double, Size> > mass_2_scan_index;
     for (PeakMap::ConstIterator s_it = spectra.begin(); s_it != spectra.end(); ++s_it)
     {
       int scan_index = s_it - spectra.begin();
@@ -1945,9 +2008,11 @@ protected:
           continue;
         }
 
-        multimap_mass_2_scan_index.insert(make_pair(precursor_mass, scan_index));
+        mass_2_scan_index.push_back(make_pair(precursor_mass, scan_index));
       }
     }
+    // (stable to keep the order of scans with equal precursor mass)
+    std::stable_sort(mass_2_scan_index.begin(), mass_2_scan_index.end(), PairComparatorFirstElement<pair<double, Size> >());
 
     // create spectrum generator
     TheoreticalSpectrumGenerator spectrum_generator;
@@ -1980,8 +2045,9 @@ protected:
     Size count_proteins = 0;
     Size count_peptides = 0;
 
+    // protein lengths (and therefore the number of candidates) vary strongly: use dynamic scheduling
 #ifdef _OPENMP
-#pragma omp parallel for
+#pragma omp parallel for schedule(dynamic, 10)
 #endif
     for (SignedSize fasta_index = 0; fasta_index < (SignedSize)fasta_db.size(); ++fasta_index)
     {
@@ -2005,11 +2071,8 @@ protected:
 #pragma omp critical (processed_peptides_access)
 #endif
         {
-          if (processed_petides.find(*cit) != processed_petides.end())
-          {
-            // peptide (and all modified variants) already processed so skip it
-            already_processed = true;
-          }
+          // peptide (and all modified variants) already processed (by any thread)? then skip it
+          already_processed = !processed_petides.insert(*cit).second;
         }
 
         if (already_processed)
@@ -2017,13 +2080,6 @@ protected:
           continue;
         }
 
-#ifdef _OPENMP
-#pragma omp critical (processed_peptides_access)
-#endif
-        {
-          processed_petides.insert(*cit);
-        }
-
 #ifdef _OPENMP
 #pragma omp atomic
 #endif
@@ -2053,19 +2109,9 @@ protected:
             double current_peptide_mass = current_peptide_mass_without_RNA + rna_mod_it->second; // add RNA mass
 
             // determine MS2 precursors that match to the current peptide mass
-            multimap<double, Size>::const_iterator low_it;
-            multimap<double, Size>::const_iterator up_it;
-
-            if (precursor_mass_tolerance_unit_ppm) // ppm
-            {
-              low_it = multimap_mass_2_scan_index.lower_bound(current_peptide_mass - current_peptide_mass * precursor_mass_tolerance * 1e-6);
-              up_it = multimap_mass_2_scan_index.upper_bound(current_peptide_mass + current_peptide_mass * precursor_mass_tolerance * 1e-6);
-            }
-            else // Dalton
-            {
-              low_it = multimap_mass_2_scan_index.lower_bound(current_peptide_mass - precursor_mass_tolerance);
-              up_it = multimap_mass_2_scan_index.upper_bound(current_peptide_mass + precursor_mass_tolerance);
-            }
+            const double tolerance = precursor_mass_tolerance_unit_ppm ? current_peptide_mass * precursor_mass_tolerance * 1e-6 : precursor_mass_tolerance;
+            vector<pair<double, Size> >::const_iterator low_it = std::lower_bound(mass_2_scan_index.begin(), mass_2_scan_index.end(), make_pair(current_peptide_mass - tolerance, Size(0)), PairComparatorFirstElement<pair<double, Size> >());
+            vector<pair<double, Size> >::const_iterator up_it = std::upper_bound(mass_2_scan_index.begin(), mass_2_scan_index.end(), make_pair(current_peptide_mass + tolerance, Size(0)), PairComparatorFirstElement<pair<double, Size> >());
 
             if (low_it == up_it) continue; // no matching precursor in data
 
@@ -2143,7 +2189,7 @@ protected:
                      mm, fixed_modifications, variable_modifications, max_variable_mods_per_peptide, 
                      spectrum_generator, 
                      fragment_mass_tolerance, fragment_mass_tolerance_unit_ppm, 
-                     all_feasible_fragment_adducts);
+                     adduct_spectra);
     }
 
     progresslogger.startProgress(0, 1, "annotation...");
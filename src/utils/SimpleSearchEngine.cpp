@@ -42,8 +42,11 @@
 #include <OpenMS/KERNEL/MSExperiment.h>
 #include <OpenMS/FORMAT/MzMLFile.h>
 #include <OpenMS/FORMAT/FASTAFile.h>
+#include <OpenMS/FORMAT/FileHandler.h>
 #include <OpenMS/CHEMISTRY/EnzymaticDigestion.h>
 #include <OpenMS/CHEMISTRY/EnzymesDB.h>
+#include <OpenMS/CHEMISTRY/PeptideCatalogue.h>
+#include <OpenMS/SYSTEM/File.h>
 
 #include <OpenMS/CHEMISTRY/ModificationsDB.h>
 #include <OpenMS/ANALYSIS/RNPXL/ModifiedPeptideGenerator.h>
@@ -70,9 +73,6 @@
 
 #ifdef _OPENMP
   #include <omp.h>
-  #define NUMBER_OF_THREADS (omp_get_num_threads())
-#else
-  #define NUMBER_OF_THREADS (1)
 #endif
 
 
@@ -117,6 +117,8 @@ class SimpleSearchEngine :
       registerInputFile_("database", "<file>", "", "input file ");
       setValidFormats_("database", ListUtils::create<String>("fasta"));
 
+      registerStringOption_("database_cache", "<file>", "", "binary file with the digested peptides of the database. Loaded instead of digesting 'database' if it exists and was created from the same database (path and content) and digestion settings, otherwise (re-)created.", false, true);
+
       registerOutputFile_("out", "<file>", "", "output file ");
       setValidFormats_("out", ListUtils::create<String>("idXML"));
 
@@ -488,134 +490,144 @@ class SimpleSearchEngine :
 
       vector<vector<PeptideHit> > peptide_hits(spectra.size(), vector<PeptideHit>());
 
-      progresslogger.startProgress(0, 1, "Load database from FASTA file...");
-      FASTAFile fastaFile;
-      vector<FASTAFile::FASTAEntry> fasta_db;
-      fastaFile.load(in_db, fasta_db);
-      progresslogger.endProgress();
-
       const Size missed_cleavages = getIntOption_("peptide:missed_cleavages");
       EnzymaticDigestion digestor;
       digestor.setEnzyme(getStringOption_("enzyme"));
       digestor.setMissedCleavages(missed_cleavages);
 
-      progresslogger.startProgress(0, (Size)(fasta_db.end() - fasta_db.begin()), "Scoring peptide models against spectra...");
-
-      // lookup for processed peptides. must be defined outside of omp section and synchronized
-      set<StringView> processed_petides;
-
       // set minimum / maximum size of peptide after digestion
       Size min_peptide_length = getIntOption_("peptide:min_size");
       Size max_peptide_length = getIntOption_("peptide:max_size");
 
-#ifdef _OPENMP
-#pragma omp parallel for
-#endif
-      for (SignedSize fasta_index = 0; fasta_index < (SignedSize)fasta_db.size(); ++fasta_index)
+      // unique peptides of the database (digested in parallel, or loaded from the cache);
+      // everything that influences the digestion (including the database content) is stored with the cache and has to match
+      String database_cache = getStringOption_("database_cache");
+      String catalogue_tag = File::absolutePath(in_db) + ";" + FileHandler::computeFileHash(in_db) + ";" + getStringOption_("enzyme") + ";" + String(missed_cleavages) + ";" +
+                             String(min_peptide_length) + ";" + String(max_peptide_length);
+      PeptideCatalogue catalogue;
+      bool cache_loaded = false;
+      if (!database_cache.empty() && File::exists(database_cache))
       {
-        IF_MASTERTHREAD
-        {
-          progresslogger.setProgress((SignedSize)fasta_index * NUMBER_OF_THREADS);
-        }
-
-        vector<StringView> current_digest;
-        digestor.digestUnmodifiedString(fasta_db[fasta_index].sequence, current_digest, min_peptide_length, max_peptide_length);
-
-        for (vector<StringView>::iterator cit = current_digest.begin(); cit != current_digest.end(); ++cit)
+        try
         {
-          bool already_processed = false;
-#ifdef _OPENMP
-#pragma omp critical (processed_peptides_access)
-#endif
+          catalogue.load(database_cache);
+          if (catalogue.getTag() == catalogue_tag)
           {
-            if (processed_petides.find(*cit) != processed_petides.end())
-            {
-              // peptide (and all modified variants) already processed so skip it
-              already_processed = true;
-            }
+            cache_loaded = true;
           }
-
-          if (already_processed)
+          else
           {
-            continue;
+            writeLog_("Database cache '" + database_cache + "' was created with a different database or settings and will be rebuilt.");
+            catalogue.clear();
           }
+        }
+        catch (Exception::BaseException& e)
+        {
+          writeLog_("Database cache '" + database_cache + "' could not be read (" + String(e.what()) + ") and will be rebuilt.");
+          catalogue.clear();
+        }
+      }
 
+      if (!cache_loaded)
+      {
+        progresslogger.startProgress(0, 1, "Load database from FASTA file...");
+        FASTAFile fastaFile;
+        vector<FASTAFile::FASTAEntry> fasta_db;
+        fastaFile.load(in_db, fasta_db);
+        progresslogger.endProgress();
+
+        progresslogger.startProgress(0, 1, "Digest database...");
+        catalogue.build(fasta_db, digestor, min_peptide_length, max_peptide_length);
+        catalogue.setTag(catalogue_tag);
+        progresslogger.endProgress();
+
+        if (!database_cache.empty())
+        {
+          catalogue.store(database_cache);
+        }
+      }
+
+      progresslogger.startProgress(0, catalogue.size(), "Scoring peptide models against spectra...");
+
+      // every peptide is contained only once in the catalogue, so no bookkeeping of processed peptides is needed
 #ifdef _OPENMP
-#pragma omp critical (processed_peptides_access)
+#pragma omp parallel for schedule(dynamic, 100)
 #endif
-          {
-            processed_petides.insert(*cit);
-          }
+      for (SignedSize peptide_index = 0; peptide_index < (SignedSize)catalogue.size(); ++peptide_index)
+      {
+        IF_MASTERTHREAD
+        {
+          progresslogger.setProgress((SignedSize)peptide_index);
+        }
 
-          vector<AASequence> all_modified_peptides;
+        vector<AASequence> all_modified_peptides;
 
-          // this critial section is because ResidueDB is not thread safe and new residues are created based on the PTMs
+        // this critial section is because ResidueDB is not thread safe and new residues are created based on the PTMs
 #ifdef _OPENMP
 #pragma omp critical (residuedb_access)
 #endif
+        {
+          AASequence aas = AASequence::fromString(catalogue.getSequence(peptide_index));
+          ModifiedPeptideGenerator::applyFixedModifications(fixedMods.begin(), fixedMods.end(), aas);
+          ModifiedPeptideGenerator::applyVariableModifications(varMods.begin(), varMods.end(), aas, max_variable_mods_per_peptide, all_modified_peptides);
+        }
+
+        for (SignedSize mod_pep_idx = 0; mod_pep_idx < (SignedSize)all_modified_peptides.size(); ++mod_pep_idx)
+        {
+          const AASequence& candidate = all_modified_peptides[mod_pep_idx];
+          double current_peptide_mass = candidate.getMonoWeight();
+
+          // determine MS2 precursors that match to the current peptide mass
+          multimap<double, Size>::const_iterator low_it;
+          multimap<double, Size>::const_iterator up_it;
+
+          if (precursor_mass_tolerance_unit_ppm) // ppm
           {
-            AASequence aas = AASequence::fromString(cit->getString());
-            ModifiedPeptideGenerator::applyFixedModifications(fixedMods.begin(), fixedMods.end(), aas);
-            ModifiedPeptideGenerator::applyVariableModifications(varMods.begin(), varMods.end(), aas, max_variable_mods_per_peptide, all_modified_peptides);
+            low_it = multimap_mass_2_scan_index.lower_bound(current_peptide_mass - 0.5 * current_peptide_mass * precursor_mass_tolerance * 1e-6);
+            up_it = multimap_mass_2_scan_index.upper_bound(current_peptide_mass + 0.5 * current_peptide_mass * precursor_mass_tolerance * 1e-6);
           }
-
-          for (SignedSize mod_pep_idx = 0; mod_pep_idx < (SignedSize)all_modified_peptides.size(); ++mod_pep_idx)
+          else // Dalton
           {
-            const AASequence& candidate = all_modified_peptides[mod_pep_idx];
-            double current_peptide_mass = candidate.getMonoWeight();
+            low_it = multimap_mass_2_scan_index.lower_bound(current_peptide_mass - 0.5 * precursor_mass_tolerance);
+            up_it = multimap_mass_2_scan_index.upper_bound(current_peptide_mass + 0.5 * precursor_mass_tolerance);
+          }
 
-            // determine MS2 precursors that match to the current peptide mass
-            multimap<double, Size>::const_iterator low_it;
-            multimap<double, Size>::const_iterator up_it;
+          if (low_it == up_it)
+          {
+            continue;     // no matching precursor in data
+          }
 
-            if (precursor_mass_tolerance_unit_ppm) // ppm
-            {
-              low_it = multimap_mass_2_scan_index.lower_bound(current_peptide_mass - 0.5 * current_peptide_mass * precursor_mass_tolerance * 1e-6);
-              up_it = multimap_mass_2_scan_index.upper_bound(current_peptide_mass + 0.5 * current_peptide_mass * precursor_mass_tolerance * 1e-6);
-            }
-            else // Dalton
-            {
-              low_it = multimap_mass_2_scan_index.lower_bound(current_peptide_mass - 0.5 * precursor_mass_tolerance);
-              up_it = multimap_mass_2_scan_index.upper_bound(current_peptide_mass + 0.5 * precursor_mass_tolerance);
-            }
+          //create theoretical spectrum
+          MSSpectrum<RichPeak1D> theo_spectrum = MSSpectrum<RichPeak1D>();
 
-            if (low_it == up_it)
-            {
-              continue;     // no matching precursor in data
-            }
+          //add peaks for b and y ions with charge 1
+          spectrum_generator.getSpectrum(theo_spectrum, candidate, 1);
 
-            //create theoretical spectrum
-            MSSpectrum<RichPeak1D> theo_spectrum = MSSpectrum<RichPeak1D>();
+          //sort by mz
+          theo_spectrum.sortByPosition();
 
-            //add peaks for b and y ions with charge 1
-            spectrum_generator.getSpectrum(theo_spectrum, candidate, 1);
+          for (; low_it != up_it; ++low_it)
+          {
+            const Size& scan_index = low_it->second;
+            const MSSpectrum<Peak1D>& exp_spectrum = spectra[scan_index];
 
-            //sort by mz
-            theo_spectrum.sortByPosition();
+            double score = HyperScore::compute(fragment_mass_tolerance, fragment_mass_tolerance_unit_ppm, exp_spectrum, theo_spectrum);
 
-            for (; low_it != up_it; ++low_it)
+            // no hit
+            if (score < 1e-16)
             {
-              const Size& scan_index = low_it->second;
-              const MSSpectrum<Peak1D>& exp_spectrum = spectra[scan_index];
-
-              double score = HyperScore::compute(fragment_mass_tolerance, fragment_mass_tolerance_unit_ppm, exp_spectrum, theo_spectrum);
-
-              // no hit
-              if (score < 1e-16)
-              {
-                continue;
-              }
+              continue;
+            }
 
-              PeptideHit hit;
-              hit.setSequence(candidate);
-              hit.setCharge(exp_spectrum.getPrecursors()[0].getCharge());
-              hit.setScore(score);
+            PeptideHit hit;
+            hit.setSequence(candidate);
+            hit.setCharge(exp_spectrum.getPrecursors()[0].getCharge());
+            hit.setScore(score);
 #ifdef _OPENMP
 #pragma omp critical (peptide_hits_access)
 #endif
-              {
-                peptide_hits[scan_index].push_back(hit);
-              }
+            {
+              peptide_hits[scan_index].push_back(hit);
             }
           }
         }